@@ -22,38 +22,72 @@ function doGet(e) {
   else {    
     // Turn the Get Request arguments into a dictionary using the key-value pairs from the request.
     // Adds Date and Time fields to start of dictionary 
-    var data_dict   = getDataDict(e.parameter);
-    
-    // The keys from data_dict is the set of columns in the spreadsheet.
-    var ignore_keys = ["sheetID", "tabID", "null"];    
-    var column_set = difference(Object.keys(data_dict), ignore_keys);
-    
-    // The name of the sheet for the data to go to is the IDtag field that is sent.
-    var sheet_id    = stripQuotes(data_dict['tabID']);
-    var spreadsheet = SpreadsheetApp.openById(data_dict['sheetID']);
-    var sheet_list  = spreadsheet.getSheets();
-    var sheet       = spreadsheet.getSheetByName(sheet_id);
-    
-    // If the tabID is new, then create a sheet for it.
-    if (sheet == undefined) {
-      sheet = spreadsheet.insertSheet(sheet_id);
-      sheet_list = spreadsheet.getSheets();
-//      sheet.appendRow(column_set);
-//      setSheetColumnList(sheet.getName(), column_set);
+    appendRows([getDataDict(e.parameter)]);
+  }
+
+  // Return result of operation
+  return ContentService.createTextOutput(result);
+}
+
+
+// Called with the rows of a batch in the body of a POST request, one row per line,
+// each in the same format as the full_data argument of doGet.
+// The URL carries the other arguments (sheetID, tabID, deviceID) shared by the rows.
+function doPost(e) {
+
+  var result = 'Ok'; // assume success
+
+  if (e.parameter == undefined || e.postData == undefined) {
+    result = 'No Parameters';
+  }
+  else {
+    var rows = e.postData.contents.split('\n');
+    var dicts = [];
+    for (var i = 0; i < rows.length; i++) {
+      if (rows[i].length > 0) dicts.push(getDataDict(e.parameter, rows[i]));
     }
-    
-    // Variable to hold new row and where to put it in the spreadsheet 
-    var new_range;
-    var new_row  = sheet.getLastRow() + 1;
-    var row_data = [];
-    
-    
+    if (dicts.length > 0) appendRows(dicts);
+    result += ' ' + dicts.length;
+  }
+
+  // Return result of operation
+  return ContentService.createTextOutput(result);
+}
+
+
+// Writes rows, each a dictionary from getDataDict, to the sheet of the first row's tabID.
+// Rows with the same set of columns are written with one setValues call.
+function appendRows(dicts) {
+
+  // The keys from data_dict is the set of columns in the spreadsheet.
+  var ignore_keys = ["sheetID", "tabID", "null"];    
+
+  // The name of the sheet for the data to go to is the IDtag field that is sent.
+  var sheet_id    = stripQuotes(dicts[0]['tabID']);
+  var spreadsheet = SpreadsheetApp.openById(dicts[0]['sheetID']);
+  var sheet_list  = spreadsheet.getSheets();
+  var sheet       = spreadsheet.getSheetByName(sheet_id);
+
+  // If the tabID is new, then create a sheet for it.
+  if (sheet == undefined) {
+    sheet = spreadsheet.insertSheet(sheet_id);
+    sheet_list = spreadsheet.getSheets();
+  }
+
+  // Where to put the next row in the spreadsheet 
+  var new_range;
+  var new_row = sheet.getLastRow() + 1;
+
+  var start = 0;
+  while (start < dicts.length) {
+    var column_set = difference(Object.keys(dicts[start]), ignore_keys);
+
     if (new_row <= 2) {
       sheet.appendRow(column_set);
       setSheetColumnList(sheet.getName(), column_set);
       new_row += 1;
     }
-    
+
     // If the set of data received is different than previous for the sheet
     // Put a break between the two data sets and label the columns accurately.
     if (!arraysEqual(column_set, getSheetColumnList(sheet.getName()))) {
@@ -63,25 +97,33 @@ function doGet(e) {
       new_row += 1;
       setSheetColumnList(sheet.getName(), column_set);
     }
-   
-    // The data from the rows are the values from the dictionary where the key is the column name.
-    for (i = 0; i < column_set.length; i++) {
-      row_data.push(data_dict[column_set[i]]);
+
+    // The data from the rows are the values from the dictionary where the key is the column name,
+    // for the following rows with the same columns.
+    var rows_data = [];
+    var end = start;
+    while (end < dicts.length && arraysEqual(column_set, difference(Object.keys(dicts[end]), ignore_keys))) {
+      var row_data = [];
+      for (var i = 0; i < column_set.length; i++) {
+        row_data.push(dicts[end][column_set[i]]);
+      }
+      rows_data.push(row_data);
+      end++;
     }
-    
-    // Write the row to the sheet.
-    new_range = sheet.getRange(new_row, 1, 1, row_data.length);
-    new_range.setValues([row_data]); 
-  }
 
-  // Return result of operation
-  return ContentService.createTextOutput(result);
+    // Write the rows to the sheet.
+    new_range = sheet.getRange(new_row, 1, rows_data.length, column_set.length);
+    new_range.setValues(rows_data);
+    new_row += rows_data.length;
+    start = end;
+  }
 }
 
 
 // Takes in the arguments of the get request
 // Formats it into a dictionary linking keys to their values.
-function getDataDict(get_args) {
+// full_data, if given, is the data of the row instead of the full_data argument.
+function getDataDict(get_args, full_data) {
   
   var data_dict = {};
   var col_list = getMatches(get_args, "key[0-9]+");
@@ -101,6 +143,8 @@ function getDataDict(get_args) {
       data_dict[col_list[i]] = val_list[i];
   }
   
+  if (full_data != undefined) data_dict["full_data"] = full_data;
+
   // Convert data string to array and then dictionary
   var data_array = data_dict["full_data"].split('~');
   for (i = 0; i < data_array.length; i+=2) {
@@ -23,6 +23,7 @@ namespace  {
 // ###
 class ActuatorTemplate : public Actuator
 {
+	LOOM_MODULE_TYPE(ActuatorTemplate, Actuator)
 
 protected:
 
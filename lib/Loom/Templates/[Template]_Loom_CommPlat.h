@@ -23,6 +23,7 @@ namespace Loom {
 // ###
 class CommPlatTemplate : public CommPlat
 {
+	LOOM_MODULE_TYPE(CommPlatTemplate, CommPlat)
 
 protected:
 
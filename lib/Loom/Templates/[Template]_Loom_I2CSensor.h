@@ -23,6 +23,7 @@ namespace Loom {
 // ###
 class I2CSensorTemplate : public I2CSensor
 {
+	LOOM_MODULE_TYPE(I2CSensorTemplate, I2CSensor)
 
 protected:
 
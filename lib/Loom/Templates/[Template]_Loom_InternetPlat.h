@@ -23,6 +23,7 @@ namespace Loom {
 // ###
 class InternetPlatTemplate : public InternetPlat
 {
+	LOOM_MODULE_TYPE(InternetPlatTemplate, InternetPlat)
 
 protected:
 
@@ -22,6 +22,7 @@ namespace Loom {
 // ###
 class LogPlatTemplate : public LogPlat
 {
+	LOOM_MODULE_TYPE(LogPlatTemplate, LogPlat)
 
 protected:
 
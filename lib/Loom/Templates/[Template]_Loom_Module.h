@@ -22,6 +22,7 @@ namespace Loom {
 // ###
 class ModuleTemplate : public Module
 {
+	LOOM_MODULE_TYPE(ModuleTemplate, Module)
 
 protected:
 
@@ -23,6 +23,7 @@ namespace Loom {
 // ###
 class PublishPlatTemplate : public PublishPlat
 {
+	LOOM_MODULE_TYPE(PublishPlatTemplate, PublishPlat)
 
 protected:
 
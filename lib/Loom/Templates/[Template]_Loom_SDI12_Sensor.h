@@ -23,6 +23,7 @@ namespace Loom {
 // ###
 class SDI12SensorTemplate : public SDI12Sensor
 {
+	LOOM_MODULE_TYPE(SDI12SensorTemplate, SDI12Sensor)
 
 protected:
 
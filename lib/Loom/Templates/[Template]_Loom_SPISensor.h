@@ -23,6 +23,7 @@ namespace Loom {
 // ###
 class SPISensorTemplate : public SPISensor
 {
+	LOOM_MODULE_TYPE(SPISensorTemplate, SPISensor)
 
 protected:
 
@@ -23,6 +23,7 @@ namespace Loom {
 // ###
 class SensorTemplate : public Sensor
 {
+	LOOM_MODULE_TYPE(SensorTemplate, Sensor)
 
 protected:
 
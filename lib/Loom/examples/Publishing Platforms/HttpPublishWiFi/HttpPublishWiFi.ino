@@ -0,0 +1,53 @@
+///////////////////////////////////////////////////////////////////////////////
+
+// This is the simplest example of posting data to your own server
+
+// The data is posted over HTTPS as JSON (the same as Feather.display_data()
+// prints), with chunked transfer encoding, to the domain and path in the
+// config. The server should respond with a 2xx status.
+
+// In the config, you need:
+// - WiFi network name and password (or '' if no password)
+// - The domain of your server (ex. example.com) and the path to post to
+
+///////////////////////////////////////////////////////////////////////////////
+
+#include <Loom.h>
+
+// Include configuration
+const char* json_config =
+#include "config.h"
+;
+
+// In Tools menu, set:
+// Internet  > WiFi
+// Sensors   > Enabled
+// Radios    > Disabled
+// Actuators > Disabled
+// Max       > Disabled
+
+using namespace Loom;
+
+Loom::Manager Feather{};
+
+
+void setup()
+{
+	Feather.begin_serial(true);
+	Feather.parse_config(json_config);
+	Feather.print_config();
+
+	LPrintln("\n ** Setup Complete ** ");
+}
+
+
+void loop()
+{
+	Feather.measure();
+	Feather.package();
+	Feather.display_data();
+
+	getHttpPublish(Feather).publish();
+
+	Feather.pause();
+}
@@ -0,0 +1,30 @@
+"{\
+	'general':\
+	{\
+		'device_name':'Device',\
+		'instance_num':1,\
+		'interval':3000\
+	},\
+	'components':[\
+		{\
+			'name':'Analog',\
+			'params':'default'\
+		},\
+		{\
+			'name':'Digital',\
+			'params':'default'\
+		},\
+		{\
+			'name':'WiFi',\
+			'params':['<ssid>','<password>']\
+		},\
+		{\
+			'name':'HttpPublish',\
+			'params':[\
+				'HTTP',\
+				'<your-server-domain>',\
+				'/<your-path>'\
+			]\
+		}\
+	]\
+}"
@@ -0,0 +1,243 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+/// @file		bintocsv.cpp
+/// @brief		Convert BinarySD .bin files to CSV or JSON on a computer.
+/// @details	Build with any C++11 compiler, e.g.
+///					g++ -std=c++11 -O2 -o bintocsv bintocsv.cpp
+///				Usage:
+///					bintocsv binFile csvFile
+///					bintocsv -json binFile jsonFile
+///				CSV output has the same two header rows as the SD module
+///				(categories, then column names), preceded by a Millis column.
+///				JSON output has one packaged data object per line.
+/// @date		2020
+/// @copyright	GNU General Public License v3.0
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#include "../../src/LogPlats/BinarySDFormat.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+using namespace Loom::BinarySDFormat;
+
+struct Column {
+	uint8_t		section;
+	uint8_t		type;
+	std::string	module;
+	std::string	key;
+	unsigned	offset;		///< Offset of value in record
+};
+
+static const char* section_name(const Column& col)
+{
+	switch (col.section) {
+		case ID:		return "ID";
+		case TIMESTAMP:	return "Timestamp";
+		default:		return col.module.c_str();
+	}
+}
+
+static const char* section_key(const unsigned section)
+{
+	return (section == ID) ? "id" : "timestamp";
+}
+
+/// Print one value of a record
+static void print_value(FILE* out, const Column& col, const uint8_t* record, const bool json)
+{
+	const uint8_t* src = record + col.offset;
+	switch (col.type) {
+		case INT: {
+			int32_t v;
+			memcpy(&v, src, 4);
+			fprintf(out, "%d", v);
+			break;
+		}
+		case FLOAT: {
+			float v;
+			memcpy(&v, src, 4);
+			fprintf(out, "%g", v);
+			break;
+		}
+		case BOOL:
+			fprintf(out, json ? (*src ? "true" : "false") : "%d", *src);
+			break;
+		case STRING: {
+			char v[BINARYSD_STRING_SIZE + 1] = {};
+			memcpy(v, src, BINARYSD_STRING_SIZE);
+			fprintf(out, json ? "\"%s\"" : "%s", v);
+			break;
+		}
+	}
+}
+
+static void print_csv_header(FILE* out, const std::vector<Column>& columns)
+{
+	// Row 1: categories, each followed by one comma per column
+	fprintf(out, "Millis,");
+	for (size_t i = 0; i < columns.size(); i++) {
+		const bool first = (i == 0) || (columns[i].section != columns[i-1].section)
+						|| (columns[i].module != columns[i-1].module);
+		fprintf(out, "%s,", first ? section_name(columns[i]) : "");
+	}
+	fprintf(out, "\n");
+
+	// Row 2: column names
+	fprintf(out, "millis,");
+	for (const auto& col : columns) {
+		fprintf(out, "%s,", col.key.c_str());
+	}
+	fprintf(out, "\n");
+}
+
+static void print_csv_record(FILE* out, const std::vector<Column>& columns, const uint8_t* record)
+{
+	uint32_t ms;
+	memcpy(&ms, record, 4);
+
+	fprintf(out, "%u,", ms);
+	for (const auto& col : columns) {
+		print_value(out, col, record, false);
+		fprintf(out, ",");
+	}
+	fprintf(out, "\n");
+}
+
+/// Same structure as Manager::package()
+static void print_json_record(FILE* out, const std::vector<Column>& columns, const uint8_t* record)
+{
+	uint32_t ms;
+	memcpy(&ms, record, 4);
+
+	fprintf(out, "{\"type\":\"data\",\"millis\":%u", ms);
+
+	// "id" and "timestamp" objects
+	for (const uint8_t section : { ID, TIMESTAMP }) {
+		bool first = true;
+		for (const auto& col : columns) {
+			if (col.section != section) continue;
+			fprintf(out, first ? ",\"%s\":{" : ",", section_key(section));
+			fprintf(out, "\"%s\":", col.key.c_str());
+			print_value(out, col, record, true);
+			first = false;
+		}
+		if (!first) fprintf(out, "}");
+	}
+
+	// "contents" array, one block per run of columns of a module
+	const Column* prev = nullptr;
+	for (const auto& col : columns) {
+		if (col.section != CONTENTS) continue;
+		if (!prev || prev->module != col.module) {
+			fprintf(out, prev ? "}},{" : ",\"contents\":[{");
+			fprintf(out, "\"module\":\"%s\",\"data\":{", col.module.c_str());
+		} else {
+			fprintf(out, ",");
+		}
+		fprintf(out, "\"%s\":", col.key.c_str());
+		print_value(out, col, record, true);
+		prev = &col;
+	}
+	if (prev) fprintf(out, "}}]");
+
+	fprintf(out, "}\n");
+}
+
+int main(int argc, char** argv)
+{
+	const bool json = (argc == 4) && (strcmp(argv[1], "-json") == 0);
+	if (argc != (json ? 4 : 3)) {
+		printf("missing arguments:\n");
+		printf("%s [-json] binFile outFile\n", argv[0]);
+		return 1;
+	}
+	const char* bin_name = argv[json ? 2 : 1];
+	const char* out_name = argv[json ? 3 : 2];
+
+	FILE* source = fopen(bin_name, "rb");
+	if (!source) {
+		printf("open failed for %s\n", bin_name);
+		return 1;
+	}
+
+	// Header blocks
+	uint8_t block[BINARYSD_BLOCK_SIZE];
+	Header header;
+	if (fread(block, sizeof(block), 1, source) != 1) {
+		printf("read header failed\n");
+		return 1;
+	}
+	memcpy(&header, block, sizeof(header));
+	if ( memcmp(header.magic, BINARYSD_MAGIC, sizeof(BINARYSD_MAGIC)) != 0 || header.version != BINARYSD_VERSION
+		|| header.header_blocks == 0 || header.record_size > DATA_DIM ) {
+		printf("Not a BinarySD file\n");
+		return 1;
+	}
+
+	std::vector<uint8_t> head(block, block + sizeof(block));
+	for (int i = 1; i < header.header_blocks; i++) {
+		if (fread(block, sizeof(block), 1, source) != 1) {
+			printf("read header failed\n");
+			return 1;
+		}
+		head.insert(head.end(), block, block + sizeof(block));
+	}
+
+	std::vector<Column> columns;
+	size_t pos = sizeof(Header);
+	unsigned record_size = 4;
+	for (int i = 0; i < header.column_count; i++) {
+		Column col;
+		col.section	= head[pos++];
+		col.type	= head[pos++];
+		col.module	= (const char*)&head[pos];
+		pos += col.module.size() + 1;
+		col.key		= (const char*)&head[pos];
+		pos += col.key.size() + 1;
+		col.offset	= record_size;
+		record_size += value_size(col.type);
+		columns.push_back(col);
+	}
+	if (record_size != header.record_size) {
+		printf("Invalid header\n");
+		return 1;
+	}
+
+	FILE* destination = fopen(out_name, "w");
+	if (!destination) {
+		printf("open failed for %s\n", out_name);
+		return 1;
+	}
+
+	printf("Columns: %u, record size: %u bytes\n", header.column_count, header.record_size);
+
+	if (!json) print_csv_header(destination, columns);
+
+	const unsigned max_count = DATA_DIM / header.record_size;
+	unsigned count = 0;
+	unsigned overruns = 0;
+	DataBlock data;
+	while (fread(&data, sizeof(data), 1, source) == 1) {
+		// Erased (unused) blocks end the data
+		if (data.count == 0 || data.count > max_count) break;
+		if (data.overrun) {
+			overruns += data.overrun;
+			if (!json) fprintf(destination, "Overruns,%d\n", data.overrun);
+		}
+		for (unsigned i = 0; i < data.count; i++) {
+			const uint8_t* record = data.data + i * header.record_size;
+			if (json)	print_json_record(destination, columns, record);
+			else		print_csv_record(destination, columns, record);
+		}
+		count += data.count;
+	}
+
+	printf("%u records read, %u overruns\n", count, overruns);
+	fclose(source);
+	fclose(destination);
+	return 0;
+}
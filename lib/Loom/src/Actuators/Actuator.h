@@ -28,6 +28,7 @@ namespace Loom {
 ///////////////////////////////////////////////////////////////////////////////
 class Actuator : public Module
 {
+	LOOM_MODULE_TYPE(Actuator, Module)
 
 public:
 
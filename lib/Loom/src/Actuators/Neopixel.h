@@ -30,6 +30,7 @@ namespace Loom {
 ///////////////////////////////////////////////////////////////////////////////
 class Neopixel : public Actuator
 {
+	LOOM_MODULE_TYPE(Neopixel, Actuator)
 
 protected:
 
@@ -28,6 +28,7 @@ namespace Loom {
 ///////////////////////////////////////////////////////////////////////////////
 class Relay : public Actuator
 {
+	LOOM_MODULE_TYPE(Relay, Actuator)
 
 protected:
 
@@ -39,6 +39,7 @@ namespace Loom {
 ///////////////////////////////////////////////////////////////////////////////
 class Servo : public Actuator
 {
+	LOOM_MODULE_TYPE(Servo, Actuator)
 
 protected:
 
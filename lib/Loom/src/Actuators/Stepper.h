@@ -41,6 +41,7 @@ namespace Loom {
 ///////////////////////////////////////////////////////////////////////////////
 class Stepper : public Actuator
 {
+	LOOM_MODULE_TYPE(Stepper, Actuator)
 
 protected:
 
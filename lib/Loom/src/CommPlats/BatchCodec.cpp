@@ -0,0 +1,238 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+/// @file		BatchCodec.cpp
+/// @brief		File for BatchCodec implementation.
+/// @date		2020
+/// @copyright	GNU General Public License v3.0
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#ifdef LOOM_INCLUDE_RADIOS
+
+#include "BatchCodec.h"
+
+#include <string.h>
+
+using namespace Loom;
+
+/// MsgPack of the keys of a Loom package, most common last (nearest)
+static const char dictionary[] =
+	"\x84" "\xA4" "type" "\xA4" "data" "\xA2" "id" "\x82" "\xA4" "name"
+	"\xA8" "instance" "\xA9" "timestamp" "\x82" "\xA4" "date" "\xA4" "time"
+	"\xA8" "contents" "\x82" "\xA6" "module" "\xA4" "data";
+
+/// Length of dictionary, without its terminator
+static const uint16_t dictionary_len = sizeof(dictionary) - 1;
+
+///////////////////////////////////////////////////////////////////////////////
+BatchCodec::BatchCodec()
+	: history_len(dictionary_len)
+	, encoded(dictionary_len)
+	, packets(0)
+	, block(nullptr)
+	, max_len(0)
+	, len(0)
+	, flags(0)
+	, flag_bit(8)
+	, overflow(false)
+	, pending(0)
+{
+	memcpy(history, dictionary, dictionary_len);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void BatchCodec::begin(uint8_t* block, const uint16_t max_len)
+{
+	this->block		= block;
+	this->max_len	= max_len;
+	len				= BATCH_BLOCK_HEADER;
+	history_len		= dictionary_len;
+	encoded			= dictionary_len;
+	packets			= 0;
+	flag_bit		= 8;
+	overflow		= false;
+	pending			= 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+uint16_t BatchCodec::packet_room() const
+{
+	return (history_len + 2 < BATCH_BLOCK_RAW) ? BATCH_BLOCK_RAW - history_len - 2 : 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void BatchCodec::put(const uint8_t byte)
+{
+	if (len >= max_len) {
+		overflow = true;
+		return;
+	}
+	block[len++] = byte;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool BatchCodec::encode()
+{
+	while (encoded < history_len) {
+		// Longest match, the nearest of equal ones
+		const uint16_t remaining = history_len - encoded;
+		const uint16_t limit = (remaining < BATCH_MATCH_MAX) ? remaining : BATCH_MATCH_MAX;
+		uint16_t best_len = 0;
+		uint16_t best_dist = 0;
+		if (limit >= BATCH_MATCH_MIN) {
+			const int start = (encoded > BATCH_WINDOW) ? encoded - BATCH_WINDOW : 0;
+			for (int c = encoded - 1; c >= start; c--) {
+				if (history[c] != history[encoded]) continue;
+				uint16_t n = 1;
+				while ( (n < limit) && (history[c + n] == history[encoded + n]) ) n++;
+				if (n > best_len) {
+					best_len	= n;
+					best_dist	= encoded - c;
+					if (n == limit) break;
+				}
+			}
+		}
+
+		if (flag_bit == 8) {
+			flags = len;
+			put(0);
+			flag_bit = 0;
+		}
+		if (best_len >= BATCH_MATCH_MIN) {
+			if (!overflow) block[flags] |= 1 << flag_bit;
+			put( (best_dist - 1) & 0xFF );
+			put( (((best_dist - 1) >> 8) << 4) | (best_len - BATCH_MATCH_MIN) );
+			encoded += best_len;
+		} else {
+			put(history[encoded++]);
+		}
+		flag_bit++;
+		if (overflow) return false;
+	}
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool BatchCodec::add(const uint16_t packet_len)
+{
+	if ( (packet_len == 0) || (packet_len > packet_room()) ) return false;
+
+	// Kept to undo the packet if it does not fit
+	const uint16_t	saved_len		= len;
+	const uint16_t	saved_flags		= flags;
+	const uint8_t	saved_bit		= flag_bit;
+	const uint8_t	saved_flag_byte	= (flag_bit < 8) ? block[flags] : 0;
+	const uint16_t	saved_history	= history_len;
+
+	history[history_len]		= packet_len & 0xFF;
+	history[history_len + 1]	= packet_len >> 8;
+	history_len += 2 + packet_len;
+
+	if ( (packets < 255) && encode() ) {
+		packets++;
+		pending = 0;
+		return true;
+	}
+
+	len			= saved_len;
+	flags		= saved_flags;
+	flag_bit	= saved_bit;
+	if (flag_bit < 8) block[flags] = saved_flag_byte;
+	overflow	= false;
+	history_len	= saved_history;
+	encoded		= saved_history;
+	pending		= packet_len;
+	return false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+uint16_t BatchCodec::finish()
+{
+	if (packets == 0) return 0;
+
+	const uint16_t raw_len = history_len - dictionary_len;
+	block[0] = BATCH_BLOCK_MARKER;
+	block[1] = packets;
+	block[2] = raw_len & 0xFF;
+	block[3] = raw_len >> 8;
+	return len;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool BatchCodec::restart()
+{
+	const uint16_t from		= history_len + 2;
+	const uint16_t count	= pending;
+	begin(block, max_len);
+	if (count == 0) return false;
+
+	memmove(packet_buffer(), history + from, count);
+	return add(count);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool BatchCodec::open(const uint8_t* data, const uint16_t data_len)
+{
+	packets = 0;
+	if ( (data_len < BATCH_BLOCK_HEADER) || (data[0] != BATCH_BLOCK_MARKER) ) return false;
+
+	const uint16_t raw_len = data[2] | (data[3] << 8);
+	if (raw_len > BATCH_BLOCK_RAW - dictionary_len) return false;
+
+	const uint16_t end = dictionary_len + raw_len;
+	uint16_t out	= dictionary_len;
+	uint16_t in		= BATCH_BLOCK_HEADER;
+	uint8_t flag	= 0;
+	uint8_t bit		= 8;
+	while (out < end) {
+		if (bit == 8) {
+			if (in >= data_len) return false;
+			flag = data[in++];
+			bit = 0;
+		}
+		if (flag & (1 << bit)) {
+			if (in + 2 > data_len) return false;
+			const uint16_t dist	= (data[in] | ((data[in + 1] >> 4) << 8)) + 1;
+			const uint8_t count	= (data[in + 1] & 0x0F) + BATCH_MATCH_MIN;
+			in += 2;
+			if ( (dist > out) || (out + count > end) ) return false;
+
+			// Byte by byte, a match can overlap what it produces
+			for (auto i = 0; i < count; i++, out++) {
+				history[out] = history[out - dist];
+			}
+		} else {
+			if (in >= data_len) return false;
+			history[out++] = data[in++];
+		}
+		bit++;
+	}
+
+	history_len	= end;
+	encoded		= dictionary_len;
+	packets		= data[1];
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+uint16_t BatchCodec::next(const uint8_t*& packet)
+{
+	if ( (packets == 0) || (encoded + 2 > history_len) ) {
+		packets = 0;
+		return 0;
+	}
+
+	const uint16_t packet_len = history[encoded] | (history[encoded + 1] << 8);
+	if (encoded + 2 + packet_len > history_len) {
+		packets = 0;
+		return 0;
+	}
+	packet = history + encoded + 2;
+	encoded += 2 + packet_len;
+	packets--;
+	return packet_len;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+#endif // ifdef LOOM_INCLUDE_RADIOS
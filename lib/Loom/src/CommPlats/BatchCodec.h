@@ -0,0 +1,148 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+/// @file		BatchCodec.h
+/// @brief		File for BatchCodec definition.
+///				Compression of batch packets for bulk transfer.
+/// @date		2020
+/// @copyright	GNU General Public License v3.0
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <stdint.h>
+
+namespace Loom {
+
+///////////////////////////////////////////////////////////////////////////////
+
+#define BATCH_BLOCK_MARKER		0xD7	///< First byte of compressed batch blocks (MsgPack fixext, never a json)
+#define BATCH_BLOCK_HEADER		4		///< Bytes of a block before the compressed packets
+#define BATCH_BLOCK_RAW			2048	///< Bytes of history: the dictionary, then the packets (with their lengths) of a block
+#define BATCH_WINDOW			4096	///< Farthest back a match can reach (12 bit offsets)
+#define BATCH_MATCH_MIN			3		///< Shortest match, shorter repeats are sent as literals
+#define BATCH_MATCH_MAX			18		///< Longest match (4 bit lengths)
+
+
+///////////////////////////////////////////////////////////////////////////////
+///
+/// Compresses runs of batch packets (MsgPack of packaged json, as BatchSD
+/// stores them) into blocks, and reads the packets back out of a block.
+///
+/// A block is
+///
+///		BATCH_BLOCK_MARKER, packet count (uint8_t),
+///		length of the packets (uint16_t little-endian), compressed packets
+///
+/// The packets, each preceded by its length (uint16_t little-endian), are
+/// compressed with LZSS: a flag byte precedes each group of 8 items, its
+/// bits (lowest first) telling a literal byte from a match of 2 bytes:
+/// the low 8 bits of the distance back minus 1, then its high 4 bits
+/// above the length minus BATCH_MATCH_MIN.
+///
+/// Matches can reach into a dictionary that precedes the packets on both
+/// ends: the MsgPack of the keys every Loom package has, so even the first
+/// packet of a block compresses. Later packets of the same device
+/// mostly repeat earlier ones.
+///
+/// Needs no memory besides the history of the block being compressed or
+/// read, and no tables: matches are found by searching the history, fast
+/// enough for the packets of a batch.
+///
+///////////////////////////////////////////////////////////////////////////////
+class BatchCodec
+{
+
+public:
+
+//=============================================================================
+///@name	CONSTRUCTORS / DESTRUCTOR
+/*@{*/ //======================================================================
+
+	/// Constructor
+	BatchCodec();
+
+//=============================================================================
+///@name	COMPRESSING
+/*@{*/ //======================================================================
+
+	/// Start a block
+	/// @param[out]	block	Buffer to compress into
+	/// @param[in]	max_len	Size of block
+	void		begin(uint8_t* block, const uint16_t max_len);
+
+	/// Where to copy the next packet before add()
+	/// @return Space in the history for the packet
+	uint8_t*	packet_buffer() { return history + history_len + 2; }
+
+	/// Size of packet_buffer()
+	/// @return Longest packet the block can still take
+	uint16_t	packet_room() const;
+
+	/// Compress the packet copied to packet_buffer() into the block.
+	/// If it does not fit, the block is left as it was, and the packet is
+	/// kept for restart()
+	/// @param[in]	len		Length of the packet
+	/// @return True if the packet was added
+	bool		add(const uint16_t len);
+
+	/// Finish the block
+	/// @return Length of the block, 0 if it holds no packets
+	uint16_t	finish();
+
+	/// Start a new block in the same buffer with the packet add() refused
+	/// @return True if the packet was added
+	bool		restart();
+
+	/// Number of packets in the block
+	/// @return Packet count
+	uint8_t		count() const { return packets; }
+
+//=============================================================================
+///@name	READING
+/*@{*/ //======================================================================
+
+	/// Decompress a block, for next() to read its packets
+	/// @param[in]	block	Block, starting with BATCH_BLOCK_MARKER
+	/// @param[in]	len		Length of block
+	/// @return False if the block is malformed
+	bool		open(const uint8_t* block, const uint16_t len);
+
+	/// Read the next packet of the opened block
+	/// @param[out]	packet	Set to the packet (valid until the next open() or begin())
+	/// @return Length of the packet, 0 if none is left
+	uint16_t	next(const uint8_t*& packet);
+
+	/// Number of packets of the opened block not read yet
+	/// @return Packets left
+	uint8_t		remaining() const { return packets; }
+
+private:
+
+	/// Compress the history from encoded up to history_len
+	/// @return False if the block ran out of space
+	bool		encode();
+
+	/// Append a byte to the block
+	void		put(const uint8_t byte);
+
+	uint8_t		history[BATCH_BLOCK_RAW];	///< Dictionary, then the packets of the block
+
+	uint16_t	history_len;	///< Bytes in history
+	uint16_t	encoded;		///< Bytes of history compressed into the block, or read by next()
+	uint8_t		packets;		///< Packets in the block, or left to read
+
+	uint8_t*	block;			///< Block being compressed
+	uint16_t	max_len;		///< Size of block
+	uint16_t	len;			///< Length of block
+	uint16_t	flags;			///< Position of the current flag byte in block
+	uint8_t		flag_bit;		///< Next bit of the flag byte, 8 when a new one is needed
+	bool		overflow;		///< Whether a byte did not fit in block
+
+	uint16_t	pending;		///< Length of the packet add() refused, 0 if none
+
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+}; // namespace Loom
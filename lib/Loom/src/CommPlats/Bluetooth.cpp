@@ -61,6 +61,28 @@ void Bluetooth::connect(const uint16_t connect_timeout)
 	}
 }
 
+///////////////////////////////////////////////////////////////////////////////
+bool Bluetooth::send_impl(JsonObject json, const uint8_t destination)
+{
+  LMark;
+	const uint16_t len = json_to_msgpack_buffer(json, send_buffer, max_message_len);
+	if (len == 0 || len > max_message_len) return false;
+
+	return send_raw(send_buffer, len, destination);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool Bluetooth::send_raw(uint8_t* bytes, const uint8_t len, const uint8_t destination)
+{
+	if ( !BLE.isConnected() || (len > max_message_len) ) return false;
+
+	bool is_sent = BLE.write(bytes, len) == len;
+
+	print_module_label();
+	LPrintln("Send " , (is_sent) ? "successful" : "failed" );
+	return is_sent;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 int8_t Bluetooth::getCommand(const uint16_t max_timeout )
 {
@@ -32,6 +32,7 @@ namespace Loom {
 ///////////////////////////////////////////////////////////////////////////////
 class Bluetooth : public CommPlat
 {
+	LOOM_MODULE_TYPE(Bluetooth, CommPlat)
 
 protected:
 
@@ -41,8 +42,25 @@ protected:
 	uint8_t spi_IRQ;	///< SPI IRQ pin
 	uint8_t spi_RST;	///< SPI reset pin
 
+//=============================================================================
+///@name	RADIO IMPLEMENTATION
+/*@{*/ //======================================================================
+
+	/// Send json to the connected device, as MessagePack over the UART
+	/// @param[in]	json			Json package to send
+	/// @param[in]	destination		Unused, Bluetooth does not use addresses
+	/// @return True if packet sent successfully
+	bool send_impl(JsonObject json, const uint8_t destination) override;
+
 public:
 
+	/// Escape hatch for sending raw bytes
+	/// @param[in] bytes			Bytes to send
+	/// @param[in] len				Number of bytes to send
+	/// @param[in] destination		Unused, Bluetooth does not use addresses
+	/// @return True if a device is connected and the bytes were written
+	bool send_raw(uint8_t* bytes, const uint8_t len, const uint8_t destination) override;
+
 //=============================================================================
 ///@name	CONSTRUCTORS / DESTRUCTOR
 /*@{*/ //======================================================================
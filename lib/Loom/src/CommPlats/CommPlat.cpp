@@ -12,9 +12,47 @@
 
 #include "CommPlat.h"
 #include "Manager.h"
+#include "../InterruptManager.h"
+#include "../RTC/RTC.h"
 
 using namespace Loom;
 
+namespace {
+
+///////////////////////////////////////////////////////////////////////////////
+/// ArduinoJson writer into a fixed buffer that keeps counting past its end,
+/// so one serialization gives both the bytes and the full length
+class BufferWriter
+{
+
+public:
+
+	BufferWriter(uint8_t* buffer, const size_t max_len) : buffer(buffer), max_len(max_len), len(0) {}
+
+	size_t write(const uint8_t c)
+	{
+		if (len < max_len) buffer[len] = c;
+		len++;
+		return 1;
+	}
+
+	size_t write(const uint8_t* s, const size_t n)
+	{
+		if (len < max_len) memcpy(buffer + len, s, (n < max_len - len) ? n : max_len - len);
+		len += n;
+		return n;
+	}
+
+private:
+
+	uint8_t*		buffer;
+	const size_t	max_len;
+	size_t			len;
+
+};
+
+} // namespace
+
 ///////////////////////////////////////////////////////////////////////////////
 CommPlat::CommPlat(
 		const char*							module_name,
@@ -29,14 +67,53 @@ CommPlat::CommPlat(
 	, last_ten_dropped{}
 	, last_ten_dropped_idx(0)
 	, mergeJson(2048)
+	, reassembly(nullptr)
+	, next_message_id(0)
+	, compact_encoding(false)
+	, wire_record(nullptr)
+	, wire_schemas(nullptr)
+	, receive_queue(nullptr)
+	, last_source(0)
+	, announced_id(0)
+	, announced_destination(0)
+	, since_announce(SCHEMA_REANNOUNCE)
+	, aggregate_samples(1)
+	, sample_buffer(nullptr)
+	, received_samples(nullptr)
+	, compress_batch(false)
+	, batch_codec(nullptr)
+	, received_batch(nullptr)
+	, batch_source(0)
+	, batch_rssi(0)
+	, routing(nullptr)
+	, relay(nullptr)
+	, slots(nullptr)
 	, override_name(override_name)
 {}
 
+///////////////////////////////////////////////////////////////////////////////
+CommPlat::~CommPlat()
+{
+	delete reassembly;
+	delete wire_record;
+	delete wire_schemas;
+	delete receive_queue;
+	delete sample_buffer;
+	delete received_samples;
+	delete batch_codec;
+	delete received_batch;
+	delete routing;
+	delete relay;
+	delete slots;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 void CommPlat::print_config() const
 {
 	Module::print_config();
 	LPrintln("\tMax Message Length  : ", max_message_len );
+	LPrintln("\tCompact Encoding    : ", (compact_encoding) ? "Enabled" : "Disabled" );
+	LPrintln("\tBatch Compression   : ", (compress_batch) ? "Enabled" : "Disabled" );
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -45,6 +122,22 @@ void CommPlat::print_state() const
 	Module::print_state();
 	LPrintln("\tDrop Rate Since Start  : ", get_drop_rate() );
 	LPrintln("\tCurrent Drop Rate  : ", get_last_ten_drop_rate() );
+	if (receive_queue) {
+		LPrintln("\tQueued Messages  : ", receive_queue->order_count );
+		LPrintln("\tQueue Drops  : ", receive_queue->dropped );
+	}
+	if (sample_buffer) {
+		LPrintln("\tBuffered Samples  : ", get_buffered_samples() );
+		LPrintln("\tLost Samples  : ", get_lost_samples() );
+	}
+	if (slots) {
+		LPrintln("\tSlot Synchronized  : ", (slots->synced) ? "Yes" : "No" );
+		LPrintln("\tBeacons  : ", slots->beacons );
+	}
+	if (relay) {
+		LPrintln("\tForwarded Frames  : ", relay->forwarded );
+		LPrintln("\tDuplicates Dropped  : ", relay->duplicates );
+	}
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -82,7 +175,12 @@ bool CommPlat::receive()
 ///////////////////////////////////////////////////////////////////////////////
 bool CommPlat::receive_blocking(JsonObject json, const uint max_wait_time)
 {
-	bool status = receive_blocking_impl(json, max_wait_time);
+	// Samples or batch packets of the last message are returned before anything new
+	if (receive_sample(json) || receive_batched(json)) return true;
+
+	bool status = supports_frames()
+		? receive_frames(json, max_wait_time)
+		: receive_blocking_impl(json, max_wait_time);
 
 	// If there is a value called "Num_Package", then it will recognize that there are more packages
 	JsonObject checker = device_manager -> internal_json();
@@ -193,22 +291,33 @@ bool CommPlat::receive_batch_blocking(uint max_wait_time){
 ///////////////////////////////////////////////////////////////////////////////
 bool	CommPlat::send(JsonObject json, const uint8_t destination) {
 
-	char buffer[max_message_len];
-	uint16_t sizeJsonObject = serializeMsgPack(json, buffer, max_message_len);
+	// Data that fits a record is sent by schema instead of as MsgPack
+	if ( (compact_encoding || aggregate_samples > 1) && supports_frames() && compile_wire_record(json) ) {
+		if (aggregate_samples > 1) return send_sample(*wire_record, destination);
+		const bool status = send_record(*wire_record, destination);
+		add_packet_result(!status);
+		return status;
+	}
+
+	// Encoded once, the same bytes are sent whole or in fragments
+	const uint16_t sizeJsonObject = json_to_msgpack_buffer(json, send_buffer, sizeof(send_buffer));
 	bool prestatus;
 	bool status;
 
+	if (supports_frames() && sizeJsonObject <= sizeof(send_buffer)) {
+		status = send_message(send_buffer, sizeJsonObject, destination);
+	}
 	// If json package size is over 252, then send into multiple packages
-	if (sizeJsonObject >= 252){
+	else if (sizeJsonObject >= 252){
 		prestatus = split_send_notification(json, destination);
 		if (prestatus) status = split_send(json, destination, 0);
 		else{
 			status = false;
 		}
 	}
-	// Else, just send as it is
+	// Else, send the encoded bytes as they are
 	else{
-		status = send_impl(json, destination);
+		status = (sizeJsonObject > 0) && send_raw(send_buffer, sizeJsonObject, destination);
 	}
 	add_packet_result(!status);
 	return status;
@@ -219,6 +328,14 @@ bool CommPlat::send(const uint8_t destination)
 {
   LMark;
 	if (device_manager != nullptr) {
+		// Manager's compiled record is already in the form sent by schema
+		const Record* record = device_manager->get_record();
+		if ( (compact_encoding || aggregate_samples > 1) && supports_frames() && record ) {
+			if (aggregate_samples > 1) return send_sample(*record, destination);
+			const bool status = send_record(*record, destination);
+			add_packet_result(!status);
+			return status;
+		}
    	LMark;
 		JsonObject tmp = device_manager->internal_json();
    	LMark;
@@ -229,7 +346,7 @@ bool CommPlat::send(const uint8_t destination)
 }
 
 ///////////////////////////////////////////////////////////////////////////////
-uint8_t CommPlat::send_batch(const uint8_t destination, int delay_time){
+uint8_t CommPlat::send_batch(const uint8_t destination, int delay_time, const bool raw){
 	BatchSD* batch;
 	// check to make sure we have BatchSD module connected
 	if (device_manager && (batch = device_manager->get<BatchSD>()) ) {
@@ -237,12 +354,14 @@ uint8_t CommPlat::send_batch(const uint8_t destination, int delay_time){
 		int packets = batch->get_packet_counter();
 		print_module_label();
 		LPrintln("Packets to send: ", packets);
-		JsonObject tmp;
-		// For all the jsons stored in the batch, run the sebd function using the json
-		for(int i=0; i < packets; i++){
-			tmp = batch->get_batch_json(i);
-			if(!send(tmp, destination)) drop_count++;;
-			device_manager->pause(delay_time);
+		if (raw && compress_batch && supports_frames()) {
+			drop_count = send_batch_blocks(*batch, destination, delay_time);
+		} else {
+			// For all the jsons stored in the batch, run the sebd function using the json
+			for(int i=0; i < packets; i++){
+				if (!send_batch_packet(*batch, i, destination, raw)) drop_count++;
+				device_manager->pause(delay_time);
+			}
 		}
 		// Clear the batch for the next batching to start
 		batch->clear_batch_log();
@@ -252,6 +371,104 @@ uint8_t CommPlat::send_batch(const uint8_t destination, int delay_time){
 	return -1;
 }
 
+///////////////////////////////////////////////////////////////////////////////
+bool CommPlat::send_batch_packet(BatchSD& batch, const int index, const uint8_t destination, const bool raw)
+{
+	// Packets too long for a frame are fragmented as they are stored
+	const uint16_t buffer_len = supports_frames() ? sizeof(send_buffer) : max_message_len;
+
+	// Stored packets are already MsgPack, only packets that need
+	// splitting (same limit as send()) have to be parsed
+	const int len = raw ? batch.get_batch_raw(index, send_buffer, buffer_len) : 0;
+	if (len < 0) {
+		add_packet_result(true);
+		return false;
+	}
+	if (raw && supports_frames()) wait_slot();
+
+	if (raw && len < 252 && len <= max_message_len && get_next_hop(destination) == destination) {
+		const bool status = send_raw(send_buffer, len, destination);
+		add_packet_result(!status);
+		return status;
+	} else if (raw && supports_frames() && len <= buffer_len) {
+		const bool status = send_fragmented(send_buffer, len, destination);
+		add_packet_result(!status);
+		return status;
+	}
+	return send(batch.get_batch_json(index), destination);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+uint8_t CommPlat::send_batch_blocks(BatchSD& batch, const uint8_t destination, const int delay_time)
+{
+	if (!batch_codec) {
+		batch_codec = new BatchCodec();
+	}
+	BatchCodec& codec = *batch_codec;
+	const int packets = batch.get_packet_counter();
+	uint8_t drop_count = 0;
+	uint8_t blocks = 0;
+
+	// Send the block compressed so far, if any
+	const auto send_block = [&]{
+		const uint8_t count = codec.count();
+		const uint16_t len = codec.finish();
+		if (len == 0) return;
+		const bool status = send_message(send_buffer, len, destination);
+		add_packet_result(!status);
+		if (!status) drop_count += count;
+		blocks++;
+		device_manager->pause(delay_time);
+	};
+
+	// Packets are read straight into the codec's history
+	codec.begin(send_buffer, sizeof(send_buffer));
+	for (int i = 0; i < packets; i++) {
+		int len = batch.get_batch_raw(i, codec.packet_buffer(), codec.packet_room());
+		if ( (len > codec.packet_room()) && (codec.count() > 0) ) {
+			send_block();
+			codec.begin(send_buffer, sizeof(send_buffer));
+			len = batch.get_batch_raw(i, codec.packet_buffer(), codec.packet_room());
+		}
+		if (len < 0) {
+			add_packet_result(true);
+			drop_count++;
+			continue;
+		}
+
+		bool added = (len <= codec.packet_room()) && codec.add(len);
+		if (!added && (len <= codec.packet_room()) && (codec.count() > 0)) {
+			send_block();
+			added = codec.restart();
+		}
+
+		// Too long for a block even alone, sent as it is
+		if (!added) {
+			codec.begin(send_buffer, sizeof(send_buffer));
+			if (!send_batch_packet(batch, i, destination, true)) drop_count++;
+			device_manager->pause(delay_time);
+		}
+	}
+	send_block();
+
+	print_module_label();
+	LPrintln("Sent ", packets, " packets in ", blocks, " blocks");
+	return drop_count;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool CommPlat::send_raw(uint8_t* bytes, const uint8_t len, const uint8_t destination)
+{
+	// Platform can't send a buffer directly
+	messageJson.clear();
+	if (deserializeMsgPack(messageJson, (const char*)bytes, len) != DeserializationError::Ok) {
+		print_module_label();
+		LPrintln("Failed to parse MsgPack");
+		return false;
+	}
+	return send_impl(messageJson.as<JsonObject>(), destination);
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 uint16_t CommPlat::determine_json_size(JsonObject json){
 
@@ -337,8 +554,936 @@ bool CommPlat::split_send(JsonObject json, const uint8_t destination, const uint
 	if(json["contents"][contentIndex].isNull()) return true;
 	// else, it will keep creating and sending small json packages
 
-	split_send(json, destination, contentIndex);
+	return split_send(json, destination, contentIndex);
+
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool CommPlat::send_fragmented(const uint8_t* message, const uint16_t len, const uint8_t destination)
+{
+	const uint8_t payload = frame_len() - FRAGMENT_HEADER_LEN;
+	const uint16_t count = (len + payload - 1) / payload;
+	if (count > FRAGMENT_MAX_COUNT) {
+		print_module_label();
+		LPrintln("Message too long to fragment: ", len, " bytes");
+		return false;
+	}
+
+	const uint8_t id = next_message_id++;
+	const uint8_t next_hop = get_next_hop(destination);
+	uint32_t pending = (count == 32) ? 0xFFFFFFFF : ((1UL << count) - 1);
+	uint8_t frame[FRAGMENT_FRAME_LEN];
+	uint8_t retries = 0;
+
+	frame[0] = FRAGMENT_MARKER;
+	frame[2] = get_address();
+	frame[3] = destination;
+	frame[4] = id;
+	frame[6] = count;
+
+	while (pending && retries < FRAGMENT_RETRIES) {
+		// The next window is the first fragments not yet acknowledged
+		uint8_t window[FRAGMENT_WINDOW];
+		uint8_t window_len = 0;
+		for (uint8_t i = 0; i < count && window_len < FRAGMENT_WINDOW; i++) {
+			if (pending & (1UL << i)) window[window_len++] = i;
+		}
+
+		const unsigned long window_start = millis();
+		for (uint8_t w = 0; w < window_len; w++) {
+			const uint8_t index = window[w];
+			const uint16_t offset = index * payload;
+			const uint8_t chunk = (len - offset < payload) ? len - offset : payload;
+			frame[1] = (w == window_len - 1) ? (FRAGMENT_DATA | FRAGMENT_ACK_REQUEST) : FRAGMENT_DATA;
+			frame[5] = index;
+			frame[7] = offset & 0xFF;
+			frame[8] = offset >> 8;
+			memcpy(frame + FRAGMENT_HEADER_LEN, message + offset, chunk);
+			send_frame(frame, FRAGMENT_HEADER_LEN + chunk, next_hop);
+		}
+
+		// Each repeater on the way sends the window on before the acknowledgement comes back
+		const uint timeout = FRAGMENT_ACK_TIMEOUT
+			+ ((next_hop != destination) ? ROUTE_MAX_HOPS * (millis() - window_start) : 0);
+
+		// Only a lost window or acknowledgement counts as a retry
+		uint32_t received;
+		if (wait_fragment_ack(id, destination, received, timeout) && (pending & received)) {
+			pending &= ~received;
+			retries = 0;
+		} else {
+			// Randomized, so the windows of senders that collided drift apart
+			retries++;
+			if (retries < FRAGMENT_RETRIES) delay(random(FRAGMENT_ACK_TIMEOUT / 2));
+		}
+	}
+	frames_done();
+
+	print_module_label();
+	LPrintln("Send of ", count, " fragments ", (pending == 0) ? "successful" : "failed");
+	return pending == 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool CommPlat::send_message(uint8_t* message, const uint16_t len, const uint8_t destination)
+{
+	wait_slot();
+
+	// Only fragments carry the destination through repeaters
+	return (len <= frame_len() && get_next_hop(destination) == destination)
+		? send_raw(message, len, destination)
+		: send_fragmented(message, len, destination);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool CommPlat::compile_wire_record(JsonObjectConst json)
+{
+	if (!wire_record) {
+		wire_record = new Record();
+	}
+	Record& record = *wire_record;
+	record.begin_fill();
+
+	// Recompile only when the json's keys no longer match
+	if ( (record.segment_count() == 0) || !record.copy_segment(0, json) ) {
+		record.reset();
+		if ( !record.add_segment(nullptr, json) || !record.copy_segment(0, json) ) {
+			record.reset();
+			return false;
+		}
+	}
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool CommPlat::announce_schema(const Record& record, const uint8_t destination)
+{
+	const uint32_t id = WireSchema::schema_id(record);
+
+	// Announce a new schema, and repeat it now and then for hubs that restarted
+	if ( (id != announced_id) || (destination != announced_destination) || (since_announce >= SCHEMA_REANNOUNCE) ) {
+		const uint16_t len = WireSchema::encode_announce(record, send_buffer, sizeof(send_buffer));
+		if ( (len == 0) || !send_message(send_buffer, len, destination) ) {
+			print_module_label();
+			LPrintln("Failed to announce schema");
+			return false;
+		}
+		announced_id			= id;
+		announced_destination	= destination;
+		since_announce			= 0;
+	}
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool CommPlat::send_record(const Record& record, const uint8_t destination)
+{
+	if (!announce_schema(record, destination)) return false;
+
+	const uint16_t len = WireSchema::encode_data(record, send_buffer, sizeof(send_buffer));
+	if (len == 0) return false;
+	since_announce++;
+	return send_message(send_buffer, len, destination);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void CommPlat::set_aggregation(const uint8_t n)
+{
+	aggregate_samples = (n > 1) ? n : 1;
+	// send() no longer gets to retry the packet
+	if ( (aggregate_samples == 1) && !flush_samples() ) drop_samples();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool CommPlat::send_sample(const Record& record, const uint8_t destination)
+{
+	if (!sample_buffer) {
+		sample_buffer = new Samples{};
+	}
+	Samples& s = *sample_buffer;
+
+	// Add to the packet being filled if it is of the same record and destination,
+	// a packet that failed to send is sent again as soon as it takes the sample
+	if (s.len > 0) {
+		const uint32_t id = WireSchema::schema_id(record);
+		if ( (destination == s.address) && (memcmp(s.packet + 1, &id, 4) == 0) ) {
+			const uint16_t len = WireSchema::append_sample(record, s.packet, s.len, frame_len());
+			if (len > 0) {
+				s.len = len;
+				return ( (s.attempts == 0) && (WireSchema::sample_count(s.packet) < aggregate_samples) ) || flush_samples();
+			}
+		}
+	}
+
+	// Send the packet to make room. One that fails again, and is still kept,
+	// leaves no room for the sample
+	const bool flushed = flush_samples();
+	if (s.len > 0) {
+		s.lost++;
+		add_packet_result(true);
+		return false;
+	}
+
+	// A packet is only started once the hub knows its schema
+	if (!announce_schema(record, destination)) {
+		s.lost++;
+		add_packet_result(true);
+		return false;
+	}
+	s.len = WireSchema::encode_samples(record, s.packet, frame_len());
+	if (s.len == 0) {
+		// Too long for a frame even alone, sent by itself
+		const bool status = send_record(record, destination);
+		if (!status) s.lost++;
+		add_packet_result(!status);
+		return flushed && status;
+	}
+	s.address	= destination;
+	s.attempts	= 0;
+	return flushed && ( (aggregate_samples > 1) || flush_samples() );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool CommPlat::flush_samples()
+{
+	if (!sample_buffer || sample_buffer->len == 0) return true;
+	Samples& s = *sample_buffer;
 
+	since_announce++;
+	if (!send_message(s.packet, s.len, s.address)) {
+		// Kept for the next send() or flush_samples(), until out of attempts
+		print_module_label();
+		LPrintln("Failed to send ", WireSchema::sample_count(s.packet), " samples");
+		if (++s.attempts >= SAMPLES_SEND_ATTEMPTS) drop_samples();
+		return false;
+	}
+
+	// The drop rate counts samples, as when sent one at a time
+	const uint8_t count = WireSchema::sample_count(s.packet);
+	for (auto i = 0; i < count; i++) add_packet_result(false);
+	print_module_label();
+	LPrintln("Sent ", count, " samples in ", s.len, " bytes");
+	s.len		= 0;
+	s.attempts	= 0;
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void CommPlat::drop_samples()
+{
+	if (!sample_buffer || sample_buffer->len == 0) return;
+	Samples& s = *sample_buffer;
+
+	const uint8_t count = WireSchema::sample_count(s.packet);
+	for (auto i = 0; i < count; i++) add_packet_result(true);
+	s.lost += count;
+	print_module_label();
+	LPrintln("Lost ", count, " samples");
+	s.len		= 0;
+	s.attempts	= 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool CommPlat::receive_sample(JsonObject json)
+{
+	if (!received_samples) return false;
+	Samples& s = *received_samples;
+
+	while ( (s.len > 0) && (s.next < WireSchema::sample_count(s.packet)) ) {
+		last_source		= s.address;
+		signal_strength	= s.rssi;
+		if ( wire_schemas && wire_schemas->decode_sample(s.packet, s.len, s.next++, json) ) {
+			if (override_name) strcpy(device_manager->temp_device_name, json["id"]["name"]);
+			return true;
+		}
+	}
+	s.len = 0;
+	return false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool CommPlat::receive_batched(JsonObject json)
+{
+	if (!received_batch) return false;
+
+	// Packets that fail to parse are skipped
+	const uint8_t* packet;
+	uint16_t len;
+	while ( (len = received_batch->next(packet)) > 0 ) {
+		last_source		= batch_source;
+		signal_strength	= batch_rssi;
+		if (msgpack_buffer_to_json((const char*)packet, json, mergeJson, len)) return true;
+	}
+	return false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool CommPlat::wait_fragment_ack(const uint8_t id, const uint8_t destination, uint32_t& received, const uint timeout)
+{
+	uint8_t frame[FRAGMENT_FRAME_LEN];
+	const unsigned long start = millis();
+	unsigned long elapsed;
+	while ( (elapsed = millis() - start) < timeout ) {
+		const uint8_t len = receive_frame(frame, sizeof(frame), timeout - elapsed);
+		if ( len == FRAGMENT_HEADER_LEN && frame[0] == FRAGMENT_MARKER && frame[1] == FRAGMENT_ACK
+				&& frame[2] == destination && frame[3] == get_address() && frame[4] == id ) {
+			received = (uint32_t)frame[5] | ((uint32_t)frame[6] << 8)
+				| ((uint32_t)frame[7] << 16) | ((uint32_t)frame[8] << 24);
+			return true;
+		}
+		// Anything else (other traffic, stale acknowledgements) is dropped
+	}
+	return false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool CommPlat::receive_frames(JsonObject json, const uint max_wait_time)
+{
+	uint8_t frame[FRAGMENT_FRAME_LEN + 1];
+	bool status = false;
+	unsigned long start = millis();
+	unsigned long timeout = max_wait_time;
+	unsigned long elapsed = 0;
+
+	do {
+		const uint8_t len = receive_frame(frame, FRAGMENT_FRAME_LEN, timeout - elapsed);
+		if (len == 0) break;
+
+		// Whole message in one frame
+		if (frame[0] != FRAGMENT_MARKER) {
+			frame[len] = '\0';
+			if ( frame[0] == SCHEMA_ANNOUNCE_MARKER || frame[0] == SLOT_BEACON_MARKER ) {
+				receive_message(frame, len, json, messageJson);
+				continue;
+			}
+			status = receive_message(frame, len, json, messageJson);
+			break;
+		}
+
+		if ( len > FRAGMENT_HEADER_LEN && (frame[1] & ~FRAGMENT_ACK_REQUEST) == FRAGMENT_DATA
+				&& frame[3] == get_address() ) {
+			if (!reassembly) {
+				reassembly = new Reassembly{};
+			}
+			Reassembly& r = *reassembly;
+			if (receive_fragment(frame, len, r)) {
+				last_source = r.source;
+				if ( r.buffer[0] == SCHEMA_ANNOUNCE_MARKER ) {
+					receive_message(r.buffer, r.length, json, mergeJson);
+					continue;
+				}
+				status = receive_message(r.buffer, r.length, json, mergeJson);
+				mergeJson.clear();
+				break;
+			}
+			// Wait for the rest of the message even if max_wait_time has passed
+			start = millis();
+			timeout = 2 * FRAGMENT_ACK_TIMEOUT;
+		}
+	} while ( (elapsed = millis() - start) < timeout );
+	frames_done();
+
+	print_module_label();
+	LPrintln("Receive ", (status) ? "successful" : "failed");
+	return status;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+uint8_t CommPlat::queue_receive(const uint max_wait_time)
+{
+	if (!supports_frames()) return 0;
+	if (!receive_queue) {
+		receive_queue = new ReceiveQueue{};
+	}
+	ReceiveQueue& q = *receive_queue;
+	uint8_t scratch[FRAGMENT_FRAME_LEN + 1];
+	uint wait = max_wait_time;
+
+	while (true) {
+		// A hub's beacons go out on time, waiting stops for each
+		uint frame_wait = wait;
+		if (sends_beacons()) {
+			const uint32_t until_beacon = serve_beacon();
+			if (until_beacon < frame_wait) frame_wait = until_beacon;
+		}
+
+		// Frames are read straight into the ring while it has room
+		ReceiveQueue::Frame* entry = (q.frame_count < RECEIVE_QUEUE_FRAMES)
+			? &q.frames[(q.frame_head + q.frame_count) % RECEIVE_QUEUE_FRAMES]
+			: nullptr;
+		uint8_t* bytes = entry ? entry->bytes : scratch;
+		const uint8_t len = receive_frame(bytes, FRAGMENT_FRAME_LEN, frame_wait);
+		if (len == 0) {
+			if (frame_wait == wait) break;
+			wait -= frame_wait;
+			continue;
+		}
+
+		// Only the first frame is waited for
+		wait = 0;
+
+		if (bytes[0] == FRAGMENT_MARKER) {
+			queue_fragment(bytes, len);
+			continue;
+		}
+
+		bytes[len] = '\0';
+		if (bytes[0] == SCHEMA_ANNOUNCE_MARKER || bytes[0] == SLOT_BEACON_MARKER) {
+			receive_message(bytes, len, JsonObject(), messageJson);
+			continue;
+		}
+		if (!entry) {
+			q.dropped++;
+			continue;
+		}
+		entry->source	= last_source;
+		entry->rssi		= signal_strength;
+		entry->len		= len;
+		q.frame_count++;
+		q.order[(q.order_head + q.order_count++) % sizeof(q.order)] = RECEIVE_QUEUE_FRAME;
+	}
+	return q.order_count;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void CommPlat::queue_fragment(const uint8_t* frame, const uint8_t len)
+{
+	if ( len <= FRAGMENT_HEADER_LEN || (frame[1] & ~FRAGMENT_ACK_REQUEST) != FRAGMENT_DATA
+			|| frame[3] != get_address() ) return;
+
+	ReceiveQueue& q = *receive_queue;
+	const uint8_t source = frame[2];
+	const uint8_t id = frame[4];
+	const uint32_t now = millis();
+
+	// The slot of this message, else the free slot unused the longest:
+	// one never started, already read, or abandoned by its sender
+	uint8_t found = RECEIVE_QUEUE_SLOTS;
+	for (auto i = 0; i < RECEIVE_QUEUE_SLOTS; i++) {
+		const Reassembly& r = q.slots[i];
+		if (r.active && r.source == source && r.id == id) {
+			found = i;
+			break;
+		}
+		const bool free = !r.active || (r.delivered && !r.queued)
+			|| (!r.queued && now - r.last_time > (FRAGMENT_RETRIES + 1) * FRAGMENT_ACK_TIMEOUT);
+		if (!free) continue;
+		if ( found == RECEIVE_QUEUE_SLOTS || ( q.slots[found].active
+				&& (!r.active || now - r.last_time > now - q.slots[found].last_time) ) ) {
+			found = i;
+		}
+	}
+
+	// Unacknowledged, the sender retries once a message has been read
+	if (found == RECEIVE_QUEUE_SLOTS) return;
+
+	Reassembly& r = q.slots[found];
+	if (!receive_fragment(frame, len, r)) return;
+	r.rssi = signal_strength;
+
+	if (r.buffer[0] == SCHEMA_ANNOUNCE_MARKER) {
+		receive_message(r.buffer, r.length, JsonObject(), mergeJson);
+		return;
+	}
+	r.queued = true;
+	q.order[(q.order_head + q.order_count++) % sizeof(q.order)] = found;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool CommPlat::receive_queued(JsonObject json)
+{
+	// Samples or batch packets of the last message are returned before anything new
+	if (receive_sample(json) || receive_batched(json)) return true;
+
+	if (!receive_queue) return false;
+	ReceiveQueue& q = *receive_queue;
+
+	// Messages that fail to parse are skipped
+	while (q.order_count > 0) {
+		const uint8_t next = q.order[q.order_head];
+		q.order_head = (q.order_head + 1) % sizeof(q.order);
+		q.order_count--;
+
+		bool status;
+		if (next == RECEIVE_QUEUE_FRAME) {
+			const ReceiveQueue::Frame& f = q.frames[q.frame_head];
+			last_source		= f.source;
+			signal_strength	= f.rssi;
+			status = receive_message(f.bytes, f.len, json, messageJson);
+			q.frame_head = (q.frame_head + 1) % RECEIVE_QUEUE_FRAMES;
+			q.frame_count--;
+		} else {
+			Reassembly& r = q.slots[next];
+			last_source		= r.source;
+			signal_strength	= r.rssi;
+			status = receive_message(r.buffer, r.length, json, mergeJson);
+			mergeJson.clear();
+			r.queued = false;
+		}
+		if (status) return true;
+	}
+	return false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool CommPlat::receive_queued()
+{
+	if (device_manager != nullptr) {
+		// Loom_Manager's json needs to be cleared (passing true to internal_json)
+		// in order to copy over correctly
+		return receive_queued( device_manager->internal_json(true) );
+	}
+	return false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool CommPlat::poll()
+{
+	if ( device_manager && device_manager->get_device_type() == Manager::DeviceType::REPEATER ) {
+		forward(0);
+	} else {
+		queue_receive(0);
+	}
+	return false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+uint8_t CommPlat::forward(const uint max_wait_time)
+{
+	if (!supports_frames()) return 0;
+	if (!relay) {
+		relay = new Relay{};
+	}
+	Relay& r = *relay;
+	const uint32_t before = r.forwarded;
+	uint8_t frame[FRAGMENT_FRAME_LEN];
+	uint wait = max_wait_time;
+
+	while (true) {
+		// The rest of a held window is waited for
+		if (r.held_count) {
+			const unsigned long held_for = millis() - r.held_time;
+			if (held_for >= FRAGMENT_ACK_TIMEOUT) {
+				forward_held();
+				wait = 0;
+				continue;
+			}
+			wait = FRAGMENT_ACK_TIMEOUT - held_for;
+		}
+
+		const uint8_t len = receive_frame(frame, sizeof(frame), wait);
+		if (len == 0) {
+			if (r.held_count) continue;
+			break;
+		}
+		wait = 0;
+
+		// Messages and fragments for this device are not forwarded
+		if ( len < FRAGMENT_HEADER_LEN || frame[0] != FRAGMENT_MARKER
+				|| frame[3] == get_address() ) continue;
+
+		learn_route(frame[2]);
+		if (seen_frame(frame)) {
+			r.duplicates++;
+			continue;
+		}
+
+		const uint8_t type = frame[1] & ~FRAGMENT_ACK_REQUEST;
+		if (type == FRAGMENT_ACK) {
+			send_frame(frame, len, get_next_hop(frame[3]));
+			r.forwarded++;
+			continue;
+		}
+		if (type != FRAGMENT_DATA) continue;
+
+		// Held while the sender is still sending (the radio can't do both),
+		// until the last fragment of the window. Another message ends it early
+		if ( r.held_count && (r.held[0][2] != frame[2] || r.held[0][4] != frame[4]) ) {
+			forward_held();
+		}
+		memcpy(r.held[r.held_count], frame, len);
+		r.held_len[r.held_count++] = len;
+		r.held_time = millis();
+		if ( (frame[1] & FRAGMENT_ACK_REQUEST) || r.held_count == FRAGMENT_WINDOW ) {
+			forward_held();
+		}
+	}
+	return r.forwarded - before;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void CommPlat::forward_held()
+{
+	Relay& r = *relay;
+	for (auto i = 0; i < r.held_count; i++) {
+		send_frame(r.held[i], r.held_len[i], get_next_hop(r.held[i][3]));
+	}
+	r.forwarded += r.held_count;
+	r.held_count = 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool CommPlat::seen_frame(const uint8_t* frame)
+{
+	Relay& r = *relay;
+	const uint32_t now = millis();
+
+	// Entries never used have type 0, which no frame has
+	for (const Relay::Seen& s : r.seen) {
+		if ( s.source == frame[2] && s.id == frame[4] && s.type == frame[1]
+				&& s.number == frame[5] && now - s.time < ROUTE_SEEN_TIME ) return true;
+	}
+	r.seen[r.seen_next] = { frame[2], frame[4], frame[1], frame[5], now };
+	r.seen_next = (r.seen_next + 1) % ROUTE_SEEN_SIZE;
+	return false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void CommPlat::set_slots(const uint16_t slot_ms, const uint8_t count)
+{
+	if (slot_ms == 0 || count < 2) {
+		delete slots;
+		slots = nullptr;
+		return;
+	}
+	if (!slots) {
+		slots = new Slots{};
+	}
+	slots->slot_ms	= slot_ms;
+	slots->count	= count;
+	slots->synced	= false;
+
+	// A node listens for a beacon before it first sends
+	slots->last_beacon = millis() - SLOT_RESYNC_FRAMES * (uint32_t)slot_ms * count - 1;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool CommPlat::sends_beacons() const
+{
+	return slots && device_manager && device_manager->get_device_type() == Manager::DeviceType::HUB;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+uint8_t CommPlat::own_slot() const
+{
+	const uint8_t instance = device_manager ? device_manager->get_instance_num() : 1;
+	return 1 + (instance + slots->count - 2) % (slots->count - 1);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+uint32_t CommPlat::until_slot(const uint8_t slot) const
+{
+	const uint32_t frame_ms = (uint32_t)slots->slot_ms * slots->count;
+	const uint32_t position = network_time() % frame_ms;
+	const uint32_t start = (uint32_t)slot * slots->slot_ms + SLOT_GUARD;
+	const uint32_t end = (uint32_t)(slot + 1) * slots->slot_ms - SLOT_GUARD;
+	if (position >= start && position < end) return 0;
+	return (start + frame_ms - position) % frame_ms;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+uint32_t CommPlat::serve_beacon()
+{
+	Slots& s = *slots;
+	const uint32_t frame_ms = (uint32_t)s.slot_ms * s.count;
+
+	// Frames of a hub with an RTC line up with its seconds
+	if (!s.synced) {
+		RTC* rtc = device_manager->get_rtc_module();
+		s.base_time		= rtc ? (uint64_t)rtc->now().unixtime() * 1000 : 0;
+		s.base_millis	= millis();
+		s.synced		= true;
+		s.beacon_frame	= s.base_time / frame_ms - 1;
+	}
+
+	uint64_t now = network_time();
+	const uint32_t frame = now / frame_ms;
+	if ( frame != s.beacon_frame && now % frame_ms < s.slot_ms - SLOT_GUARD ) {
+		const uint32_t seconds = now / 1000;
+		const uint16_t ms = now % 1000;
+		uint8_t beacon[SLOT_BEACON_LEN] = {
+			SLOT_BEACON_MARKER,
+			(uint8_t)seconds, (uint8_t)(seconds >> 8), (uint8_t)(seconds >> 16), (uint8_t)(seconds >> 24),
+			(uint8_t)ms, (uint8_t)(ms >> 8),
+			(uint8_t)s.slot_ms, (uint8_t)(s.slot_ms >> 8),
+			s.count
+		};
+		send_raw(beacon, sizeof(beacon), SLOT_BROADCAST);
+		s.beacon_frame	= frame;
+		s.last_beacon	= millis();
+		s.beacons++;
+		now = network_time();
+	}
+	return frame_ms - now % frame_ms;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void CommPlat::receive_beacon(const uint8_t* beacon, const uint8_t len)
+{
+	if ( len != SLOT_BEACON_LEN || !slots || sends_beacons() ) return;
+
+	const uint32_t seconds = (uint32_t)beacon[1] | ((uint32_t)beacon[2] << 8)
+		| ((uint32_t)beacon[3] << 16) | ((uint32_t)beacon[4] << 24);
+	const uint16_t ms		= beacon[5] | (beacon[6] << 8);
+	const uint16_t slot_ms	= beacon[7] | (beacon[8] << 8);
+	const uint8_t count		= beacon[9];
+	if ( ms >= 1000 || slot_ms == 0 || count < 2 ) return;
+
+	// Every node hears a beacon its airtime after it was sent,
+	// so their clocks lag the hub's alike and their slots still line up
+	Slots& s = *slots;
+	s.base_time		= (uint64_t)seconds * 1000 + ms;
+	s.base_millis	= millis();
+	s.slot_ms		= slot_ms;
+	s.count			= count;
+	s.synced		= true;
+	s.last_beacon	= s.base_millis;
+	s.beacons++;
+
+	// The RTC, which only wakes the node for its slot, is only set when
+	// off by whole seconds (and the hub's time is a date)
+	RTC* rtc = device_manager ? device_manager->get_rtc_module() : nullptr;
+	if ( rtc && seconds >= SLOT_VALID_TIME ) {
+		const int32_t offset = (int32_t)(rtc->now().unixtime() - seconds);
+		if (offset > 1 || offset < -1) rtc->time_adjust(DateTime(seconds));
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void CommPlat::wait_slot()
+{
+	if ( !slots || sends_beacons() || !supports_frames() ) return;
+	Slots& s = *slots;
+	const uint32_t frame_ms = (uint32_t)s.slot_ms * s.count;
+
+	if (millis() - s.last_beacon > SLOT_RESYNC_FRAMES * frame_ms) {
+		// A stale clock is still close enough to catch slot 0,
+		// without one a node listens for a few frames
+		uint32_t listen = SLOT_SYNC_FRAMES * frame_ms;
+		if (s.synced) {
+			frames_done();
+			delay( (2 * frame_ms - SLOT_GUARD - network_time() % frame_ms) % frame_ms );
+			listen = s.slot_ms + 2 * SLOT_GUARD;
+		}
+
+		// A beacon the radio held from before would set the clock late
+		uint8_t frame[FRAGMENT_FRAME_LEN];
+		while ( receive_frame(frame, sizeof(frame), 0) ) {}
+
+		const uint32_t heard = s.beacons;
+		const unsigned long start = millis();
+		unsigned long elapsed;
+		while ( s.beacons == heard && (elapsed = millis() - start) < listen ) {
+			const uint8_t len = receive_frame(frame, sizeof(frame), listen - elapsed);
+			if (len && frame[0] == SLOT_BEACON_MARKER) receive_beacon(frame, len);
+		}
+
+		// Not heard, tried again after as many frames
+		if (s.beacons == heard) {
+			s.last_beacon = millis();
+			print_module_label();
+			LPrintln("No beacon heard, sending ", (s.synced) ? "by the last one" : "unslotted");
+		}
+		if (!s.synced) return;
+	}
+
+	const uint32_t wait = until_slot(own_slot());
+	if (wait > 0) {
+		frames_done();
+		delay(wait);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool CommPlat::set_slot_alarm()
+{
+	if ( !get_slot_synced() || sends_beacons() || !device_manager ) return false;
+	InterruptManager* interrupts = device_manager->get_interrupt_manager();
+	RTC* rtc = device_manager->get_rtc_module();
+	if (!interrupts || !rtc) return false;
+
+	// The RTC's seconds may be up to one off the hub's
+	const uint32_t until = until_slot(own_slot());
+	if (until < 2000) return false;
+	return interrupts->RTC_alarm_at( rtc->now() + TimeSpan(until / 1000 - 1) );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+uint8_t CommPlat::get_next_hop(const uint8_t destination) const
+{
+	if (routing) {
+		for (auto i = 0; i < routing->count; i++) {
+			if (routing->routes[i].destination == destination) return routing->routes[i].next_hop;
+		}
+	}
+	return destination;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool CommPlat::set_route(const uint8_t destination, const uint8_t next_hop, const bool learned)
+{
+	if (!routing) {
+		if (next_hop == destination) return true;
+		routing = new Routing{};
+	}
+	Routing& t = *routing;
+
+	uint8_t i = 0;
+	while (i < t.count && t.routes[i].destination != destination) i++;
+	if (i < t.count) {
+		if (learned && !t.routes[i].learned) return true;
+		if (next_hop != destination) {
+			t.routes[i] = { destination, next_hop, learned };
+			return true;
+		}
+	} else {
+		if (next_hop == destination) return true;
+		if (t.count == ROUTE_TABLE_SIZE) {
+			// A learned route replaces the oldest learned one
+			if (learned) {
+				i = 0;
+				while (i < t.count && !t.routes[i].learned) i++;
+			}
+			if (i == t.count) {
+				print_module_label();
+				LPrintln("Routing table full, no route to ", destination);
+				return false;
+			}
+		} else {
+			t.routes[t.count++] = { destination, next_hop, learned };
+			return true;
+		}
+	}
+
+	// Remove route i, keeping the rest oldest first
+	memmove(&t.routes[i], &t.routes[i + 1], (t.count - i - 1) * sizeof(Routing::Route));
+	t.count--;
+	if (next_hop != destination) t.routes[t.count++] = { destination, next_hop, learned };
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool CommPlat::receive_message(const uint8_t* message, const uint16_t len, JsonObject json, JsonDocument& doc)
+{
+	switch (message[0]) {
+		case SCHEMA_ANNOUNCE_MARKER:
+			if (!wire_schemas) {
+				wire_schemas = new WireSchema();
+			}
+			if ( !wire_schemas->add(message, len) ) {
+				print_module_label();
+				LPrintln("Malformed schema announcement");
+			}
+			return false;
+
+		case SLOT_BEACON_MARKER:
+			receive_beacon(message, len);
+			return false;
+
+		case SCHEMA_DATA_MARKER:
+			if ( !wire_schemas || !wire_schemas->decode(message, len, json) ) {
+				print_module_label();
+				LPrintln("Data of an unknown schema, waiting for it to be announced");
+				return false;
+			}
+			if (override_name) strcpy(device_manager->temp_device_name, json["id"]["name"]);
+			return true;
+
+		case SCHEMA_SAMPLES_MARKER:
+			if ( (len > FRAGMENT_FRAME_LEN) || !wire_schemas || !wire_schemas->decode_sample(message, len, 0, json) ) {
+				print_module_label();
+				LPrintln("Samples of an unknown schema, waiting for it to be announced");
+				return false;
+			}
+			if (override_name) strcpy(device_manager->temp_device_name, json["id"]["name"]);
+
+			// The rest are read by the next receives
+			if (!received_samples) {
+				received_samples = new Samples{};
+			}
+			memcpy(received_samples->packet, message, len);
+			received_samples->len		= len;
+			received_samples->next		= 1;
+			received_samples->address	= last_source;
+			received_samples->rssi		= signal_strength;
+			return true;
+
+		case BATCH_BLOCK_MARKER:
+			if (!received_batch) {
+				received_batch = new BatchCodec();
+			}
+			if ( !received_batch->open(message, len) ) {
+				print_module_label();
+				LPrintln("Malformed batch block");
+				return false;
+			}
+			batch_source	= last_source;
+			batch_rssi		= signal_strength;
+			return receive_batched(json);
+
+		default:
+			return msgpack_buffer_to_json((const char*)message, json, doc, len);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool CommPlat::receive_fragment(const uint8_t* frame, const uint8_t len, Reassembly& r)
+{
+	const uint8_t source = frame[2];
+	const uint8_t id = frame[4];
+	const uint8_t index = frame[5];
+	const uint8_t count = frame[6];
+	const uint16_t offset = frame[7] | (frame[8] << 8);
+	const uint8_t chunk = len - FRAGMENT_HEADER_LEN;
+	learn_route(source);
+
+	if ( count == 0 || count > FRAGMENT_MAX_COUNT || index >= count
+			|| offset + chunk > FRAGMENT_MAX_MESSAGE ) return false;
+
+	// A new message replaces an unfinished one. State outlives the sender's
+	// retries only until the ID could be reused (e.g. after a reset),
+	// a message waiting in the receive queue is kept until read
+	const uint32_t now = millis();
+	if ( !r.active || r.source != source || r.id != id
+			|| (!r.queued && now - r.last_time > (FRAGMENT_RETRIES + 1) * FRAGMENT_ACK_TIMEOUT) ) {
+		r.active	= true;
+		r.delivered	= false;
+		r.queued	= false;
+		r.source	= source;
+		r.id		= id;
+		r.count		= count;
+		r.received	= 0;
+		r.length	= 0;
+	}
+	if (count != r.count) return false;
+	r.last_time = now;
+
+	const uint32_t all = (count == 32) ? 0xFFFFFFFF : ((1UL << count) - 1);
+	bool complete = false;
+
+	// Fragments of a message already returned are only acknowledged again
+	if (!r.delivered) {
+		memcpy(r.buffer + offset, frame + FRAGMENT_HEADER_LEN, chunk);
+		r.received |= 1UL << index;
+		if (index == count - 1) r.length = offset + chunk;
+		if (r.received == all) {
+			r.buffer[r.length] = '\0';
+			r.delivered = true;
+			complete = true;
+		}
+	}
+
+	if (frame[1] & FRAGMENT_ACK_REQUEST) {
+		const uint32_t received = r.delivered ? all : r.received;
+		const uint8_t ack[FRAGMENT_HEADER_LEN] = {
+			FRAGMENT_MARKER, FRAGMENT_ACK, get_address(), source, id,
+			(uint8_t)received, (uint8_t)(received >> 8),
+			(uint8_t)(received >> 16), (uint8_t)(received >> 24)
+		};
+		// Back the way the fragment came, through any repeaters
+		send_frame(ack, sizeof(ack), last_source);
+	}
+	return complete;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -376,47 +1521,47 @@ void CommPlat::broadcast_batch(int delay_time)
 
 
 ///////////////////////////////////////////////////////////////////////////////
-bool CommPlat::json_to_msgpack_buffer(JsonObjectConst json, char* buffer, const uint16_t max_len) const
+uint16_t CommPlat::json_to_msgpack_buffer(JsonObjectConst json, uint8_t* buffer, const uint16_t max_len) const
 {
-	memset(buffer, '\0', sizeof(buffer));
   LMark;
-
-	bool status = serializeMsgPack(json, buffer, max_len);
+	BufferWriter writer(buffer, max_len);
+	const size_t len = serializeMsgPack(json, writer);
 
 	if (print_verbosity == Verbosity::V_HIGH) {
 		print_module_label();
-		LPrintln(buffer);
-		LPrintln("MsgPack size: ", measureMsgPack(json));
+		LPrintln("MsgPack size: ", len);
 	}
 
-	return status;
+	return len;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
-bool CommPlat::msgpack_buffer_to_json(const char* buffer, JsonObject json)
+bool CommPlat::msgpack_buffer_to_json(const char* buffer, JsonObject json, JsonDocument& doc, const size_t len)
 {
 	if (print_verbosity == Verbosity::V_HIGH) {
 		print_module_label();
 		LPrintln("Received: ", (const char*)buffer);
 		print_module_label();
-		LPrintln("Received Json Memory Usage: ", measureMsgPack(messageJson));
+		LPrintln("Received Json Memory Usage: ", measureMsgPack(doc));
 	}
 
-	messageJson.clear();
+	doc.clear();
 
-	if (deserializeMsgPack(messageJson, buffer) != DeserializationError::Ok ) {
+	// A known length keeps a malformed message from being read past its end
+	const DeserializationError error = (len > 0) ? deserializeMsgPack(doc, buffer, len) : deserializeMsgPack(doc, buffer);
+	if (error != DeserializationError::Ok ) {
 		print_module_label();
 		LPrintln("Failed to parse MsgPack");
 		return false;
 	}
 
-	bool status = json.set(messageJson.as<JsonObject>());
+	bool status = json.set(doc.as<JsonObject>());
 	if (!status) return false;
 
 	if (print_verbosity == Verbosity::V_HIGH) {
 		print_module_label();
-		LPrintln("Internal messageJson:");
-		serializeJsonPretty(messageJson, Serial);
+		LPrintln("Deserialized json:");
+		serializeJsonPretty(doc, Serial);
 		LPrintln();
 
 		// LPrintln("\nJson passed in:");
@@ -13,15 +13,106 @@
 
 #include "Module.h"
 #include "../LogPlats/BatchSD.h"
+#include "WireSchema.h"
+#include "BatchCodec.h"
 
 namespace Loom {
 
+///////////////////////////////////////////////////////////////////////////////
+
+#define FRAGMENT_MARKER			0xC1	///< First byte of fragment frames (a byte MsgPack never uses)
+#define FRAGMENT_HEADER_LEN		9		///< Bytes of a fragment or acknowledgement frame before the payload
+#define FRAGMENT_FRAME_LEN		251		///< Longest frame sent (RadioHead's RF95 maximum)
+#define FRAGMENT_MAX_COUNT		32		///< Most fragments of a message (bits of the acknowledgement bitmap)
+#define FRAGMENT_MAX_MESSAGE	1024	///< Largest message that can be fragmented (size of the reassembly buffer)
+#define FRAGMENT_WINDOW			8		///< Fragments sent before waiting for an acknowledgement
+#define FRAGMENT_ACK_TIMEOUT	2000	///< Milliseconds to wait for an acknowledgement, or the next fragment
+#define FRAGMENT_RETRIES		4		///< Windows sent without progress before giving up
+#define SAMPLES_SEND_ATTEMPTS	3		///< Times a packet of samples is sent before its samples are given up as lost
+
+#define FRAGMENT_DATA			0x01	///< Frame type of a fragment
+#define FRAGMENT_ACK			0x02	///< Frame type of an acknowledgement
+#define FRAGMENT_ACK_REQUEST	0x80	///< Flag of the last fragment of a window, asking for an acknowledgement
+
+#define RECEIVE_QUEUE_FRAMES	8		///< Single frame messages a hub holds until they are read
+#define RECEIVE_QUEUE_SLOTS		4		///< Fragmented messages a hub reassembles or holds at once
+#define RECEIVE_QUEUE_FRAME		0xFF	///< Arrival order entry of a single frame message (else a slot index)
+
+#define ROUTE_TABLE_SIZE		16		///< Devices out of range a device keeps a next hop for
+#define ROUTE_SEEN_SIZE			32		///< Frames a repeater remembers, to drop copies of them
+#define ROUTE_SEEN_TIME			1000	///< Milliseconds a frame counts as a copy of one forwarded (less than FRAGMENT_ACK_TIMEOUT, so windows sent again pass)
+#define ROUTE_MAX_HOPS			2		///< Repeaters a sender waits for an acknowledgement to come back through
+
+#define SLOT_BEACON_MARKER		0xD8	///< First byte of slot beacons (MsgPack fixext, never a json)
+#define SLOT_BEACON_LEN			10		///< Bytes of a beacon
+#define SLOT_BROADCAST			0xFF	///< Address beacons are sent to (RadioHead's broadcast address)
+#define SLOT_GUARD				40		///< Milliseconds at each end of a slot nothing is sent in, for clock error and beacon airtime
+#define SLOT_RESYNC_FRAMES		8		///< Frames a node goes without a beacon before listening for one again
+#define SLOT_SYNC_FRAMES		2		///< Frames a node listens for a beacon before sending unslotted
+#define SLOT_VALID_TIME			1577836800	///< Hub times before this (2020) are uptime, not set from an RTC
+
+
 ///////////////////////////////////////////////////////////////////////////////
 ///
 /// Abstract base of communication platform modules
 ///
 /// All communication platform modules inherit from this class.
 ///
+/// Messages too long for one frame are fragmented on platforms that
+/// implement send_frame() and receive_frame(). Each fragment frame is
+///
+///		FRAGMENT_MARKER, type, source, destination, message ID,
+///		index, count, offset (uint16_t little-endian), payload
+///
+/// The sender sends a window of up to FRAGMENT_WINDOW missing fragments,
+/// the last one requesting an acknowledgement, and the receiver answers with
+///
+///		FRAGMENT_MARKER, type, source, destination, message ID,
+///		bitmap of fragments received (uint32_t little-endian)
+///
+/// so only lost fragments are sent again. Other platforms use the previous
+/// scheme of one json per module (split_send()).
+///
+/// A hub receiving from many nodes can use a receive queue instead of
+/// receive_blocking(): queue_receive() (also run by poll()) drains frames
+/// from the platform as they arrive, reassembling each sender's fragmented
+/// messages in its own slot, and receive_queued() reads the completed
+/// messages in arrival order.
+///
+/// A node sending periodic readings can pack several samples into one
+/// packet (set_aggregation()), each after the first sent as a delta against
+/// it (see WireSchema). The hub returns them one receive at a time.
+/// Samples carry their own timestamp only if the node has an RTC.
+/// A packet that fails to send is kept, taking more samples while it has
+/// room, and sent again with the next sample or flush_samples(), up to
+/// SAMPLES_SEND_ATTEMPTS times. Only then are its samples lost, each
+/// counted (get_lost_samples()) and in the drop rate.
+///
+/// send_batch() can compress the stored packets into blocks
+/// (set_batch_compression(), see BatchCodec), which the hub also returns
+/// one packet per receive.
+///
+/// Nodes out of range of their hub reach it through repeaters (devices of
+/// Manager::DeviceType::REPEATER, see forward()). Messages to a device with
+/// a route (add_route()) are always sent as fragments, whose header carries
+/// the sender and final destination, to the route's next hop. A repeater
+/// holds each window of fragments until its last frame, sends it on toward
+/// the destination, and sends the acknowledgement back, without parsing
+/// either. Acknowledgements go back the way the fragments came, and
+/// devices learn routes back to the senders of forwarded fragments.
+///
+/// Many nodes can share the channel without colliding in time slots (TDMA,
+/// set_slots()). Time is divided into frames of slots: in slot 0 the hub
+/// broadcasts a beacon
+///
+///		SLOT_BEACON_MARKER, hub time (uint32_t Unix seconds, uint16_t
+///		milliseconds), slot length (uint16_t milliseconds), slot count
+///
+/// and the node of each instance number sends only in its own slot.
+/// Nodes keep the hub's time from the beacons (adjusting their RTC if it
+/// is off), send() waits for the node's slot with the radio asleep, and
+/// set_slot_alarm() wakes the node from sleep for its next slot.
+///
 /// @par Resources
 /// - [Module Documentation](https://openslab-osu.github.io/Loom/html/class_loom_comm_plat.html)
 ///	- [Hardware Support](https://github.com/OPEnSLab-OSU/Loom/wiki/Hardware-Support#telecommunication-capabilities)
@@ -29,6 +120,7 @@ namespace Loom {
 ///////////////////////////////////////////////////////////////////////////////
 class CommPlat : public Module
 {
+	LOOM_MODULE_TYPE(CommPlat, Module)
 
 protected:
 
@@ -43,6 +135,126 @@ protected:
 	/// Especially as the LoomManager is intended to be non-mandatory for usage of Loom
 	StaticJsonDocument<1500> messageJson;
 	DynamicJsonDocument mergeJson;
+
+	/// Fragmented message being received
+	struct Reassembly {
+		bool		active;			///< Whether a message has been started
+		bool		delivered;		///< Whether the complete message was already returned
+		uint8_t		source;			///< Address of the sender
+		uint8_t		id;				///< Message ID
+		uint8_t		count;			///< Number of fragments
+		uint32_t	received;		///< Bitmap of fragments received
+		uint16_t	length;			///< Length of the message, 0 until its last fragment arrives
+		uint32_t	last_time;		///< millis() of the last fragment, older state is forgotten
+		bool		queued;			///< Whether the complete message waits in the receive queue
+		int16_t		rssi;			///< Signal strength of the last fragment
+		uint8_t		buffer[FRAGMENT_MAX_MESSAGE + 1];	///< Message, null terminated once complete
+	};
+
+	/// Messages received ahead of being read, on a hub
+	struct ReceiveQueue {
+		/// Single frame message, as drained from the platform
+		struct Frame {
+			uint8_t		source;			///< Address of the sender
+			int16_t		rssi;			///< Signal strength of the frame
+			uint8_t		len;			///< Length of the message
+			uint8_t		bytes[FRAGMENT_FRAME_LEN + 1];	///< Message, null terminated
+		};
+
+		Frame		frames[RECEIVE_QUEUE_FRAMES];	///< Ring of single frame messages
+		uint8_t		frame_head;						///< Oldest frame in the ring
+		uint8_t		frame_count;					///< Frames in the ring
+		Reassembly	slots[RECEIVE_QUEUE_SLOTS];		///< Fragmented messages, one per sender and message ID
+		uint8_t		order[RECEIVE_QUEUE_FRAMES + RECEIVE_QUEUE_SLOTS];	///< Complete messages in arrival order
+		uint8_t		order_head;						///< Oldest entry of order
+		uint8_t		order_count;					///< Entries in order
+		uint16_t	dropped;						///< Single frame messages dropped with the ring full
+	};
+
+	/// Packet of samples, being filled on a node or read on a hub
+	struct Samples {
+		uint8_t		packet[FRAGMENT_FRAME_LEN + 1];	///< SCHEMA_SAMPLES_MARKER packet
+		uint16_t	len;			///< Length of packet, 0 if none
+		uint8_t		address;		///< Device the packet is for, or came from
+		uint8_t		next;			///< Next sample to read, on a hub
+		uint8_t		attempts;		///< Times the packet failed to send, on a node
+		uint32_t	lost;			///< Samples given up after failing to send, on a node
+		int16_t		rssi;			///< Signal strength of the packet, on a hub
+	};
+
+	/// Time slots, of a hub sending beacons or a node following them
+	struct Slots {
+		uint16_t	slot_ms;		///< Length of a slot
+		uint8_t		count;			///< Slots in a frame, slot 0 is the hub's beacon
+		uint64_t	base_time;		///< Hub time (milliseconds since the Unix epoch) at base_millis
+		uint32_t	base_millis;	///< millis() when base_time was set
+		bool		synced;			///< Whether base_time is the hub's (always on the hub)
+		uint32_t	last_beacon;	///< millis() of the last beacon sent or heard (or listened for in vain)
+		uint32_t	beacon_frame;	///< Frame the hub last sent a beacon in
+		uint32_t	beacons;		///< Beacons sent or heard
+	};
+
+	/// Next hops toward devices out of range
+	struct Routing {
+		/// Route to one device
+		struct Route {
+			uint8_t		destination;	///< Device out of range
+			uint8_t		next_hop;		///< Device to send its frames to
+			bool		learned;		///< Whether learned from a forwarded frame, else set by add_route()
+		};
+
+		Route		routes[ROUTE_TABLE_SIZE];	///< Routes, oldest first
+		uint8_t		count;						///< Routes in use
+	};
+
+	/// Frames being forwarded, on a repeater
+	struct Relay {
+		/// Frame forwarded recently
+		struct Seen {
+			uint8_t		source;		///< Sender of the frame
+			uint8_t		id;			///< Message ID
+			uint8_t		type;		///< Frame type, with FRAGMENT_ACK_REQUEST
+			uint8_t		number;		///< Index of a fragment, first byte of an acknowledgement's bitmap
+			uint32_t	time;		///< millis() when it arrived
+		};
+
+		uint8_t		held[FRAGMENT_WINDOW][FRAGMENT_FRAME_LEN];	///< Window of fragments being held
+		uint8_t		held_len[FRAGMENT_WINDOW];	///< Length of each held fragment
+		uint8_t		held_count;					///< Fragments held
+		uint32_t	held_time;					///< millis() of the last fragment held
+		Seen		seen[ROUTE_SEEN_SIZE];		///< Ring of frames forwarded
+		uint8_t		seen_next;					///< Entry of seen overwritten next
+		uint32_t	forwarded;					///< Frames forwarded
+		uint32_t	duplicates;					///< Copies of frames dropped
+	};
+
+	Reassembly*	reassembly;			///< Fragmented message being received, nullptr until a fragment arrives
+	uint8_t		next_message_id;	///< ID of the next fragmented message sent
+
+	/// Transmit buffer. Each outgoing message is encoded into it once,
+	/// then handed to the platform as is
+	uint8_t		send_buffer[FRAGMENT_MAX_MESSAGE];
+
+	bool		compact_encoding;		///< Whether data is sent in the WireSchema encoding
+	Record*		wire_record;			///< Record compiled from sent json, nullptr until needed
+	WireSchema*	wire_schemas;			///< Schemas announced to this device, nullptr until one arrives
+	ReceiveQueue*	receive_queue;		///< Messages waiting to be read, nullptr until queue_receive() is used
+	uint8_t		last_source;			///< Address of the sender of the last frame or message received
+	uint32_t	announced_id;			///< Schema last announced
+	uint8_t		announced_destination;	///< Device the schema was announced to
+	uint8_t		since_announce;			///< Data packets sent since the announcement
+	uint8_t		aggregate_samples;		///< Samples packed into each packet, 1 to send each at once
+	Samples*	sample_buffer;			///< Samples waiting to be sent, nullptr until aggregation is used
+	Samples*	received_samples;		///< Packet of samples being read, nullptr until one arrives
+	bool		compress_batch;			///< Whether send_batch() sends compressed blocks
+	BatchCodec*	batch_codec;			///< Compressor of send_batch(), nullptr until needed
+	BatchCodec*	received_batch;			///< Block of batch packets being read, nullptr until one arrives
+	uint8_t		batch_source;			///< Address of the sender of received_batch
+	int16_t		batch_rssi;				///< Signal strength of received_batch
+	Routing*	routing;				///< Next hops, nullptr until a route is set or learned
+	Relay*		relay;					///< Forwarding state, nullptr until forward() is used
+	Slots*		slots;					///< Time slots, nullptr unless set_slots() is used
+
 	// counters for determining packet drop rate
 	// used only for debug
 	uint32_t total_packet_count;
@@ -75,6 +287,31 @@ protected:
 	/// @param[in]	json	Json object to send
 	virtual void broadcast_impl(JsonObject json) {}
 
+	/// Whether the platform implements send_frame() and receive_frame(),
+	/// which are needed to fragment messages
+	/// @return True if frames are supported
+	virtual bool supports_frames() const { return false; }
+
+	/// Send a frame without waiting for the platform to acknowledge it
+	/// (fragments are acknowledged together)
+	/// @param[in]	bytes			Bytes to send
+	/// @param[in]	len				Number of bytes to send, at most FRAGMENT_FRAME_LEN
+	/// @param[in]	destination		Device to send to
+	/// @return True if the frame was sent
+	virtual bool send_frame(const uint8_t* bytes, const uint8_t len, const uint8_t destination) { return false; }
+
+	/// Receive a frame as is, without parsing it.
+	/// Sets signal_strength and last_source
+	/// @param[out]	bytes			Buffer to fill
+	/// @param[in]	max_len			Size of bytes
+	/// @param[in]	max_wait_time	Maximum number of milliseconds to block for
+	/// @return Length of the frame, 0 if none arrived
+	virtual uint8_t receive_frame(uint8_t* bytes, const uint8_t max_len, const uint max_wait_time) { return 0; }
+
+	/// Called when an exchange of frames is over,
+	/// e.g. to put the radio back to sleep
+	virtual void frames_done() {}
+
 public:
 
 //=============================================================================
@@ -92,7 +329,7 @@ public:
 		);
 
 	/// Destructor
-	virtual ~CommPlat() = default;
+	virtual ~CommPlat();
 
 //=============================================================================
 ///@name	OPERATION
@@ -130,6 +367,50 @@ public:
 	/// @return True if packet received
 	bool			receive_blocking(const uint max_wait_time);
 
+	/// Move the frames that have arrived into the receive queue,
+	/// acknowledging fragments as they come.
+	/// Only on platforms that support frames. The radio is left listening,
+	/// so a hub should call this (or schedule the module) often.
+	/// Once every slot holds a message, new fragmented messages are not
+	/// acknowledged and their senders retry later
+	/// @param[in]	max_wait_time	Maximum number of milliseconds to wait for the first frame
+	/// @return Number of complete messages waiting to be read
+	uint8_t			queue_receive(const uint max_wait_time = 0);
+
+	/// Read the oldest complete message of the receive queue.
+	/// Sets the signal strength and source to those of the message
+	/// @param[out]	json	Json object to fill with the message
+	/// @return True if a message was read, false if none is waiting
+	bool			receive_queued(JsonObject json);
+
+	/// Version of receive_queued for use with LoomManager.
+	/// Accesses Json from LoomManager
+	/// @return True if a message was read
+	bool			receive_queued();
+
+	/// Forward the frames of other devices toward their destinations,
+	/// as a repeater. Only on platforms that support frames.
+	/// Frames are not parsed: a window of fragments is held until its last
+	/// frame arrives (or none has for FRAGMENT_ACK_TIMEOUT), then sent to
+	/// the next hop toward its destination, and acknowledgements are sent
+	/// on at once. Copies of a frame arriving within ROUTE_SEEN_TIME are
+	/// dropped, and messages for the repeater itself are ignored
+	/// @param[in]	max_wait_time	Maximum number of milliseconds to wait for the first frame
+	/// @return Number of frames forwarded
+	uint8_t			forward(const uint max_wait_time = 0);
+
+	/// Set an RTC alarm (with the InterruptManager) to wake a node for its
+	/// next slot: a second or two before, send() waits out the rest
+	/// @return False if the node is not synchronized, has no RTC or
+	///			InterruptManager, or its slot starts within a second
+	bool			set_slot_alarm();
+
+	/// Drain the receive queue when scheduled with Manager::schedule()
+	/// (sending beacons on a hub with slots),
+	/// or forward frames on a Manager of DeviceType::REPEATER
+	/// @return False, draining is never left in progress
+	bool			poll() override;
+
 	/// Giving the header of the Package from the other board
 	/// @param[in] json				json of the headers if it came in split
 	/// @return	JsonObject			it will return the headers of the package
@@ -153,11 +434,32 @@ public:
 	/// @return True if packet sent successfully, false otherwise
 	bool			send(const uint8_t destination);
 
+	/// Send the samples buffered by send() with aggregation enabled,
+	/// e.g. before a long sleep. If the packet fails to send it is kept for
+	/// the next attempt, until SAMPLES_SEND_ATTEMPTS, after which its
+	/// samples are lost
+	/// @return True if sent successfully, or none were buffered
+	bool			flush_samples();
+
 	/// Sends all the jsons stored in the batch
 	/// @param[in]	destination		Address of destination device
 	/// @param[in] 	delay_time		The amount of time between each packet in the batch being sent
-	/// @return true if the packet sent successfully
-	uint8_t			send_batch(const uint8_t destination, int delay_time);
+	/// @param[in]	raw				True to send packets as stored on the SD card (with send_raw()),
+	///								only parsing packets that must be split. False to parse and send every packet as json
+	/// @return Number of packets that failed to send
+	/// With set_batch_compression(), raw packets are sent in compressed
+	/// blocks, and delay_time is waited between blocks
+	uint8_t			send_batch(const uint8_t destination, int delay_time, const bool raw = true);
+
+	/// Send bytes that are already a serialized message (MsgPack of a json)
+	/// to a specific address.
+	/// Platforms that can transmit a buffer directly override this,
+	/// by default the bytes are parsed and sent with send_impl()
+	/// @param[in]	bytes			Bytes to send
+	/// @param[in]	len				Number of bytes to send (must be less than 252)
+	/// @param[in]	destination		Address of device to send to
+	/// @return True if packet sent successfully
+	virtual bool	send_raw(uint8_t* bytes, const uint8_t len, const uint8_t destination);
 
 	/// Return the size of the json to determing wether to send as split or not
 	///	@param[in]	json			Json that will the measurement of the size
@@ -178,6 +480,14 @@ public:
 	/// @return true if all of them send completely, false otherwise
 	bool			split_send(JsonObject json, const uint8_t destination, const uint8_t index);
 
+	/// Send a serialized message that is too long for one frame in fragments.
+	/// Only on platforms that support frames
+	/// @param[in]	message			Message to send (MsgPack of a json)
+	/// @param[in]	len				Length of message, at most FRAGMENT_MAX_MESSAGE
+	/// @param[in]	destination		Address of destination device
+	/// @return True if every fragment was acknowledged
+	bool			send_fragmented(const uint8_t* message, const uint16_t len, const uint8_t destination);
+
 	/// Broadcast data to all that can receive.
 	/// Derived classes can optionally provide an implementation for this,
 	/// As supported by the radio/platform's library
@@ -225,6 +535,60 @@ public:
 	/// @return The drop rate from 0 (no drops) to 100 (100% drop)
 	float get_last_ten_drop_rate() const;
 
+	/// Get whether data is sent in the compact WireSchema encoding
+	/// @return True if enabled
+	bool	get_compact_encoding() const { return compact_encoding; }
+
+	/// Get whether send_batch() compresses the stored packets
+	/// @return True if enabled
+	bool	get_batch_compression() const { return compress_batch; }
+
+	/// Get the number of samples packed into each packet
+	/// @return Samples per packet, 1 if aggregation is disabled
+	uint8_t	get_aggregation() const { return aggregate_samples; }
+
+	/// Get the number of samples waiting to be sent
+	/// @return Samples buffered by send()
+	uint8_t	get_buffered_samples() const { return (sample_buffer && sample_buffer->len) ? WireSchema::sample_count(sample_buffer->packet) : 0; }
+
+	/// Get the number of samples lost, given up after failing to send
+	/// @return Samples lost since start
+	uint32_t	get_lost_samples() const { return (sample_buffer) ? sample_buffer->lost : 0; }
+
+	/// Get the signal strength of the last message received
+	/// @return RSSI, as reported by the platform
+	int16_t	get_signal_strength() const { return signal_strength; }
+
+	/// Get the address of the sender of the last message received
+	/// @return Address
+	uint8_t	get_last_source() const { return last_source; }
+
+	/// Get the number of complete messages in the receive queue
+	/// @return Messages waiting to be read
+	uint8_t	get_queued_count() const { return receive_queue ? receive_queue->order_count : 0; }
+
+	/// Get the device frames for a destination are sent to
+	/// @param[in]	destination		Address of destination device
+	/// @return Next hop, the destination itself if it has no route
+	uint8_t	get_next_hop(const uint8_t destination) const;
+
+	/// Get whether a node follows the slots of a hub's beacons
+	/// (always true on a hub with slots)
+	/// @return True if the node sends in its slot
+	bool	get_slot_synced() const { return slots && slots->synced; }
+
+	/// Get the number of beacons sent (on a hub) or heard (on a node)
+	/// @return Beacons since set_slots()
+	uint32_t	get_beacons() const { return slots ? slots->beacons : 0; }
+
+	/// Get the number of frames forwarded as a repeater
+	/// @return Frames forwarded by forward()
+	uint32_t	get_forwarded() const { return relay ? relay->forwarded : 0; }
+
+	/// Get the number of copies of frames a repeater dropped
+	/// @return Frames dropped by forward() as duplicates
+	uint32_t	get_duplicates() const { return relay ? relay->duplicates : 0; }
+
 //=============================================================================
 ///@name	SETTERS
 /*@{*/ //======================================================================
@@ -235,15 +599,66 @@ public:
 	/// @param[in]	a 	The address to set this device to
 	virtual void	set_address(const uint8_t a) = 0;
 
+	/// Set whether data is sent in the compact WireSchema encoding:
+	/// the layout of the data is announced once, then packets only carry
+	/// a schema ID and the values.
+	/// Only on platforms that support frames. Receiving hubs must run
+	/// a version of Loom that decodes it (any platform that supports frames).
+	/// @param[in]	enable	True to enable
+	void	set_compact_encoding(const bool enable) { compact_encoding = enable; }
+
+	/// Set whether send_batch() compresses the stored packets: as many as
+	/// fit are sent as one block of up to FRAGMENT_MAX_MESSAGE bytes
+	/// (fragmented as needed), e.g. to drain a backlog after an outage.
+	/// Only on platforms that support frames. Receiving hubs must run
+	/// a version of Loom that reads blocks
+	/// @param[in]	enable	True to enable
+	void	set_batch_compression(const bool enable) { compress_batch = enable; }
+
+	/// Set how many samples are packed into one packet, for a node sending
+	/// periodic readings. Data is then sent in the WireSchema encoding
+	/// (as with set_compact_encoding()), and send() buffers each sample,
+	/// returning true. The packet is sent once it holds n samples,
+	/// when the next sample would not fit in a frame or has another layout
+	/// or destination, and by flush_samples(). send() returns false when
+	/// that send fails, or a sample is lost.
+	/// Setting n to 1 gives up the buffered samples if they fail to send
+	/// Only on platforms that support frames.
+	/// @param[in]	n	Samples per packet, 1 to send each at once (sending any buffered)
+	void	set_aggregation(const uint8_t n);
+
+	/// Send in time slots (TDMA). On a hub (Manager of DeviceType::HUB),
+	/// frames of count slots start every count * slot_ms milliseconds
+	/// (from its RTC time if it has one), and queue_receive() sends a beacon
+	/// at the start of each. A node sends only in the slot of its instance
+	/// number (1 + (instance - 1) % (count - 1)), with the layout of the
+	/// hub's beacons. Until it hears one it sends unslotted.
+	/// Only on platforms that support frames.
+	/// A slot must be long enough for a node's longest exchange
+	/// (its messages, their acknowledgements and retries)
+	/// @param[in]	slot_ms		Milliseconds of each slot, 0 to send unslotted
+	/// @param[in]	count		Slots in a frame (at least 2), including the beacon's
+	void	set_slots(const uint16_t slot_ms, const uint8_t count);
+
+	/// Reach a device out of range through another, e.g. a node's hub
+	/// through a repeater: frames for destination are sent to next_hop,
+	/// messages always as fragments. Replaces a route learned to destination.
+	/// Only on platforms that support frames
+	/// @param[in]	destination		Device out of range
+	/// @param[in]	next_hop		Device in range to send its frames to, destination to remove the route
+	/// @return False if the routing table is full
+	bool	add_route(const uint8_t destination, const uint8_t next_hop) { return set_route(destination, next_hop, false); }
+
 protected:
 
-	/// Serialize a JsonObject into a MessagePack buffer.
-	/// Also contains buffer memsetting and print statements
+	/// Serialize a JsonObject into a MessagePack buffer, in a single pass
+	/// that also measures it.
+	/// Also contains print statements
 	/// @param[in]	json		JsonObject to serialize
 	/// @param[out]	buffer		Buffer to fill with MessagePack of json
 	/// @param[in]	max_len		Length of buffer
-	/// @return True if success
-	bool	json_to_msgpack_buffer(JsonObjectConst json, char* buffer, const uint16_t max_len) const;
+	/// @return Length of the MessagePack, only in buffer if not more than max_len
+	uint16_t	json_to_msgpack_buffer(JsonObjectConst json, uint8_t* buffer, const uint16_t max_len) const;
 
 	/// Deserialize a MessagePack buffer into a JsonObject.
 	/// Also clears the json, contains prints and error checks.
@@ -251,12 +666,177 @@ protected:
 	/// @param[out]	json		JsonObject to deserialize into
 	/// @param[in]	max_len		Length of buffer
 	/// @return True if success
-	bool	msgpack_buffer_to_json(const char* buffer, JsonObject json);
+	bool	msgpack_buffer_to_json(const char* buffer, JsonObject json) { return msgpack_buffer_to_json(buffer, json, messageJson); }
+
+	/// Deserialize a MessagePack buffer into a JsonObject, through a given document
+	/// (e.g. mergeJson for reassembled messages, which may not fit in messageJson)
+	/// @param[in]	buffer		Buffer to deserialize
+	/// @param[out]	json		JsonObject to deserialize into
+	/// @param[in]	doc			Document to deserialize buffer into first
+	/// @param[in]	len			Length of buffer, 0 if the MsgPack alone bounds it
+	/// @return True if success
+	bool	msgpack_buffer_to_json(const char* buffer, JsonObject json, JsonDocument& doc, const size_t len = 0);
 
 	/// Add the result of a packet to the drop_rate tracker
 	/// @param[in] did_drop		Whether or not the packet dropped during transmission.
 	void	add_packet_result(const bool did_drop);
 
+	/// Receive a message that may be fragmented, on platforms that support frames
+	/// @param[out]	json			Json object to fill with the message
+	/// @param[in]	max_wait_time	Milliseconds to wait for the first frame
+	/// @return True if a whole message was received
+	bool	receive_frames(JsonObject json, const uint max_wait_time);
+
+	/// Add a fragment to a message being reassembled,
+	/// acknowledging it if the sender asked
+	/// @param[in]	frame	Fragment frame
+	/// @param[in]	len		Length of frame
+	/// @param[in]	r		Reassembly state, restarted if it is of another message
+	/// @return True if the message is now complete
+	bool	receive_fragment(const uint8_t* frame, const uint8_t len, Reassembly& r);
+
+	/// Add a fragment to the receive queue's slot for its message
+	/// @param[in]	frame	Fragment frame
+	/// @param[in]	len		Length of frame
+	void	queue_fragment(const uint8_t* frame, const uint8_t len);
+
+	/// Send a serialized message, in fragments if it does not fit in a frame
+	/// @param[in]	message			Message to send
+	/// @param[in]	len				Length of message
+	/// @param[in]	destination		Address of destination device
+	/// @return True if sent successfully
+	bool	send_message(uint8_t* message, const uint16_t len, const uint8_t destination);
+
+	/// Send a record in the WireSchema encoding, announcing its schema first
+	/// if the destination has not been told it recently
+	/// @param[in]	record			Record to send
+	/// @param[in]	destination		Address of destination device
+	/// @return True if sent successfully
+	bool	send_record(const Record& record, const uint8_t destination);
+
+	/// Announce the schema of a record, if the destination has not been
+	/// told it recently
+	/// @param[in]	record			Record to describe
+	/// @param[in]	destination		Address of destination device
+	/// @return False if the announcement failed
+	bool	announce_schema(const Record& record, const uint8_t destination);
+
+	/// Add a record's values to the packet of samples, sending it when full
+	/// @param[in]	record			Record to send
+	/// @param[in]	destination		Address of destination device
+	/// @return True if buffered, or sent successfully. False if a packet
+	///			failed to send (kept for another attempt), or a sample was lost
+	bool	send_sample(const Record& record, const uint8_t destination);
+
+	/// Give up the buffered packet of samples, counting each as lost
+	void	drop_samples();
+
+	/// Read the next sample of the last packet of samples received
+	/// @param[out]	json	Json object to fill with the sample
+	/// @return True if json was filled, false if none is left
+	bool	receive_sample(JsonObject json);
+
+	/// Send a packet of the batch on its own
+	/// @param[in]	batch			Batch holding the packet
+	/// @param[in]	index			Index of the packet
+	/// @param[in]	destination		Address of destination device
+	/// @param[in]	raw				Whether to send it as stored (see send_batch())
+	/// @return True if sent successfully
+	bool	send_batch_packet(BatchSD& batch, const int index, const uint8_t destination, const bool raw);
+
+	/// Send the packets of the batch in compressed blocks
+	/// @param[in]	batch			Batch to send
+	/// @param[in]	destination		Address of destination device
+	/// @param[in] 	delay_time		Milliseconds to wait after each block
+	/// @return Number of packets that failed to send
+	uint8_t	send_batch_blocks(BatchSD& batch, const uint8_t destination, const int delay_time);
+
+	/// Read the next packet of the last compressed batch block received
+	/// @param[out]	json	Json object to fill with the packet
+	/// @return True if json was filled, false if none is left
+	bool	receive_batched(JsonObject json);
+
+	/// Compile wire_record from json (reusing it if the layout did not change)
+	/// and copy the values of json into it
+	/// @param[in]	json	Data to send
+	/// @return False if json can't be held by a record
+	bool	compile_wire_record(JsonObjectConst json);
+
+	/// Handle a complete message: cache a schema announcement,
+	/// or decode data into json
+	/// @param[in]	message		Message, null terminated
+	/// @param[in]	len			Length of message
+	/// @param[out]	json		Json object to fill with the message
+	/// @param[in]	doc			Document to deserialize MsgPack into
+	/// @return True if json was filled
+	bool	receive_message(const uint8_t* message, const uint16_t len, JsonObject json, JsonDocument& doc);
+
+	/// Wait for the acknowledgement of a fragmented message
+	/// @param[in]	id				Message ID
+	/// @param[in]	destination		Device the message was sent to
+	/// @param[out]	received		Bitmap of fragments received
+	/// @param[in]	timeout			Milliseconds to wait
+	/// @return True if an acknowledgement arrived
+	bool	wait_fragment_ack(const uint8_t id, const uint8_t destination, uint32_t& received, const uint timeout = FRAGMENT_ACK_TIMEOUT);
+
+	/// Set, replace or remove the route to a device.
+	/// A learned route does not replace one set by add_route(), and makes
+	/// room in a full table by replacing the oldest learned one
+	/// @param[in]	destination		Device out of range
+	/// @param[in]	next_hop		Device to send its frames to, destination to remove the route
+	/// @param[in]	learned			Whether learned from a forwarded frame
+	/// @return False if the routing table is full
+	bool	set_route(const uint8_t destination, const uint8_t next_hop, const bool learned);
+
+	/// Learn the route back to the sender of a fragment frame:
+	/// through the device it came from (last_source), if not the sender
+	/// @param[in]	source			Sender of the frame
+	void	learn_route(const uint8_t source) { if (routing || source != last_source) set_route(source, last_source, true); }
+
+	/// Whether this device sends the beacons of its slots
+	/// @return True on a hub with slots
+	bool	sends_beacons() const;
+
+	/// Get the hub's time, as last synchronized
+	/// @return Milliseconds since the Unix epoch (or the hub's start if it has no RTC)
+	uint64_t	network_time() const { return slots->base_time + (uint32_t)(millis() - slots->base_millis); }
+
+	/// Get the slot this node sends in
+	/// @return Slot index
+	uint8_t	own_slot() const;
+
+	/// Get the time until a device may send in a slot
+	/// @param[in]	slot	Slot index
+	/// @return Milliseconds, 0 if it may send now
+	uint32_t	until_slot(const uint8_t slot) const;
+
+	/// Send the beacon of the current frame if it is due, on a hub
+	/// @return Milliseconds until the next beacon is due
+	uint32_t	serve_beacon();
+
+	/// Synchronize to a beacon, on a node
+	/// @param[in]	beacon	Beacon frame
+	/// @param[in]	len		Length of beacon
+	void	receive_beacon(const uint8_t* beacon, const uint8_t len);
+
+	/// Wait for this node's slot before sending, listening for a beacon
+	/// first if none was heard recently. Returns at once on a hub or
+	/// a node without slots, or if no beacon can be heard
+	void	wait_slot();
+
+	/// Send the window of fragments held by forward() on to the next hop
+	void	forward_held();
+
+	/// Check whether a frame is a copy of one forwarded recently,
+	/// remembering it if not
+	/// @param[in]	frame			Fragment or acknowledgement frame
+	/// @return True if it is a copy
+	bool	seen_frame(const uint8_t* frame);
+
+	/// Get the longest frame this platform sends
+	/// @return Frame length in bytes
+	uint8_t	frame_len() const { return (max_message_len < FRAGMENT_FRAME_LEN) ? max_message_len : FRAGMENT_FRAME_LEN; }
+
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -12,9 +12,31 @@
 
 #include "LoRa.h"
 #include "Module_Factory.h"
+#include "Manager.h"
 
 using namespace Loom;
 
+namespace {
+
+/// Modem settings of a data rate, slowest first
+struct DataRate {
+	uint8_t		spreading_factor;
+	uint32_t	bandwidth;		///< Hz
+	int16_t		sensitivity;	///< Weakest RSSI received (dBm, SX1276 datasheet)
+};
+
+const DataRate data_rates[LORA_DATA_RATES] = {
+	{ 12, 125000, -137 },
+	{ 11, 125000, -134 },
+	{ 10, 125000, -132 },
+	{  9, 125000, -129 },
+	{  8, 125000, -126 },
+	{  7, 125000, -123 },
+	{  7, 250000, -120 },
+};
+
+} // namespace
+
 ///////////////////////////////////////////////////////////////////////////////
 LoRa::LoRa(
 		const uint16_t		max_message_len,
@@ -27,8 +49,21 @@ LoRa::LoRa(
 	: CommPlat("LoRa", max_message_len )
 	, address(address)
 	, power_level( ( (power_level >= 5) && (power_level <= 23) ) ? power_level : 23 )
+	, max_power(this->power_level)
 	, retry_count(retry_count)
 	, retry_timeout(retry_timeout)
+	, adaptive(false)
+	, data_rate(LORA_DATA_RATE)
+	, worst_rssi(0)
+	, acked(0)
+	, failures(0)
+	, unanswered_rate(LORA_DATA_RATES)
+	, rate_follower(false)
+	, rate_peer(0)
+	, rate_heard(0)
+	, rate_refused(false)
+	, first_peer(RH_BROADCAST_ADDRESS)
+	, many_peers(false)
 	, driver{ RFM95_CS, RFM95_INT }
 	, manager{ driver, address }
 {
@@ -50,9 +85,9 @@ LoRa::LoRa(
 
 	// Set Power Level
 	print_module_label();
-	LPrintln("\tSetting Power Level to ", power_level);
+	LPrintln("\tSetting Power Level to ", this->power_level);
   LMark;
-	driver.setTxPower(power_level, false);
+	driver.setTxPower(this->power_level, false);
 
 	// Set Retry Delay
 	print_module_label();
@@ -66,15 +101,16 @@ LoRa::LoRa(
 	manager.setRetries(retry_count);
   LMark;
 
+	// Listen before talking, so nodes whose sends start together
+	// don't collide on every retry
+	driver.setCADTimeout(LORA_CAD_TIMEOUT);
+
 	// Using default settings
 	//driver.setModemConfig(RH_RF95::Bw125Cr45Sf128);
 
-	// Setting bandwidth
-	driver.setSignalBandwidth(125000);
-  LMark;
-
-	// Setting Spreading Factor (2^10 = 1024)
-	driver.setSpreadingFactor(10); 
+	// Setting bandwidth and Spreading Factor (SF10, 125 kHz)
+	driver.setSignalBandwidth(data_rates[data_rate].bandwidth);
+	driver.setSpreadingFactor(data_rates[data_rate].spreading_factor);
   LMark;
 
 	// Setting Coding Rate (4/8)
@@ -107,6 +143,60 @@ void LoRa::print_config() const
 	LPrintln("\tPower Level   : ", power_level );
 	LPrintln("\tRetry Count   : ", retry_count );
 	LPrintln("\tRetry Timeout : ", retry_timeout );
+	LPrintln("\tAdaptive      : ", (adaptive) ? "Enabled" : "Disabled" );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void LoRa::print_state() const
+{
+	CommPlat::print_state();
+	LPrintln("\tData Rate     : ", data_rate, " (SF", data_rates[data_rate].spreading_factor,
+		", ", data_rates[data_rate].bandwidth / 1000, " kHz)" );
+	LPrintln("\tPower Level   : ", power_level );
+	if (adaptive) {
+		LPrintln("\tLink Margin   : ", signal_strength - sensitivity(data_rate), " dB" );
+		LPrintln("\tFailed Sends  : ", failures );
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void LoRa::set_adaptive(const bool enable)
+{
+	adaptive = enable;
+	acked = 0;
+	failures = 0;
+	unanswered_rate = LORA_DATA_RATES;
+	rate_follower = false;
+	rate_refused = false;
+	if (!enable) {
+		set_data_rate(LORA_DATA_RATE);
+		set_power_level(max_power);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void LoRa::set_data_rate(const uint8_t rate)
+{
+	if (rate >= LORA_DATA_RATES) return;
+	data_rate = rate;
+	acked = 0;
+	driver.setSignalBandwidth(data_rates[rate].bandwidth);
+	driver.setSpreadingFactor(data_rates[rate].spreading_factor);
+
+	print_module_label();
+	LPrintln("Data rate ", rate, " (SF", data_rates[rate].spreading_factor, ", ", data_rates[rate].bandwidth / 1000, " kHz)");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void LoRa::set_power_level(const uint8_t level)
+{
+	if ( (level < LORA_POWER_MIN) || (level > 23) ) return;
+	power_level = level;
+	acked = 0;
+	driver.setTxPower(level, false);
+
+	print_module_label();
+	LPrintln("Power level ", level);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -135,6 +225,8 @@ bool LoRa::receive_blocking_impl(JsonObject json, uint max_wait_time)
 	if (status) {
    	LMark;
 		signal_strength = driver.lastRssi();
+		last_source = from;
+		note_peer(from);
    	LMark;
 		status = msgpack_buffer_to_json(buffer, json);
 	}
@@ -149,22 +241,66 @@ bool LoRa::receive_blocking_impl(JsonObject json, uint max_wait_time)
 ///////////////////////////////////////////////////////////////////////////////
 bool LoRa::send_impl(JsonObject json, const uint8_t destination)
 {
-	char buffer[max_message_len];
   LMark;
-	bool to_msgpack = json_to_msgpack_buffer(json, buffer, max_message_len);
-	if (!to_msgpack) return false;
+	const uint16_t len = json_to_msgpack_buffer(json, send_buffer, max_message_len);
+	if (len == 0 || len > max_message_len) return false;
 
-	bool is_sent = manager.sendtoWait( (uint8_t*)buffer, measureMsgPack(json), destination );
+	return send_raw(send_buffer, len, destination);
+}
 
-	print_module_label();
-	LPrintln("Send " , (is_sent) ? "successful" : "failed" );
-  LMark;
-	signal_strength = driver.lastRssi();
-  LMark;
-	driver.sleep();
+///////////////////////////////////////////////////////////////////////////////
+bool LoRa::send_frame(const uint8_t* bytes, const uint8_t len, const uint8_t destination)
+{
+	driver.setHeaderTo(destination);
+	driver.setHeaderFlags(LORA_FRAME_FLAG, RH_FLAGS_APPLICATION_SPECIFIC);
+	bool is_sent = driver.send(bytes, len) && driver.waitPacketSent();
+	driver.setHeaderFlags(RH_FLAGS_NONE, RH_FLAGS_APPLICATION_SPECIFIC);
 	return is_sent;
 }
 
+///////////////////////////////////////////////////////////////////////////////
+uint8_t LoRa::receive_frame(uint8_t* bytes, const uint8_t max_len, const uint max_wait_time)
+{
+	// Meet a peer that went quiet at the default data rate
+	if ( rate_follower && (millis() - rate_heard > LORA_ADR_FALLBACK) ) {
+		rate_follower = false;
+		set_data_rate(LORA_DATA_RATE);
+	}
+
+	const unsigned long start = millis();
+	unsigned long elapsed = 0;
+	do {
+		uint8_t len = max_len;
+		uint8_t from;
+		const bool available = (max_wait_time == 0)
+			? driver.available()
+			: driver.waitAvailableTimeout(max_wait_time - elapsed);
+		if (!available) return 0;
+
+		// Headers of the packet waiting are known once available() returns
+		if (driver.headerFlags() & LORA_RATE_FLAG) {
+			answer_data_rate();
+			continue;
+		}
+
+		bool status;
+		if (driver.headerFlags() & LORA_FRAME_FLAG) {
+			from = driver.headerFrom();
+			status = driver.recv(bytes, &len);
+		} else {
+			status = manager.recvfromAck(bytes, &len, &from);
+		}
+
+		if (!status) return 0;
+		signal_strength = driver.lastRssi();
+		last_source = from;
+		note_peer(from);
+		if (from == rate_peer) rate_heard = millis();
+		return len;
+	} while ( (elapsed = millis() - start) < max_wait_time );
+	return 0;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 bool LoRa::send_raw(uint8_t* bytes, const uint8_t len, const uint8_t destination) {
   LMark;
@@ -175,10 +311,148 @@ bool LoRa::send_raw(uint8_t* bytes, const uint8_t len, const uint8_t destination
   LMark;
 	signal_strength = driver.lastRssi();
   LMark;
+	adapt_link(is_sent, destination);
 	driver.sleep();
 	return is_sent;
 }
 
+///////////////////////////////////////////////////////////////////////////////
+int16_t LoRa::sensitivity(const uint8_t rate)
+{
+	return data_rates[rate].sensitivity;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void LoRa::adapt_link(const bool acknowledged, const uint8_t destination)
+{
+	if ( !adaptive || (destination == RH_BROADCAST_ADDRESS) ) return;
+
+	if (!acknowledged) {
+		acked = 0;
+		failures++;
+		if ( (failures == LORA_ADR_BACKOFF) && (power_level < max_power) ) {
+			set_power_level(max_power);
+		}
+		else if (failures >= 2 * LORA_ADR_BACKOFF) {
+			// The destination may have switched to a rate it did not get to
+			// confirm, else it is waiting at the default rate
+			if (unanswered_rate < LORA_DATA_RATES) {
+				set_data_rate(unanswered_rate);
+				unanswered_rate = LORA_DATA_RATES;
+			} else if (data_rate != LORA_DATA_RATE) {
+				set_data_rate(LORA_DATA_RATE);
+			}
+			failures = 0;
+		}
+		return;
+	}
+
+	failures = 0;
+	unanswered_rate = LORA_DATA_RATES;
+	if ( (acked == 0) || (signal_strength < worst_rssi) ) {
+		worst_rssi = signal_strength;
+	}
+	if (++acked < LORA_ADR_HISTORY) return;
+	acked = 0;
+
+	// The hub acknowledges at the configured power, so the power given up
+	// comes off the margin of the acknowledgements to give the margin of
+	// this device's frames at the hub
+	const int16_t margin = worst_rssi - sensitivity(data_rate) - LORA_ADR_MARGIN - (max_power - power_level);
+
+	// One step per round, a faster data rate before lower power
+	if (margin >= LORA_POWER_STEP) {
+		if ( (data_rate < LORA_DATA_RATES - 1) && !rate_refused
+				&& (margin >= sensitivity(data_rate + 1) - sensitivity(data_rate))
+				&& request_data_rate(data_rate + 1, destination) ) {
+			return;
+		}
+		if (power_level - LORA_POWER_STEP >= LORA_POWER_MIN) {
+			set_power_level(power_level - LORA_POWER_STEP);
+		}
+	}
+	else if ( (margin < 0) && (power_level < max_power) ) {
+		set_power_level( (power_level + LORA_POWER_STEP < max_power) ? power_level + LORA_POWER_STEP : max_power );
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool LoRa::request_data_rate(const uint8_t rate, const uint8_t destination)
+{
+	uint8_t frame[2] = { LORA_RATE_REQUEST, rate };
+	driver.setHeaderTo(destination);
+	driver.setHeaderFlags(LORA_RATE_FLAG, RH_FLAGS_APPLICATION_SPECIFIC);
+	const bool is_sent = driver.send(frame, sizeof(frame)) && driver.waitPacketSent();
+	driver.setHeaderFlags(RH_FLAGS_NONE, RH_FLAGS_APPLICATION_SPECIFIC);
+	if (!is_sent) return false;
+
+	// Other frames arriving meanwhile are dropped
+	const unsigned long start = millis();
+	unsigned long elapsed;
+	while ( (elapsed = millis() - start) < retry_timeout ) {
+		if (!driver.waitAvailableTimeout(retry_timeout - elapsed)) break;
+		const bool is_answer = (driver.headerFlags() & LORA_RATE_FLAG) && (driver.headerFrom() == destination);
+		uint8_t len = sizeof(frame);
+		if ( !driver.recv(frame, &len) || !is_answer || (len != 2) || (frame[1] != rate) ) continue;
+		if (frame[0] == LORA_RATE_ANSWER) {
+			set_data_rate(rate);
+			return true;
+		}
+		if (frame[0] == LORA_RATE_REFUSE) {
+			// Only power is adapted from now on
+			rate_refused = true;
+			return false;
+		}
+	}
+	unanswered_rate = rate;
+	return false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void LoRa::answer_data_rate()
+{
+	uint8_t frame[2];
+	uint8_t len = sizeof(frame);
+	const uint8_t from = driver.headerFrom();
+	if ( !driver.recv(frame, &len) || !adaptive || (len != 2)
+			|| (frame[0] != LORA_RATE_REQUEST) || (frame[1] >= LORA_DATA_RATES) ) return;
+	note_peer(from);
+
+	// A hub's other devices would no longer be heard at another rate
+	const bool refuse = many_peers && device_manager
+		&& (device_manager->get_device_type() == Manager::DeviceType::HUB);
+
+	// Answered at the current rate, then both switch unless refused
+	frame[0] = refuse ? LORA_RATE_REFUSE : LORA_RATE_ANSWER;
+	driver.setHeaderTo(from);
+	driver.setHeaderFlags(LORA_RATE_FLAG, RH_FLAGS_APPLICATION_SPECIFIC);
+	driver.send(frame, sizeof(frame)) && driver.waitPacketSent();
+	driver.setHeaderFlags(RH_FLAGS_NONE, RH_FLAGS_APPLICATION_SPECIFIC);
+	if (refuse) return;
+
+	set_data_rate(frame[1]);
+	rate_follower	= true;
+	rate_peer		= from;
+	rate_heard		= millis();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void LoRa::note_peer(const uint8_t from)
+{
+	if (first_peer == RH_BROADCAST_ADDRESS) {
+		first_peer = from;
+		return;
+	}
+	if ( many_peers || (from == first_peer) ) return;
+	many_peers = true;
+
+	if ( rate_follower && device_manager
+			&& (device_manager->get_device_type() == Manager::DeviceType::HUB) ) {
+		rate_follower = false;
+		set_data_rate(LORA_DATA_RATE);
+	}
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 bool LoRa::receive_blocking_raw(uint8_t* dest, const uint8_t maxlen, const uint max_wait_time) {
 	bool status;
@@ -28,6 +28,23 @@ namespace Loom {
 
 /// LoRa radio frequence.
 /// Hardware specific, Tx must match Rx
+#define LORA_FRAME_FLAG 0x01	///< RadioHead application header flag of fragment frames
+#define LORA_RATE_FLAG	0x02	///< RadioHead application header flag of data rate requests and answers
+
+#define LORA_RATE_REQUEST	0x01	///< Data rate frame asking the destination to switch
+#define LORA_RATE_ANSWER	0x02	///< Data rate frame agreeing to switch
+#define LORA_RATE_REFUSE	0x03	///< Data rate frame refusing to switch (a hub with several nodes)
+
+#define LORA_DATA_RATE		2		///< Data rate used until a link negotiates another (SF10, 125 kHz)
+#define LORA_DATA_RATES		7		///< Number of data rates
+#define LORA_POWER_MIN		5		///< Lowest transmit power (dBm)
+#define LORA_POWER_STEP		3		///< dB transmit power is adapted by at a time
+#define LORA_ADR_MARGIN		10		///< dB of signal kept above the sensitivity of the data rate
+#define LORA_ADR_HISTORY	8		///< Acknowledged sends at a setting before it is adapted
+#define LORA_ADR_BACKOFF	2		///< Failed sends before power is raised to the configured level, twice as many before the data rate falls back
+#define LORA_ADR_FALLBACK	3600000	///< Milliseconds a hub stays at a negotiated data rate without hearing its peer
+#define LORA_CAD_TIMEOUT	3000	///< Longest wait for the channel to clear before each transmission (ms)
+
 #define RF95_FREQ 915.0
 
 
@@ -35,6 +52,23 @@ namespace Loom {
 ///
 /// LoRa communication platform module.
 ///
+/// With set_adaptive(), a node adapts its link to the hub from the RSSI of
+/// the acknowledgements it gets, like LoRaWAN's ADR. Every LORA_ADR_HISTORY
+/// acknowledged sends, the margin of the weakest RSSI over the sensitivity of
+/// the data rate plus LORA_ADR_MARGIN is worked out. The hub acknowledges at
+/// the configured power, so the power the node has given up is taken off the
+/// margin, giving the margin its own frames arrive at the hub with. With
+/// margin to spare, the node asks the destination for the next faster data
+/// rate (both switch once it answers), and at the fastest rate, or if it
+/// refuses or does not answer, lowers its transmit power. Without enough
+/// margin, power is raised. After failed sends, power goes back to the
+/// configured level, then the data rate to LORA_DATA_RATE, the rate a hub
+/// also returns to when it has not heard its peer for LORA_ADR_FALLBACK.
+///
+/// A hub listens at one data rate, so once it has heard from more than one
+/// device it refuses data rate requests and returns to LORA_DATA_RATE.
+/// Its nodes still adapt their power.
+///
 /// @par Resources
 /// - [Module Documentation](https://openslab-osu.github.io/Loom/html/class_loom___lo_ra.html)
 /// - [Product Page: Adafruit Feather M0 LoRa](https://www.adafruit.com/product/3178)
@@ -45,6 +79,7 @@ namespace Loom {
 ///////////////////////////////////////////////////////////////////////////////
 class LoRa : public CommPlat
 {
+	LOOM_MODULE_TYPE(LoRa, CommPlat)
 
 protected:
 
@@ -54,9 +89,23 @@ protected:
 	uint8_t				address;		///< Device Address    (should this be part of LoomCommPlat? – maybe not as each platform handles addresses differently)
 
 	uint8_t				power_level;	///< Power level to send at
+	uint8_t				max_power;		///< Configured power level, the most adaptive mode uses
 	uint8_t				retry_count;	///< Number of transmission retries allowed
 	uint16_t			retry_timeout;	///< Delay between transmission retries (in milliseconds)
 
+	bool				adaptive;		///< Whether data rate and power adapt to the link
+	uint8_t				data_rate;		///< Data rate in use, index of data_rates
+	int16_t				worst_rssi;		///< Weakest acknowledgement since the setting was last adapted
+	uint8_t				acked;			///< Acknowledged sends since the setting was last adapted
+	uint8_t				failures;		///< Failed sends in a row
+	uint8_t				unanswered_rate;	///< Data rate of a request that got no answer (which may have been heard), LORA_DATA_RATES if none
+	bool				rate_follower;	///< Whether the data rate was switched at a peer's request (on a hub)
+	uint8_t				rate_peer;		///< Device whose request set the data rate
+	uint32_t			rate_heard;		///< millis() rate_peer was last heard from
+	bool				rate_refused;	///< Whether the destination refused to switch data rate
+	uint8_t				first_peer;		///< First device heard from, RH_BROADCAST_ADDRESS until one is
+	bool				many_peers;		///< Whether more than one device has been heard from
+
 
 //=============================================================================
 ///@name	RADIO IMPLEMENTATION
@@ -74,6 +123,51 @@ protected:
 	/// @return True if packet sent successfully
 	bool send_impl(JsonObject json, const uint8_t destination) override;
 
+	bool supports_frames() const override { return true; }
+
+	/// Send a fragment frame with the driver, bypassing the reliable datagram
+	/// manager, so it is neither acknowledged on its own nor dropped as a duplicate
+	/// @param[in]	bytes			Bytes to send
+	/// @param[in]	len				Number of bytes to send
+	/// @param[in]	destination		Device to send to
+	/// @return True if the frame was sent
+	bool send_frame(const uint8_t* bytes, const uint8_t len, const uint8_t destination) override;
+
+	/// Receive a fragment frame, or a message sent with send_impl()
+	/// (which is acknowledged as usual)
+	/// @param[out]	bytes			Buffer to fill
+	/// @param[in]	max_len			Size of bytes
+	/// @param[in]	max_wait_time	Maximum number of milliseconds to block for
+	/// @return Length of the frame, 0 if none arrived
+	uint8_t receive_frame(uint8_t* bytes, const uint8_t max_len, const uint max_wait_time) override;
+
+	void frames_done() override { driver.sleep(); }
+
+	/// Adapt the data rate and power after a send, if adaptive
+	/// @param[in]	acknowledged	Whether the send was acknowledged
+	/// @param[in]	destination		Device sent to
+	void adapt_link(const bool acknowledged, const uint8_t destination);
+
+	/// Ask a device to switch data rate, switching too if it agrees
+	/// @param[in]	rate			Data rate to switch to
+	/// @param[in]	destination		Device to ask
+	/// @return True if switched
+	bool request_data_rate(const uint8_t rate, const uint8_t destination);
+
+	/// Answer a data rate request that has arrived, switching to it if adaptive,
+	/// unless this is a hub that has heard from more than one device
+	void answer_data_rate();
+
+	/// Note a device heard from. A hub that hears a second device returns
+	/// to LORA_DATA_RATE, the rate every node starts at
+	/// @param[in]	from	Sender of the frame received
+	void note_peer(const uint8_t from);
+
+	/// Sensitivity of a data rate
+	/// @param[in]	rate	Data rate
+	/// @return Weakest RSSI received (dBm)
+	static int16_t sensitivity(const uint8_t rate);
+
 public:
 
 	/// Escape hatch for sending raw bytes
@@ -81,7 +175,7 @@ public:
 	/// @param[in] len		Number of bytes to send (MUST be less than 251)
 	/// @param[in] destination		Address of device to send to
 	/// @return True if packet sent successfully
-	bool send_raw(uint8_t* bytes, const uint8_t len, const uint8_t destination);
+	bool send_raw(uint8_t* bytes, const uint8_t len, const uint8_t destination) override;
 
 	/// Escape hatch for receiving raw bytes
 	/// @param[out] dest	Pointer to byte array to store data
@@ -131,6 +225,7 @@ public:
 /*@{*/ //======================================================================
 
 	void		print_config() const override;
+	void		print_state() const override;
 
 //=============================================================================
 ///@name	GETTERS
@@ -138,7 +233,17 @@ public:
 
 	uint8_t		get_address() const override { return address; }
 
-	int16_t     get_signal_strength() const { return signal_strength; }
+	/// Get whether data rate and power adapt to the link
+	/// @return True if enabled
+	bool		get_adaptive() const { return adaptive; }
+
+	/// Get the data rate in use
+	/// @return Data rate, 0 (SF12, 125 kHz) to 6 (SF7, 250 kHz)
+	uint8_t		get_data_rate() const { return data_rate; }
+
+	/// Get the transmit power in use
+	/// @return Power level (dBm)
+	uint8_t		get_power_level() const { return power_level; }
 
 //=============================================================================
 ///@name	SETTERS
@@ -146,6 +251,19 @@ public:
 
 	void		set_address(const uint8_t addr) override;
 
+	/// Set whether data rate and power adapt to the link.
+	/// Disabling returns to LORA_DATA_RATE and the configured power
+	/// @param[in]	enable	True to enable
+	void		set_adaptive(const bool enable);
+
+	/// Set the data rate. The other end of the link must use the same
+	/// @param[in]	rate	Data rate, 0 (SF12, 125 kHz) to 6 (SF7, 250 kHz)
+	void		set_data_rate(const uint8_t rate);
+
+	/// Set the transmit power
+	/// @param[in]	level	Power level (dBm), 5 to 23
+	void		set_power_level(const uint8_t level);
+
 private:
 
 };
@@ -0,0 +1,201 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+/// @file		SimRadio.cpp
+/// @brief		File for SimRadio implementation.
+/// @date		2020
+/// @copyright	GNU General Public License v3.0
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#if defined(LOOM_INCLUDE_RADIOS) && defined(LOOM_NATIVE)
+
+#include "SimRadio.h"
+#include "Module_Factory.h"
+
+#include <SimClock.h>
+
+using namespace Loom;
+using namespace LoomNative;
+
+///////////////////////////////////////////////////////////////////////////////
+SimRadio::SimRadio(
+		const uint16_t		max_message_len,
+		const uint8_t		address,
+		const uint8_t		retry_count,
+		const uint16_t		retry_timeout,
+		const bool			fragment
+	)
+	: CommPlat("SimRadio", (max_message_len < 251) ? max_message_len : 251 )
+	, radio( Channel::attach(address) )
+	, address(address)
+	, retry_count(retry_count)
+	, retry_timeout(retry_timeout)
+	, fragment(fragment)
+	, sequence(0)
+	, seen_ids{}
+	, retransmits(0)
+{}
+
+///////////////////////////////////////////////////////////////////////////////
+SimRadio::SimRadio(JsonArrayConst p)
+	: SimRadio(EXPAND_ARRAY(p, 5) ) {}
+
+///////////////////////////////////////////////////////////////////////////////
+SimRadio::~SimRadio()
+{
+	Channel::detach(radio);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void SimRadio::print_config() const
+{
+	CommPlat::print_config();
+
+	LPrintln("\tAddress       : ", address );
+	LPrintln("\tRetry Count   : ", retry_count );
+	LPrintln("\tRetry Timeout : ", retry_timeout );
+	LPrintln("\tFragment      : ", (fragment) ? "Enabled" : "Disabled" );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void SimRadio::print_state() const
+{
+	CommPlat::print_state();
+	LPrintln("\tRetransmits   : ", retransmits );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void SimRadio::set_address(const uint8_t addr)
+{
+	address = addr;
+	Channel::set_address(radio, addr);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool SimRadio::receive_blocking_impl(JsonObject json, uint max_wait_time)
+{
+	char buffer[max_message_len + 1];
+	const uint8_t len = receive_frame((uint8_t*)buffer, max_message_len, max_wait_time);
+	buffer[len] = '\0';
+	const bool status = (len > 0) && msgpack_buffer_to_json(buffer, json);
+
+	print_module_label();
+	LPrintln("Receive ", (status) ? "successful" : "failed");
+	return status;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool SimRadio::send_impl(JsonObject json, const uint8_t destination)
+{
+	const uint16_t len = json_to_msgpack_buffer(json, send_buffer, max_message_len);
+	if (len == 0 || len > max_message_len) return false;
+
+	return send_raw(send_buffer, len, destination);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void SimRadio::broadcast_impl(JsonObject json)
+{
+	const uint16_t len = json_to_msgpack_buffer(json, send_buffer, max_message_len);
+	if (len == 0 || len > max_message_len) return;
+
+	send_raw(send_buffer, len, Channel::BROADCAST);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool SimRadio::send_frame(const uint8_t* bytes, const uint8_t len, const uint8_t destination)
+{
+	if (!wait_clear()) return false;
+	Channel::transmit(radio, { destination, address, 0, SIMRADIO_FLAG_FRAME }, bytes, len);
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+uint8_t SimRadio::receive_frame(uint8_t* bytes, const uint8_t max_len, const uint max_wait_time)
+{
+	const uint64_t deadline = Clock::now_us() + (uint64_t)max_wait_time * 1000ULL;
+	while (true) {
+		const uint64_t now = Clock::now_us();
+		Channel::Header header;
+		const int len = Channel::receive(radio, header, bytes, max_len, (deadline > now) ? deadline - now : 0);
+		if (len < 0) return 0;
+
+		// Acknowledgements are only waited for while sending
+		if (header.flags & SIMRADIO_FLAG_ACK) continue;
+
+		if ( !(header.flags & SIMRADIO_FLAG_FRAME) ) {
+			if (header.to != Channel::BROADCAST) acknowledge(header.id, header.from);
+			if (seen_ids[header.from] == header.id) continue;
+			seen_ids[header.from] = header.id;
+		}
+		last_source = header.from;
+		return len;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool SimRadio::send_raw(uint8_t* bytes, const uint8_t len, const uint8_t destination)
+{
+	if (len > max_message_len) return false;
+
+	const Channel::Header header = { destination, address, ++sequence, 0 };
+	bool is_sent = false;
+	for (auto attempt = 0; attempt <= retry_count && !is_sent; attempt++) {
+		if (attempt > 0) retransmits++;
+		if (!wait_clear()) break;
+		Channel::transmit(radio, header, bytes, len);
+		if (destination == Channel::BROADCAST) return true;
+
+		// Randomized, so the retries of senders that collided drift apart
+		is_sent = wait_ack(sequence, destination, retry_timeout + random(retry_timeout));
+	}
+
+	print_module_label();
+	LPrintln("Send " , (is_sent) ? "successful" : "failed" );
+	return is_sent;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool SimRadio::wait_clear()
+{
+	const unsigned long start = millis();
+	while (Channel::busy(radio)) {
+		if (millis() - start > SIMRADIO_CAD_TIMEOUT) return false;
+		delay(random(1, 10) * 100);
+	}
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool SimRadio::wait_ack(const uint8_t id, const uint8_t destination, const uint timeout)
+{
+	const uint64_t deadline = Clock::now_us() + (uint64_t)timeout * 1000ULL;
+	uint8_t frame[FRAGMENT_FRAME_LEN];
+	uint64_t now;
+	while ( (now = Clock::now_us()) < deadline ) {
+		Channel::Header header;
+		if (Channel::receive(radio, header, frame, sizeof(frame), deadline - now) < 0) break;
+
+		if ( (header.flags & SIMRADIO_FLAG_ACK) && (header.from == destination) && (header.id == id) ) {
+			return true;
+		}
+		// A message received again lost its acknowledgement, anything else is dropped
+		if ( !(header.flags & (SIMRADIO_FLAG_ACK | SIMRADIO_FLAG_FRAME))
+				&& (header.to != Channel::BROADCAST) && (seen_ids[header.from] == header.id) ) {
+			acknowledge(header.id, header.from);
+		}
+	}
+	return false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void SimRadio::acknowledge(const uint8_t id, const uint8_t source)
+{
+	const uint8_t ack = '!';
+	if (!wait_clear()) return;
+	Channel::transmit(radio, { source, address, id, SIMRADIO_FLAG_ACK }, &ack, 1);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+#endif // if defined(LOOM_INCLUDE_RADIOS) && defined(LOOM_NATIVE)
@@ -0,0 +1,187 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+/// @file		SimRadio.h
+/// @brief		File for SimRadio definition.
+///				Radio on the native build's simulated channel.
+/// @date		2020
+/// @copyright	GNU General Public License v3.0
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#if defined(LOOM_INCLUDE_RADIOS) && defined(LOOM_NATIVE)
+#pragma once
+
+#include "CommPlat.h"
+
+#include <SimChannel.h>
+
+namespace Loom {
+
+///////////////////////////////////////////////////////////////////////////////
+
+#define SIMRADIO_FLAG_FRAME	0x01	///< Header flag of fragment frames, not acknowledged on their own
+#define SIMRADIO_FLAG_ACK	0x80	///< Header flag of acknowledgements (RadioHead's RH_FLAGS_ACK)
+#define SIMRADIO_CAD_TIMEOUT	3000	///< Longest wait for the channel to clear before sending (ms), as LoRa's
+
+
+///////////////////////////////////////////////////////////////////////////////
+///
+/// Radio on the simulated channel of the native build (LoomNative::Channel),
+/// for testing and benchmarking communication without hardware.
+///
+/// Messages are sent the way LoRa sends them with RadioHead's reliable
+/// datagrams: each is acknowledged by the receiver, retried up to
+/// retry_count times after a random timeout of one to two retry_timeout,
+/// and duplicates of a message are acknowledged again but dropped.
+/// Fragment frames are sent unacknowledged, as LoRa does. Every frame
+/// waits for the channel to clear first (RadioHead's channel activity
+/// detection), backing off 100 to 900 ms at a time, so that devices
+/// whose sends start together don't collide on every retry.
+///
+/// Many devices, each with a Manager and a SimRadio, can share the channel
+/// with LoomNative::Channel::add_node() and run().
+///
+/// @par Resources
+/// - [Simulated channel](https://github.com/OPEnSLab-OSU/Loom/blob/master/lib/LoomNative/README.md)
+///
+///////////////////////////////////////////////////////////////////////////////
+class SimRadio : public CommPlat
+{
+	LOOM_MODULE_TYPE(SimRadio, CommPlat)
+
+protected:
+
+	int					radio;			///< Handle of the radio on the channel
+
+	uint8_t				address;		///< Device address
+	uint8_t				retry_count;	///< Number of transmission retries allowed
+	uint16_t			retry_timeout;	///< Least time to wait for an acknowledgement (in milliseconds)
+	bool				fragment;		///< Whether long messages are fragmented, else split by module
+
+	uint8_t				sequence;		///< ID of the last message sent
+	uint8_t				seen_ids[256];	///< ID of the last message received from each address
+	uint32_t			retransmits;	///< Messages sent again after a missing acknowledgement
+
+//=============================================================================
+///@name	RADIO IMPLEMENTATION
+/*@{*/ //======================================================================
+
+	/// Receive, but block until packet received, or timeout reached
+	/// @param[out]	json			Json object to fill with incoming data
+	/// @param[in]	max_wait_time	Maximum number of milliseconds to block for (can be zero for non-blocking)
+	/// @return True if packet received
+	bool receive_blocking_impl(JsonObject json, uint max_wait_time) override;
+
+	/// Send json to a specific address
+	/// @param[in]	json			Json package to send
+	/// @param[in]	destination		Device to send to
+	/// @return True if packet sent successfully
+	bool send_impl(JsonObject json, const uint8_t destination) override;
+
+	/// Broadcast json to all devices, unacknowledged
+	/// @param[in]	json			Json package to send
+	void broadcast_impl(JsonObject json) override;
+
+	bool supports_frames() const override { return fragment; }
+
+	/// Send a fragment frame, unacknowledged
+	/// @param[in]	bytes			Bytes to send
+	/// @param[in]	len				Number of bytes to send
+	/// @param[in]	destination		Device to send to
+	/// @return True, false if the channel stayed busy
+	bool send_frame(const uint8_t* bytes, const uint8_t len, const uint8_t destination) override;
+
+	/// Receive a fragment frame, or a message (which is acknowledged)
+	/// @param[out]	bytes			Buffer to fill
+	/// @param[in]	max_len			Size of bytes
+	/// @param[in]	max_wait_time	Maximum number of milliseconds to block for
+	/// @return Length of the frame, 0 if none arrived
+	uint8_t receive_frame(uint8_t* bytes, const uint8_t max_len, const uint max_wait_time) override;
+
+	/// Wait until no other device is heard transmitting, as RadioHead's
+	/// waitCAD() does
+	/// @return False if the channel stayed busy for SIMRADIO_CAD_TIMEOUT
+	bool wait_clear();
+
+	/// Wait for the acknowledgement of a message
+	/// @param[in]	id				ID of the message
+	/// @param[in]	destination		Device the message was sent to
+	/// @param[in]	timeout			Milliseconds to wait
+	/// @return True if acknowledged
+	bool wait_ack(const uint8_t id, const uint8_t destination, const uint timeout);
+
+	/// Acknowledge a message
+	/// @param[in]	id				ID of the message
+	/// @param[in]	source			Device that sent it
+	void acknowledge(const uint8_t id, const uint8_t source);
+
+public:
+
+	/// Send raw bytes as an acknowledged message
+	/// @param[in] raw		Bytes to send
+	/// @param[in] len		Number of bytes to send (at most max_message_len)
+	/// @param[in] destination		Address of device to send to
+	/// @return True if the message was acknowledged (or broadcast)
+	bool send_raw(uint8_t* bytes, const uint8_t len, const uint8_t destination) override;
+
+//=============================================================================
+///@name	CONSTRUCTORS / DESTRUCTOR
+/*@{*/ //======================================================================
+
+	/// SimRadio module constructor
+	///
+	/// @param[in]	max_message_len				Int | <251> | [1-251] | The maximum possible message length
+	/// @param[in]	address						Int | <01> | [0-254] | This device's address
+	/// @param[in]	retry_count					Int | <3> | [0-15] | Max number of transmission retries
+	/// @param[in]	retry_timeout				Int | <200>| [20-500] | Least delay between retransmissions (ms)
+	/// @param[in]	fragment					Bool | <true> | {true, false} | Fragment long messages, else split them by module
+	SimRadio(
+			const uint16_t		max_message_len		= 251,
+			const uint8_t		address				= 0,
+			const uint8_t		retry_count			= 3,
+			const uint16_t		retry_timeout		= 200,
+			const bool			fragment			= true
+		);
+
+	/// Constructor that takes Json Array, extracts args
+	/// and delegates to regular constructor
+	/// @param[in]	p		The array of constuctor args to expand
+	SimRadio(JsonArrayConst p);
+
+	/// Destructor, detaches from the channel
+	~SimRadio();
+
+//=============================================================================
+///@name	PRINT INFORMATION
+/*@{*/ //======================================================================
+
+	void		print_config() const override;
+	void		print_state() const override;
+
+//=============================================================================
+///@name	GETTERS
+/*@{*/ //======================================================================
+
+	uint8_t		get_address() const override { return address; }
+
+	/// Get the number of messages sent again after a missing acknowledgement
+	/// @return Retransmissions since construction
+	uint32_t	get_retransmits() const { return retransmits; }
+
+//=============================================================================
+///@name	SETTERS
+/*@{*/ //======================================================================
+
+	void		set_address(const uint8_t addr) override;
+
+private:
+
+};
+
+///////////////////////////////////////////////////////////////////////////////
+REGISTER(Module, SimRadio, "SimRadio");
+///////////////////////////////////////////////////////////////////////////////
+
+}; // namespace Loom
+
+#endif // if defined(LOOM_INCLUDE_RADIOS) && defined(LOOM_NATIVE)
@@ -0,0 +1,584 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+/// @file		WireSchema.cpp
+/// @brief		File for WireSchema implementation.
+/// @date		2020
+/// @copyright	GNU General Public License v3.0
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#ifdef LOOM_INCLUDE_RADIOS
+
+#include "WireSchema.h"
+
+using namespace Loom;
+
+namespace {
+
+///////////////////////////////////////////////////////////////////////////////
+/// Appends bytes to a buffer, remembering if any did not fit
+struct Output {
+	uint8_t*	buffer;
+	uint16_t	max_len;
+	uint16_t	len;
+	bool		ok;
+
+	Output(uint8_t* buffer, const uint16_t max_len) : buffer(buffer), max_len(max_len), len(0), ok(true) {}
+
+	void put(const void* src, const uint16_t count)
+	{
+		if (len + count > max_len) {
+			ok = false;
+			return;
+		}
+		memcpy(buffer + len, src, count);
+		len += count;
+	}
+
+	void put_byte(const uint8_t byte) { put(&byte, 1); }
+
+	/// Zigzag varint, small magnitudes of either sign take one byte
+	void put_int(const int32_t i)
+	{
+		uint32_t zigzag = ((uint32_t)i << 1) ^ (uint32_t)(i >> 31);
+		do {
+			const uint8_t byte = zigzag & 0x7F;
+			zigzag >>= 7;
+			put_byte(zigzag ? (byte | 0x80) : byte);
+		} while (zigzag);
+	}
+
+	/// Length (at most 255) then characters
+	void put_text(const char* text, const size_t text_len)
+	{
+		const uint8_t count = (text_len > 255) ? 255 : text_len;
+		put_byte(count);
+		put(text, count);
+	}
+
+	void put_value(const Record::Type type, const Record::Value& val)
+	{
+		switch (type) {
+			case Record::Type::INT:		put_int(val.i); break;
+			case Record::Type::FLOAT:	put(&val.f, 4); break;
+			case Record::Type::BOOL:	put_byte(val.b); break;
+			case Record::Type::STRING:	put_text(val.s, strlen(val.s)); break;
+		}
+	}
+
+	/// Float bits XOR those of the first sample. Slowly changing readings
+	/// share sign, exponent and high mantissa bits, so leading bytes are zero
+	void put_float_delta(const uint32_t x)
+	{
+		uint8_t trailing = 0;
+		uint8_t significant = 4;
+		if (x == 0) {
+			significant = 0;
+		} else {
+			while ( ((x >> (8 * trailing)) & 0xFF) == 0 ) trailing++;
+			while ( ((x >> (8 * (significant - 1))) & 0xFF) == 0 ) significant--;
+			significant -= trailing;
+		}
+		put_byte((significant << 4) | trailing);
+		for (auto i = 0; i < significant; i++) {
+			put_byte(x >> (8 * (trailing + i)));
+		}
+	}
+};
+
+///////////////////////////////////////////////////////////////////////////////
+/// Reads bytes from a buffer, remembering if it ran out
+struct Input {
+	const uint8_t*	buffer;
+	uint16_t		len;
+	uint16_t		pos;
+	bool			ok;
+
+	Input(const uint8_t* buffer, const uint16_t len) : buffer(buffer), len(len), pos(0), ok(true) {}
+
+	uint8_t get_byte()
+	{
+		if (pos >= len) {
+			ok = false;
+			return 0;
+		}
+		return buffer[pos++];
+	}
+
+	/// @return Bytes in the buffer, nullptr if fewer than count remain
+	const uint8_t* get_bytes(const uint16_t count)
+	{
+		if (pos + count > len) {
+			ok = false;
+			return nullptr;
+		}
+		pos += count;
+		return buffer + pos - count;
+	}
+
+	/// @return C-string in the buffer, nullptr if unterminated
+	const char* get_string()
+	{
+		const char* str = (const char*)buffer + pos;
+		while (get_byte() != '\0') {
+			if (!ok) return nullptr;
+		}
+		return str;
+	}
+
+	int32_t get_int()
+	{
+		uint32_t zigzag = 0;
+		for (uint8_t shift = 0; shift < 35; shift += 7) {
+			const uint8_t byte = get_byte();
+			zigzag |= (uint32_t)(byte & 0x7F) << shift;
+			if (!(byte & 0x80)) break;
+		}
+		return (int32_t)((zigzag >> 1) ^ -(int32_t)(zigzag & 1));
+	}
+
+	uint32_t get_bits()
+	{
+		uint32_t bits = 0;
+		const uint8_t* src = get_bytes(4);
+		if (src) memcpy(&bits, src, 4);
+		return bits;
+	}
+
+	/// @param[out]	count	Length of the text
+	/// @return Characters in the buffer, unterminated
+	const char* get_text(uint8_t& count)
+	{
+		count = get_byte();
+		const char* text = (const char*)get_bytes(count);
+		if (!text) count = 0;
+		return text;
+	}
+
+	uint32_t get_float_delta()
+	{
+		const uint8_t header		= get_byte();
+		const uint8_t significant	= header >> 4;
+		const uint8_t trailing		= header & 0x0F;
+		if (significant + trailing > 4) {
+			ok = false;
+			return 0;
+		}
+		uint32_t x = 0;
+		for (auto i = 0; i < significant; i++) {
+			x |= (uint32_t)get_byte() << (8 * (trailing + i));
+		}
+		return x;
+	}
+
+	/// Read a value and store it in dst, copying strings
+	void get_value(const uint8_t type, JsonVariant dst)
+	{
+		switch (type) {
+			case (uint8_t)Record::Type::INT:
+				dst.set(get_int());
+				break;
+			case (uint8_t)Record::Type::FLOAT: {
+				const uint32_t bits = get_bits();
+				float f;
+				memcpy(&f, &bits, 4);
+				dst.set(f);
+				break;
+			}
+			case (uint8_t)Record::Type::BOOL:
+				dst.set(get_byte() != 0);
+				break;
+			case (uint8_t)Record::Type::STRING: {
+				char text[256];
+				uint8_t count;
+				const char* src = get_text(count);
+				if (src) memcpy(text, src, count);
+				text[count] = '\0';
+				dst.set((char*)text);
+				break;
+			}
+			default:
+				ok = false;
+		}
+	}
+
+	/// Read a delta against the value ref reads, and store the sum in dst
+	void get_delta(const uint8_t type, Input& ref, JsonVariant dst)
+	{
+		switch (type) {
+			case (uint8_t)Record::Type::INT:
+				dst.set( (int32_t)((uint32_t)ref.get_int() + (uint32_t)get_int()) );
+				break;
+			case (uint8_t)Record::Type::FLOAT: {
+				const uint32_t bits = ref.get_bits() ^ get_float_delta();
+				float f;
+				memcpy(&f, &bits, 4);
+				dst.set(f);
+				break;
+			}
+			case (uint8_t)Record::Type::BOOL:
+				ref.get_byte();
+				dst.set(get_byte() != 0);
+				break;
+			case (uint8_t)Record::Type::STRING: {
+				char text[256];
+				uint8_t ref_count, count;
+				const char* prefix	= ref.get_text(ref_count);
+				const uint8_t shared	= get_byte();
+				const char* suffix	= get_text(count);
+				if ( (shared > ref_count) || (shared + count > 255) ) {
+					ok = false;
+					return;
+				}
+				if (shared) memcpy(text, prefix, shared);
+				if (count) memcpy(text + shared, suffix, count);
+				text[shared + count] = '\0';
+				dst.set((char*)text);
+				break;
+			}
+			default:
+				ok = false;
+		}
+	}
+
+	void skip_value(const uint8_t type)
+	{
+		uint8_t count;
+		switch (type) {
+			case (uint8_t)Record::Type::INT:	get_int(); break;
+			case (uint8_t)Record::Type::FLOAT:	get_bytes(4); break;
+			case (uint8_t)Record::Type::BOOL:	get_byte(); break;
+			case (uint8_t)Record::Type::STRING:	get_text(count); break;
+			default:							ok = false;
+		}
+	}
+
+	void skip_delta(const uint8_t type)
+	{
+		uint8_t count;
+		switch (type) {
+			case (uint8_t)Record::Type::FLOAT:	get_float_delta(); break;
+			case (uint8_t)Record::Type::STRING:	get_byte(); get_text(count); break;
+			default:							skip_value(type);
+		}
+	}
+};
+
+///////////////////////////////////////////////////////////////////////////////
+/// Call visit(type) for each value (not id) column of a cached announcement
+template<typename F>
+void for_each_value(Input schema, F&& visit)
+{
+	const uint8_t columns = schema.get_byte();
+	for (auto i = 0; (i < columns) && schema.ok; i++) {
+		const uint8_t section	= schema.get_byte();
+		const uint8_t type		= schema.get_byte();
+		schema.get_string();
+		schema.get_string();
+		if (section != (uint8_t)Record::Section::ID) visit(type);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// Build packaged json from a cached announcement, the values of the id
+/// columns from it and the others by calling read_value(type, dst)
+template<typename F>
+bool to_json(Input schema, F&& read_value, JsonObject json)
+{
+	const uint8_t columns = schema.get_byte();
+
+	// Id values follow the column descriptions in the announcement
+	Input id_values = schema;
+	for (auto i = 0; i < columns; i++) {
+		id_values.get_byte();
+		id_values.get_byte();
+		id_values.get_string();
+		id_values.get_string();
+	}
+
+	json["type"] = "data";
+
+	JsonObject block;
+	uint8_t last_section = 0xFF;
+	const char* last_module = nullptr;
+	for (auto i = 0; i < columns; i++) {
+		const uint8_t section	= schema.get_byte();
+		const uint8_t type		= schema.get_byte();
+		const char* module		= schema.get_string();
+		const char* key			= schema.get_string();
+
+		// Start a new block when the section or module changes
+		if ( (section != last_section) || (last_module == nullptr) || (strcmp(module, last_module) != 0) ) {
+			switch (section) {
+				case (uint8_t)Record::Section::ID:
+				case (uint8_t)Record::Section::TIMESTAMP: {
+					const char* name = (section == (uint8_t)Record::Section::ID) ? "id" : "timestamp";
+					block = json[name];
+					if (block.isNull()) block = json.createNestedObject(name);
+					break;
+				}
+				case (uint8_t)Record::Section::CONTENTS: {
+					JsonArray contents = json["contents"];
+					if (contents.isNull()) contents = json.createNestedArray("contents");
+					JsonObject component = contents.createNestedObject();
+					component["module"] = (char*)module;
+					block = component.createNestedObject("data");
+					break;
+				}
+				default:
+					return false;
+			}
+			last_section	= section;
+			last_module		= module;
+		}
+
+		if (section == (uint8_t)Record::Section::ID) {
+			id_values.get_value(type, block.getOrAddMember((char*)key));
+		} else {
+			read_value(type, block.getOrAddMember((char*)key));
+		}
+	}
+	return schema.ok && id_values.ok;
+}
+
+} // namespace
+
+///////////////////////////////////////////////////////////////////////////////
+uint32_t WireSchema::schema_id(const Record& record)
+{
+	uint8_t id_values[64];
+	Output out(id_values, sizeof(id_values));
+	for (auto i = 0; i < record.size(); i++) {
+		if (record.column(i).section == Record::Section::ID) {
+			out.put_value(record.column(i).type, record.value(i));
+		}
+	}
+
+	// Continue the FNV-1a hash of the columns
+	uint32_t hash = record.schema_hash();
+	for (auto i = 0; i < out.len; i++) {
+		hash = (hash ^ id_values[i]) * 16777619UL;
+	}
+	return hash;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+uint16_t WireSchema::encode_announce(const Record& record, uint8_t* buffer, const uint16_t max_len)
+{
+	const uint32_t id = schema_id(record);
+	Output out(buffer, max_len);
+	out.put_byte(SCHEMA_ANNOUNCE_MARKER);
+	out.put(&id, 4);
+	out.put_byte(record.size());
+
+	for (auto i = 0; i < record.size(); i++) {
+		out.put_byte((uint8_t)record.column(i).section);
+		out.put_byte((uint8_t)record.column(i).type);
+		out.put(record.module(i), strlen(record.module(i)) + 1);
+		out.put(record.key(i), strlen(record.key(i)) + 1);
+	}
+	for (auto i = 0; i < record.size(); i++) {
+		if (record.column(i).section == Record::Section::ID) {
+			out.put_value(record.column(i).type, record.value(i));
+		}
+	}
+	return out.ok ? out.len : 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+uint16_t WireSchema::encode_data(const Record& record, uint8_t* buffer, const uint16_t max_len)
+{
+	const uint32_t id = schema_id(record);
+	Output out(buffer, max_len);
+	out.put_byte(SCHEMA_DATA_MARKER);
+	out.put(&id, 4);
+
+	for (auto i = 0; i < record.size(); i++) {
+		if (record.column(i).section != Record::Section::ID) {
+			out.put_value(record.column(i).type, record.value(i));
+		}
+	}
+	return out.ok ? out.len : 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+uint16_t WireSchema::encode_samples(const Record& record, uint8_t* buffer, const uint16_t max_len)
+{
+	const uint32_t id = schema_id(record);
+	Output out(buffer, max_len);
+	out.put_byte(SCHEMA_SAMPLES_MARKER);
+	out.put(&id, 4);
+	out.put_byte(1);
+
+	for (auto i = 0; i < record.size(); i++) {
+		if (record.column(i).section != Record::Section::ID) {
+			out.put_value(record.column(i).type, record.value(i));
+		}
+	}
+	return out.ok ? out.len : 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+uint16_t WireSchema::append_sample(const Record& record, uint8_t* packet, const uint16_t len, const uint16_t max_len)
+{
+	const uint32_t id = schema_id(record);
+	if ( (len < 6) || (packet[0] != SCHEMA_SAMPLES_MARKER) || (packet[5] == 255)
+			|| (memcmp(packet + 1, &id, 4) != 0) || (len >= max_len) ) {
+		return 0;
+	}
+
+	// Deltas against the first sample, read back from the packet
+	Input ref(packet + 6, len - 6);
+	Output out(packet + len, max_len - len);
+	for (auto i = 0; (i < record.size()) && out.ok; i++) {
+		const Record::Type type = record.column(i).type;
+		if (record.column(i).section == Record::Section::ID) continue;
+
+		const Record::Value& val = record.value(i);
+		switch (type) {
+			case Record::Type::INT:
+				out.put_int( (int32_t)((uint32_t)val.i - (uint32_t)ref.get_int()) );
+				break;
+			case Record::Type::FLOAT: {
+				uint32_t bits;
+				memcpy(&bits, &val.f, 4);
+				out.put_float_delta(bits ^ ref.get_bits());
+				break;
+			}
+			case Record::Type::BOOL:
+				ref.get_byte();
+				out.put_byte(val.b);
+				break;
+			case Record::Type::STRING: {
+				uint8_t ref_count;
+				const char* prefix = ref.get_text(ref_count);
+				const size_t str_len = strlen(val.s);
+				uint8_t shared = 0;
+				while ( (shared < ref_count) && (shared < str_len) && (prefix[shared] == val.s[shared]) ) shared++;
+				out.put_byte(shared);
+				out.put_text(val.s + shared, (str_len > 255) ? 255 - shared : str_len - shared);
+				break;
+			}
+		}
+	}
+	if (!out.ok || !ref.ok) return 0;
+
+	packet[5]++;
+	return len + out.len;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+uint8_t WireSchema::find(const uint32_t id) const
+{
+	for (auto i = 0; i < count; i++) {
+		if (entries[i].id == id) return i;
+	}
+	return count;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void WireSchema::remove(const uint8_t idx)
+{
+	// Entries are in pool order, later ones move down
+	const uint16_t offset	= entries[idx].offset;
+	const uint16_t freed	= entries[idx].len;
+	memmove(pool + offset, pool + offset + freed, used - offset - freed);
+	used -= freed;
+
+	for (auto i = idx + 1; i < count; i++) {
+		entries[i-1] = entries[i];
+		entries[i-1].offset -= freed;
+	}
+	count--;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool WireSchema::add(const uint8_t* announce, const uint16_t len)
+{
+	if ( (len < 6) || (announce[0] != SCHEMA_ANNOUNCE_MARKER) || (len - 5 > SCHEMA_CACHE_POOL) ) return false;
+
+	// Check the column descriptions before keeping them
+	Input in(announce + 5, len - 5);
+	const uint8_t columns = in.get_byte();
+	for (auto i = 0; (i < columns) && in.ok; i++) {
+		// to_json() only knows the sections of Record
+		if (in.get_byte() > (uint8_t)Record::Section::CONTENTS) return false;
+		in.get_byte();
+		in.get_string();
+		in.get_string();
+	}
+	if (!in.ok) return false;
+
+	uint32_t id;
+	memcpy(&id, announce + 1, 4);
+
+	// A repeated announcement is kept where it is, a different one with
+	// the same ID replaces it
+	const uint8_t existing = find(id);
+	if (existing < count) {
+		if ( (entries[existing].len == len - 5) && (memcmp(pool + entries[existing].offset, announce + 5, len - 5) == 0) ) {
+			return true;
+		}
+		remove(existing);
+	}
+
+	// Forget the oldest schemas to make room
+	while ( (count == SCHEMA_CACHE_SIZE) || (used + len - 5 > SCHEMA_CACHE_POOL) ) {
+		remove(0);
+	}
+
+	memcpy(pool + used, announce + 5, len - 5);
+	entries[count++] = { id, used, (uint16_t)(len - 5) };
+	used += len - 5;
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool WireSchema::decode(const uint8_t* data, const uint16_t len, JsonObject json) const
+{
+	if ( (len < 5) || (data[0] != SCHEMA_DATA_MARKER) ) return false;
+
+	uint32_t id;
+	memcpy(&id, data + 1, 4);
+	const uint8_t idx = find(id);
+	if (idx == count) return false;
+
+	Input values(data + 5, len - 5);
+	const bool ok = to_json(Input(pool + entries[idx].offset, entries[idx].len),
+		[&](const uint8_t type, JsonVariant dst){ values.get_value(type, dst); }, json);
+
+	// Values must fill the packet exactly
+	return ok && values.ok && (values.pos == values.len);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool WireSchema::decode_sample(const uint8_t* data, const uint16_t len, const uint8_t index, JsonObject json) const
+{
+	if ( (len < 6) || (data[0] != SCHEMA_SAMPLES_MARKER) || (index >= data[5]) ) return false;
+
+	uint32_t id;
+	memcpy(&id, data + 1, 4);
+	const uint8_t idx = find(id);
+	if (idx == count) return false;
+
+	const Input schema(pool + entries[idx].offset, entries[idx].len);
+	Input ref(data + 6, len - 6);
+	if (index == 0) {
+		return to_json(schema, [&](const uint8_t type, JsonVariant dst){ ref.get_value(type, dst); }, json) && ref.ok;
+	}
+
+	// Deltas follow the first sample, skip to the ones wanted
+	Input deltas = ref;
+	for_each_value(schema, [&](const uint8_t type){ deltas.skip_value(type); });
+	for (auto i = 1; (i < index) && deltas.ok; i++) {
+		for_each_value(schema, [&](const uint8_t type){ deltas.skip_delta(type); });
+	}
+	if (!deltas.ok) return false;
+
+	const bool ok = to_json(schema, [&](const uint8_t type, JsonVariant dst){ deltas.get_delta(type, ref, dst); }, json);
+	return ok && ref.ok && deltas.ok;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+#endif // ifdef LOOM_INCLUDE_RADIOS
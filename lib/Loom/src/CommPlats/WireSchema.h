@@ -0,0 +1,171 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+/// @file		WireSchema.h
+/// @brief		File for WireSchema definition.
+///				Compact radio encoding of records, by schema ID.
+/// @date		2020
+/// @copyright	GNU General Public License v3.0
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "../Record.h"
+
+namespace Loom {
+
+///////////////////////////////////////////////////////////////////////////////
+
+#define SCHEMA_DATA_MARKER		0xD4	///< First byte of compact data packets (MsgPack fixext, never a json)
+#define SCHEMA_ANNOUNCE_MARKER	0xD5	///< First byte of schema announcements (MsgPack fixext, never a json)
+#define SCHEMA_SAMPLES_MARKER	0xD6	///< First byte of packets of several samples (MsgPack fixext, never a json)
+#define SCHEMA_CACHE_SIZE		8		///< Most schemas a hub remembers
+#define SCHEMA_CACHE_POOL		2048	///< Bytes for the announcements a hub remembers, SCHEMA_CACHE_SIZE of a frame each
+#define SCHEMA_REANNOUNCE		32		///< Data packets sent between announcements (e.g. for a hub that restarted)
+
+
+///////////////////////////////////////////////////////////////////////////////
+///
+/// Compact wire encoding of packaged data.
+///
+/// A node and a hub agree on the layout of a record (the columns of
+/// Record, plus the node's id values) by its schema ID, so data packets
+/// only carry the ID and the values:
+///
+///		SCHEMA_DATA_MARKER, schema ID (uint32_t), values of the non id columns
+///
+/// The layout is sent once, and every SCHEMA_REANNOUNCE packets, as
+///
+///		SCHEMA_ANNOUNCE_MARKER, schema ID (uint32_t), column count (uint8_t),
+///		column descriptions, values of the id columns
+///
+/// Several samples of a record can share a packet, each later one encoded
+/// as a delta against the first:
+///
+///		SCHEMA_SAMPLES_MARKER, schema ID (uint32_t), sample count (uint8_t),
+///		values of the first sample, deltas of each later sample
+///
+/// Column descriptions are the same as in BinarySD files: uint8_t section,
+/// uint8_t type, module name and key as C-strings.
+/// Values are an INT as a zigzag varint, a FLOAT as 4 bytes, a BOOL as 1 byte
+/// and a STRING as its length (uint8_t) then its characters.
+/// Deltas are an INT's difference as a zigzag varint, a FLOAT's bits XOR
+/// those of the first sample (a byte holding the count of significant bytes
+/// and trailing zero bytes, then the significant bytes), a BOOL as 1 byte
+/// and a STRING as the length it shares with the first sample's (uint8_t),
+/// then the rest as a STRING value.
+/// All values are little-endian.
+///
+/// The static functions encode on a node. An instance is a hub's cache of
+/// announced schemas, which decodes data packets back into json.
+///
+///////////////////////////////////////////////////////////////////////////////
+class WireSchema
+{
+
+public:
+
+//=============================================================================
+///@name	ENCODING
+/*@{*/ //======================================================================
+
+	/// Get the schema ID of a record: its schema hash, extended with
+	/// the values of its id columns (device name and instance)
+	/// @param[in]	record	Record to identify
+	/// @return Schema ID
+	static uint32_t	schema_id(const Record& record);
+
+	/// Encode the announcement of a record's schema
+	/// @param[in]	record	Record to describe
+	/// @param[out]	buffer	Buffer to fill
+	/// @param[in]	max_len	Size of buffer
+	/// @return Length of the announcement, 0 if it does not fit
+	static uint16_t	encode_announce(const Record& record, uint8_t* buffer, const uint16_t max_len);
+
+	/// Encode the current values of a record
+	/// @param[in]	record	Record to encode
+	/// @param[out]	buffer	Buffer to fill
+	/// @param[in]	max_len	Size of buffer
+	/// @return Length of the packet, 0 if it does not fit
+	static uint16_t	encode_data(const Record& record, uint8_t* buffer, const uint16_t max_len);
+
+	/// Start a packet of samples with the current values of a record
+	/// @param[in]	record	Record to encode
+	/// @param[out]	buffer	Buffer to fill
+	/// @param[in]	max_len	Size of buffer
+	/// @return Length of the packet, 0 if it does not fit
+	static uint16_t	encode_samples(const Record& record, uint8_t* buffer, const uint16_t max_len);
+
+	/// Add the current values of a record to a packet of samples.
+	/// The record must have the schema the packet was started with
+	/// @param[in]		record	Record to encode
+	/// @param[in,out]	packet	Packet started by encode_samples()
+	/// @param[in]		len		Length of packet
+	/// @param[in]		max_len	Size of packet's buffer
+	/// @return New length of the packet, 0 if the sample does not fit (packet is unchanged)
+	static uint16_t	append_sample(const Record& record, uint8_t* packet, const uint16_t len, const uint16_t max_len);
+
+	/// Get the number of samples in a packet
+	/// @param[in]	packet	Packet, starting with SCHEMA_SAMPLES_MARKER
+	/// @return Sample count
+	static uint8_t	sample_count(const uint8_t* packet) { return packet[5]; }
+
+//=============================================================================
+///@name	DECODING
+/*@{*/ //======================================================================
+
+	WireSchema() : count(0), used(0) {}
+
+	/// Remember an announced schema, forgetting the oldest ones if needed
+	/// @param[in]	announce	Announcement, starting with SCHEMA_ANNOUNCE_MARKER
+	/// @param[in]	len			Length of announcement
+	/// @return False if the announcement is malformed or larger than the cache
+	bool		add(const uint8_t* announce, const uint16_t len);
+
+	/// Decode a data packet into packaged json
+	/// @param[in]	data	Packet, starting with SCHEMA_DATA_MARKER
+	/// @param[in]	len		Length of data
+	/// @param[out]	json	Object to add data to (keys and strings are copied)
+	/// @return False if the schema is unknown or the packet does not match it
+	bool		decode(const uint8_t* data, const uint16_t len, JsonObject json) const;
+
+	/// Decode one sample of a packet of samples into packaged json
+	/// @param[in]	data	Packet, starting with SCHEMA_SAMPLES_MARKER
+	/// @param[in]	len		Length of data
+	/// @param[in]	index	Sample to decode, 0 for the first
+	/// @param[out]	json	Object to add data to (keys and strings are copied)
+	/// @return False if the schema is unknown or the packet does not match it
+	bool		decode_sample(const uint8_t* data, const uint16_t len, const uint8_t index, JsonObject json) const;
+
+	/// Whether a schema has been announced
+	/// @param[in]	id		Schema ID
+	/// @return True if id is cached
+	bool		has(const uint32_t id) const { return find(id) < count; }
+
+private:
+
+	/// Location of a cached announcement in the pool
+	struct Entry {
+		uint32_t	id;			///< Schema ID
+		uint16_t	offset;		///< Start of the column count in pool
+		uint16_t	len;		///< Bytes from the column count to the end
+	};
+
+	Entry		entries[SCHEMA_CACHE_SIZE];		///< Cached schemas, oldest first
+	uint8_t		count;							///< Number of entries in use
+	uint8_t		pool[SCHEMA_CACHE_POOL];		///< Announcements, without marker and ID
+	uint16_t	used;							///< Bytes of pool in use
+
+	/// Get the index of a schema
+	/// @return Index, count if not cached
+	uint8_t		find(const uint32_t id) const;
+
+	/// Forget a schema
+	/// @param[in]	idx		Index of the schema
+	void		remove(const uint8_t idx);
+
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+}; // namespace Loom
@@ -163,15 +163,44 @@ bool nRF::receive_blocking_impl(JsonObject json, uint max_wait_time)
 ///////////////////////////////////////////////////////////////////////////////
 bool nRF::send_impl(JsonObject json, const uint8_t destination)
 {
-	char buffer[max_message_len];
   LMark;
-	bool to_msgpack = json_to_msgpack_buffer(json, buffer, max_message_len);
-	if (!to_msgpack) return false;
+	const uint16_t len = json_to_msgpack_buffer(json, send_buffer, max_message_len);
+	if (len == 0 || len > max_message_len) return false;
 
+	return send_raw(send_buffer, len, destination);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool nRF::send_frame(const uint8_t* bytes, const uint8_t len, const uint8_t destination)
+{
 	RF24NetworkHeader header(destination);
-  LMark;
-	bool is_sent = network->write( header, buffer, measureMsgPack(json) );
-	// bool is_sent = network->write( header, buffer, 120 );
+	return network->write( header, bytes, len );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+uint8_t nRF::receive_frame(uint8_t* bytes, const uint8_t max_len, const uint max_wait_time)
+{
+	const unsigned long start_time = millis();
+	do {
+		network->update();
+		if ( network->available() ) {
+			RF24NetworkHeader header;
+			const uint8_t len = network->read(header, bytes, max_len);
+			last_source = header.from_node;
+			return len;
+		}
+	} while ( (millis() - start_time) < max_wait_time );
+	return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool nRF::send_raw(uint8_t* bytes, const uint8_t len, const uint8_t destination)
+{
+	if (len > max_message_len) return false;
+
+	RF24NetworkHeader header(destination);
+	LMark;
+	bool is_sent = network->write( header, bytes, len );
 
 	print_module_label();
 	LPrintln("Send " , (is_sent) ? "successful" : "failed" );
@@ -181,10 +210,9 @@ bool nRF::send_impl(JsonObject json, const uint8_t destination)
 ///////////////////////////////////////////////////////////////////////////////
 void nRF::broadcast_impl(JsonObject json)
 {
-	char buffer[max_message_len];
   LMark;
-	bool to_msgpack = json_to_msgpack_buffer(json, buffer, max_message_len);
-	if (!to_msgpack) {
+	const uint16_t len = json_to_msgpack_buffer(json, send_buffer, max_message_len);
+	if (len == 0 || len > max_message_len) {
 		print_module_label();
 		LPrintln("Failed to convert to msgpack");
 		return;
@@ -192,7 +220,7 @@ void nRF::broadcast_impl(JsonObject json)
 
 	RF24NetworkHeader header(00);
   LMark;
-	network->multicast( header, buffer, measureMsgPack(json), multicast_level );
+	network->multicast( header, send_buffer, len, multicast_level );
 
 	print_module_label();
 	LPrintln("Broadcasted");
@@ -36,6 +36,7 @@ namespace Loom {
 ///////////////////////////////////////////////////////////////////////////////
 class nRF : public CommPlat
 {
+	LOOM_MODULE_TYPE(nRF, CommPlat)
 
 protected:
 
@@ -73,8 +74,31 @@ protected:
 	/// @param[in]	json	Json object to send
 	void broadcast_impl(JsonObject json) override;
 
+	bool supports_frames() const override { return true; }
+
+	/// Send a fragment frame
+	/// @param[in]	bytes			Bytes to send
+	/// @param[in]	len				Number of bytes to send
+	/// @param[in]	destination		Device to send to
+	/// @return True if the frame was sent
+	bool send_frame(const uint8_t* bytes, const uint8_t len, const uint8_t destination) override;
+
+	/// Receive a frame
+	/// @param[out]	bytes			Buffer to fill
+	/// @param[in]	max_len			Size of bytes
+	/// @param[in]	max_wait_time	Maximum number of milliseconds to block for
+	/// @return Length of the frame, 0 if none arrived
+	uint8_t receive_frame(uint8_t* bytes, const uint8_t max_len, const uint max_wait_time) override;
+
 public:
 
+	/// Send bytes that are already MsgPack without parsing them
+	/// @param[in]	bytes			Bytes to send
+	/// @param[in]	len				Number of bytes to send
+	/// @param[in]	destination		Address of device to send to
+	/// @return True if packet sent successfully
+	bool send_raw(uint8_t* bytes, const uint8_t len, const uint8_t destination) override;
+
 //=============================================================================
 ///@name	CONSTRUCTORS / DESTRUCTOR
 /*@{*/ //======================================================================
@@ -24,6 +24,8 @@ namespace Loom {
 class WarmUp;
 
 class WarmUpManager : public Module {
+  LOOM_MODULE_TYPE(WarmUpManager, Module)
+
   public:
     ///Constructor
     WarmUpManager();
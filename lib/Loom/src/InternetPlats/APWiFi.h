@@ -33,6 +33,7 @@ namespace Loom {
 ///////////////////////////////////////////////////////////////////////////////
 class APWiFi : public InternetPlat
 {
+	LOOM_MODULE_TYPE(APWiFi, InternetPlat)
 
 protected:
 
@@ -24,7 +24,7 @@ Ethernet::Ethernet(
 	)
 	: InternetPlat("Ethernet")
 	, m_base_client()
-	, m_client(m_base_client, TAs, (size_t)TAs_NUM, A7, 1, SSLClient::SSL_ERROR)
+	, m_client(m_base_client, TAs, (size_t)TAs_NUM, A7, SSL_SESSIONS, SSLClient::SSL_ERROR)
 	, m_mac{}
 	, m_ip()
 	, m_is_connected(false)
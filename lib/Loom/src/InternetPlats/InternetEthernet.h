@@ -34,6 +34,7 @@ namespace Loom {
 ///////////////////////////////////////////////////////////////////////////////
 class Ethernet : public InternetPlat
 {
+	LOOM_MODULE_TYPE(Ethernet, InternetPlat)
 
 protected:
 
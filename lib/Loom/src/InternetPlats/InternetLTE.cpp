@@ -34,7 +34,7 @@ LTE::LTE(
   , gprsPass(pass)
   , powerPin(analog_pin)
   , m_base_client(modem)
-  , m_client(m_base_client, TAs, (size_t)TAs_NUM, A7, 1, SSLClient::SSL_INFO)
+  , m_client(m_base_client, TAs, (size_t)TAs_NUM, A7, SSL_SESSIONS, SSLClient::SSL_INFO)
 {
 
   //sets baud rate for SARA-R4 and restarts module
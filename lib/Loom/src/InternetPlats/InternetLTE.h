@@ -38,6 +38,7 @@ namespace Loom {
 
 class LTE: public InternetPlat
 {
+  LOOM_MODULE_TYPE(LTE, InternetPlat)
 
   protected:
 
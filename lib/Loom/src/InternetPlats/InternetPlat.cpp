@@ -18,7 +18,23 @@ using namespace Loom;
 InternetPlat::InternetPlat(
 		const char* module_name
 	)
-	: Module(module_name) {}
+	: Module(module_name)
+	, pool_domain{}
+	, pool_idle_since(0)
+	, pool_hits(0)
+	, pool_misses(0)
+	, sessions_resumed(0)
+	, last_reused(false)
+{}
+
+///////////////////////////////////////////////////////////////////////////////
+void InternetPlat::print_state() const
+{
+	Module::print_state();
+	LPrintln("\tConnections Reused  : ", pool_hits );
+	LPrintln("\tConnections Opened  : ", pool_misses );
+	LPrintln("\tSessions Resumed    : ", sessions_resumed );
+}
 
 ///////////////////////////////////////////////////////////////////////////////
 InternetPlat::ClientSession InternetPlat::http_request(const char* domain, const char* url, const char* body, const char* verb)
@@ -46,6 +62,7 @@ void InternetPlat::write_http_request(Stream& client, const char* domain, const
 	client.print(" ");
 	client.print("HTTP/1.1\r\nUser-Agent: LoomOverSSLClient\r\nHost: ");
 	client.print(domain);
+	// callers read the response themselves, so the connection is not kept for another request
 	client.print("\r\nConnection: close\r\n");
 	// add the optional body
 	if(body != nullptr) client.print(body);
@@ -68,11 +85,23 @@ InternetPlat::ClientSession InternetPlat::connect_to_domain(const char* domain)
 	// I guess we are connected! lets go
 	SSLClient& client = get_client();
   LMark;
+	// reuse the connection if it is still open to this domain, and nothing is left unread on it
+	last_reused = client.connected() && !client.available()
+		&& strncmp(pool_domain, domain, sizeof(pool_domain)) == 0
+		&& millis() - pool_idle_since < HTTP_IDLE_TIMEOUT;
+	if (last_reused) {
+		pool_hits++;
+		return InternetPlat::ClientSession(&client);
+	}
+	pool_misses++;
+	pool_domain[0] = '\0';
 	// if the socket is somehow still open, close it
 	if (client.connected()) client.stop();
 	// and clear a write error if there is any
 	if (client.getWriteError()) client.clearWriteError();
   LMark;
+	// the client resumes the cached session of the domain, if it has one
+	const bool resuming = client.getSession(domain) != nullptr;
 	// * the rainbow connection *
 	int status = client.connect(domain, 443);
 	if (!status) {
@@ -93,10 +122,121 @@ InternetPlat::ClientSession InternetPlat::connect_to_domain(const char* domain)
 		}
 		return ClientSession();
 	}
+	if (resuming) sessions_resumed++;
+	strncpy(pool_domain, domain, sizeof(pool_domain) - 1);
+	pool_domain[sizeof(pool_domain) - 1] = '\0';
 	// return a pointer to the client for data reception
 	return InternetPlat::ClientSession(&client);
 }
 
+///////////////////////////////////////////////////////////////////////////////
+/// Read a line of an http response, without its line ending
+/// @return False if the line did not arrive before deadline
+static bool read_http_line(Client& client, char* line, const size_t size, const unsigned long deadline)
+{
+	size_t len = 0;
+	while ((long)(deadline - millis()) > 0) {
+		const int c = client.read();
+		if (c < 0) {
+			if (!client.connected()) return false;
+			delay(1);
+			continue;
+		}
+		if (c == '\n') {
+			if (len > 0 && line[len - 1] == '\r') len--;
+			line[len] = '\0';
+			return true;
+		}
+		if (len < size - 1) line[len++] = c;
+	}
+	return false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// Read and discard bytes of an http response
+/// @return False if they did not arrive before deadline
+static bool skip_http_bytes(Client& client, uint32_t len, const unsigned long deadline)
+{
+	uint8_t buf[64];
+	while (len > 0) {
+		if ((long)(deadline - millis()) <= 0) return false;
+		const int got = client.read(buf, (len < sizeof(buf)) ? len : sizeof(buf));
+		if (got > 0) {
+			len -= got;
+		} else if (!client.connected()) {
+			return false;
+		} else {
+			delay(1);
+		}
+	}
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int InternetPlat::read_http_response(ClientSession& session, const uint32_t timeout)
+{
+  LMark;
+	if (!session) return 0;
+	Client& client = *session;
+	const unsigned long deadline = millis() + timeout;
+	char line[HTTP_LINE_LEN];
+
+	int status = 0;
+	bool close = false;
+	bool chunked = false;
+	long length = -1;
+	// skip interim (1xx) responses
+	while (status < 200) {
+		if (!read_http_line(client, line, sizeof(line), deadline)) return 0;
+		if (strncmp(line, "HTTP/1.", 7) != 0) return 0;
+		// HTTP/1.0 servers close the connection unless asked otherwise
+		close = (line[7] == '0');
+		status = atoi(line + 9);
+		// headers, up to the empty line before the body
+		while (true) {
+			if (!read_http_line(client, line, sizeof(line), deadline)) return 0;
+			if (line[0] == '\0') break;
+			const char* value = strchr(line, ':');
+			if (value == nullptr) continue;
+			value++;
+			while (*value == ' ') value++;
+			if (strncasecmp(line, "Content-Length:", 15) == 0) {
+				length = strtol(value, nullptr, 10);
+			} else if (strncasecmp(line, "Transfer-Encoding:", 18) == 0) {
+				chunked = strstr(value, "chunked") != nullptr;
+			} else if (strncasecmp(line, "Connection:", 11) == 0) {
+				close = strncasecmp(value, "close", 5) == 0;
+			}
+		}
+	}
+  LMark;
+	// the body, unless the response has none
+	if (status == 204 || status == 304) {
+		length = 0;
+	} else if (chunked) {
+		while (true) {
+			if (!read_http_line(client, line, sizeof(line), deadline)) return status;
+			const uint32_t size = strtoul(line, nullptr, 16);
+			if (size == 0) break;
+			// the chunk, then its line ending
+			if (!skip_http_bytes(client, size + 2, deadline)) return status;
+		}
+		// trailers, up to the empty line
+		do {
+			if (!read_http_line(client, line, sizeof(line), deadline)) return status;
+		} while (line[0] != '\0');
+	} else if (length < 0 || !skip_http_bytes(client, length, deadline)) {
+		// a body without a length ends when the server closes the connection
+		return status;
+	}
+	// the whole response was read, so the connection can carry the next request
+	if (!close && client.connected()) {
+		session.get_deleter().keep_alive = true;
+		pool_idle_since = millis();
+	}
+	return status;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 InternetPlat::ClientSession InternetPlat::connect_to_ip(const IPAddress& ip, const uint16_t port) {
 	pinMode(8, OUTPUT);
@@ -115,6 +255,7 @@ InternetPlat::ClientSession InternetPlat::connect_to_ip(const IPAddress& ip, con
   LMark;
 	// if the socket is somehow still open, close it
 	if (client.connected()) client.stop();
+	pool_domain[0] = '\0';
 	// and clear a write error if there is any
 	if (client.getWriteError()) client.clearWriteError();
 	// * the rainbow connection *
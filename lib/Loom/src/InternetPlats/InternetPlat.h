@@ -22,12 +22,27 @@
 
 namespace Loom {
 
+///////////////////////////////////////////////////////////////////////////////
+
+#define HTTP_IDLE_TIMEOUT		20000	///< Longest a kept-alive connection is reused after its last response, before servers close it
+#define HTTP_RESPONSE_TIMEOUT	10000	///< Milliseconds read_http_response() waits for a response
+#define HTTP_LINE_LEN			96		///< Longest response line read, longer lines are cut
+#define SSL_SESSIONS			2		///< TLS sessions the SSLClient keeps for resumption, one per domain
+
+
 ///////////////////////////////////////////////////////////////////////////////
 ///
 /// Abstract internet communication module.
 ///
 /// All internet modules inherit from this class.
 ///
+/// A TLS handshake takes seconds of math on a SAMD21, so connections are
+/// kept alive between requests: a request to the domain the client is
+/// still connected to reuses the connection, once read_http_response() has
+/// read the response to the last request to its end. A connection the
+/// server closed is opened again resuming the TLS session of its domain,
+/// which skips the key exchange.
+///
 /// @par Resources
 /// - [Module Documentation](https://openslab-osu.github.io/Loom/html/class_loom_internet_plat.html)
 ///	- [Hardware Support](https://github.com/OPEnSLab-OSU/Loom/wiki/Hardware-Support#internet-capabilities)
@@ -35,6 +50,7 @@ namespace Loom {
 ///////////////////////////////////////////////////////////////////////////////
 class InternetPlat : public Module
 {
+	LOOM_MODULE_TYPE(InternetPlat, Module)
 
 protected:
 
@@ -46,6 +62,14 @@ protected:
 	virtual SSLClient& get_client() = 0;
 	virtual const SSLClient& get_client() const = 0;
 
+	char			pool_domain[48];	///< Domain the client is connected to, empty if none
+	unsigned long	pool_idle_since;	///< millis() when the last response over the connection was read
+
+	uint16_t		pool_hits;			///< Connections to a domain that reused the open connection
+	uint16_t		pool_misses;		///< Connections to a domain that needed a new connection
+	uint16_t		sessions_resumed;	///< New connections that resumed a cached TLS session
+	bool			last_reused;		///< Whether the last connection to a domain was reused
+
 public:
 
 //=============================================================================
@@ -65,11 +89,13 @@ public:
 	/// Cleaner name for UDP smart pointer
 	using UDPPtr = std::unique_ptr<UDP, UDPDeletor>;
 
-	/// Simply close the socket when the client dissapears, we don't want to delete the
+	/// Simply close the socket when the client dissapears, unless its response was read
+	/// for the connection to carry the next request. We don't want to delete the
 	/// object because the client needs to cache sessions
 	struct ClientCleanup {
+		bool keep_alive = false;	///< Set by read_http_response() when the connection can be reused
 		void operator() (Client* c) {
-			if (c != nullptr)
+			if (c != nullptr && !keep_alive)
 				c->stop();
 		}
 	};
@@ -125,11 +151,26 @@ public:
 							{ return http_request(domain, url, body, "POST"); }
 
 	/// Connect to a domain, but don't write any HTTP stuff, Let the module figure that out.
+	/// Reuses the open connection if it is to the same domain and was kept alive
+	/// by read_http_response().
 	/// @attention	Remember to close the socket!
 	/// @param[in]	domain	The domain to connect to "www.google.com"
 	/// @returns A client reference. The client::connected method will return true if the connection succeeded, and false otherwise.
 	virtual ClientSession	connect_to_domain(const char* domain);
 
+	/// Read the response to a request written to a session, up to the end of its body.
+	/// If the server keeps the connection open, the session is marked to keep it alive
+	/// when destroyed, for the next connect_to_domain() to the same domain.
+	/// @param[in]	session	Session the request was written to
+	/// @param[in]	timeout	Milliseconds to wait for the whole response
+	/// @returns The HTTP status code, or 0 if no complete response arrived
+	int						read_http_response(ClientSession& session, const uint32_t timeout = HTTP_RESPONSE_TIMEOUT);
+
+	/// Whether the last connect_to_domain() reused an open connection.
+	/// A request that fails on a reused connection may only have found it closed by the server.
+	/// @returns True if reused
+	bool					get_reused() const { return last_reused; }
+
 	/// Connect to a domain, but don't write any HTTP stuff, Let the module figure that out.
 	/// @attention	Remember to close the socket!
 	/// @param[in]	ip		The IPAddress to connect to
@@ -151,6 +192,12 @@ public:
 	/// @returns a unix timestamp if success, or 0 if failure.
 	uint32_t				get_time();
 
+//=============================================================================
+///@name	PRINT INFORMATION
+/*@{*/ //======================================================================
+
+	virtual void	print_state() const override;
+
 
 private:
 
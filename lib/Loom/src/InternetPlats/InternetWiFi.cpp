@@ -25,7 +25,7 @@ WiFi::WiFi(
 	, SSID(ssid)
 	, pass(pass)
 	, m_base_client()
-	, m_client(m_base_client, TAs, (size_t)TAs_NUM, A7, 1, SSLClient::SSL_INFO)
+	, m_client(m_base_client, TAs, (size_t)TAs_NUM, A7, SSL_SESSIONS, SSLClient::SSL_INFO)
 {
   LMark;
 	// Configure pins for Adafruit ATWINC1500 Feather
@@ -34,6 +34,7 @@ namespace Loom {
 ///////////////////////////////////////////////////////////////////////////////
 class WiFi : public InternetPlat
 {
+	LOOM_MODULE_TYPE(WiFi, InternetPlat)
 
 protected:
 
@@ -383,6 +383,7 @@ bool InterruptManager::RTC_alarm_at(DateTime future_time)
 	// Tell RTC_Inst to set RTC time at future_time
 	// Then call sleep_until_interrupt on pin, because that is what it is
 	RTC_Inst->set_alarm(future_time);
+	return true;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
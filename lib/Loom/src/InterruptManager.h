@@ -51,6 +51,7 @@ enum class ISR_Type {
 ///////////////////////////////////////////////////////////////////////////////
 class InterruptManager : public Module
 {
+	LOOM_MODULE_TYPE(InterruptManager, Module)
 
 private:
 
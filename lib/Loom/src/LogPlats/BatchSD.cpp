@@ -27,6 +27,8 @@ BatchSD::BatchSD(
     : LogPlat("BatchSD", enable_rate_filter, min_filter_delay )
     , chip_select(chip_select)
     , doc(2048)
+    , next_index(0)
+    , next_offset(0)
 {
   digitalWrite(8, HIGH); // if using LoRa, need to temporarily prevent it from using SPI
   LMark;
@@ -39,6 +41,10 @@ BatchSD::BatchSD(
     LMark;
     // Setup Directory for Batch Files
     sd.mkdir("Batches");
+    if (open_files() && packet_counter > 0) {
+      print_module_label();
+      LPrintln("Resuming batch of ", packet_counter, " packets");
+    }
   }
 
   print_module_label();
@@ -62,30 +68,18 @@ void BatchSD::print_config() const
 
 ///////////////////////////////////////////////////////////////////////////////
 bool BatchSD::dump_batch(int index){
-  char file_name[30];
-  create_file_name(index, file_name);
-  //digitalWrite(8, HIGH); // if using LoRa, need to temporarily prevent it from using SPI
-
-  //sd.begin(chip_select); // It seems that SD card may become 'unsetup' sometimes, so re-setup
-
-
-  File file = sd.open(file_name, O_READ);
+  JsonObject json = get_batch_json(index);
   LMark;
 
-  if (file) {
+  if (!json.isNull()) {
     print_module_label();
-    LPrintln("Contents of file: ", file_name);
-
-    // read from the file until there's nothing else in it:
-    while (file.available())
-      Serial.write(file.read());
+    LPrintln("Contents of packet: ", index);
+    serializeJson(json, Serial);
     LPrintln();
-    file.close();
     return true;
   } else {
-    // if the file didn't open, print an error:
     print_module_label();
-    LPrintln("Error opening ", file_name);
+    LPrintln("Error reading packet ", index);
     return false;
   }
 }
@@ -95,19 +89,20 @@ void BatchSD::clear_batch_log(){
   print_module_label();
   LPrintln("Clearing batch log");
   LMark;
-  char file_name[30];
   digitalWrite(8, HIGH); // if using LoRa, need to temporarily prevent it from using SPI
-  //sd.begin(chip_select);
 
-  // For all the packets stored in the batch, create the file name and remove from SD
-  for(int i=0; i<packet_counter;i++){
-    create_file_name(i, file_name);
-    LMark;
-    sd.remove(file_name);
+  // Truncating both files discards the whole batch
+  if (open_files()) {
+    data_file.truncate(0);
+    index_file.truncate(0);
+    data_file.sync();
+    index_file.sync();
   }
 
   // Reset packet counter and increment to next batch
   packet_counter = 0;
+  next_index = 0;
+  next_offset = 0;
   drop_count = 0;
   batch_counter++;
 }
@@ -122,40 +117,47 @@ bool BatchSD::store_batch(){
 
 ///////////////////////////////////////////////////////////////////////////////
 bool BatchSD::store_batch_json(JsonObject json){
-  // Create file name and add which Batch the packet is from to json
-  char file_name[30];
   LMark;
-  create_file_name(packet_counter, file_name);
   digitalWrite(8, HIGH); // if using LoRa, need to temporarily prevent it from using SPI
-  //sd.begin(chip_select);
 
-  // Write json to batch file
-  File file;
-  if( (!file.open(file_name, O_WRONLY | O_CREAT)) ){
+  const size_t len = measureMsgPack(json);
+  if (len > BATCHSD_MAX_PACKET) {
     print_module_label();
-    LPrintln("Error opening: ", file_name);
+    LPrintln("Packet too large: ", len);
     return false;
   }
-  else {
+  if (!open_files()) {
     print_module_label();
-    LPrintln("Writing to: ", file_name);
+    LPrintln("Error opening batch files");
+    return false;
   }
 
-  serializeJson(json, file);
+  // Length prefix and packet written with one write
+  // (serializeMsgPack() also null terminates)
+  uint8_t buffer[len + 3];
+  buffer[0] = len & 0xFF;
+  buffer[1] = len >> 8;
+  serializeMsgPack(json, (char*)buffer + 2, len + 1);
+
+  const uint32_t offset = data_file.fileSize();
+  data_file.seekSet(offset);
+  data_file.write(buffer, len + 2);
+
+  // Packet counts once its offset is in the index, so the data is synced first
+  if (!data_file.sync() || data_file.getWriteError()) {
+    print_module_label();
+    LPrintln("Write Error");
+    return false;
+  }
 
-  if (!file.sync()) {
-		file.close();
-		print_module_label();
-		LPrintln("Sync Error");
-		return false;
-	}
-  else if(file.getWriteError()){
-    file.close();
+  index_file.seekSet((uint32_t)packet_counter * sizeof(offset));
+  index_file.write((const uint8_t*)&offset, sizeof(offset));
+  if (!index_file.sync() || index_file.getWriteError()) {
     print_module_label();
     LPrintln("Write Error");
     return false;
   }
-  file.close();
+
   packet_counter++;
   print_module_label();
   LPrintln("Done writing to Batch");
@@ -166,60 +168,138 @@ bool BatchSD::store_batch_json(JsonObject json){
 JsonObject BatchSD::get_batch_json(int index){
   doc.clear();
 
-  char file_name[30];
-  create_file_name(index, file_name);
-
   digitalWrite(8, HIGH); // if using LoRa, need to temporarily prevent it from using SPI
-  //sd.begin(chip_select);
 
-  if(index <= packet_counter || index < 0){
+  uint16_t len;
+  if (!seek_packet(index, len)) return JsonObject();
+
+  uint8_t buffer[len];
+  if (data_file.read(buffer, len) != len) {
     print_module_label();
-    LPrintln("Retrieving Packet in file ", file_name);
-    LMark;
-    File file = sd.open(file_name, O_READ);
-    if(!file) {
-      print_module_label();
-      LPrintln("Failed to open '", file_name, "'");
-    }
+    LPrintln("Failed to read packet ", index);
+    return JsonObject();
+  }
 
-    DeserializationError error = deserializeJson(doc, file);
-    if(error) {
-      print_module_label();
-      LPrintln("deserializeJson() failed: ", error.c_str());
-    }
+  LMark;
+  DeserializationError error = deserializeMsgPack(doc, (const char*)buffer, len);
+  if (error) {
+    print_module_label();
+    LPrintln("deserializeMsgPack() failed: ", error.c_str());
+    return JsonObject();
+  }
+  return doc.as<JsonObject>();
+}
 
-    else {
-      LMark;
-      return doc.as<JsonObject>();
-    }
+///////////////////////////////////////////////////////////////////////////////
+int BatchSD::get_batch_raw(int index, uint8_t* buffer, const uint16_t max_len){
+  digitalWrite(8, HIGH); // if using LoRa, need to temporarily prevent it from using SPI
+
+  uint16_t len;
+  if (!seek_packet(index, len)) return -1;
+
+  // Caller can't take the packet, let it decide what to do
+  if (len > max_len) return len;
+
+  if (data_file.read(buffer, len) != len) {
+    print_module_label();
+    LPrintln("Failed to read packet ", index);
+    return -1;
   }
-  else {
+  return len;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool BatchSD::seek_packet(int index, uint16_t& len){
+  if (index < 0 || index >= packet_counter) {
     print_module_label();
     LPrintln("Get Batch Error: Index is out of range");
+    return false;
   }
+
+  uint32_t offset;
+  uint8_t prefix[2];
+  if (!open_files() || !packet_offset(index, offset) || !data_file.seekSet(offset)
+      || data_file.read(prefix, 2) != 2) {
+    print_module_label();
+    LPrintln("Failed to read packet ", index);
+    return false;
+  }
+
+  len = prefix[0] | (prefix[1] << 8);
+  if (len > BATCHSD_MAX_PACKET) {
+    print_module_label();
+    LPrintln("Invalid packet ", index);
+    return false;
+  }
+
+  // Next packet follows this one
+  next_index = index + 1;
+  next_offset = offset + 2 + len;
+  return true;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
-void BatchSD::power_up() {
-  digitalWrite(8, HIGH);
+bool BatchSD::packet_offset(int index, uint32_t& offset){
+  // Reading in order doesn't need the index
+  if (index == next_index) {
+    offset = next_offset;
+    return true;
+  }
+
+  return index_file.seekSet((uint32_t)index * sizeof(offset))
+      && index_file.read(&offset, sizeof(offset)) == sizeof(offset);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool BatchSD::open_files(){
+  if (data_file.isOpen() && index_file.isOpen()) return true;
   LMark;
-  sd.begin(chip_select, SD_SCK_MHZ(50));
+
+  close_files();
+  if (!data_file.open(BATCHSD_DATA_FILE, O_RDWR | O_CREAT)
+      || !index_file.open(BATCHSD_INDEX_FILE, O_RDWR | O_CREAT)) {
+    close_files();
+    return false;
+  }
+
+  // Resume a batch already on the card, ignoring an offset written without its packet
+  packet_counter = index_file.fileSize() / sizeof(uint32_t);
+  uint32_t last;
+  while (packet_counter > 0
+      && (!index_file.seekSet((uint32_t)(packet_counter - 1) * sizeof(last))
+          || index_file.read(&last, sizeof(last)) != sizeof(last)
+          || last + 2 > data_file.fileSize())) {
+    packet_counter--;
+  }
+  index_file.truncate((uint32_t)packet_counter * sizeof(last));
+  next_index = 0;
+  next_offset = 0;
+  return true;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
-void BatchSD::power_down(){
-  //do nothing
+void BatchSD::close_files(){
+  if (data_file.isOpen()) {
+    data_file.sync();
+    data_file.close();
+  }
+  if (index_file.isOpen()) {
+    index_file.sync();
+    index_file.close();
+  }
 }
 
 ///////////////////////////////////////////////////////////////////////////////
-void BatchSD::create_file_name(int index, char* name){
+void BatchSD::power_up() {
+  digitalWrite(8, HIGH);
   LMark;
-  String file = "Batches/Batch-";
-  file = file + batch_counter;
-  file = file + "-";
-  file = file + index;
-  file = file + ".json";
-  file.toCharArray(name, file.length()+1);
+  sd.begin(chip_select, SD_SCK_MHZ(50));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void BatchSD::power_down(){
+  // Files are reopened on next use
+  close_files();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -236,3 +316,9 @@ void BatchSD::package(JsonObject json) {
 
   data["Number"] = batch_counter+1;
 }
+
+///////////////////////////////////////////////////////////////////////////////
+bool BatchSD::package_record(Record::Writer& record) {
+  record.add(batch_counter+1);
+  return true;
+}
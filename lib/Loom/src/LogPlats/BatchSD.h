@@ -16,10 +16,27 @@
 
 namespace Loom {
 
+///////////////////////////////////////////////////////////////////////////////
+
+#define BATCHSD_DATA_FILE		"Batches/Batch.dat"	///< Packets of the batch
+#define BATCHSD_INDEX_FILE		"Batches/Batch.idx"	///< Offset of each packet in the data file
+#define BATCHSD_MAX_PACKET		2048				///< Largest stored packet, in MsgPack bytes
+
+
 ///////////////////////////////////////////////////////////////////////////////
 ///
 /// Batch SD logging platform module.
 ///
+/// Packets are appended to a single data file as a little-endian uint16_t
+/// length followed by the packet serialized as MsgPack, the format radios
+/// send, so batches are replayed without re-serializing (get_batch_raw(),
+/// CommPlat::send_batch()). A second file holds
+/// the uint32_t offset of each packet, so get_batch_json() is a seek instead
+/// of opening a file per packet, and clearing the batch truncates both files
+/// instead of removing a file per packet.
+/// Both files stay open between calls until power_down().
+/// A batch left on the card (e.g. after a reset) is resumed.
+///
 /// @par Resources
 /// - [Module Documentation](https://openslab-osu.github.io/Loom/html/class_loom___s_d.html)
 /// - [Product Page: Adafruit Adalogger Featherwing](https://www.adafruit.com/product/2922)
@@ -31,6 +48,8 @@ namespace Loom {
 
 class BatchSD : public LogPlat
 {
+  LOOM_MODULE_TYPE(BatchSD, LogPlat)
+
 protected:
   SdFat sd;               ///< File System Object
   const byte chip_select; ///< Chip select pin
@@ -38,6 +57,11 @@ protected:
   int packet_counter;     ///< Current packet count value in a batch
   int drop_count;         ///< Current count of packets that failed to be sent
   DynamicJsonDocument doc;
+
+  File data_file;         ///< Packets, length prefixed MsgPack
+  File index_file;        ///< uint32_t offset of each packet in data_file
+  int next_index;         ///< Packet after the last one read, to skip the index when reading in order
+  uint32_t next_offset;   ///< Offset of next_index in data_file
 public:
 
 //=============================================================================
@@ -61,8 +85,8 @@ public:
 	/// @param[in]	p		The array of constuctor args to expand
   BatchSD(JsonArrayConst p);
 
-	/// Destructor
-  ~BatchSD() = default;
+	/// Destructor, closes the batch files
+  ~BatchSD() { close_files(); }
 
 //=============================================================================
 ///@name	OPERATION
@@ -76,15 +100,15 @@ public:
   using LogPlat::log;
 
 
-  /// Clears all the files that are being stored in the batch on the SD card
+  /// Clears all the packets stored in the batch on the SD card
   void    clear_batch_log();
 
   /// Accesses the internal json from Loom Manager to store to batch using store_batch_json
 	/// @return True if success
   bool    store_batch();
 
-  /// Uses JsonObject to write file as packet in the batch onto the SD Card
-  /// @param[in] json   The data to be saved as .json file
+  /// Appends json as a packet of the batch on the SD Card
+  /// @param[in] json   The data to be saved
   /// @return True if success
   bool    store_batch_json(JsonObject json);
 
@@ -93,6 +117,7 @@ public:
   void    power_down() override;
 
   void    package(JsonObject json);
+  bool    package_record(Record::Writer& record) override;
 
 //=============================================================================
 ///@name	PRINT INFORMATION
@@ -100,8 +125,8 @@ public:
 
   void		print_config() const override;
 
-  /// Prints the contents of a particular packet file in the batch
-  /// @param[in]  index   The index of file in the batch to print
+  /// Prints a particular packet in the batch as json
+  /// @param[in]  index   The index of the packet in the batch to print
   /// @return True if success
   bool    dump_batch(int index);
 
@@ -110,11 +135,21 @@ public:
 /*@{*/ //======================================================================
 
 
-  /// Returns a JsonObject of the packet file (.json) in the batch from the SD card
-  /// @param[in] index    The index of the file in the batch to retrieve
-  /// @return   The JsonObject stored index
+  /// Returns a JsonObject of a packet in the batch from the SD card.
+  /// Valid until the next call
+  /// @param[in] index    The index of the packet in the batch to retrieve
+  /// @return   The JsonObject stored at index, null if it could not be read
   JsonObject  get_batch_json(int index);
 
+  /// Copies a packet in the batch from the SD card as stored: MsgPack,
+  /// the same bytes CommPlat sends, so it can be sent without parsing it
+  /// @param[in]  index     The index of the packet in the batch to retrieve
+  /// @param[out] buffer    Where to copy the packet
+  /// @param[in]  max_len   Size of buffer
+  /// @return   Length of the packet, nothing is copied if larger than max_len.
+  ///           -1 if it could not be read
+  int         get_batch_raw(int index, uint8_t* buffer, const uint16_t max_len);
+
   /// Get the current amount of packets that are being stored in the batch
   /// @return   The current number of packets
   int         get_packet_counter() { return packet_counter; }
@@ -131,10 +166,24 @@ public:
 
 private:
 
-  /// Creates the proper file name of the file from the batch
-  /// @param[in] index    The index of the file in the batch
-  /// @return The file name to be used for file in batch
-  void create_file_name(int index, char* name);
+  /// Open the batch files if not open, creating them if needed
+  /// @return True if success
+  bool open_files();
+
+  /// Sync and close the batch files
+  void close_files();
+
+  /// Find where a packet is stored in the data file
+  /// @param[in]  index   The index of the packet in the batch
+  /// @param[out] offset  Offset of the packet's length prefix
+  /// @return True if success
+  bool packet_offset(int index, uint32_t& offset);
+
+  /// Position the data file at the start of a packet's MsgPack
+  /// @param[in]  index   The index of the packet in the batch
+  /// @param[out] len     Length of the packet
+  /// @return True if success
+  bool seek_packet(int index, uint16_t& len);
 
   /// Get the packet drop rate from the current batch
   /// Keep in mind that this drop rate will not account for retransmissions
@@ -0,0 +1,383 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+/// @file		BinarySD.cpp
+/// @brief		File for BinarySD implementation.
+/// @date		2020
+/// @copyright	GNU General Public License v3.0
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#include "BinarySD.h"
+#include "Manager.h"
+#include "Module_Factory.h"
+
+#include <SPI.h>
+
+using namespace Loom;
+using namespace Loom::BinarySDFormat;
+
+static_assert((uint8_t)Record::Type::INT		== Type::INT		&&
+			  (uint8_t)Record::Type::FLOAT		== Type::FLOAT		&&
+			  (uint8_t)Record::Type::BOOL		== Type::BOOL		&&
+			  (uint8_t)Record::Type::STRING		== Type::STRING,	"BinarySDFormat::Type must match Record::Type");
+static_assert((uint8_t)Record::Section::ID			== Section::ID			&&
+			  (uint8_t)Record::Section::TIMESTAMP	== Section::TIMESTAMP	&&
+			  (uint8_t)Record::Section::CONTENTS	== Section::CONTENTS,	"BinarySDFormat::Section must match Record::Section");
+
+///////////////////////////////////////////////////////////////////////////////
+BinarySD::BinarySD(
+		const bool			enable_rate_filter,
+		const uint16_t		min_filter_delay,
+		const byte			chip_select,
+		const char*			default_file,
+		const uint16_t		file_blocks
+	)
+	: LogPlat("BinarySD", enable_rate_filter, min_filter_delay )
+	, chip_select(chip_select)
+	, file_blocks(file_blocks)
+	, first_block(0)
+	, block_count(0)
+	, card_writing(false)
+	, file_hash(0)
+	, record_size(0)
+	, records_per_block(0)
+	, buffer_head(0)
+	, buffer_full(0)
+	, overrun(0)
+	, json_record(nullptr)
+{
+	digitalWrite(8, HIGH); // if using LoRa, need to temporarily prevent it from using SPI
+	LMark;
+
+	snprintf(base_name, sizeof(base_name), "%s", default_file);
+	filename[0] = '\0';
+	for (auto& block : buffer) {
+		block.count = 0;
+	}
+
+	bool sd_found = sd.begin(chip_select, SD_SCK_MHZ(50));
+	if (!sd_found) {
+		active = false;
+	}
+
+	print_module_label();
+	LPrintln("Initialize ", (sd_found) ? "sucessful" : "failed");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+BinarySD::BinarySD(JsonArrayConst p)
+	: BinarySD(EXPAND_ARRAY(p, 5) ) {}
+
+///////////////////////////////////////////////////////////////////////////////
+BinarySD::~BinarySD()
+{
+	close_file();
+	delete json_record;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void BinarySD::print_config() const
+{
+	LogPlat::print_config();
+
+	LPrintln("\tFile Base Name      : ", base_name);
+	LPrintln("\tFile Blocks         : ", file_blocks);
+	LPrintln("\tCurrent File        : ", get_filename());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool BinarySD::log(JsonObject json)
+{
+	if (!json_record) {
+		json_record = new Record();
+	}
+	Record& record = *json_record;
+	record.begin_fill();
+
+	// Recompile only when the json's keys no longer match
+	if ( (record.segment_count() == 0) || !record.copy_segment(0, json) ) {
+		record.reset();
+		if ( !record.add_segment(nullptr, json) || !record.copy_segment(0, json) ) {
+			print_module_label();
+			LPrintln("Data cannot be stored as a binary record");
+			record.reset();
+			return false;
+		}
+	}
+
+	return log_record(record);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool BinarySD::log()
+{
+	if (device_manager != nullptr) {
+		const Record* record = device_manager->get_record();
+		if (record) {
+			return log_record(*record);
+		}
+	}
+	return LogPlat::log();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool BinarySD::log_record(const Record& record)
+{
+	if ( !active || !check_millis() ) return false;
+
+	// Start a new file if the layout changed (records in the current file
+	// would be unreadable) or the preallocated file is full
+	DataBlock* block = &buffer[(buffer_head + buffer_full) % BINARYSD_BUFFER_BLOCKS];
+	if ( !file.isOpen() || (record.schema_hash() != file_hash)
+		|| ( (block->count == 0) && (block_count + buffer_full >= file_blocks) ) ) {
+		if ( !open_file(record) ) return false;
+	}
+	if ( !card_writing && !start_write() ) return false;
+
+	// Make room in the ring, dropping the record if the card is still busy
+	if (buffer_full == BINARYSD_BUFFER_BLOCKS) {
+		drain();
+		if (buffer_full == BINARYSD_BUFFER_BLOCKS) {
+			overrun++;
+			return false;
+		}
+	}
+
+	block = &buffer[(buffer_head + buffer_full) % BINARYSD_BUFFER_BLOCKS];
+	if (block->count == 0) {
+		block->overrun = overrun;
+		overrun = 0;
+	}
+
+	uint8_t* dst = block->data + block->count * record_size;
+	const uint32_t ms = millis();
+	memcpy(dst, &ms, sizeof(ms));
+	dst += sizeof(ms);
+
+	// memcpy since values are unaligned
+	for (auto i = 0; i < record.size(); i++) {
+		const Record::Value& v = record.value(i);
+		switch (record.column(i).type) {
+			case Record::Type::INT:		memcpy(dst, &v.i, 4); dst += 4; break;
+			case Record::Type::FLOAT:	memcpy(dst, &v.f, 4); dst += 4; break;
+			case Record::Type::BOOL:	*dst++ = v.b; break;
+			case Record::Type::STRING:	strncpy((char*)dst, v.s, BINARYSD_STRING_SIZE); dst += BINARYSD_STRING_SIZE; break;
+		}
+	}
+
+	if (++block->count == records_per_block) {
+		buffer_full++;
+		drain();
+	}
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void BinarySD::drain(const bool wait)
+{
+	const unsigned long start = millis();
+	while ( buffer_full && card_writing ) {
+		if ( sd.card()->isBusy() ) {
+			if (!wait) return;
+			// a card stuck busy would otherwise hang the logger until the watchdog
+			if ( millis() - start > BINARYSD_BUSY_TIMEOUT ) {
+				print_module_label();
+				LPrintln("Card busy, write failed");
+				card_writing = false;
+				return;
+			}
+			delay(1);
+			continue;
+		}
+
+		DataBlock& block = buffer[buffer_head];
+		if ( !sd.card()->writeData((const uint8_t*)&block) ) {
+			print_module_label();
+			LPrintln("Write failed");
+			card_writing = false;
+			return;
+		}
+
+		block.count = 0;	// Free blocks are empty
+		block_count++;
+		buffer_head = (buffer_head + 1) % BINARYSD_BUFFER_BLOCKS;
+		buffer_full--;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void BinarySD::flush()
+{
+	if ( !file.isOpen() ) return;
+
+	// Partially filled block is written as is, later records start a new block
+	DataBlock& block = buffer[(buffer_head + buffer_full) % BINARYSD_BUFFER_BLOCKS];
+	if ( (buffer_full < BINARYSD_BUFFER_BLOCKS) && (block.count > 0) ) {
+		buffer_full++;
+	}
+
+	if ( !card_writing ) start_write();
+	drain(true);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void BinarySD::close_file()
+{
+	if ( !file.isOpen() ) return;
+	LMark;
+
+	flush();
+	if (card_writing) {
+		sd.card()->writeStop();
+		card_writing = false;
+	}
+
+	file.truncate((uint32_t)BINARYSD_BLOCK_SIZE * block_count);
+	file.close();
+
+	// Discard anything that could not be written
+	buffer_head = 0;
+	buffer_full = 0;
+	for (auto& block : buffer) {
+		block.count = 0;
+	}
+
+	print_module_label();
+	LPrintln("Closed ", filename, ", ", block_count, " blocks");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool BinarySD::open_file(const Record& record)
+{
+	close_file();
+	LMark;
+
+	// Size of each record: millis() then the values
+	uint16_t size = sizeof(uint32_t);
+	uint16_t header_size = sizeof(Header);
+	for (auto i = 0; i < record.size(); i++) {
+		size += value_size((uint8_t)record.column(i).type);
+		header_size += 2 + strlen(record.module(i)) + 1 + strlen(record.key(i)) + 1;
+	}
+	const uint16_t header_blocks = (header_size + BINARYSD_BLOCK_SIZE - 1) / BINARYSD_BLOCK_SIZE;
+
+	if ( (size > DATA_DIM) || (header_blocks >= file_blocks) ) {
+		print_module_label();
+		LPrintln("Record too large (", size, " bytes)");
+		return false;
+	}
+
+	// Next unused file number
+	uint8_t num = 0;
+	do {
+		snprintf(filename, sizeof(filename), "%s%02u.bin", base_name, num);
+	} while ( sd.exists(filename) && (++num < 100) );
+
+	if ( (num == 100) || !file.createContiguous(filename, (uint32_t)BINARYSD_BLOCK_SIZE * file_blocks) ) {
+		print_module_label();
+		LPrintln("Could not create file");
+		return false;
+	}
+	if ( !file.contiguousRange(&first_block, nullptr) ) {
+		print_module_label();
+		LPrintln("File is not contiguous");
+		file.close();
+		return false;
+	}
+
+	record_size			= size;
+	records_per_block	= DATA_DIM / size;
+	file_hash			= record.schema_hash();
+	block_count			= 0;
+	buffer_head			= 0;
+	buffer_full			= 0;
+
+	if ( !start_write() ) {
+		file.close();
+		return false;
+	}
+
+	// Stream the header through the first buffer, one block at a time
+	uint8_t* const scratch = (uint8_t*)&buffer[0];
+	uint16_t pos = 0;
+	bool success = true;
+	auto put = [&](const void* src, uint16_t len) {
+		const uint8_t* bytes = (const uint8_t*)src;
+		while (len--) {
+			scratch[pos++] = *bytes++;
+			if (pos == BINARYSD_BLOCK_SIZE) {
+				success &= sd.card()->writeData(scratch);
+				block_count++;
+				pos = 0;
+			}
+		}
+	};
+
+	Header header = {};
+	strcpy(header.magic, BINARYSD_MAGIC);
+	header.version			= BINARYSD_VERSION;
+	header.header_blocks	= header_blocks;
+	header.record_size		= record_size;
+	header.column_count		= record.size();
+	header.schema_hash		= file_hash;
+	put(&header, sizeof(header));
+
+	for (auto i = 0; i < record.size(); i++) {
+		const uint8_t kind[2] = { (uint8_t)record.column(i).section, (uint8_t)record.column(i).type };
+		put(kind, 2);
+		put(record.module(i), strlen(record.module(i)) + 1);
+		put(record.key(i), strlen(record.key(i)) + 1);
+	}
+	if (pos > 0) {
+		memset(scratch + pos, 0, BINARYSD_BLOCK_SIZE - pos);
+		success &= sd.card()->writeData(scratch);
+		block_count++;
+	}
+	buffer[0].count = 0;
+
+	if (!success) {
+		print_module_label();
+		LPrintln("Could not write header");
+		sd.card()->writeStop();
+		card_writing = false;
+		file.close();
+		return false;
+	}
+
+	print_module_label();
+	LPrintln("Logging to: ", filename, " (", records_per_block, " records per block)");
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool BinarySD::start_write()
+{
+	digitalWrite(8, HIGH); // if using LoRa, need to temporarily prevent it from using SPI
+
+	// Erase count lets the card pre-erase the rest of the file
+	card_writing = sd.card()->writeStart(first_block + block_count, file_blocks - block_count);
+	if (!card_writing) {
+		print_module_label();
+		LPrintln("Could not start write");
+	}
+	return card_writing;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void BinarySD::power_up()
+{
+	digitalWrite(8, HIGH); // LoRa fix
+	// re-begin SD, the write resumes with the next log
+	sd.begin(chip_select, SD_SCK_MHZ(50));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void BinarySD::power_down()
+{
+	// Card must not lose power in the middle of a multiple block write
+	flush();
+	if (card_writing) {
+		sd.card()->writeStop();
+		card_writing = false;
+	}
+}
@@ -0,0 +1,185 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+/// @file		BinarySD.h
+/// @brief		File for BinarySD definition.
+/// @date		2020
+/// @copyright	GNU General Public License v3.0
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "LogPlat.h"
+#include "BinarySDFormat.h"
+
+#include <SdFat.h>
+
+namespace Loom {
+
+///////////////////////////////////////////////////////////////////////////////
+
+#define BINARYSD_BUFFER_BLOCKS	4		///< Number of 512 byte blocks buffered in RAM
+#define BINARYSD_BUSY_TIMEOUT	1000	///< Milliseconds drain(true) waits for a busy card before giving up on it
+
+
+///////////////////////////////////////////////////////////////////////////////
+///
+/// High rate binary SD logging platform module.
+///
+/// Instead of opening, appending text to, syncing and closing a file for
+/// every log like SD, BinarySD preallocates a contiguous file and streams
+/// fixed size binary records into it with a single SD multiple block write,
+/// so logging a record costs a memcpy and, every few records, one 512 byte
+/// block write with no FAT or directory updates.
+/// Full blocks wait in a ring of BINARYSD_BUFFER_BLOCKS buffers while the
+/// card is busy; records that arrive when all buffers are full are dropped
+/// and counted as overruns.
+///
+/// Files are named <base>NN.bin. A new file is started when the preallocated
+/// file is full or the layout of the logged data changes.
+/// The file is truncated to the data written when closed
+/// (close_file() or destruction). On power down the write is only paused,
+/// unwritten blocks stay erased and mark the end of data.
+///
+/// Convert files to CSV or JSON on a computer with extras/bintocsv.
+///
+/// Records come from the Manager's compiled record when available
+/// (see Manager::set_compiled_record()), otherwise the json is compiled into
+/// a record here.
+///
+/// @par Resources
+/// - [Dependency: SdFat](https://github.com/greiman/SdFat)
+/// - [Example: SdFat LowLatencyLogger](https://github.com/greiman/SdFat/tree/master/examples/LowLatencyLogger)
+///	- [Hardware Support](https://github.com/OPEnSLab-OSU/Loom/wiki/Hardware-Support#sd-card)
+///
+///////////////////////////////////////////////////////////////////////////////
+class BinarySD : public LogPlat
+{
+	LOOM_MODULE_TYPE(BinarySD, LogPlat)
+
+protected:
+
+	SdFat		sd;						///< File system object
+	File		file;					///< Current preallocated file
+
+	const byte		chip_select;		///< Chip select pin
+	char			base_name[7];		///< File name base, without number and extension
+	char			filename[13];		///< Current file name
+	const uint16_t	file_blocks;		///< Size of preallocated files, in blocks
+
+	uint32_t	first_block;			///< First SD block of current file
+	uint32_t	block_count;			///< Blocks of current file written, including header
+	bool		card_writing;			///< Whether a multiple block write is in progress
+
+	uint32_t	file_hash;				///< Schema hash of the records in current file
+	uint16_t	record_size;			///< Bytes per record in current file
+	uint16_t	records_per_block;		///< Records that fit a block in current file
+
+	BinarySDFormat::DataBlock	buffer[BINARYSD_BUFFER_BLOCKS];	///< Ring of blocks waiting to be written
+	uint8_t		buffer_head;			///< Oldest full block in ring
+	uint8_t		buffer_full;			///< Number of full blocks in ring
+	uint16_t	overrun;				///< Records dropped since last stored record
+
+	Record*		json_record;			///< Record compiled from logged json, nullptr until needed
+
+public:
+
+//=============================================================================
+///@name	CONSTRUCTORS / DESTRUCTOR
+/*@{*/ //======================================================================
+
+	/// BinarySD Module Constructor
+	///
+	/// @param[in]	enable_rate_filter			Bool | <false> | {true, false} | Whether or not to impose maximum update rate
+	/// @param[in]	min_filter_delay			Int | <0> | [0-5000] | Minimum update delay, if enable_rate_filter enabled
+	/// @param[in]	chip_select					Set(Int) | <11> | {5, 6, 9, 10, 11, 12, 13, 14("A0"), 15("A1"), 16("A2"), 17("A3"), 18("A4"), 19("A5")} | Which pin to use for chip select
+	/// @param[in]	default_file				String | <"bin"> | null | File name base, a two digit number and .bin are appended (should be <= 6 characters)
+	/// @param[in]	file_blocks					Int | <8192> | [16-65535] | Size of each preallocated file in 512 byte blocks (8192 is 4MB)
+	BinarySD(
+			const bool			enable_rate_filter	= false,
+			const uint16_t		min_filter_delay	= 0,
+			const byte			chip_select			= 11,
+			const char*			default_file		= "bin",
+			const uint16_t		file_blocks			= 8192
+		);
+
+	/// Constructor that takes Json Array, extracts args
+	/// and delegates to regular constructor
+	/// @param[in]	p		The array of constuctor args to expand
+	BinarySD(JsonArrayConst p);
+
+	/// Destructor, closes the current file
+	~BinarySD();
+
+//=============================================================================
+///@name	OPERATION
+/*@{*/ //======================================================================
+
+	/// Log packaged json.
+	/// The json is compiled into a record, recompiling when its keys change
+	/// @param[in]	json	The data to be saved
+	/// @return True if the record was stored
+	bool		log(JsonObject json) override;
+
+	/// Log the linked Manager's data.
+	/// Uses the Manager's compiled record directly if it has one,
+	/// otherwise its internal json
+	/// @return True if the record was stored
+	bool		log() override;
+
+	/// Log a record.
+	/// Starts a new file if the record's layout differs from the current file's
+	/// @param[in]	record	Record to store
+	/// @return True if the record was stored (buffered)
+	bool		log_record(const Record& record);
+
+	/// Write all buffered records to the card
+	void		flush();
+
+	/// Flush, end the multiple block write, and truncate and close the
+	/// current file. The next log starts a new file
+	void		close_file();
+
+	void		power_up() override;
+	void 		power_down() override;
+
+//=============================================================================
+///@name	PRINT INFORMATION
+/*@{*/ //======================================================================
+
+	void		print_config() const override;
+
+//=============================================================================
+///@name	GETTERS
+/*@{*/ //======================================================================
+
+	/// Get the current file name
+	/// @return File name, empty if no file is open
+	const char*	get_filename() const { return file.isOpen() ? filename : ""; }
+
+	/// Get the number of records dropped since the last stored record
+	/// @return Overrun count
+	uint16_t	get_overrun() const { return overrun; }
+
+private:
+
+	/// Create and preallocate the next numbered file and write its header
+	/// @param[in]	record	Record describing the layout of the file
+	/// @return True if success
+	bool		open_file(const Record& record);
+
+	/// Start (or resume after power down) the multiple block write
+	/// @return True if success
+	bool		start_write();
+
+	/// Write full blocks to the card while it is not busy
+	/// @param[in]	wait	True to wait for the card until all full blocks are written
+	void		drain(const bool wait = false);
+
+};
+
+///////////////////////////////////////////////////////////////////////////////
+REGISTER(Module, BinarySD, "BinarySD");
+///////////////////////////////////////////////////////////////////////////////
+
+}; // namespace Loom
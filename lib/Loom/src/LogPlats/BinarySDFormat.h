@@ -0,0 +1,87 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+/// @file		BinarySDFormat.h
+/// @brief		On-card layout of files written by BinarySD.
+/// @details	Plain C++ with no Arduino dependencies so that host tools
+///				(extras/bintocsv) read files with the same definitions.
+///				All values are little-endian.
+/// @date		2020
+/// @copyright	GNU General Public License v3.0
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <stdint.h>
+
+namespace Loom {
+namespace BinarySDFormat {
+
+///////////////////////////////////////////////////////////////////////////////
+
+#define BINARYSD_BLOCK_SIZE		512			///< Bytes per SD block
+#define BINARYSD_MAGIC			"LOOMBIN"	///< Start of every file
+#define BINARYSD_VERSION		1			///< Format version
+#define BINARYSD_STRING_SIZE	12			///< Bytes stored for a string value (zero padded, may be unterminated)
+
+/// Same values as Record::Section
+enum Section : uint8_t { ID = 0, TIMESTAMP = 1, CONTENTS = 2 };
+
+/// Same values as Record::Type
+enum Type : uint8_t { INT = 0, FLOAT = 1, BOOL = 2, STRING = 3 };
+
+///////////////////////////////////////////////////////////////////////////////
+/// Start of the first block of a file.
+///
+/// Followed by column_count column descriptions, each:
+///		uint8_t section, uint8_t type, module name and key as C-strings.
+/// Descriptions may cross block boundaries, the rest of the last header
+/// block is zero.
+struct Header {
+	char		magic[8];			///< BINARYSD_MAGIC
+	uint16_t	version;			///< BINARYSD_VERSION
+	uint16_t	header_blocks;		///< Number of blocks before the first data block
+	uint16_t	record_size;		///< Bytes per record
+	uint16_t	column_count;		///< Values per record
+	uint32_t	schema_hash;		///< Record::schema_hash() of the logged data
+	uint32_t	reserved;
+};
+
+/// Data bytes in a block
+const uint16_t DATA_DIM = BINARYSD_BLOCK_SIZE - 4;
+
+///////////////////////////////////////////////////////////////////////////////
+/// A data block.
+///
+/// Each record is a uint32_t millis() timestamp followed by one value per
+/// column: int32_t (INT), float (FLOAT), uint8_t (BOOL) or
+/// char[BINARYSD_STRING_SIZE] (STRING), without padding.
+/// Data ends at the first block with a count of 0 or an invalid count
+/// (unused blocks of the preallocated file are erased).
+struct DataBlock {
+	uint16_t	count;				///< Number of records in block
+	uint16_t	overrun;			///< Records dropped before this block because buffers were full
+	uint8_t		data[DATA_DIM];		///< Records
+};
+
+static_assert(sizeof(DataBlock) == BINARYSD_BLOCK_SIZE, "DataBlock must be one SD block");
+static_assert(sizeof(Header) == 24, "Header must not be padded");
+
+/// Bytes a value of a type occupies in a record
+/// @param[in]	type	Column type
+/// @return Size in bytes
+inline uint8_t value_size(const uint8_t type)
+{
+	switch (type) {
+		case INT:		return 4;
+		case FLOAT:		return 4;
+		case BOOL:		return 1;
+		case STRING:	return BINARYSD_STRING_SIZE;
+		default:		return 0;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+}; // namespace BinarySDFormat
+}; // namespace Loom
@@ -0,0 +1,152 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+/// @file		CSVRow.cpp
+/// @brief		File for CSVRow implementation.
+/// @date		2020
+/// @copyright	GNU General Public License v3.0
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#include "CSVRow.h"
+
+using namespace Loom;
+
+///////////////////////////////////////////////////////////////////////////////
+CSVRow::CSVRow(Print& out, const uint8_t precision)
+	: out(out)
+	, precision( (precision > CSV_ROW_MAX_PRECISION) ? CSV_ROW_MAX_PRECISION : precision )
+	, len(0)
+	, written(0)
+{}
+
+///////////////////////////////////////////////////////////////////////////////
+void CSVRow::add(const int32_t val)
+{
+	reserve(12);
+	len += format_int(buffer + len, val);
+	buffer[len++] = ',';
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void CSVRow::add(const float val)
+{
+	reserve(15 + CSV_ROW_MAX_PRECISION);
+	len += format_float(buffer + len, val, precision);
+	buffer[len++] = ',';
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void CSVRow::add(const char* val)
+{
+	if (val) {
+		while (*val) {
+			append_char(*val++);
+		}
+	}
+	append_char(',');
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void CSVRow::add_json(JsonVariantConst val)
+{
+	if (val.is<int>()) {
+		add( (int32_t)val.as<int>() );
+	} else if (val.is<bool>()) {
+		add( val.as<bool>() );
+	} else if (val.is<float>()) {
+		add( val.as<float>() );
+	} else if (val.is<const char*>()) {
+		add( val.as<const char*>() );
+	} else {
+		append_char(',');
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void CSVRow::end()
+{
+	reserve(2);
+	buffer[len++] = '\r';
+	buffer[len++] = '\n';
+	flush();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+size_t CSVRow::flush()
+{
+	if (len == 0) return 0;
+
+	const size_t count = out.write( (const uint8_t*)buffer, len );
+	written += count;
+	len = 0;
+	return count;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+uint8_t CSVRow::format_uint(char* dst, uint32_t val, const uint8_t min_width)
+{
+	// Digits are produced backwards
+	char digits[10];
+	uint8_t count = 0;
+	do {
+		digits[count++] = '0' + (val % 10);
+		val /= 10;
+	} while (val || count < min_width);
+
+	for (uint8_t i = 0; i < count; i++) {
+		dst[i] = digits[count - 1 - i];
+	}
+	return count;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+uint8_t CSVRow::format_int(char* dst, const int32_t val)
+{
+	if (val < 0) {
+		*dst = '-';
+		return 1 + format_uint(dst + 1, -(uint32_t)val);
+	}
+	return format_uint(dst, val);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+uint8_t CSVRow::format_float(char* dst, float val, uint8_t precision)
+{
+	// Same special cases as Print::print(float)
+	if (isnan(val)) { memcpy(dst, "nan", 3); return 3; }
+	if (isinf(val)) { memcpy(dst, "inf", 3); return 3; }
+	if (val > 4294967040.0f || val < -4294967040.0f) { memcpy(dst, "ovf", 3); return 3; }
+
+	if (precision > CSV_ROW_MAX_PRECISION) precision = CSV_ROW_MAX_PRECISION;
+
+	uint8_t count = 0;
+	double number = val;
+	if (number < 0) {
+		dst[count++] = '-';
+		number = -number;
+	}
+
+	// Round half up at the last digit and take the fraction's digits one at
+	// a time, in double, exactly as Print::print(float) does: rounding in
+	// float misrounds values a float step away from a tie
+	double rounding = 0.5;
+	for (uint8_t i = 0; i < precision; i++) rounding /= 10.0;
+	number += rounding;
+
+	const uint32_t int_part = (uint32_t)number;
+	double remainder = number - (double)int_part;
+
+	count += format_uint(dst + count, int_part);
+	if (precision > 0) {
+		dst[count++] = '.';
+		for (uint8_t i = 0; i < precision; i++) {
+			remainder *= 10.0;
+			const uint8_t digit = (uint8_t)remainder;
+			dst[count++] = '0' + digit;
+			remainder -= digit;
+		}
+	}
+	return count;
+}
+
+///////////////////////////////////////////////////////////////////////////////
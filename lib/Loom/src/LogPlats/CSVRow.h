@@ -0,0 +1,107 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+/// @file		CSVRow.h
+/// @brief		File for CSVRow definition.
+/// @date		2020
+/// @copyright	GNU General Public License v3.0
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+namespace Loom {
+
+///////////////////////////////////////////////////////////////////////////////
+
+#define CSV_ROW_BUFFER_SIZE		256		///< Bytes of a row rendered before writing
+#define CSV_ROW_MAX_PRECISION	6		///< Most float digits (float has ~7 significant digits)
+
+
+///////////////////////////////////////////////////////////////////////////////
+///
+/// Renders a CSV row into a stack buffer and writes it with a single
+/// write() call, instead of one print() per value and delimiter.
+///
+/// Floats are formatted into the buffer with the same algorithm as the
+/// Arduino core's Print::print(float, precision) (rounding half up in double,
+/// including "nan", "inf" and "ovf"), so the output is identical, without a
+/// print() call per digit.
+///
+/// Rows longer than CSV_ROW_BUFFER_SIZE are written in several pieces.
+///
+///////////////////////////////////////////////////////////////////////////////
+class CSVRow
+{
+
+public:
+
+	/// Constructor
+	/// @param[in]	out			Where the row is written (e.g. a File)
+	/// @param[in]	precision	Digits after the decimal point of floats
+	CSVRow(Print& out, const uint8_t precision = 2);
+
+	/// Destructor, writes anything not yet written
+	~CSVRow() { flush(); }
+
+	/// Append a value followed by a comma
+	/// @param[in]	val		Value to add
+	void		add(const int32_t val);
+	void		add(const float val);
+	void		add(const bool val)			{ append_char(val ? '1' : '0'); append_char(','); }
+	void		add(const char* val);
+
+	/// Append a json value followed by a comma,
+	/// formatted the way SD has always printed it
+	/// (ints, bools as 0 / 1, floats, strings, nothing for other types)
+	/// @param[in]	val		Value to add
+	void		add_json(JsonVariantConst val);
+
+	/// Append a line ending and write the row
+	void		end();
+
+	/// Write the rendered part of the row
+	/// @return Number of bytes written
+	size_t		flush();
+
+	/// Get the number of bytes written so far
+	/// @return Bytes written
+	size_t		get_written() const { return written; }
+
+	/// Format a float in fixed point without floating point printing.
+	/// @param[out]	dst			Buffer, at least 14 + precision bytes
+	/// @param[in]	val			Value to format
+	/// @param[in]	precision	Digits after the decimal point (at most CSV_ROW_MAX_PRECISION)
+	/// @return Number of characters written (not null terminated)
+	static uint8_t	format_float(char* dst, float val, uint8_t precision);
+
+	/// Format an integer in decimal
+	/// @param[out]	dst		Buffer, at least 11 bytes
+	/// @param[in]	val		Value to format
+	/// @return Number of characters written (not null terminated)
+	static uint8_t	format_int(char* dst, const int32_t val);
+
+private:
+
+	Print&		out;			///< Destination
+	uint8_t		precision;		///< Float digits after the decimal point
+	uint16_t	len;			///< Bytes of buffer in use
+	size_t		written;		///< Bytes written to out
+	char		buffer[CSV_ROW_BUFFER_SIZE];	///< Row being rendered
+
+	/// Make room for a number of bytes, writing the buffer if needed
+	/// @param[in]	count	Bytes needed
+	void		reserve(const uint16_t count) { if (len + count > CSV_ROW_BUFFER_SIZE) flush(); }
+
+	void		append_char(const char c) { reserve(1); buffer[len++] = c; }
+
+	/// Format an unsigned integer, zero padded to a minimum width
+	static uint8_t	format_uint(char* dst, uint32_t val, const uint8_t min_width = 1);
+
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+}; // namespace Loom
@@ -27,6 +27,7 @@ namespace Loom {
 ///////////////////////////////////////////////////////////////////////////////
 class LogPlat : public Module
 {
+	LOOM_MODULE_TYPE(LogPlat, Module)
 
 protected:
 
@@ -68,7 +69,7 @@ public:
 	/// Version of log for use with LoomManager.
 	/// Accesses Json from LoomManager.
 	/// Calls derived classes implementations of log(JsonObject json)
-	bool			log();
+	virtual bool	log();
 
 //=============================================================================
 ///@name	PRINT INFORMATION
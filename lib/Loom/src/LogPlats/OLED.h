@@ -31,6 +31,7 @@ namespace Loom {
 	///////////////////////////////////////////////////////////////////////////////
 	class OLED : public LogPlat
 	{
+		LOOM_MODULE_TYPE(OLED, LogPlat)
 
 		public:
 
@@ -22,11 +22,27 @@ SD::SD(
 		const uint16_t		min_filter_delay,
 		const byte			chip_select,
 		const char*			default_file,
-		const bool			number_files
+		const bool			number_files,
+		const bool			keep_open,
+		const uint8_t		sync_count,
+		const uint16_t		sync_interval,
+		const uint8_t		precision
 	)
 	: LogPlat("SD", enable_rate_filter, min_filter_delay )
 	, chip_select(chip_select)
+	, number_files(number_files)
+	, keep_open(keep_open)
+	, sync_count(sync_count ? sync_count : 1)
+	, sync_interval(sync_interval)
+	, unsynced(0)
+	, last_sync_millis(0)
+	, header_hash(0)
+	, precision( (precision > CSV_ROW_MAX_PRECISION) ? CSV_ROW_MAX_PRECISION : precision )
 {
+	file_base[0] = '\0';
+	open_name[0] = '\0';
+	header_name[0] = '\0';
+
 	digitalWrite(8, HIGH); // if using LoRa, need to temporarily prevent it from using SPI
   LMark;
 
@@ -47,25 +63,27 @@ SD::SD(
 
 ///////////////////////////////////////////////////////////////////////////////
 SD::SD(JsonArrayConst p)
-	: SD(EXPAND_ARRAY(p, 5) ) {}
+	: SD(EXPAND_ARRAY(p, 9) ) {}
 
 ///////////////////////////////////////////////////////////////////////////////
 bool SD::update_filename(const char* default_file, const bool number_files)
 {
   LMark;
-	snprintf(filename, 12, "%s", default_file);	// file before potential modifcation
+	if (default_file != file_base) {
+		snprintf(file_base, sizeof(file_base), "%s", default_file);	// file before potential modifcation
+	}
 	File file;				// file representation
 
 	if (number_files) {	// Use numbers
 
-		if ( strlen(filename) > 6) {
+		if ( strlen(file_base) > 6) {
 			print_module_label();
 			LPrintln("filename too long, truncating");
-			filename[6] = '\0';
+			file_base[6] = '\0';
 		}
 
-		const uint8_t base_len = strlen(filename);
-		snprintf(filename, 13, "%s000.csv", filename);
+		const uint8_t base_len = strlen(file_base);
+		snprintf(filename, 13, "%s00.csv", file_base);
 
 		// Determine next file number
 		while (sd.exists(filename)) {
@@ -84,12 +102,12 @@ bool SD::update_filename(const char* default_file, const bool number_files)
 		}
 
 	} else {			// Don't use numbers
-		if ( strlen(filename) > 8) {
+		if ( strlen(file_base) > 8) {
 			print_module_label();
 			LPrintln("filename too long, truncating");
-			filename[8] = '\0';
+			file_base[8] = '\0';
 		}
-		snprintf(filename, 13, "%s.csv", filename);
+		snprintf(filename, 13, "%s.csv", file_base);
 	}
 
 	if (!file.open(filename, O_WRONLY | O_CREAT | O_EXCL)) {
@@ -114,6 +132,12 @@ void SD::print_config() const
 {
 	LogPlat::print_config();
 
+	LPrintln("\tKeep File Open      : ", (keep_open) ? "Enabled" : "Disabled" );
+	if (keep_open) {
+		LPrintln("\tSync Every          : ", sync_count, " logs / ", sync_interval, " ms");
+	}
+	LPrintln("\tFloat Precision     : ", precision);
+
 	// LPrintln("\tChip Select Pin     : ", chip_select);
 
 	// LPrintln("\tSD Version        : ", enum_oled_version_string(version) );
@@ -140,10 +164,20 @@ void SD::set_filename(const char* name)
 	snprintf(this->filename, 13, "%s", name);
 }
 
+///////////////////////////////////////////////////////////////////////////////
+void SD::set_keep_open(const bool keep_open, const uint8_t sync_count, const uint16_t sync_interval)
+{
+	if (!keep_open) close_file();
+	this->keep_open		= keep_open;
+	this->sync_count	= sync_count ? sync_count : 1;
+	this->sync_interval	= sync_interval;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 void SD::empty_file(const char* name)
 {
   LMark;
+	close_file();
 	sd.remove(name);
 	File file = sd.open(name, O_WRITE);
 	file.close();
@@ -157,6 +191,7 @@ bool SD::dump_file(const char* name)
 		digitalWrite(8, HIGH); // if using LoRa, need to temporarily prevent it from using SPI
   	LMark;
 
+		close_file();
 		sd.begin(chip_select); // It seems that SD card may become 'unsetup' sometimes, so re-setup
 
 		File file = sd.open(name, O_READ);
@@ -199,13 +234,29 @@ bool SD::save_json(JsonObject json, const char* name)
 {
 	if ( !check_millis() ) return false;
 
+	JsonObject dev_id    = json["id"];
+	JsonObject timestamp = json["timestamp"];
+	JsonArray  contents  = json["contents"];
+
+	// Don't log if no data
+	if (contents.isNull()) return false;
+
 	digitalWrite(8, HIGH); // if using LoRa, need to temporarily prevent it from using SPI
 
-	// sd.begin(chip_select); // It seems that SD card may become 'unsetup' sometimes, so re-setup
-	File file;
+	const uint32_t hash = _schema_hash(dev_id, timestamp, contents);
+	const bool schema_changed = (strcmp(header_name, name) == 0) && (hash != header_hash);
+
+	// Columns of the default file would no longer line up, continue in a new numbered file
+	if ( schema_changed && number_files && (strcmp(name, filename) == 0) ) {
+		close_file();
+		print_module_label();
+		LPrintln("Data layout changed, starting new file");
+		if ( !update_filename(file_base, true) ) return false;
+		name = filename;
+	}
 
-	// if ( !file ) {
-	if ( !file.open(name, O_WRITE | O_AT_END) ) {
+	// sd.begin(chip_select); // It seems that SD card may become 'unsetup' sometimes, so re-setup
+	if ( !open_file(name) ) {
 		print_module_label();
 		LPrintln("Error opening: ", name);
 		return false;
@@ -214,16 +265,9 @@ bool SD::save_json(JsonObject json, const char* name)
 		LPrintln("Writing to: ", name);
 	}
 
-	JsonObject dev_id    = json["id"];
-	JsonObject timestamp = json["timestamp"];
-	JsonArray  contents  = json["contents"];
-
-	// Don't log if no data
-	if (contents.isNull()) return false;
-
-
 	// Create Header Rows
-	if ( file.curPosition() == 0) {
+	// Empty file, or layout changed in a file that can't be renumbered
+	if ( (file.curPosition() == 0) || ( schema_changed && (strcmp(header_name, name) == 0) ) ) {
 
 		// Create Header Row 1 (Categories)
 		_write_json_header_part1(file, dev_id, timestamp, contents);
@@ -232,25 +276,97 @@ bool SD::save_json(JsonObject json, const char* name)
 		_write_json_header_part2(file, dev_id, timestamp, contents);
 
 	}
+	snprintf(header_name, sizeof(header_name), "%s", name);
+	header_hash = hash;
 
 	// Write data values
 	_write_json_data(file, dev_id, timestamp, contents);
+	unsynced++;
 
 	// Force data to SD and update the directory entry to avoid data loss.
-	if (!file.sync() || file.getWriteError()) {
-		file.close();
+	// With keep_open, only every sync_count logs or sync_interval ms
+	const bool sync_due = !keep_open || (unsynced >= sync_count)
+						  || (millis() - last_sync_millis >= sync_interval);
+	if ( (sync_due && !flush()) || file.getWriteError() ) {
+		close_file();
 		print_module_label();
 		LPrintln("write error");
 		return false;
 	}
 
-	file.close();
+	if (!keep_open) {
+		close_file();
+	}
 
 	print_module_label();
 	LPrintln("Done writing to SD");
 	return true;
 }
 
+///////////////////////////////////////////////////////////////////////////////
+bool SD::open_file(const char* name)
+{
+	if ( file.isOpen() ) {
+		if ( strcmp(open_name, name) == 0 ) return true;
+		close_file();
+	}
+
+	if ( !file.open(name, O_WRITE | O_AT_END) ) return false;
+
+	snprintf(open_name, sizeof(open_name), "%s", name);
+	last_sync_millis = millis();
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool SD::flush()
+{
+	if ( !file.isOpen() || (unsynced == 0) ) return true;
+	LMark;
+
+	unsynced = 0;
+	last_sync_millis = millis();
+	return file.sync();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void SD::close_file()
+{
+	if ( !file.isOpen() ) return;
+
+	flush();
+	file.close();
+	open_name[0] = '\0';
+}
+
+///////////////////////////////////////////////////////////////////////////////
+uint32_t SD::_schema_hash(JsonObject dev_id, JsonObject timestamp, JsonArray contents) const
+{
+	uint32_t hash = 2166136261UL;	// FNV-1a offset basis
+	auto mix = [&hash](const char* str) {
+		for ( ; ; str++) {
+			hash = (hash ^ (uint8_t)*str) * 16777619UL;
+			if (!*str) break;
+		}
+	};
+
+	mix("id");
+	for (JsonPair dataPoint : dev_id) {
+		mix(dataPoint.key().c_str());
+	}
+	mix("timestamp");
+	for (JsonPair dataPoint : timestamp) {
+		mix(dataPoint.key().c_str());
+	}
+	for (JsonObject module : contents) {
+		mix(module["module"] | "");
+		for (JsonPair dataPoint : module["data"].as<JsonObject>()) {
+			mix(dataPoint.key().c_str());
+		}
+	}
+	return hash;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 void SD::_write_json_header_part1(File& file, JsonObject dev_id, JsonObject timestamp, JsonArray contents) const
 {
@@ -325,30 +441,19 @@ void SD::_write_json_header_part2(File& file, JsonObject dev_id, JsonObject time
 ///////////////////////////////////////////////////////////////////////////////
 void SD::_write_json_data(File& file, JsonObject dev_id, JsonObject timestamp, JsonArray contents) const
 {
+	// Whole row is rendered in a buffer and written at once
+	CSVRow row(file, precision);
+
 	if (!dev_id.isNull()) {
 		for (JsonPair dataPoint : dev_id) {
-    	LMark;
-			JsonVariant val = dataPoint.value();
-			if (val.is<int>()) {
-     		LMark;
-				file.print(dataPoint.value().as<int>());
-			} else if (val.is<char*>() || val.is<const char*>() ) {
-				file.print(dataPoint.value().as<const char*>());
-			}
-			file.print(',');
+			row.add_json(dataPoint.value());
 		}
 	}
 
 	if (!timestamp.isNull()) {
-   	LMark;
+		LMark;
 		for (JsonPair dataPoint : timestamp) {
-    	LMark;
-			JsonVariant val = dataPoint.value();
-			if (val.is<char*>() || val.is<const char*>() ) {
-     		LMark;
-				file.print(dataPoint.value().as<const char*>());
-			}
-			file.print(',');
+			row.add_json(dataPoint.value());
 		}
 	}
 
@@ -357,22 +462,11 @@ void SD::_write_json_data(File& file, JsonObject dev_id, JsonObject timestamp, J
 		if (data.isNull()) continue;
 
 		for (JsonPair dataPoint : data) {
-    	LMark;
-			JsonVariant val = dataPoint.value();
-			if (val.is<int>()) {
-				file.print(dataPoint.value().as<int>());
-			} else if (val.is<bool>()) {
-				file.print(dataPoint.value().as<bool>());
-			} else if (val.is<float>()) {
-				file.print(dataPoint.value().as<float>());
-			} else if (val.is<char*>() || val.is<const char*>() ) {
-				file.print(dataPoint.value().as<const char*>());
-			}
-			file.print(",");
+			row.add_json(dataPoint.value());
 		}
 	}
 
-	file.println();
+	row.end();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -384,7 +478,8 @@ void SD::power_up() {
 
 ///////////////////////////////////////////////////////////////////////////////
 void SD::power_down() {
-	// do nothing
+	// Card may lose power while asleep, and power_up() re-begins it
+	close_file();
 }
 
 // ///////////////////////////////////////////////////////////////////////////////
@@ -11,6 +11,7 @@
 #pragma once
 
 #include "LogPlat.h"
+#include "CSVRow.h"
 
 #include <SdFat.h>
 #include "../RTC/RTC.h"
@@ -34,16 +35,32 @@ namespace Loom {
 ///////////////////////////////////////////////////////////////////////////////
 class SD : public LogPlat
 {
+	LOOM_MODULE_TYPE(SD, LogPlat)
 
 protected:
 
 		SdFat sd;						///< File system object
-		// File file;
+		File	file;					///< File kept open between logs if keep_open
 
 		const byte	chip_select;		///< Chip select pin
-		char		filename[13];		///< String of file to write to if not filename explicitly provided (should not exceed 6 characters)
+		char		filename[13];		///< String of file to write to if not filename explicitly provided
+		char		file_base[9];		///< Base of filename, used to number a new file when the data layout changes
+		bool		number_files;		///< Whether filename is numbered
 		RTC*	RTC_Inst;			///< Pointer to an RTC object for timestamps
 
+		bool		keep_open;			///< Whether to keep the file open and batch syncs between logs
+		uint8_t		sync_count;			///< With keep_open, sync after this many logs
+		uint16_t	sync_interval;		///< With keep_open, sync when this many milliseconds passed since the last sync
+
+		char		open_name[13];		///< Name of file currently open
+		uint8_t		unsynced;			///< Logs written since last sync
+		unsigned long	last_sync_millis;	///< Value of millis() at last sync
+
+		char		header_name[13];	///< File the CSV header was last checked / written for
+		uint32_t	header_hash;		///< Schema hash of the data under that header
+
+		uint8_t		precision;			///< Digits after the decimal point of logged floats
+
 		// SD_Version 		version;
 		// byte 			reset_pin;
 
@@ -60,12 +77,20 @@ public:
 	/// @param[in]	chip_select					Set(Int) | <11> | {5, 6, 9, 10, 11, 12, 13, 14("A0"), 15("A1"), 16("A2"), 17("A3"), 18("A4"), 19("A5")} | Which pin to use for chip select
 	/// @param[in]	default_file_base			String | <"test"> | null | File to write to if none explicity provided (should be <= 6 characters, don't add extension)
 	/// @param[in]	number_files				Bool | <true> | {true, false} | True to number files with run number, false to not.
+	/// @param[in]	keep_open					Bool | <false> | {true, false} | Keep the file open between logs and only sync periodically, false to open, sync and close on every log
+	/// @param[in]	sync_count					Int | <10> | [1-255] | With keep_open, sync after this many logs
+	/// @param[in]	sync_interval				Int | <10000> | [0-60000] | With keep_open, also sync when this many milliseconds have passed since the last sync
+	/// @param[in]	precision					Int | <2> | [0-6] | Digits after the decimal point of logged floats
 	SD(
 			const bool			enable_rate_filter	= true,
 			const uint16_t		min_filter_delay	= 1000,
 			const byte			chip_select			= 11,
 			const char*			default_file		= "test",
-			const bool			number_files		= true
+			const bool			number_files		= true,
+			const bool			keep_open			= false,
+			const uint8_t		sync_count			= 10,
+			const uint16_t		sync_interval		= 10000,
+			const uint8_t		precision			= 2
 
 			// SD_Version 		version 			= FEATHERWING,
 			// byte 			reset_pin 			= A2
@@ -76,8 +101,8 @@ public:
 	/// @param[in]	p		The array of constuctor args to expand
 	SD(JsonArrayConst p);
 
-	/// Destructor
-	~SD() = default;
+	/// Destructor, syncs and closes any open file
+	~SD() { close_file(); }
 
 //=============================================================================
 ///@name	OPERATION
@@ -101,13 +126,23 @@ public:
 	/// Save data to SD card in CSV format.
 	/// Format:
 	/// Identification Date Time ModuleA key1 val1 key2 val2 ... ModuleB key1 val1 ...
+	/// The two header rows are written to empty files. If the keys of the
+	/// data change, the default file continues in a new numbered file
+	/// (other files get new header rows) so columns stay aligned.
 	/// @param[in]	json		The data to be saved
 	/// @param[in]	filename	The file to save to
 	bool		save_json(JsonObject json, const char* name);
 
+	/// Write any logs not yet synced to the card
+	/// @return True if success (or nothing to sync)
+	bool		flush();
+
+	/// Flush and close the file kept open by keep_open
+	void		close_file();
+
 	/// Delete a file
 	/// @param[in]	filename	Name of file to delete
-	void		delete_file(const char* name) { sd.remove(name); }
+	void		delete_file(const char* name) { close_file(); sd.remove(name); }
 
 	/// Clear a file (remove contents but not file itself)
 	/// @param[in]	filename	Name of file to empty
@@ -159,6 +194,16 @@ public:
 	/// @param[in]	filename	New default file (max 8 characters excluding extension)
 	void		set_filename(const char* name);
 
+	/// Set whether to keep the file open between logs.
+	/// @param[in]	keep_open		True to keep open and sync periodically
+	/// @param[in]	sync_count		Sync after this many logs
+	/// @param[in]	sync_interval	Sync when this many milliseconds passed since last sync
+	void		set_keep_open(const bool keep_open, const uint8_t sync_count = 10, const uint16_t sync_interval = 10000);
+
+	/// Set the digits after the decimal point of logged floats
+	/// @param[in]	precision		Number of digits, at most CSV_ROW_MAX_PRECISION
+	void		set_precision(const uint8_t precision) { this->precision = (precision > CSV_ROW_MAX_PRECISION) ? CSV_ROW_MAX_PRECISION : precision; }
+
 //=============================================================================
 ///@name	MISCELLANEOUS
 /*@{*/ //======================================================================
@@ -194,6 +239,15 @@ private:
 	/// Aux method to write data values
 	void _write_json_data(File& file, JsonObject dev_id, JsonObject timestamp, JsonArray contents) const;
 
+	/// Hash of the header rows the data would produce (module names and keys)
+	/// @return FNV-1a hash
+	uint32_t _schema_hash(JsonObject dev_id, JsonObject timestamp, JsonArray contents) const;
+
+	/// Open a file for appending, reusing the open file if keep_open
+	/// @param[in]	name	File to open
+	/// @return True if success
+	bool		open_file(const char* name);
+
 	/// When instantiating the SD module, you provide a file name base, to which a number is appended.
 	/// This number represents the run number, starting at 0.
 	/// For example, if you use the file name base 'data', the first run will generate a file named: 'data00.csv'.
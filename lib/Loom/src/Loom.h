@@ -48,6 +48,10 @@ This is the Doxygen generated documentation of the Loom library code.
     Loom::nRF& getnRF(const Loom::Manager& feather) {return *(feather.get<Loom::nRF>());}
     #include "CommPlats/Bluetooth.h"
     Loom::Bluetooth& getBluetooth(const Loom::Manager& feather) {return *(feather.get<Loom::Bluetooth>());}
+  #ifdef LOOM_NATIVE
+    #include "CommPlats/SimRadio.h"
+    Loom::SimRadio& getSimRadio(const Loom::Manager& feather) {return *(feather.get<Loom::SimRadio>());}
+  #endif
 #endif
 
 // InternetPlats
@@ -65,6 +69,8 @@ This is the Doxygen generated documentation of the Loom library code.
 #if (defined(LOOM_INCLUDE_WIFI) || defined(LOOM_INCLUDE_ETHERNET) || defined(LOOM_INCLUDE_LTE))
     #include "PublishPlats/GoogleSheets.h"
     Loom::GoogleSheets& getGoogleSheets(const Loom::Manager& feather) {return *(feather.get<Loom::GoogleSheets>());}
+    #include "PublishPlats/HttpPublish.h"
+    Loom::HttpPublish& getHttpPublish(const Loom::Manager& feather) {return *(feather.get<Loom::HttpPublish>());}
 #endif
 
 // Max
@@ -84,6 +90,8 @@ Loom::OLED& getOLED(const Loom::Manager& feather) { return *(feather.get<Loom::O
 Loom::SD& getSD(const Loom::Manager& feather) { return *(feather.get<Loom::SD>()); }
 #include "LogPlats/BatchSD.h"
 Loom::BatchSD& getBatchSD(const Loom::Manager& feather) { return *(feather.get<Loom::BatchSD>()); }
+#include "LogPlats/BinarySD.h"
+Loom::BinarySD& getBinarySD(const Loom::Manager& feather) { return *(feather.get<Loom::BinarySD>()); }
 
 // // RTC
 #include "RTC/DS3231.h"
@@ -39,6 +39,12 @@ using namespace Loom;
 auto module_exists = [](Module* module) { return module != nullptr; };
 auto module_active = [](Module* module) { return module->get_active(); };
 
+/// Milliseconds until a timer expires, 0 if it already has
+static uint32_t time_until(const AsyncDelay& timer)
+{
+	return timer.isExpired() ? 0 : (timer.getExpiry() - millis());
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 const char* Manager::enum_device_type_string(const DeviceType t)
 {
@@ -72,6 +78,7 @@ Manager::Manager(
 Manager::~Manager()
 {
 	free_modules();
+	delete compiled_record;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -137,7 +144,96 @@ void Manager::add_module(Module* module)
 	LPrintln("Adding Module: ", module->get_module_name() );
 
 	modules.emplace_back(module);
+	categorize_module(module);
+	clear_type_cache();
 	module->link_device_manager(this);
+	record_stale = true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void Manager::categorize_module(Module* module)
+{
+	// Scheduled modules are measured by poll() instead of measure()
+	const bool measured = !is_scheduled(module);
+
+	if (module->is<Sensor>()) {
+		if (measured) sensors.emplace_back( static_cast<Sensor*>(module) );
+	}
+#ifdef LOOM_INCLUDE_SENSORS
+	else if (module->is<Multiplexer>()) {
+		if (measured) multiplexers.emplace_back( static_cast<Multiplexer*>(module) );
+	}
+#endif // ifdef LOOM_INCLUDE_SENSORS
+#if (defined(LOOM_INCLUDE_WIFI) || defined(LOOM_INCLUDE_ETHERNET) || defined(LOOM_INCLUDE_LTE))
+	else if (module->is<NTPSync>()) {
+		if (measured) ntp_syncs.emplace_back( static_cast<NTPSync*>(module) );
+	}
+	else if (module->is<PublishPlat>()) {
+		publish_plats.emplace_back( static_cast<PublishPlat*>(module) );
+	}
+#endif // if (defined(LOOM_INCLUDE_WIFI) || defined(LOOM_INCLUDE_ETHERNET) || defined(LOOM_INCLUDE_LTE))
+#ifdef LOOM_INCLUDE_RADIOS
+	else if (module->is<CommPlat>()) {
+		comm_plats.emplace_back( static_cast<CommPlat*>(module) );
+	}
+#endif // ifdef LOOM_INCLUDE_RADIOS
+	else if (module->is<LogPlat>()) {
+		log_plats.emplace_back( static_cast<LogPlat*>(module) );
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void Manager::categorize_modules()
+{
+	sensors.clear();
+	multiplexers.clear();
+	ntp_syncs.clear();
+	log_plats.clear();
+	publish_plats.clear();
+	comm_plats.clear();
+
+	for (auto module : modules | std::views::filter(module_exists)) {
+		categorize_module(module);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+Module* Manager::find_module(const TypeID type, const uint8_t idx) const
+{
+	// Only the first module of a type is cached, which is what nearly all
+	// lookups ask for
+	if (idx == 0) {
+		for (const auto& entry : type_cache) {
+			if (entry.type == type) {
+				return entry.module;
+			}
+		}
+	}
+
+	Module* found = nullptr;
+	uint8_t count = 0;
+	for (auto module : modules | std::views::filter(module_exists)) {
+		if ( module->is_type(type) && (count++ == idx) ) {
+			found = module;
+			break;
+		}
+	}
+
+	// Missing modules are cached too, they are looked up just as often
+	if (idx == 0) {
+		type_cache[type_cache_next] = { type, found };
+		type_cache_next = (type_cache_next + 1) % TYPE_CACHE_SIZE;
+	}
+	return found;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void Manager::clear_type_cache() const
+{
+	for (auto& entry : type_cache) {
+		entry = { nullptr, nullptr };
+	}
+	type_cache_next = 0;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -199,34 +295,47 @@ void Manager::set_package_verbosity(const Verbosity v, const bool set_modules)
     for (auto module : modules | (std::views::filter(module_exists) | std::views::filter(module_active))) {
       module->set_package_verbosity(v);
 		}
+		record_stale = true;
 	}
 }
 
+///////////////////////////////////////////////////////////////////////////////
+void Manager::set_compiled_record(const bool enable)
+{
+	if (enable && !compiled_record) {
+		compiled_record = new Record();
+	} else if (!enable) {
+		delete compiled_record;
+		compiled_record = nullptr;
+	}
+	record_stale	= true;
+	record_pending	= false;
+	record_current	= false;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 void Manager::measure()
 {
-  for (auto module : modules | (std::views::filter(module_exists) | std::views::filter(module_active))) {
-		// Not within LOOM_INCLUDE_SENSORS as Analog and Digital are always enabled
+	// Not within LOOM_INCLUDE_SENSORS as Analog and Digital are always enabled
+  for (auto sensor : sensors | std::views::filter(module_active)) {
     LMark;
-    if (dynamic_cast<Loom::Sensor*>(module)) {
-			((Sensor*)module)->measure();
-		}
+		sensor->measure();
+	}
 
 #ifdef LOOM_INCLUDE_SENSORS
-		else if (dynamic_cast<Loom::Multiplexer*>(module) ) {
-			((Multiplexer*)module)->measure();
-		}
-		// else if (dynamic_cast<Loom::TempSync*>(module)) {
-		// 	((TempSync*)module)->measure();
-		// }
+	for (auto multiplexer : multiplexers | std::views::filter(module_active)) {
+		multiplexer->measure();
+	}
+	// for (auto temp_sync : temp_syncs | std::views::filter(module_active)) {
+	// 	temp_sync->measure();
+	// }
 #endif // ifdef LOOM_INCLUDE_SENSORS
 
 #if (defined(LOOM_INCLUDE_WIFI) || defined(LOOM_INCLUDE_ETHERNET) || defined(LOOM_INCLUDE_LTE))
-		else if (dynamic_cast<Loom::NTPSync*>(module)) {
-			((NTPSync*)module)->measure();
-		}
-#endif // if (defined(LOOM_INCLUDE_WIFI) || defined(LOOM_INCLUDE_ETHERNET) || defined(LOOM_INCLUDE_LTE))
+	for (auto ntp_sync : ntp_syncs | std::views::filter(module_active)) {
+		ntp_sync->measure();
 	}
+#endif // if (defined(LOOM_INCLUDE_WIFI) || defined(LOOM_INCLUDE_ETHERNET) || defined(LOOM_INCLUDE_LTE))
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -246,6 +355,11 @@ void Manager::package(JsonObject json)
 ///////////////////////////////////////////////////////////////////////////////
 JsonObject Manager::package()
 {
+	if (compiled_record) {
+		package_record();
+		return internal_json();
+	}
+
 	doc.clear();
 	doc["type"] = "data";
 	JsonObject json = doc.as<JsonObject>();
@@ -257,6 +371,100 @@ JsonObject Manager::package()
 	return json;
 }
 
+///////////////////////////////////////////////////////////////////////////////
+void Manager::package_record()
+{
+	if (!compiled_record) {
+		package();
+		return;
+	}
+
+	// Recompile if the layout changed, either flagged by a module or
+	// detected while filling (e.g. a module packaged a different set of keys)
+	if ( (record_stale || !fill_record()) && (!compile_record() || !fill_record()) ) {
+		print_device_label();
+		LPrintln("Packaged data does not fit a compiled record, using json packaging");
+		set_compiled_record(false);
+		package();
+		return;
+	}
+
+	packet_number++;
+	record_pending = true;
+	record_current = true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool Manager::compile_record()
+{
+	Record& rec = *compiled_record;
+	rec.reset();
+	record_stale	= false;
+	record_pending	= false;
+	record_current	= false;
+
+	// Manager's own segment: device id and packet number
+	doc.clear();
+	JsonObject json = doc.to<JsonObject>();
+	add_device_ID_to_json(json);
+	get_module_data_object(json, "Packet")["Number"] = packet_number;
+	bool success = rec.add_segment(nullptr, json);
+
+	for (auto module : modules | (std::views::filter(module_exists) | std::views::filter(module_active))) {
+		if (!success) break;
+		doc.clear();
+		json = doc.to<JsonObject>();
+		module->package(json);
+		success = rec.add_segment(module, json);
+	}
+
+	doc.clear();
+	if (!success) rec.reset();
+	return success;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool Manager::fill_record()
+{
+	Record& rec = *compiled_record;
+	if (rec.segment_count() == 0) return false;
+	rec.begin_fill();
+
+	Record::Writer id = rec.writer(0);
+	id.add(device_name);
+	id.add(instance);
+	id.add(packet_number);
+	if (!id.valid()) return false;
+
+	uint8_t seg = 1;
+	for (auto module : modules | (std::views::filter(module_exists) | std::views::filter(module_active))) {
+		if ( (seg >= rec.segment_count()) || (rec.segment(seg).module != module) ) return false;
+
+		Record::Writer writer = rec.writer(seg);
+		if (module->package_record(writer)) {
+			if (!writer.valid()) return false;
+		} else {
+			// Module has no fast path, copy out of its json package
+			doc.clear();
+			JsonObject json = doc.to<JsonObject>();
+			module->package(json);
+			if (!rec.copy_segment(seg, json)) return false;
+		}
+		seg++;
+	}
+	return seg == rec.segment_count();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void Manager::render_record()
+{
+	if (record_pending) {
+		record_pending = false;
+		doc.clear();
+		compiled_record->to_json(doc.to<JsonObject>());
+	}
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 void Manager::add_device_ID_to_json(JsonObject json)
 {
@@ -271,8 +479,11 @@ JsonObject Manager::internal_json(const bool clear)
   LMark;
 	if (clear) {
 		// doc.clear();
+		record_pending = false;
+		record_current = false;
 		return doc.to<JsonObject>(); // clears in the process
 	} else {
+		render_record();
 		return doc.as<JsonObject>();
 	}
 
@@ -290,12 +501,11 @@ JsonObject Manager::internal_json(const bool clear)
 bool Manager::publish_all(const JsonObject json)
 {
   LMark;
-	auto is_publish_plat = [](Module *module) { return dynamic_cast<Loom::PublishPlat*>(module) != nullptr; };
 	bool result = true;
 	uint8_t count = 0;
   LMark;
-	for (auto module : modules | views::filter(module_exists) | views::filter(module_active) | views::filter(is_publish_plat) ) {
-    result &= ((PublishPlat*)module)->publish( json );
+	for (auto publish_plat : publish_plats | std::views::filter(module_active)) {
+    result &= publish_plat->publish( json );
 		count++;
 	}
 	return (count > 0) && result;
@@ -308,12 +518,25 @@ bool Manager::publish_all(const JsonObject json)
 bool Manager::log_all(const JsonObject json)
 {
   LMark;
-	auto is_log_plat = [](Module *module) { return dynamic_cast<Loom::LogPlat*>(module) != nullptr; };
+	bool result = true;
+	uint8_t count = 0;
+	for (auto log_plat : log_plats | std::views::filter(module_active)) {
+    result &= log_plat->log( json );
+		count++;
+	}
+	return (count > 0) && result;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool Manager::log_all()
+{
+	if (!get_record()) return log_all(internal_json());
 
+  LMark;
 	bool result = true;
 	uint8_t count = 0;
-	for (auto module : modules | ((std::views::filter(module_exists) | std::views::filter(module_active)) | std::views::filter(is_log_plat))) {
-    result &= ((LogPlat*)module)->log( json );
+	for (auto log_plat : log_plats | std::views::filter(module_active)) {
+    result &= log_plat->log();
 		count++;
 	}
 	return (count > 0) && result;
@@ -365,8 +588,9 @@ bool Manager::dispatch_self(JsonObject json)
 }
 
 ///////////////////////////////////////////////////////////////////////////////
-void Manager::display_data() const
+void Manager::display_data()
 {
+	render_record();
 	print_device_label();
 	LPrintln("Json:");
   LMark;
@@ -397,10 +621,133 @@ void Manager::free_modules()
 		delete module;
 	}
 	modules.clear();
+	tasks.clear();
+
+	categorize_modules();
+	clear_type_cache();
 
 	rtc_module = nullptr;
 	interrupt_manager = nullptr;
 	sleep_manager = nullptr;
+
+	// Record segments point to the freed modules
+	record_stale	= true;
+	record_pending	= false;
+	record_current	= false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void Manager::schedule(Module* module, const uint32_t period)
+{
+	if (module == nullptr) {
+		return;
+	}
+
+	print_device_label();
+	LPrintln("Scheduling ", module->get_module_name(), " every ", period, " ms");
+
+	// Rescheduling a module only changes its period
+	for (auto& task : tasks) {
+		if (task.module == module) {
+			task.timer.start(period, AsyncDelay::MILLIS);
+			return;
+		}
+	}
+
+	// Due on the first pass
+	Task task = { module, nullptr, AsyncDelay(period, AsyncDelay::MILLIS), false };
+	task.timer.expire();
+	tasks.emplace_back(task);
+
+	// Stop measuring it in measure()
+	categorize_modules();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void Manager::schedule(const TaskFuncPtr func, const uint32_t period)
+{
+	if (func == nullptr) {
+		return;
+	}
+
+	Task task = { nullptr, func, AsyncDelay(period, AsyncDelay::MILLIS), false };
+	task.timer.expire();
+	tasks.emplace_back(task);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void Manager::clear_schedule()
+{
+	tasks.clear();
+	categorize_modules();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool Manager::is_scheduled(const Module* module) const
+{
+	for (const auto& task : tasks) {
+		if (task.module == module) {
+			return true;
+		}
+	}
+	return false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+uint32_t Manager::poll()
+{
+	// Interrupt bottom halves and the InterruptManager's AsyncDelay timers
+	if (interrupt_manager) {
+		interrupt_manager->run_pending_ISRs();
+	}
+
+	uint32_t next = UINT32_MAX;
+	for (auto& task : tasks) {
+		if ( !task.busy ) {
+			if ( !task.timer.isExpired() ) {
+				next = std::min(next, time_until(task.timer));
+				continue;
+			}
+
+			// Keep the phase of the period, unless a whole period behind
+			task.timer.repeat();
+			if (task.timer.isExpired()) {
+				task.timer.restart();
+			}
+		}
+
+    LMark;
+		if (task.module) {
+			task.busy = task.module->get_active() && task.module->poll();
+		} else {
+			task.func();
+		}
+
+		next = task.busy ? 0 : std::min(next, time_until(task.timer));
+	}
+	return next;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void Manager::run(const uint32_t ms)
+{
+	LMark;
+	const unsigned long start = millis();
+	while (true) {
+		const uint32_t next		= poll();
+		const uint32_t elapsed	= millis() - start;
+		if (elapsed >= ms) {
+			break;
+		}
+
+		// Idle until the next task is due, in steps of at most a second
+		// like pause() so the watchdog is still marked.
+		// Modules with work in progress are waiting on a bus, so are polled
+		// again after a millisecond
+		const uint32_t wait = std::min<uint32_t>( std::min<uint32_t>(next, ms - elapsed), 1000 );
+		delay( (wait > 0) ? wait : 1 );
+		LMark;
+	}
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -609,6 +956,9 @@ bool Manager::parse_config_json(JsonObject config)
 	if (general.containsKey("package_verbosity")) {
 		this->package_verbosity = (Verbosity)(int)general["package_verbosity"];
 	}
+	if (general.containsKey("compiled_record")) {
+		set_compiled_record(general["compiled_record"]);
+	}
 
 	// Generate Module Objects
 	if (print_verbosity == Verbosity::V_HIGH) {
@@ -623,7 +973,12 @@ bool Manager::parse_config_json(JsonObject config)
 			print_device_label();
 			LPrintln("Invalid module key: '", modulekey["name"].as<String>(), "'");
 		}
+		// Checked before add_module(), which deletes inactive modules
+		const bool scheduled = (module != nullptr) && module->get_active() && modulekey.containsKey("period");
     add_module(module);
+		if (scheduled) {
+			schedule(module, modulekey["period"].as<uint32_t>());
+		}
 	}
 	config_count = config["components"].as<JsonArray>().size();
 
@@ -650,7 +1005,6 @@ bool Manager::parse_config_json(JsonObject config)
 ///////////////////////////////////////////////////////////////////////////////
 void Manager::package_fault(){
   if(FeatherFault::DidFault()) {
-    auto is_log_plat = [](Module *module) { return dynamic_cast<Loom::LogPlat*>(module) != nullptr; };
     doc.clear();
     doc["type"] = "data";
     JsonObject json = doc.as<JsonObject>();
@@ -676,11 +1030,11 @@ void Manager::package_fault(){
     publish_all(json);
     #endif // if (defined(LOOM_INCLUDE_WIFI) || defined(LOOM_INCLUDE_ETHERNET) || defined(LOOM_INCLUDE_LTE))
     LMark;
-    for (auto module : modules | ((std::views::filter(module_exists) | std::views::filter(module_active)) | std::views::filter(is_log_plat))) {
-      if(dynamic_cast<Loom::SD*>(module)){
+    for (auto log_plat : log_plats | std::views::filter(module_active)) {
+      if(log_plat->is<SD>()){
         File file;
         file.open("Errors.csv", O_WRONLY | O_CREAT | O_EXCL);
-        ((SD*)module)->save_json( json, "Errors.csv" );
+        static_cast<SD*>(log_plat)->save_json( json, "Errors.csv" );
       }
     }
   }
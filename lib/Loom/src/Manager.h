@@ -14,6 +14,7 @@
 #include "Misc.h"
 
 #include <ArduinoJson.h>
+#include <AsyncDelay.h>
 
 // Need to undef max and min for vector to work
 #undef max
@@ -30,13 +31,23 @@ class RTC;
 class WarmUpManager;
 class SleepManager;
 class InterruptManager;
+class Sensor;
+class Multiplexer;
+class NTPSync;
+class LogPlat;
+class PublishPlat;
+class CommPlat;
 
 
 #define SERIAL_BAUD		115200	///< Serial Baud Rate
 #define MAX_SERIAL_WAIT	20000	///< Maximum number of milliseconds to wait for user given 'begin_serial(true)'
+#define TYPE_CACHE_SIZE	8		///< Number of types get<T>() remembers the first module of
 #define SD_CS			10		///< SD chip select used in parse_config_SD().
 								///< You can still instantiate a Loom_SD module with a different chip select
 
+/// Function run periodically by Manager::poll()
+using TaskFuncPtr = void (*)();
+
 
 ///////////////////////////////////////////////////////////////////////////////
 ///
@@ -78,6 +89,36 @@ protected:
 	/// Vectors of Module pointers
 	std::vector<Module*>		modules;
 
+	/// Modules by category, in the order they were added.
+	/// Filled by add_module() so the per cycle loops don't need to check
+	/// the type of every module.
+	/// Scheduled modules are left out of the lists measure() uses
+	std::vector<Sensor*>		sensors;
+	std::vector<Multiplexer*>	multiplexers;
+	std::vector<NTPSync*>		ntp_syncs;
+	std::vector<LogPlat*>		log_plats;
+	std::vector<PublishPlat*>	publish_plats;
+	std::vector<CommPlat*>		comm_plats;
+
+	/// Entry of the get<T>() lookup cache
+	struct TypeCacheEntry {
+		TypeID		type;		///< Class looked up
+		Module*		module;		///< First module of that class, nullptr if there is none
+	};
+
+	mutable TypeCacheEntry	type_cache[TYPE_CACHE_SIZE] = {};	///< Recent get<T>() results, cleared when modules change
+	mutable uint8_t			type_cache_next = 0;				///< Entry of type_cache to replace next
+
+	/// A module or function run periodically by poll()
+	struct Task {
+		Module*		module;		///< Module to poll, nullptr if a function
+		TaskFuncPtr	func;		///< Function to run, nullptr if a module
+		AsyncDelay	timer;		///< Time until the task is next due
+		bool		busy;		///< Whether the module's poll() has work in progress
+	};
+
+	std::vector<Task>		tasks;		///< Tasks run by poll(), in the order scheduled
+
 	Verbosity	print_verbosity;		///< Print detail verbosity
 	Verbosity	package_verbosity;		///< Package detail verbosity
 
@@ -85,6 +126,11 @@ protected:
 
 	uint16_t		packet_number = 1;		///< Packet number, incremented each time package is called
 
+	Record*		compiled_record = nullptr;	///< Compiled record, nullptr unless compiled record mode is enabled
+	bool		record_stale	= false;	///< Whether module layout changed since the record was compiled
+	bool		record_pending	= false;	///< Whether record holds values not yet rendered into doc
+	bool		record_current	= false;	///< Whether record holds the most recently packaged data
+
 	uint8_t		config_count = -1;
 
 public:
@@ -169,13 +215,20 @@ public:
 	void		package(JsonObject json);
 
 	/// Measure and package data.
-	/// Convenience function, current just calls measure then package
-	void		record() { measure(); package(); }
+	/// Convenience function, current just calls measure then package_record
+	void		record() { measure(); package_record(); }
 
 	/// Package data of all modules into JsonObject and return
 	/// @return JsonObject of packaged data of enabled modules
 	JsonObject	package();
 
+	/// Package data of all modules without building json.
+	/// In compiled record mode, values are written into the compiled record
+	/// and the internal json is only built when next requested
+	/// (internal_json(), log_all(), publish_all(), ...).
+	/// Otherwise the same as package()
+	void		package_record();
+
 	#if (defined(LOOM_INCLUDE_WIFI) || defined(LOOM_INCLUDE_ETHERNET) || defined(LOOM_INCLUDE_LTE))
 	/// Publish
 	/// @param[in]	json	Data object to publish
@@ -194,9 +247,11 @@ public:
 	bool		log_all(const JsonObject json);
 
 	/// Log.
-	/// Calls log_all(const JsonObject json) with interal json
+	/// Calls log_all(const JsonObject json) with interal json, or with a
+	/// compiled record, each log platform's log() so that ones storing
+	/// records (BinarySD) take it without the json being built
 	/// @return True if success
-	bool		log_all() { return log_all(internal_json()); }
+	bool		log_all();
 
 	/// Iterate over list of commands, forwarding to handling module
 	/// @param[in] json		Object containing commands
@@ -207,12 +262,50 @@ public:
 	void		dispatch() { dispatch( internal_json() ); }
 
 	/// Delay milliseconds.
+	/// Nothing else runs in the meantime, see run() for that
 	void		pause(const uint32_t ms) const;
 
 	/// Delay milliseconds based on interval member.
 	/// Uses interval member as value
 	void		pause() const { pause(interval); }
 
+//=============================================================================
+///@name	SCHEDULER
+/*@{*/ //======================================================================
+
+	/// Poll a module every period instead of measuring it in measure().
+	/// Lets fast sensors sample at their own rate while modules on slow
+	/// buses measure in steps between other work.
+	/// Can also be set with a "period" key in a module's configuration
+	/// @param[in]	module	Module to poll, must already be added
+	/// @param[in]	period	Milliseconds between the start of each poll
+	void		schedule(Module* module, const uint32_t period);
+
+	/// Run a function every period, e.g. one that packages and logs
+	/// @param[in]	func	Function to run
+	/// @param[in]	period	Milliseconds between the start of each run
+	void		schedule(const TaskFuncPtr func, const uint32_t period);
+
+	/// Remove all scheduled modules and functions.
+	/// Modules are measured by measure() again
+	void		clear_schedule();
+
+	/// Run one pass of the scheduler: pending interrupt bottom halves and
+	/// timers of the InterruptManager, then every task that is due or has
+	/// work in progress. Call from loop() as often as possible
+	/// @return Milliseconds until a task is next due, 0 if one is in progress
+	uint32_t	poll();
+
+	/// Run the scheduler for a number of milliseconds.
+	/// Use in place of pause() to keep scheduled tasks running,
+	/// idling with delay() while none is due
+	/// (a millisecond at a time while a module has work in progress)
+	/// @param[in]	ms		Milliseconds to run for
+	void		run(const uint32_t ms);
+
+	/// Run the scheduler for the interval member
+	void		run() { run(interval); }
+
 	/// Iterate over modules, calling power up method
 	void 		power_up();
 
@@ -251,6 +344,8 @@ public:
 	template<typename T>
 	bool add_data(const char* module, const char* key, const T val)
 	{
+		render_record();
+		record_current = false;
 		if ( doc.isNull() ) {
 			doc["type"] = "data";
 		}
@@ -274,6 +369,7 @@ public:
 	template<typename T>
 	T get_data_as(const char* module, const char* key)
 	{
+		render_record();
 		JsonObject json = doc.as<JsonObject>();
 		JsonArray contents = json["contents"];
 		if (!contents.isNull()) {
@@ -311,7 +407,7 @@ public:
 	void 		list_modules() const;
 
 	/// Print out the internal JSON object
-	void		display_data() const;
+	void		display_data();
 
 //=============================================================================
 ///@name	ADD MODULE TO MANAGER
@@ -333,6 +429,15 @@ public:
 	/// @return Reference to internal json object
 	JsonObject	internal_json(const bool clear = false);
 
+	/// Get the compiled record holding the most recently packaged data.
+	/// @return Record, nullptr if compiled record mode is disabled or
+	///			internal json has been modified since the last package_record()
+	const Record*	get_record() const { return record_current ? compiled_record : nullptr; }
+
+	/// Get whether compiled record mode is enabled
+	/// @return True if enabled
+	bool		get_compiled_record() const { return compiled_record != nullptr; }
+
 	/// Get the device name, copies into provided buffer.
 	/// @param[out]	buf		The buffer copy device name into
 	void 		get_device_name(char* buf);
@@ -384,6 +489,21 @@ public:
 	/// this value will be used
 	void		set_interval(const uint16_t ms);
 
+	/// Enable or disable compiled record mode.
+	/// When enabled, the layout of packaged data is compiled once and
+	/// package() / package_record() fill a flat record instead of
+	/// rebuilding the json tree each cycle.
+	/// The record is compiled on the next package, falling back to json
+	/// packaging if the data can't be held in a record.
+	/// Can also be enabled with "compiled_record":true in the general config.
+	/// @param[in]	enable	True to enable
+	void		set_compiled_record(const bool enable);
+
+	/// Mark the compiled record as out of date.
+	/// Modules call this (via Module::invalidate_record()) when a setting
+	/// changes which keys they package. The record is recompiled on the next package
+	void		invalidate_record() { record_stale = true; }
+
 //=============================================================================
 ///@name	MISCELLANEOUS
 /*@{*/ //======================================================================
@@ -403,9 +523,12 @@ public:
 ///@name	MODULE ACCESS
 /*@{*/ //======================================================================
 
-	/// Auxiliary function to search a list of modules for a module of specified type
-	/// @param[in]	type	Type to search for
-	// Module*	find_module(const Module::Type type, const uint8_t idx=0) const;
+	/// Auxiliary function to search a list of modules for a module of specified type.
+	/// The first module of recently searched types is cached
+	/// @param[in]	type	Type to search for, from type_id<T>()
+	/// @param[in]	idx		Which module of that type to get
+	/// @return Module of the type or derived from it, nullptr if none
+	Module*	find_module(const TypeID type, const uint8_t idx=0) const;
 
 	/// Auxiliary function to search a list of modules for a module of specified category
 	/// @param[in]	category	Category to search for
@@ -413,20 +536,12 @@ public:
 
 	///////////////////////////////////////////////////////////////////////////
 
+	/// Get a module of a class, or derived from it
+	/// @param[in]	idx		Which module of that class to get
+	/// @return The module, nullptr if none
 	template <typename T>
 	T* get(const uint8_t idx=0) const {
-		uint8_t count = 0;
-		for (auto module : modules) {
-			auto tmp = dynamic_cast<T*>(module);
-			if ( tmp ) {
-				if (count < idx) {
-					count++;
-				} else {
-					return tmp;
-				}
-			}
-		}
-		return nullptr;
+		return static_cast<T*>( find_module(type_id<T>(), idx) );
 	}
 
 protected:
@@ -443,6 +558,7 @@ private:
 	friend class SD;
 	friend class BatchSD;
 	friend class NTPSync;
+	friend class CommPlat;
 
 	InterruptManager*	get_interrupt_manager() { return interrupt_manager; }
 	SleepManager*		get_sleep_manager() { return sleep_manager; }
@@ -455,8 +571,31 @@ private:
 	/// Used in destructor or when switching configuration
 	void free_modules();
 
+	/// Add a module to the category lists it belongs to
+	void categorize_module(Module* module);
+
+	/// Rebuild the category lists from all modules
+	void categorize_modules();
+
+	/// Check whether a module is polled by the scheduler
+	bool is_scheduled(const Module* module) const;
+
+	/// Forget cached get<T>() results
+	void clear_type_cache() const;
+
 	/// Run dispatch on any commands directed to the manager
 	bool dispatch_self(JsonObject json);
 
+	/// Build the record schema from one json package of each module.
+	/// @return True if all packaged data fits in a record
+	bool compile_record();
+
+	/// Fill the record with current values of each module.
+	/// @return False if the data no longer matches the schema
+	bool fill_record();
+
+	/// Build internal json from the record if it has not been yet
+	void render_record();
+
 };
 }
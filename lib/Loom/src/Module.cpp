@@ -9,6 +9,7 @@
 ///////////////////////////////////////////////////////////////////////////////
 
 #include "Module.h"
+#include "Manager.h"
 
 using namespace Loom;
 
@@ -30,6 +31,14 @@ void Module::link_device_manager(Manager* LM)
 	device_manager = LM;
 }
 
+///////////////////////////////////////////////////////////////////////////////
+void Module::invalidate_record()
+{
+	if (device_manager) {
+		device_manager->invalidate_record();
+	}
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 void Module::print_module_label() const
 {
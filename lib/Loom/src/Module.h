@@ -12,6 +12,7 @@
 
 #include "Misc.h"
 #include "Package.h"
+#include "Record.h"
 #include "Module_Factory.h"
 #include "Macros.h"
 
@@ -25,6 +26,29 @@ namespace Loom {
 
 class Manager; // Specify that Manager exists, defined in own file
 
+///////////////////////////////////////////////////////////////////////////////
+
+/// Identifies a module class, see LOOM_MODULE_TYPE
+using TypeID = const void*;
+
+/// Get the identifier of a class.
+/// The address of a static that each instantiation has its own copy of,
+/// so no RTTI is needed
+/// @return Identifier of T
+template <typename T>
+TypeID type_id() { static char id; return &id; }
+
+/// Declare a module class's place in the inheritance tree, so Module::is<T>()
+/// and Manager::get<T>() can check the type of a module without dynamic_cast.
+/// Must be the first thing in the body of every class derived from Module
+/// (it leaves the access specifier at private, the default of a class)
+/// @param	Class	The class being declared
+/// @param	Base	The class it derives from
+#define LOOM_MODULE_TYPE(Class, Base) \
+	public: \
+	bool is_type(const Loom::TypeID id) const override { return (id == Loom::type_id<Class>()) || Base::is_type(id); } \
+	private:
+
 ///////////////////////////////////////////////////////////////////////////////
 ///
 /// Abstract root of Loom component modules inheritance hierarchy.
@@ -42,7 +66,7 @@ public:
 	/// Enum to check against to when finding individual component
 	/// managed by a Manager.
 	/// Used because we cannot use dynamic_cast to check type of modules
-	/// (rtti disabled by Arduino IDE)
+	/// (rtti disabled by Arduino IDE), see LOOM_MODULE_TYPE instead
 	// enum class Type {
 	// 	Unknown = 0,
 	// 	// Other
@@ -133,9 +157,24 @@ public:
 	/// @param[out]	json	Object to put data into
 	virtual void 	package(JsonObject json) = 0;
 
+	/// Package a modules measurements or state into a compiled record.
+	/// Values must be added in the same order and with the same types
+	/// that package(JsonObject) adds keys.
+	/// Only used when the Manager is in compiled record mode.
+	/// @param[out]	record	Writer over this module's columns
+	/// @return False if not implemented, in which case package(JsonObject) is used
+	virtual bool	package_record(Record::Writer& record) { return false; }
+
 	/// Route command to driver
 	virtual bool	dispatch(JsonObject json) {};
 
+	/// Take one non-blocking step of the module's periodic work.
+	/// Called by Manager::poll() when the period the module was scheduled
+	/// with elapses, then again on every pass while it returns true.
+	/// Slow modules return between steps rather than calling delay()
+	/// @return True if work is still in progress
+	virtual bool	poll() { return false; }
+
 	/// Turn off any hardware
 	virtual void	power_down() {}
 
@@ -192,6 +231,17 @@ public:
 	/// Get the category of the module.
 	// Category		category() const;
 
+	/// Check whether the module is of a class or derived from it.
+	/// Overridden by LOOM_MODULE_TYPE in each derived class
+	/// @param[in]	id	Identifier of the class, from type_id<T>()
+	/// @return True if the module is of that class
+	virtual bool	is_type(const TypeID id) const { return id == type_id<Module>(); }
+
+	/// Check whether the module is a T or derived from T
+	/// @return True if the module can be cast to T
+	template <typename T>
+	bool			is() const { return is_type(type_id<T>()); }
+
 //=============================================================================
 ///@name	SETTERS
 /*@{*/ //======================================================================
@@ -241,6 +291,11 @@ protected:
 	/// Used for matching debug prints to corresponding module
 	void			print_module_label() const;
 
+	/// Notify the Manager that the keys or types this module packages
+	/// have changed, so a compiled record needs to be rebuilt.
+	/// Call from setters that change what package() produces
+	void			invalidate_record();
+
 private:
 
 
@@ -15,10 +15,10 @@
 #include "Macros.h"
 #include <ArduinoJson.h>
 
-// Need to undef max and min for vector to work
+// Need to undef max and min for standard headers to work
 #undef max
 #undef min
-#include <vector>
+#include <type_traits>
 
 namespace Loom {
 
@@ -35,9 +35,31 @@ template <class S, class T>
 S* ConstructDefaultJson(JsonArrayConst p) { return new T(p); }
 
 
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef LOOM_REGISTRY_SIZE
+#define LOOM_REGISTRY_SIZE	64		///< Most classes a Registry can hold
+#endif
+
+/// FNV-1a hash of a registry name.
+/// constexpr so REGISTER() hashes names at compile time
+/// @param[in]	name	Name to hash
+/// @return Hash of name
+constexpr uint32_t registry_hash(const char* name)
+{
+	uint32_t hash = 2166136261UL;
+	for ( ; *name; name++) {
+		hash = (hash ^ (uint8_t)*name) * 16777619UL;
+	}
+	return hash;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 /// A generic registry/factory that collects constructors of a give base type and allows for any number
 /// of base classes as static singleton templates will only create new instances of a new type is introduced
+///
+/// Entries live in a fixed size array (no heap) sorted by the hash of their
+/// name, so lookups are a binary search and a single strcmp
 template <typename T>
 class Registry
 {
@@ -47,20 +69,24 @@ public:
 	using FactoryFunctionJson = T* (*)(JsonArrayConst);
 	using FactoryPair = struct
 	{										///<  *Needed as an alternative to std::map
+		uint32_t hash;						///< registry_hash() of name
 		const char* name;					///< Name of module that will be used to make a new copy
-		const FactoryFunction ctor;			///< Pointer to the Creation function which will be used to CTOR
-		const FactoryFunctionJson ctorJson; ///< Pointer to the CreationJSON function which will be used to CTOR form JSON
+		FactoryFunction ctor;				///< Pointer to the Creation function which will be used to CTOR
+		FactoryFunctionJson ctorJson;		///< Pointer to the CreationJSON function which will be used to CTOR form JSON
 	};
 
 
 	template <class U>
-	static bool add(const char*);
+	static bool add(const char* name, const uint32_t hash);
 
 	template <class U>
-	static bool addNoJson(const char*);
+	static bool addNoJson(const char* name, const uint32_t hash);
 
 	template <class U>
-	static bool addNoDefault(const char*);
+	static bool addNoDefault(const char* name, const uint32_t hash);
+
+	template <class U>
+	static bool add(const char* name) { return add<U>(name, registry_hash(name)); }
 
 	static T* create(const char*);	///< Returns an instance of type T created by using the FactoryFunction coresponding to the provided name
 	static T *create(JsonVariant);	///< Returns an instance of type T created from provided JSON
@@ -69,51 +95,98 @@ public:
 
 private:
 
-	static bool add(const char*, const FactoryFunction, const FactoryFunctionJson); ///< Adds a new Factory Pair derived from args to lookup table
+	/// Sorted entries
+	struct FactoryTable {
+		FactoryPair	entries[LOOM_REGISTRY_SIZE];
+		uint8_t		count;
+	};
+
+	static bool add(const char*, const uint32_t, const FactoryFunction, const FactoryFunctionJson); ///< Adds a new Factory Pair derived from args to lookup table
+
+	/// Find the entry of a name
+	/// @return Entry, nullptr if not registered
+	static const FactoryPair* find(const char* name, const uint32_t hash);
+
+	/// Index of the first entry whose hash is not less than hash
+	static uint8_t lower_bound(const uint32_t hash);
 
 	/// Use Meyer's singleton to prevent SIOF
-	static std::vector<FactoryPair>& getFactoryTable();
+	/// (zero initialized, so no constructor runs)
+	static FactoryTable& getFactoryTable();
 };
 
 ///////////////////////////////////////////////////////////////////////////////
 // Registers a module that hasn't implemented a default constructor
 template <typename T>
 template <class U>
-bool Registry<T>::addNoDefault(const char* name)
+bool Registry<T>::addNoDefault(const char* name, const uint32_t hash)
 {
-	return add(name, nullptr, ConstructDefaultJson<T, U>);
+	return add(name, hash, nullptr, ConstructDefaultJson<T, U>);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 // Registers a module that hasn't implemented a JSON constructor
 template <typename T>
 template <class U>
-bool Registry<T>::addNoJson(const char* name)
+bool Registry<T>::addNoJson(const char* name, const uint32_t hash)
 {
-	return add(name, ConstructDefault<T, U>, nullptr);
+	return add(name, hash, ConstructDefault<T, U>, nullptr);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 template <typename T>
 template <class U>
-bool Registry<T>::add(const char* name)
+bool Registry<T>::add(const char* name, const uint32_t hash)
+{
+	return add(name, hash, ConstructDefault<T, U>, ConstructDefaultJson<T, U>);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+template <typename T>
+uint8_t Registry<T>::lower_bound(const uint32_t hash)
 {
-	return add(name, ConstructDefault<T, U>, ConstructDefaultJson<T, U>);
+	const FactoryTable& table = getFactoryTable();
+	uint8_t lo = 0, hi = table.count;
+	while (lo < hi) {
+		const uint8_t mid = (lo + hi) / 2;
+		if (table.entries[mid].hash < hash)	lo = mid + 1;
+		else								hi = mid;
+	}
+	return lo;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 template <typename T>
-bool Registry<T>::add(const char* name, const Registry<T>::FactoryFunction ctor, const Registry<T>::FactoryFunctionJson ctorJson)
+const typename Registry<T>::FactoryPair* Registry<T>::find(const char* name, const uint32_t hash)
 {
-	auto lookUp = getFactoryTable();
-	for (auto elem : lookUp) {
-		// Add string processing for fuzzy search and debug suggestions?
-		if (!strcmp(name, elem.name)) {
-			return false; // On match, fail. Items two items cannot have the same creation name;
+	const FactoryTable& table = getFactoryTable();
+	// Names with the same hash are adjacent
+	for (uint8_t i = lower_bound(hash); i < table.count && table.entries[i].hash == hash; i++) {
+		if (!strcmp(name, table.entries[i].name)) {
+			return &table.entries[i];
 		}
-	} // No match found, exiting for
+	}
+	return nullptr;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+template <typename T>
+bool Registry<T>::add(const char* name, const uint32_t hash, const Registry<T>::FactoryFunction ctor, const Registry<T>::FactoryFunctionJson ctorJson)
+{
+	// Items two items cannot have the same creation name.
+	// Also rejects the repeated registration from every file including a module's header
+	if (find(name, hash)) return false;
 
-	getFactoryTable().push_back(FactoryPair{name, ctor, ctorJson});
+	FactoryTable& table = getFactoryTable();
+	if (table.count == LOOM_REGISTRY_SIZE) return false;	// Increase LOOM_REGISTRY_SIZE
+
+	// Insert in hash order
+	const uint8_t pos = lower_bound(hash);
+	for (uint8_t i = table.count; i > pos; i--) {
+		table.entries[i] = table.entries[i-1];
+	}
+	table.entries[pos] = FactoryPair{hash, name, ctor, ctorJson};
+	table.count++;
 	return true;
 }
 
@@ -121,13 +194,10 @@ bool Registry<T>::add(const char* name, const Registry<T>::FactoryFunction ctor,
 template <typename T>
 T* Registry<T>::create(const char* name)
 {
-	auto lookUp = getFactoryTable();
-	for (auto elem : lookUp) {
-		// Add string processing for fuzzy search and debug suggestions?
-		if (!strcmp(name, elem.name) && elem.ctor) {
-			return elem.ctor(); // On match, return a *new* item of type name
-		}
-	} // No match found, exiting for
+	const FactoryPair* elem = find(name, registry_hash(name));
+	if (elem && elem->ctor) {
+		return elem->ctor(); // On match, return a *new* item of type name
+	}
 	return nullptr;
 }
 
@@ -136,42 +206,40 @@ template <typename T>
 T *Registry<T>::create(JsonVariant target)
 {
 	const char* name = target["name"].as<const char*>();
+	if (!name) return nullptr;
+
+	const FactoryPair* elem = find(name, registry_hash(name));
+	if (!elem) return nullptr;	// No match found
 
-	for (auto elem : getFactoryTable()) {
-		if (strcmp(name, elem.name) == 0) {
-
-			// Parameters are provided and a ctor exists to accept json parameters
-			if (elem.ctorJson && target["params"].is<JsonArray>()) {
-				// Generate according to list of parameters
-				return elem.ctorJson(target["params"].as<JsonArrayConst>());
-			}
-
-			// 'params' key exists, but simply specifies 'default' (for legacy configs)
-			else if (target["params"].is<const char*>() && strcmp(target["params"], "default") == 0 ) {
-				if (elem.ctor) {
-					return elem.ctor();
-				} else {
-					LPrintln("Module [", name, "] does not have default settings, please provides params");
-					return nullptr;
-				}
-			}
-
-			// 'params' key omitted, assume default settings if default ctor available
-			// If 'params' does exist and wasn't covered by the above two cases, assume there is
-			// something wrong with the parameters and let the else case catch it instead
-			else if (elem.ctor && !target["params"]) {
-				return elem.ctor();
-			}
-
-			// Something was wrong with the config or the user specified to use a ctor
-			// that didn't exist
-			else {
-				LPrintln("Check the config for component: ", name);
-				return nullptr;
-			}
+	// Parameters are provided and a ctor exists to accept json parameters
+	if (elem->ctorJson && target["params"].is<JsonArray>()) {
+		// Generate according to list of parameters
+		return elem->ctorJson(target["params"].as<JsonArrayConst>());
+	}
+
+	// 'params' key exists, but simply specifies 'default' (for legacy configs)
+	else if (target["params"].is<const char*>() && strcmp(target["params"], "default") == 0 ) {
+		if (elem->ctor) {
+			return elem->ctor();
+		} else {
+			LPrintln("Module [", name, "] does not have default settings, please provides params");
+			return nullptr;
 		}
-	} // No match found, exiting for
-	return nullptr;
+	}
+
+	// 'params' key omitted, assume default settings if default ctor available
+	// If 'params' does exist and wasn't covered by the above two cases, assume there is
+	// something wrong with the parameters and let the else case catch it instead
+	else if (elem->ctor && !target["params"]) {
+		return elem->ctor();
+	}
+
+	// Something was wrong with the config or the user specified to use a ctor
+	// that didn't exist
+	else {
+		LPrintln("Check the config for component: ", name);
+		return nullptr;
+	}
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -179,36 +247,37 @@ T *Registry<T>::create(JsonVariant target)
 /// the compiler only expects a single instance to ever exist
 /// Due to this behavior, we can use this:
 template <typename T>
-std::vector<typename Registry<T>::FactoryPair>& Registry<T>::getFactoryTable()
+typename Registry<T>::FactoryTable& Registry<T>::getFactoryTable()
 {
-	static std::vector<FactoryPair> lookUpTable;
+	static FactoryTable lookUpTable;
 	return lookUpTable;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
-#include <typeinfo>
-
 template <typename T>
 void Registry<T>::print_registry()
 {
-	auto lookUp = getFactoryTable();
-	LPrintln(typeid(T).name(), " Factory [", lookUp.size(), " classes]");
+	const FactoryTable& lookUp = getFactoryTable();
+	LPrintln("Factory [", lookUp.count, " classes]");
 
-	for (auto elem : lookUp) {
-		LPrintln(" - ", elem.name);
+	for (uint8_t i = 0; i < lookUp.count; i++) {
+		LPrintln(" - ", lookUp.entries[i].name);
 	}
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
+/// Key's hash as a compile time constant
+#define REGISTRY_HASH(Key) std::integral_constant<uint32_t, registry_hash(Key)>::value
+
 #define REGISTER(Factory, ModuleName, Key) \
-	static const bool ModuleName##_entry = Registry<Factory>::add<ModuleName>(Key)
+	static const bool ModuleName##_entry = Registry<Factory>::add<ModuleName>(Key, REGISTRY_HASH(Key))
 
 #define REGISTER_NODEFAULT(Factory, ModuleName, Key) \
-	static const bool ModuleName##_entry = Registry<Factory>::addNoDefault<ModuleName>(Key)
+	static const bool ModuleName##_entry = Registry<Factory>::addNoDefault<ModuleName>(Key, REGISTRY_HASH(Key))
 
 #define REGISTER_NOJSON(Factory, ModuleName, Key) \
-	static const bool ModuleName##_entry = Registry<Factory>::addNoJson<ModuleName>(Key)
+	static const bool ModuleName##_entry = Registry<Factory>::addNoJson<ModuleName>(Key, REGISTRY_HASH(Key))
 
 ///////////////////////////////////////////////////////////////////////////////
 
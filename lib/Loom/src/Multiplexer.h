@@ -58,6 +58,8 @@ const I2C_Selection i2c_0x36 = I2C_Selection::L_STEMMA;
 ///////////////////////////////////////////////////////////////////////////////
 class Multiplexer : public Module
 {
+	LOOM_MODULE_TYPE(Multiplexer, Module)
+
 private:
 
 	/// List of known I2C addresses used by Loom.
@@ -116,6 +118,10 @@ public:
 	/// Call measure on all connected sensors
 	void		measure();
 
+	/// Measure all sensors when scheduled with Manager::schedule()
+	/// @return False, measuring does not take several steps
+	bool		poll() override { measure(); return false; }
+
 	void		package(JsonObject json) override;
 	bool		dispatch(JsonObject) override {}
 
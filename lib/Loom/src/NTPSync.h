@@ -31,6 +31,7 @@ namespace Loom {
 
 class NTPSync : public Module
 {
+	LOOM_MODULE_TYPE(NTPSync, Module)
 
 public:
 
@@ -64,6 +65,11 @@ public:
 	/// Allows the module to run regularly by emulating a sensor, which have
 	/// thier measure methods called regularly.
 	void		measure();
+
+	/// Sync the time when scheduled with Manager::schedule()
+	/// @return False, syncing does not take several steps
+	bool		poll() override { measure(); return false; }
+
 	void		package(JsonObject json) override { /* do nothing */ };
 	bool		dispatch(JsonObject) override { /* do nothing */}
 
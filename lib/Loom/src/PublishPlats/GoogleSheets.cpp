@@ -48,21 +48,94 @@ void GoogleSheets::print_config() const
 	LPrint("\t Tab ID: ", m_tab_id, "\n");
 }
 
+///////////////////////////////////////////////////////////////////////////////
+/// Counts the bytes printed to it, to measure a body before sending it
+struct CountingPrint : public Print {
+	uint32_t count = 0;
+	size_t write(uint8_t) override { count++; return 1; }
+	size_t write(const uint8_t* buffer, size_t size) override { count += size; return size; }
+};
+
 ///////////////////////////////////////////////////////////////////////////////
 bool GoogleSheets::send_to_internet(const JsonObject json, InternetPlat* plat)
 {
-  LMark;
-	// connect to script.google.com
-	auto network = plat->connect_to_domain("script.google.com");
-	// check if we connected
-	if (!network) {
-		print_module_label();
-		LPrintln("Could not connect to script.google.com");
-		return false;
-	}
+	return m_request(plat, [&](Client& network) {
+		write_publish_request(json, network);
+		return true;
+	});
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void GoogleSheets::write_publish_request(const JsonObject json, Print& network)
+{
 	// start writing data to the network
 	// print the initial http request
-	network->print("GET ");
+	network.print("GET ");
+	m_write_url(network);
+	network.print("&key3=full_data&val3=");
+	// next print the body data, converted in real time
+	m_serialize_internet_impl(json, network);
+
+	// that should finish off the URL, so print the rest of the HTTP request
+	network.print(" HTTP/1.1\r\nUser-Agent: LoomOverSSLClient\r\nHost: script.google.com\r\nConnection: keep-alive\r\n\r\n");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int GoogleSheets::send_batch_to_internet(BatchSD& batch, InternetPlat* plat)
+{
+	const int packets = batch.get_packet_counter();
+	int drop_count = 0;
+	for (int first = 0; first < packets; first += SHEETS_BATCH_ROWS) {
+		const int count = (packets - first < SHEETS_BATCH_ROWS) ? packets - first : SHEETS_BATCH_ROWS;
+		drop_count += m_send_rows(batch, first, count, plat);
+	}
+	return drop_count;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int GoogleSheets::m_send_rows(BatchSD& batch, const int first, const int count, InternetPlat* plat)
+{
+  LMark;
+	// the length of the body goes before it, so serialize the rows once to measure them
+	CountingPrint measure;
+	int rows = 0;
+	for (int i = first; i < first + count; i++) {
+		const JsonObject json = batch.get_batch_json(i);
+		if (!m_validate_json(json)) continue;
+		m_serialize_internet_impl(json, measure);
+		measure.write('\n');
+		rows++;
+	}
+	if (rows == 0) return count;
+	print_module_label();
+	LPrint("Publishing ", rows, " rows in ", measure.count, " bytes\n");
+
+	const bool sent = m_request(plat, [&](Client& network) {
+		network.print("POST ");
+		m_write_url(network);
+		network.print(" HTTP/1.1\r\nUser-Agent: LoomOverSSLClient\r\nHost: script.google.com\r\nConnection: keep-alive\r\n");
+		network.print("Content-Type: text/plain\r\nContent-Length: ");
+		network.print(measure.count);
+		network.print("\r\n\r\n");
+		// then stream the rows, one per line, read from the batch again
+		CountingPrint written;
+		for (int i = first; i < first + count; i++) {
+			const JsonObject json = batch.get_batch_json(i);
+			if (!m_validate_json(json)) continue;
+			m_serialize_internet_impl(json, network);
+			m_serialize_internet_impl(json, written);
+			network.print('\n');
+			written.write('\n');
+		}
+		// a packet read differently the second time leaves a body of the wrong length
+		return written.count == measure.count;
+	});
+	return sent ? count - rows : count;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void GoogleSheets::m_write_url(Print& network)
+{
   LMark;
 	// construct the URL from a bunch of different segments
 	// start with the sheet metadata base, referenced from the following snprintf statement:
@@ -72,10 +145,10 @@ bool GoogleSheets::send_to_internet(const JsonObject json, InternetPlat* plat)
 		tab_id,					// Tab to write to
 		device_id);				// The bundle source's device ID */
 
-	network->print(m_script_url);
-	network->print("?key0=sheetID&val0=");
-	network->print(m_sheet_id);
-	network->print("&key1=tabID&val1=");
+	network.print(m_script_url);
+	network.print("?key0=sheetID&val0=");
+	network.print(m_sheet_id);
+	network.print("&key1=tabID&val1=");
 	char buf[20];
 	if( device_manager ) {
    	LMark;
@@ -85,42 +158,22 @@ bool GoogleSheets::send_to_internet(const JsonObject json, InternetPlat* plat)
 	if ((tab_matches_dev_id && device_manager) || (device_manager && strstr(buf, "Errors"))){
    	LMark;
 		snprintf(buf, 20, "%s%d", buf, device_manager->get_instance_num());
-		network->print(buf);
+		network.print(buf);
 	} else {
-		network->print(m_tab_id);
+		network.print(m_tab_id);
 	}
 
-	network->print("&key2=deviceID&val2=");
+	network.print("&key2=deviceID&val2=");
 
 	// Get device ID from manager
 	if (device_manager) {
 		if(strstr(buf, "Errors")) device_manager->get_device_name(buf);
    	LMark;
 		snprintf(buf, 20, "%s%d", buf, device_manager->get_instance_num());
-		network->print(buf);
+		network.print(buf);
 	} else {
-		network->print("Unknown");
+		network.print("Unknown");
 	}
-
-	network->print("&key3=full_data&val3=");
-	// next print the body data, converted in real time
-	m_serialize_internet_impl(json, *network);
-
-	// that should finish off the URL, so print the rest of the HTTP request
-	network->print(" HTTP/1.1\r\nUser-Agent: LoomOverSSLClient\r\nHost: script.google.com\r\nConnection: close\r\n\r\n");
-	// all ready to go!
-	if (!network->connected()) {
-		print_module_label();
-		LPrintln("Internet disconnected during transmission!");
-		return false;
-	}
-	// flush all that
-	network->flush();
-	// all done!
-	print_module_label();
-	LPrint("Published successfully!\n");
-
-	return true;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -130,7 +183,6 @@ bool GoogleSheets::m_serialize_internet_impl(const JsonObject json, Print& write
 	const JsonObject time_obj = json["timestamp"];
   LMark;
 	for (const JsonPair i : time_obj) {
-		print_module_label();
    	LMark;
 		write.print(i.key().c_str());
 		write.print('~');
@@ -15,10 +15,20 @@
 
 namespace Loom {
 
+///////////////////////////////////////////////////////////////////////////////
+
+#define SHEETS_BATCH_ROWS	50	///< Most batch packets published as rows of one request
+
+
 ///////////////////////////////////////////////////////////////////////////////
 ///
 /// Module taking in and translating JSON into data understood by the Google Sheets script API.
 ///
+/// A single packet is published as a GET request, its data in the URL. The packets
+/// of a batch are published SHEETS_BATCH_ROWS at a time in the body of a POST request,
+/// one row per line in the same key~value format, which the script appends with
+/// one setValues() call.
+///
 /// @par Resources
 /// - [Module Documentation](https://openslab-osu.github.io/Loom/html/class_loom___google_sheets.html)
 /// - [wiki: Using Loom with Google Sheets](https://github.com/OPEnSLab-OSU/Loom/wiki/Using-Loom-with-Google-Sheets)
@@ -26,6 +36,7 @@ namespace Loom {
 ///////////////////////////////////////////////////////////////////////////////
 class GoogleSheets : public PublishPlat
 {
+	LOOM_MODULE_TYPE(GoogleSheets, PublishPlat)
 
 public:
 
@@ -75,8 +86,34 @@ protected:
 	/// @return True if success
 	bool send_to_internet(const JsonObject json, InternetPlat* plat) override;
 
+	/// Send the packets of a batch to a google sheet, as rows of a few requests
+	/// @param[in] batch	Batch holding the packets
+	/// @param[in] plat		A pointer to an internet platform
+	/// @return Number of packets that were not published
+	int send_batch_to_internet(BatchSD& batch, InternetPlat* plat) override;
+
+	/// Domain of the script
+	/// @return "script.google.com"
+	const char* publish_domain() const override { return "script.google.com"; }
+
+	/// Write the GET request publishing json, its data in the URL
+	/// @param[in]	json	The JSON data, formatted according to publish();
+	/// @param[out]	network	Where to write the request
+	void write_publish_request(const JsonObject json, Print& network) override;
+
 private:
 
+	/// Publish packets of a batch as rows of one request
+	/// @param[in] batch	Batch holding the packets
+	/// @param[in] first	Index of the first packet
+	/// @param[in] count	Number of packets
+	/// @param[in] plat		A pointer to an internet platform
+	/// @return Number of packets that were not published
+	int m_send_rows(BatchSD& batch, const int first, const int count, InternetPlat* plat);
+
+	/// Write the script URL with the sheet, tab and device parameters
+	void m_write_url(Print& network);
+
 	/// Private utility send function
 	bool m_serialize_internet_impl(const JsonObject json, Print& write);
 
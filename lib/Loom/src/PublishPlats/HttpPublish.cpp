@@ -0,0 +1,101 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+/// @file		HttpPublish.cpp
+/// @brief		File for HttpPublish implementation.
+/// @date		2020
+/// @copyright	GNU General Public License v3.0
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#if (defined(LOOM_INCLUDE_WIFI) || defined(LOOM_INCLUDE_ETHERNET) || defined(LOOM_INCLUDE_LTE))
+
+#include "HttpPublish.h"
+#include "../Manager.h"
+#include "Module_Factory.h"
+
+using namespace Loom;
+
+///////////////////////////////////////////////////////////////////////////////
+HttpPublish::HttpPublish(
+		const char*				module_name,
+		const char*				domain,
+		const char*				path
+	)
+	: PublishPlat(module_name)
+	, m_domain(domain)
+	, m_path(path)
+{
+	print_module_label();
+	LPrint("HTTP publish ready with url: ", m_domain, m_path, '\n');
+}
+
+///////////////////////////////////////////////////////////////////////////////
+HttpPublish::HttpPublish(JsonArrayConst p)
+	: HttpPublish(p[0], p[1], p[2] | "/") {}
+
+///////////////////////////////////////////////////////////////////////////////
+void HttpPublish::print_config() const
+{
+	PublishPlat::print_config();
+	LPrint("\t Domain: ", m_domain, "\n");
+	LPrint("\t Path: ", m_path, "\n");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// Writes what is printed to it as the chunks of a chunked body,
+/// HTTP_PUBLISH_CHUNK bytes at a time
+struct ChunkedPrint : public Print {
+	Print&		out;
+	uint8_t		buffer[HTTP_PUBLISH_CHUNK];
+	uint8_t		len = 0;
+	ChunkedPrint(Print& out) : out(out) {}
+	size_t write(uint8_t byte) override
+	{
+		buffer[len++] = byte;
+		if (len == sizeof(buffer)) flush_chunk();
+		return 1;
+	}
+	/// Write the buffered bytes as a chunk: its length in hex, then the bytes
+	void flush_chunk()
+	{
+		if (len == 0) return;
+		out.print(len, HEX);
+		out.print("\r\n");
+		out.write(buffer, len);
+		out.print("\r\n");
+		len = 0;
+	}
+	/// Write the last of the body, then the empty chunk ending it
+	void finish()
+	{
+		flush_chunk();
+		out.print("0\r\n\r\n");
+	}
+};
+
+///////////////////////////////////////////////////////////////////////////////
+bool HttpPublish::send_to_internet(const JsonObject json, InternetPlat* plat)
+{
+	return m_request(plat, [&](Client& network) {
+		write_publish_request(json, network);
+		return true;
+	});
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void HttpPublish::write_publish_request(const JsonObject json, Print& network)
+{
+	network.print("POST ");
+	network.print(m_path);
+	network.print(" HTTP/1.1\r\nUser-Agent: LoomOverSSLClient\r\nHost: ");
+	network.print(m_domain);
+	network.print("\r\nConnection: keep-alive\r\nContent-Type: application/json\r\nTransfer-Encoding: chunked\r\n\r\n");
+	// the json goes straight into the request, a chunk at a time
+	ChunkedPrint body(network);
+	serializeJson(json, body);
+	body.finish();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+#endif // if (defined(LOOM_INCLUDE_WIFI) || defined(LOOM_INCLUDE_ETHERNET) || defined(LOOM_INCLUDE_LTE))
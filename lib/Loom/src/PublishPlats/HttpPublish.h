@@ -0,0 +1,100 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+/// @file		HttpPublish.h
+/// @brief		File for HttpPublish definition.
+/// @date		2020
+/// @copyright	GNU General Public License v3.0
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#if (defined(LOOM_INCLUDE_WIFI) || defined(LOOM_INCLUDE_ETHERNET) || defined(LOOM_INCLUDE_LTE))
+#pragma once
+
+#include "PublishPlat.h"
+
+namespace Loom {
+
+///////////////////////////////////////////////////////////////////////////////
+
+#define HTTP_PUBLISH_CHUNK	64	///< Bytes of json buffered into each chunk of the request body
+
+
+///////////////////////////////////////////////////////////////////////////////
+///
+/// Module publishing JSON to any HTTPS endpoint, as the body of a POST request.
+///
+/// The packaged json is serialized straight into the connection with
+/// `Transfer-Encoding: chunked`, through a buffer of HTTP_PUBLISH_CHUNK
+/// bytes, so the body is never held whole in memory and its length need
+/// not be known before sending. Only the status of the response is read,
+/// the rest of it is skipped.
+///
+/// @par Resources
+/// - [Module Documentation](https://openslab-osu.github.io/Loom/html/class_loom___http_publish.html)
+///
+///////////////////////////////////////////////////////////////////////////////
+class HttpPublish : public PublishPlat
+{
+	LOOM_MODULE_TYPE(HttpPublish, PublishPlat)
+
+public:
+
+//=============================================================================
+///@name	CONSTRUCTORS / DESTRUCTOR
+/*@{*/ //======================================================================
+
+	/// Loom HTTP Publish Platform module constructor.
+	/// @param[in]	module_name		String | <"HTTP"> | null | Publish platform module name.
+	/// @param[in]	domain			String | <""> | null | Domain of the server (ex. example.com), connected to on port 443.
+	/// @param[in]	path			String | <"/"> | null | Path the json is posted to (ex. /api/data).
+	HttpPublish(
+			const char*				module_name,
+			const char*				domain,
+			const char*				path			= "/"
+		);
+
+	/// Constructor that takes Json Array, extracts args
+	/// and delegates to regular constructor
+	/// @param[in]  p     The array of constuctor args to expand
+	HttpPublish(JsonArrayConst p);
+
+	/// Destructor
+	~HttpPublish() = default;
+
+//=============================================================================
+///@name	PRINT INFORMATION
+/*@{*/ //======================================================================
+
+	void print_config() const override;
+
+protected:
+
+	/// Post JSON data to the server
+	/// @param[in] json The JSON data, formatted according to publish();
+	/// @param[in] plat A pointer to an internet platform
+	/// @return True if success
+	bool send_to_internet(const JsonObject json, InternetPlat* plat) override;
+
+	/// Domain of the server
+	/// @return Domain
+	const char* publish_domain() const override { return m_domain.c_str(); }
+
+	/// Write the POST request publishing json, its body chunked
+	/// @param[in]	json	The JSON data, formatted according to publish();
+	/// @param[out]	network	Where to write the request
+	void write_publish_request(const JsonObject json, Print& network) override;
+
+private:
+
+	const String m_domain;		///< Domain of the server
+	const String m_path;		///< Path the json is posted to
+
+};
+
+///////////////////////////////////////////////////////////////////////////////
+REGISTER_NODEFAULT(Module, HttpPublish, "HttpPublish");
+///////////////////////////////////////////////////////////////////////////////
+
+}; // namespace Loom
+
+#endif // if (defined(LOOM_INCLUDE_WIFI) || defined(LOOM_INCLUDE_ETHERNET) || defined(LOOM_INCLUDE_LTE))
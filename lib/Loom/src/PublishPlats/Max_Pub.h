@@ -27,6 +27,7 @@ namespace Loom {
 ///////////////////////////////////////////////////////////////////////////////
 class MaxPub : public PublishPlat
 {
+	LOOM_MODULE_TYPE(MaxPub, PublishPlat)
 
 protected:
 
@@ -12,6 +12,7 @@
 
 #include "PublishPlat.h"
 #include "Manager.h"
+#include "../LogPlats/SD.h"
 
 using namespace Loom;
 
@@ -21,8 +22,27 @@ PublishPlat::PublishPlat(
 	)
 	: Module(module_name)
 	, m_internet( nullptr )
+	, outbox( nullptr )
+	, use_journal( false )
+	, retry_backoff( PUBLISH_RETRY_MIN )
+	, retry_budget( PUBLISH_RETRY_BUDGET )
+	, sleeps( false )
+	, retries( 0 )
+	, last_result( PublishResult::Published )
+	, publish_step( PublishStep::Idle )
+	, publish_attempt( 0 )
+	, publish_written( 0 )
+	, on_published( nullptr )
+	, on_failed( nullptr )
 {}
 
+///////////////////////////////////////////////////////////////////////////////
+PublishPlat::~PublishPlat()
+{
+	power_down();
+	delete outbox;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 void PublishPlat::second_stage_ctor()
 {
@@ -40,6 +60,11 @@ void PublishPlat::second_stage_ctor()
 		LPrintln("Unable to find internet platform");
 	}
 
+	// keep what can't be published yet on the card, if there is one
+	if (device_manager->get<SD>() || device_manager->get<BatchSD>()) {
+		set_journal(true);
+	}
+
 	// made it here, guess we're good to go!
 	print_module_label();
 	LPrint("Ready\n");
@@ -49,6 +74,19 @@ void PublishPlat::second_stage_ctor()
 bool PublishPlat::publish(const JsonObject json)
 {
   LMark;
+	// with the journal, the data is kept until published, even without an internet module yet
+	if (use_journal && m_validate_json(json)) {
+		// finish the packet poll() is publishing, which has the connection
+		while (publish_step != PublishStep::Idle) poll();
+		if (m_push_outbox(json)) {
+			// then publish the outbox oldest first, up to this packet
+			while (poll()) {}
+			return outbox->count == 0 && last_result == PublishResult::Published;
+		}
+		// the card failed, so send the packet as without the journal
+		print_module_label();
+		LPrintln("Publishing without the journal");
+	}
 	// check validity
 	if (m_internet == nullptr  || !m_validate_json(json)){
 		print_module_label();
@@ -57,6 +95,8 @@ bool PublishPlat::publish(const JsonObject json)
 		else LPrint("valid data.\n");
 		return false;
 	}
+	// finish the packet poll() is publishing, which has the connection
+	while (publish_step != PublishStep::Idle) poll();
 	// guess we're good to go
 	return send_to_internet(json, m_internet);
 }
@@ -67,17 +107,19 @@ uint8_t PublishPlat::publish_batch()
 	BatchSD* batch;
 		// check to make sure we have BatchSD module connected
 		if (device_manager && (batch = device_manager->get<BatchSD>()) ) {
-			uint8_t drop_count = 0;
 			int packets = batch->get_packet_counter();
 			print_module_label();
 			LPrintln("Packets in batch to publish: ", packets);
-			JsonObject tmp;
-			// For all the jsons stored in the batch, run the publish function using the json
-			for(int i=0; i < packets; i++){
-				tmp = batch->get_batch_json(i);
-				if(!publish(tmp)) drop_count++;
-				//delay(1000);
+			int dropped = packets;
+			if (m_internet == nullptr) {
+				print_module_label();
+				LPrint("Could not publish without internet module\n");
+			} else {
+				// finish the packet poll() is publishing, which has the connection
+				while (publish_step != PublishStep::Idle) poll();
+				dropped = send_batch_to_internet(*batch, m_internet);
 			}
+			const uint8_t drop_count = (dropped > 255) ? 255 : dropped;
 			// Clear the batch for the next batching to start
 			batch->clear_batch_log();
 			batch->add_drop_count(drop_count);
@@ -86,6 +128,18 @@ uint8_t PublishPlat::publish_batch()
 		return -1;
 }
 
+///////////////////////////////////////////////////////////////////////////////
+int PublishPlat::send_batch_to_internet(BatchSD& batch, InternetPlat* plat)
+{
+	int drop_count = 0;
+	const int packets = batch.get_packet_counter();
+	// For all the jsons stored in the batch, run the publish function using the json
+	for(int i=0; i < packets; i++){
+		const JsonObject tmp = batch.get_batch_json(i);
+		if(!m_validate_json(tmp) || !send_to_internet(tmp, plat)) drop_count++;
+	}
+	return drop_count;
+}
 
 ///////////////////////////////////////////////////////////////////////////////
 bool PublishPlat::publish()
@@ -100,6 +154,407 @@ bool PublishPlat::publish()
 	return false;
 }
 
+///////////////////////////////////////////////////////////////////////////////
+/// Writes the part of what is printed to it from skip up to skip + len,
+/// to write a request in slices
+struct SlicePrint : public Print {
+	Print&		out;
+	uint32_t	skip;		///< Bytes before the slice
+	uint32_t	end;		///< Bytes up to the end of the slice
+	uint32_t	count = 0;	///< Bytes printed
+
+	SlicePrint(Print& out, const uint32_t skip, const uint32_t len)
+		: out(out), skip(skip), end(skip + len) {}
+
+	size_t write(uint8_t byte) override { return write(&byte, 1); }
+	size_t write(const uint8_t* buffer, size_t size) override
+	{
+		const uint32_t from = (count < skip) ? skip - count : 0;
+		const uint32_t to = (count + size > end) ? ((count < end) ? end - count : 0) : size;
+		if (from < to) out.write(buffer + from, to - from);
+		count += size;
+		return size;
+	}
+};
+
+///////////////////////////////////////////////////////////////////////////////
+bool PublishPlat::publish_async(const JsonObject json)
+{
+  LMark;
+	if ((m_internet == nullptr && !use_journal) || !m_validate_json(json)) {
+		print_module_label();
+		LPrint("Could not publish without ");
+		if(m_internet == nullptr) LPrint("internet module\n");
+		else LPrint("valid data.\n");
+		return false;
+	}
+	if (m_push_outbox(json)) return true;
+	// a full memory outbox was counted as a drop already
+	if (!use_journal) return false;
+	// the card failed, so keep the outbox in memory, unless the journal holds packets still
+	print_module_label();
+	if (outbox->count == 0) {
+		LPrintln("Keeping the outbox in memory");
+		set_journal(false);
+		return m_push_outbox(json);
+	}
+	outbox->dropped++;
+	LPrintln("Dropped packet");
+	return false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool PublishPlat::publish_async()
+{
+	if (device_manager != nullptr) {
+		JsonObject tmp = device_manager->internal_json();
+		if (strcmp(tmp["type"], "data") == 0 ) {
+			return publish_async(tmp);
+		}
+	}
+	return false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool PublishPlat::poll()
+{
+  LMark;
+	if (!outbox || outbox->count == 0 || m_internet == nullptr) return false;
+	Outbox& box = *outbox;
+	const JsonObject json = box.doc.as<JsonObject>();
+
+	switch (publish_step) {
+		case PublishStep::Idle:
+			// wait out the backoff of the last failure
+			if (!retry_wait.isExpired()) return false;
+			// once out of retries, a device with wake cycles waits for the next,
+			// one that never sleeps has waited out the backoff instead
+			if (retry_budget == 0) {
+				if (sleeps) return false;
+				retry_budget = PUBLISH_RETRY_BUDGET;
+			}
+			// read back the oldest packet
+			if (!m_read_outbox()) {
+				m_finish_publish(PublishResult::Rejected);
+				return box.count > 0;
+			}
+			publish_attempt = 0;
+			publish_step = PublishStep::Connect;
+			return true;
+
+		case PublishStep::Connect:
+			// platforms without steps publish in this one
+			if (publish_domain() == nullptr) {
+				m_finish_publish(send_to_internet(json, m_internet) ? PublishResult::Published : PublishResult::Retry);
+				return last_result != PublishResult::Retry && box.count > 0;
+			}
+			publish_session = m_internet->connect_to_domain(publish_domain());
+			publish_attempt++;
+			if (!publish_session) {
+				print_module_label();
+				LPrintln("Could not connect to ", publish_domain());
+				m_finish_publish(PublishResult::Retry);
+				return false;
+			}
+			publish_written = 0;
+			publish_step = PublishStep::Write;
+			return true;
+
+		case PublishStep::Write: {
+			SlicePrint slice(*publish_session, publish_written, PUBLISH_SLICE);
+			write_publish_request(json, slice);
+			publish_written = (slice.count < slice.end) ? slice.count : slice.end;
+			if (!publish_session->connected()) {
+				publish_session.reset();
+				if (m_retry_connection(m_internet, publish_attempt)) {
+					publish_step = PublishStep::Connect;
+					return true;
+				}
+				print_module_label();
+				LPrintln("Internet disconnected during transmission!");
+				m_finish_publish(PublishResult::Retry);
+				return false;
+			}
+			if (publish_written < slice.count) return true;
+			// the whole request is written
+			publish_session->flush();
+			publish_wait.start(HTTP_RESPONSE_TIMEOUT, AsyncDelay::MILLIS);
+			publish_step = PublishStep::Response;
+			return true;
+		}
+
+		case PublishStep::Response: {
+			// wait for the response to start arriving, then read it
+			int status = 0;
+			if (publish_session->available()) {
+				status = m_internet->read_http_response(publish_session);
+			} else if (!publish_wait.isExpired() && publish_session->connected()) {
+				return true;
+			}
+			// no response, the request may never have reached the server
+			if (status == 0) {
+				publish_session.reset();
+				if (m_retry_connection(m_internet, publish_attempt)) {
+					publish_step = PublishStep::Connect;
+					return true;
+				}
+				print_module_label();
+				LPrintln("No response to publish");
+				m_finish_publish(PublishResult::Retry);
+				return false;
+			}
+			print_module_label();
+			if (status >= 400) LPrintln("Publish failed with status ", status);
+			else LPrintln("Published successfully!");
+			// the server won't take a packet it found bad, but may be back from an error of its own
+			if (status >= 500) m_finish_publish(PublishResult::Retry);
+			else if (status >= 400) m_finish_publish(PublishResult::Rejected);
+			else m_finish_publish(PublishResult::Published);
+			return last_result != PublishResult::Retry && box.count > 0;
+		}
+	}
+	return false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void PublishPlat::m_finish_publish(const PublishResult result)
+{
+	Outbox& box = *outbox;
+	// the connection is closed unless read_http_response() kept it alive
+	publish_session.reset();
+	publish_step = PublishStep::Idle;
+	last_result = result;
+
+	// keep the packet, and back off before retrying it
+	if (result == PublishResult::Retry) {
+		retries++;
+		if (retry_budget > 0) retry_budget--;
+		// half the backoff is random
+		const uint32_t wait = retry_backoff / 2 + random(retry_backoff / 2 + 1);
+		retry_wait.start(wait, AsyncDelay::MILLIS);
+		retry_backoff = (retry_backoff < PUBLISH_RETRY_MAX / 2) ? retry_backoff * 2 : PUBLISH_RETRY_MAX;
+		print_module_label();
+		LPrintln(box.count, " packets to publish, retrying in ", wait, " ms");
+		box.doc.clear();
+		return;
+	}
+
+	retry_backoff = PUBLISH_RETRY_MIN;
+	retry_budget = PUBLISH_RETRY_BUDGET;
+	if (result == PublishResult::Published && on_published) on_published(box.doc.as<JsonObject>());
+	if (result == PublishResult::Rejected) {
+		box.dropped++;
+		if (on_failed) on_failed(box.doc.as<JsonObject>());
+	}
+	m_pop_outbox();
+	box.doc.clear();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void PublishPlat::set_journal(const bool enable)
+{
+	if (enable == use_journal) return;
+	// packets held in memory are not moved to the card, or back
+	if (outbox && outbox->count > 0) {
+		print_module_label();
+		LPrintln("Outbox not empty, keeping it in ", (use_journal) ? "the journal" : "memory");
+		return;
+	}
+	power_down();
+	delete outbox;
+	outbox = nullptr;
+	use_journal = enable;
+	// resume a journal left on the card
+	if (use_journal) m_open_outbox();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool PublishPlat::m_open_outbox()
+{
+	if (!outbox) {
+		outbox = new Outbox{};
+	}
+	Outbox& box = *outbox;
+	if (!use_journal) return true;
+	if (box.data_file.isOpen() && box.head_file.isOpen()) return true;
+  LMark;
+	digitalWrite(8, HIGH); // if using LoRa, need to temporarily prevent it from using SPI
+
+	// files named after the module, so each platform has its own journal
+	char path[40];
+	snprintf(path, sizeof(path), "%s.out", get_module_name());
+	const bool data_open = box.data_file.open(path, O_RDWR | O_CREAT);
+	snprintf(path, sizeof(path), "%s.hed", get_module_name());
+	if (!data_open || !box.head_file.open(path, O_RDWR | O_CREAT)) {
+		power_down();
+		print_module_label();
+		LPrintln("Error opening journal");
+		return false;
+	}
+
+	// resume the journal from its head, dropping a packet written partly before a reset
+	const uint32_t size = box.data_file.fileSize();
+	box.head = 0;
+	if (box.head_file.seekSet(0) && box.head_file.read(&box.head, sizeof(box.head)) != sizeof(box.head)) {
+		box.head = 0;
+	}
+	if (box.head > size) box.head = size;
+	box.count = 0;
+	uint32_t offset = box.head;
+	uint8_t prefix[2];
+	while (offset + sizeof(prefix) <= size && box.data_file.seekSet(offset)
+			&& box.data_file.read(prefix, sizeof(prefix)) == sizeof(prefix)) {
+		const uint16_t len = prefix[0] | (prefix[1] << 8);
+		if (len > PUBLISH_MAX_PACKET || offset + sizeof(prefix) + len > size) break;
+		offset += sizeof(prefix) + len;
+		box.count++;
+	}
+	if (offset < size) {
+		box.data_file.truncate(offset);
+		box.data_file.sync();
+	}
+	if (box.count > 0) {
+		print_module_label();
+		LPrintln("Resuming journal of ", box.count, " packets");
+	}
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool PublishPlat::m_push_outbox(const JsonObject json)
+{
+	if (!m_open_outbox()) return false;
+	Outbox& box = *outbox;
+	const uint16_t len = measureMsgPack(json);
+
+	if (!use_journal) {
+		// (serializeMsgPack() also null terminates, over the next packet's length)
+		if (box.used + sizeof(len) + len + 1 > sizeof(box.bytes)) {
+			box.dropped++;
+			print_module_label();
+			LPrintln("Outbox full, dropped packet");
+			return false;
+		}
+		memcpy(box.bytes + box.used, &len, sizeof(len));
+		serializeMsgPack(json, (char*)box.bytes + box.used + sizeof(len), len + 1);
+		box.used += sizeof(len) + len;
+		box.count++;
+		return true;
+	}
+
+	if (len > PUBLISH_MAX_PACKET) {
+		print_module_label();
+		LPrintln("Packet too large for the journal");
+		return false;
+	}
+  LMark;
+	digitalWrite(8, HIGH); // if using LoRa, need to temporarily prevent it from using SPI
+	// length prefix and packet written with one write, as BatchSD does
+	// (serializeMsgPack() also null terminates)
+	uint8_t buffer[len + 3];
+	buffer[0] = len & 0xFF;
+	buffer[1] = len >> 8;
+	serializeMsgPack(json, (char*)buffer + 2, len + 1);
+
+	// a packet is only counted once synced whole; m_open_outbox() truncates a torn one
+	const uint32_t size = box.data_file.fileSize();
+	box.data_file.seekSet(size);
+	box.data_file.write(buffer, len + 2);
+	if (!box.data_file.sync() || box.data_file.getWriteError()) {
+		box.data_file.clearWriteError();
+		box.data_file.truncate(size);
+		print_module_label();
+		LPrintln("Error writing journal");
+		return false;
+	}
+	box.count++;
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool PublishPlat::m_read_outbox()
+{
+	Outbox& box = *outbox;
+	uint16_t len;
+
+	if (!use_journal) {
+		memcpy(&len, box.bytes, sizeof(len));
+		return !deserializeMsgPack(box.doc, (const char*)box.bytes + sizeof(len), len);
+	}
+
+	if (!m_open_outbox()) return false;
+  LMark;
+	digitalWrite(8, HIGH); // if using LoRa, need to temporarily prevent it from using SPI
+	uint8_t prefix[2];
+	if (!box.data_file.seekSet(box.head) || box.data_file.read(prefix, sizeof(prefix)) != sizeof(prefix)) {
+		return false;
+	}
+	len = prefix[0] | (prefix[1] << 8);
+	uint8_t buffer[len];
+	if (box.data_file.read(buffer, len) != len) return false;
+	return !deserializeMsgPack(box.doc, (const char*)buffer, len);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void PublishPlat::m_pop_outbox()
+{
+	Outbox& box = *outbox;
+	if (box.count == 0) return;
+	box.count--;
+	uint16_t len;
+
+	if (!use_journal) {
+		memcpy(&len, box.bytes, sizeof(len));
+		const uint16_t size = sizeof(len) + len;
+		memmove(box.bytes, box.bytes + size, box.used - size);
+		box.used -= size;
+		return;
+	}
+
+	if (!m_open_outbox()) return;
+  LMark;
+	digitalWrite(8, HIGH); // if using LoRa, need to temporarily prevent it from using SPI
+	if (box.count == 0) {
+		// empty the data file before the head goes back to its start,
+		// so a reset in between can't publish its packets again
+		box.data_file.truncate(0);
+		box.data_file.sync();
+		box.head = 0;
+	} else {
+		uint8_t prefix[2];
+		box.data_file.seekSet(box.head);
+		box.data_file.read(prefix, sizeof(prefix));
+		box.head += sizeof(prefix) + (prefix[0] | (prefix[1] << 8));
+	}
+	m_write_head();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool PublishPlat::m_write_head()
+{
+	Outbox& box = *outbox;
+	return box.head_file.seekSet(0)
+		&& box.head_file.write((const uint8_t*)&box.head, sizeof(box.head)) == sizeof(box.head)
+		&& box.head_file.sync();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void PublishPlat::power_up()
+{
+	// millis() stops while asleep, so a backoff started before can't be waited out
+	sleeps = true;
+	retry_budget = PUBLISH_RETRY_BUDGET;
+	retry_wait.expire();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void PublishPlat::power_down()
+{
+	if (!outbox) return;
+	if (outbox->data_file.isOpen()) outbox->data_file.close();
+	if (outbox->head_file.isOpen()) outbox->head_file.close();
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 void PublishPlat::print_config() const
 {
@@ -112,6 +567,12 @@ void PublishPlat::print_state() const
 	Module::print_state();
   LMark;
 	LPrintln("\tInternet Connected: ", m_internet != nullptr && m_internet->is_connected());
+	if (outbox) {
+		LPrintln("\tOutbox Packets: ", outbox->count);
+		LPrintln("\tOutbox Drops: ", outbox->dropped);
+		LPrintln("\tOutbox Journal: ", use_journal);
+		LPrintln("\tPublish Retries: ", retries);
+	}
 }
 
 ///////////////////////////////////////////////////////////////////////////////
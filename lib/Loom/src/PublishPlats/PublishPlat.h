@@ -16,26 +16,125 @@
 #include "../InternetPlats/InternetPlat.h"
 #include "../LogPlats/BatchSD.h"
 
+#include <AsyncDelay.h>
+
 namespace Loom {
 
+///////////////////////////////////////////////////////////////////////////////
+
+#define PUBLISH_OUTBOX_SIZE		1024	///< Bytes of packets the outbox holds in memory, as MsgPack with their lengths
+#define PUBLISH_DOC_SIZE		2048	///< Size of the json a held packet is read back into
+#define PUBLISH_MAX_PACKET		2048	///< Largest packet the journal holds, in MsgPack bytes
+#define PUBLISH_SLICE			128		///< Most bytes of a request poll() writes in one step
+#define PUBLISH_RETRY_MIN		5000	///< Milliseconds before retrying a failed packet, doubled by each failure
+#define PUBLISH_RETRY_MAX		600000	///< Longest wait before retrying
+#define PUBLISH_RETRY_BUDGET	4		///< Failed attempts per wake cycle before the outbox waits for the next
+
+
 ///////////////////////////////////////////////////////////////////////////////
 ///
 /// Abstract internet publishing module, implementing google sheets and mongodb functionality
 ///
 /// All actuator modules inherit from this class.
 ///
+/// publish() blocks until the request is sent. publish_async() instead copies
+/// the packet into an outbox and returns; poll(), run by the Manager's
+/// scheduler, publishes the packets in steps: connect, write the request a
+/// PUBLISH_SLICE at a time, then wait for the response without blocking.
+/// The TLS handshake of a new connection is one step, as SSLClient completes
+/// it in connect(), but it is skipped while the connection is kept alive.
+/// The callbacks set with set_publish_callbacks() tell, from poll(), how
+/// each packet went.
+///
+/// With an SD module in the Manager (SD or BatchSD), the outbox is a
+/// journal on the card instead of memory, so packets survive resets,
+/// watchdog resets included, and publish() stores each packet in it before
+/// sending: a packet that fails is kept, not dropped. If the card can't
+/// take a packet, publish() sends it without the journal and
+/// publish_async() moves an empty outbox to memory. The journal is a data
+/// file the packets are appended to, length prefixed MsgPack as BatchSD
+/// stores them, and a file holding the offset of the oldest packet not
+/// published. Both are synced on every change; a reset between publishing
+/// a packet and moving past it publishes it again. The data file is
+/// truncated whenever the journal empties.
+///
+/// Packets are published oldest first. A packet that fails is retried after
+/// a backoff that doubles from PUBLISH_RETRY_MIN up to PUBLISH_RETRY_MAX,
+/// with half of it random so devices that lost the uplink together don't
+/// retry together, at most PUBLISH_RETRY_BUDGET times in a row per wake
+/// cycle (power_up()) so a dead uplink doesn't keep the device awake. The
+/// budget is renewed by each packet published or dropped, and on a device
+/// without wake cycles (never calling power_up()) by each backoff waited
+/// out. A packet
+/// without a response is retried, at once on a new connection if it was
+/// sent over a kept-alive one. A packet the server rejects (4xx) or that
+/// can't be read back is dropped.
+///
 /// @par Resources
 /// - [Module Documentation](https://openslab-osu.github.io/Loom/html/class_loom_publish_plat.html)
 ///
 ///////////////////////////////////////////////////////////////////////////////
 class PublishPlat : public Module
 {
+	LOOM_MODULE_TYPE(PublishPlat, Module)
+
+public:
+
+	/// Called from poll() with a packet of the outbox
+	using PublishFuncPtr = void (*)(const JsonObject json);
 
 protected:
 
 	/// Pointer to internet platform to use to publish
 	InternetPlat*	m_internet;
 
+	/// Steps of publishing a packet of the outbox, taken by poll()
+	enum class PublishStep : uint8_t {
+		Idle,		///< No packet being published
+		Connect,	///< Connecting to the domain
+		Write,		///< Writing the request
+		Response	///< Waiting for the response
+	};
+
+	/// Outcome of an attempt to publish a packet of the outbox
+	enum class PublishResult : uint8_t {
+		Published,	///< Published, move on to the next
+		Retry,		///< Failed, retry after a backoff
+		Rejected	///< Can't be published, drop it
+	};
+
+	/// Packets held for poll(), oldest first
+	struct Outbox {
+		uint8_t		bytes[PUBLISH_OUTBOX_SIZE];	///< Packets as MsgPack, each after its length (uint16_t), without a journal
+		uint16_t	used;			///< Bytes of bytes holding packets
+		uint32_t	count;			///< Packets held
+		uint16_t	dropped;		///< Packets refused with the outbox full, or rejected
+		DynamicJsonDocument	doc{PUBLISH_DOC_SIZE};	///< Oldest packet, read back while it is published
+
+		File		data_file;		///< Journal: packets, as in bytes
+		File		head_file;		///< Journal: offset in data_file of the oldest packet (uint32_t)
+		uint32_t	head;			///< Offset in data_file of the oldest packet
+	};
+
+	Outbox*			outbox;			///< Packets to publish, allocated on first use
+	bool			use_journal;	///< Whether the outbox is a journal on the SD card
+
+	uint32_t		retry_backoff;	///< Milliseconds of backoff after the next failure, before jitter
+	AsyncDelay		retry_wait;		///< Time left before retrying after a failure
+	uint8_t			retry_budget;	///< Failed attempts in a row left this wake cycle
+	bool			sleeps;			///< Whether power_up() has been called, so the device has wake cycles
+	uint16_t		retries;		///< Failed attempts since start
+	PublishResult	last_result;	///< Outcome of the last attempt
+
+	PublishStep		publish_step;		///< Step of the packet being published
+	uint8_t			publish_attempt;	///< Connections tried for the packet being published
+	uint32_t		publish_written;	///< Bytes of its request written
+	AsyncDelay		publish_wait;		///< Time left for its response
+	InternetPlat::ClientSession	publish_session;	///< Connection it is being published on
+
+	PublishFuncPtr	on_published;	///< Called with each packet poll() published
+	PublishFuncPtr	on_failed;		///< Called with each packet poll() dropped
+
 public:
 
 //=============================================================================
@@ -50,9 +149,10 @@ public:
 	);
 
 	/// Destructor
-	virtual ~PublishPlat() = default;
+	virtual ~PublishPlat();
 
-	/// Grab the internet platform specified by the ctor parameters
+	/// Grab the internet platform specified by the ctor parameters,
+	/// and keep the outbox on the SD card if there is one
 	void second_stage_ctor() override;
 
 //=============================================================================
@@ -64,13 +164,15 @@ public:
 	void	package(JsonObject json) override { /* do nothing for now */ }
 
 	/// Publish data.
+	/// With the journal, the data is stored in it first, then the journal
+	/// is published oldest first, so data that fails is kept to be retried.
 	/// @param[in] json JSON object to publish. MUST be formatted as
 	/// 	{ "contents" : [ { "module": "module_name", "data" : {...} }, ... ], "timestamp"(optional) : {...} }
 	/// @returns Whether or not the publish succeded
 	bool	publish(const JsonObject json);
 
-	/// Publish all the packets stored in the batch
-	/// @returns Whether or not the publishes succeded or not
+	/// Publish all the packets stored in the batch, in as few requests as the platform can
+	/// @returns Number of packets that failed to publish
 	uint8_t publish_batch();
 
 	/// Version of log for use with LoomManager.
@@ -78,6 +180,44 @@ public:
 	/// @return True if success
 	bool	publish();
 
+	/// Publish data without blocking: copy it into the outbox for poll() to publish.
+	/// @param[in] json JSON object to publish, formatted as for publish()
+	/// @returns False if the data is invalid or the outbox is full
+	bool	publish_async(const JsonObject json);
+
+	/// Version of publish_async() for use with LoomManager.
+	/// Accesses Json from LoomManager
+	/// @return False if the data is invalid or the outbox is full
+	bool	publish_async();
+
+	/// Take one step of publishing the packets in the outbox.
+	/// Schedule the module with the Manager to have it run
+	/// @return True while packets are being published, false once none are
+	///			left or while waiting to retry
+	bool	poll() override;
+
+	/// Set the functions poll() calls with each packet of the outbox
+	/// @param[in]	published	Called once the packet was published, can be nullptr
+	/// @param[in]	failed		Called if it was dropped, can be nullptr
+	void	set_publish_callbacks(const PublishFuncPtr published, const PublishFuncPtr failed)
+			{ on_published = published; on_failed = failed; }
+
+	/// Keep the outbox in memory or in a journal on the SD card.
+	/// Enabled by second_stage_ctor() if the Manager has an SD module
+	/// @param[in]	enable	Whether to keep the outbox on the card
+	void	set_journal(const bool enable);
+
+	/// Number of packets in the outbox
+	/// @return Packets waiting to be published
+	uint32_t	get_outbox_count() const { return outbox ? outbox->count : 0; }
+
+	/// Start a new wake cycle: retry failed packets now, with a new retry budget.
+	/// From then on, only wake cycles renew a budget run out
+	void	power_up() override;
+
+	/// Close the journal files, they are reopened on next use
+	void	power_down() override;
+
 //=============================================================================
 ///@name	PRINT INFORMATION
 /*@{*/ //======================================================================
@@ -93,21 +233,130 @@ protected:
 	/// @return True if success
 	virtual bool send_to_internet(const JsonObject json, InternetPlat* plat) = 0;
 
+	/// Send all the packets stored in a batch to the internet, assumes that a valid internet plat was found.
+	/// Sends each packet on its own with send_to_internet(), platforms that can send
+	/// many packets in one request override this
+	/// @param[in]	batch	Batch holding the packets
+	/// @param[in]	plat	Internet platform to send on
+	/// @return Number of packets that could not be sent
+	virtual int send_batch_to_internet(BatchSD& batch, InternetPlat* plat);
+
+	/// Domain the requests of publish_async() go to.
+	/// Platforms that don't override this and write_publish_request() have
+	/// poll() publish with send_to_internet() instead, in one step
+	/// @return Domain, nullptr if none
+	virtual const char* publish_domain() const { return nullptr; }
+
+	/// Write the whole request publishing json, to the domain of publish_domain().
+	/// poll() writes a request in steps by calling this for each, so it must
+	/// write the same bytes every time for the same json
+	/// @param[in]	json	Json to publish
+	/// @param[out]	out		Where to write the request
+	virtual void write_publish_request(const JsonObject json, Print& out) {}
+
+	/// Connect to publish_domain(), write a request and read its response,
+	/// trying a new connection if a kept-alive one was closed by the server
+	/// or gave no response
+	/// @param[in] plat		A pointer to an internet platform
+	/// @param[in] write	Writes the request to a Client, returns false if it could not write all of it
+	/// @return True if the server took the request
+	template <typename Write>
+	bool m_request(InternetPlat* plat, Write write);
+
+	/// Whether a request that failed on its connection is tried again on a new one:
+	/// a kept-alive connection may have been closed by the server while idle,
+	/// without us knowing until it is used
+	/// @param[in] plat		Internet platform the connection is from
+	/// @param[in] attempt	Connections tried for the request, this one included
+	/// @return True if the connection was kept alive and is the first tried
+	bool m_retry_connection(InternetPlat* plat, const uint8_t attempt) const
+		{ return plat->get_reused() && attempt < 2; }
+
 	// Switch to: ?
 	// virtual bool send_to_internet(const JsonObject json) = 0;
 
-private:
-
 	/// Check that the JSON supplied meets the format criteria required by publish()
 	/// @param[in]	json	Json to validate
 	bool m_validate_json(const JsonObjectConst json) const;
 
+private:
+
+	/// Finish an attempt to publish the oldest packet of the outbox: remove it and
+	/// call the callback, or keep it and back off
+	/// @param[in]	result		Outcome of the attempt
+	void m_finish_publish(const PublishResult result);
+
+	/// Allocate the outbox, and open the journal if it is to be used.
+	/// A journal left on the card (e.g. after a reset) is resumed
+	/// @return True if success
+	bool m_open_outbox();
+
+	/// Append a packet to the outbox
+	/// @param[in]	json	Packet to store
+	/// @return False if the outbox could not take it
+	bool m_push_outbox(const JsonObject json);
+
+	/// Read the oldest packet of the outbox into its doc
+	/// @return False if it could not be read
+	bool m_read_outbox();
+
+	/// Remove the oldest packet of the outbox
+	void m_pop_outbox();
+
+	/// Write the offset of the oldest packet to the journal's head file
+	/// @return True if success
+	bool m_write_head();
+
 	/// Print a JSON error
 	/// @param[in]	str		Error string to print
 	void m_print_json_error(const char* str) const;
 
 };
 
+///////////////////////////////////////////////////////////////////////////////
+template <typename Write>
+bool PublishPlat::m_request(InternetPlat* plat, Write write)
+{
+  LMark;
+	for (uint8_t attempt = 1; ; attempt++) {
+		auto network = plat->connect_to_domain(publish_domain());
+		// check if we connected
+		if (!network) {
+			print_module_label();
+			LPrintln("Could not connect to ", publish_domain());
+			return false;
+		}
+		// a request that could not be written whole is dropped with its connection
+		if (!write(*network)) return false;
+		if (!network->connected()) {
+			if (m_retry_connection(plat, attempt)) continue;
+			print_module_label();
+			LPrintln("Internet disconnected during transmission!");
+			return false;
+		}
+		// flush all that
+		network->flush();
+		// read the response, keeping the connection for the next publish
+		const int status = plat->read_http_response(network);
+		// no response, the request may never have reached the server
+		if (status == 0) {
+			if (m_retry_connection(plat, attempt)) continue;
+			print_module_label();
+			LPrintln("No response to publish");
+			return false;
+		}
+		if (status >= 400) {
+			print_module_label();
+			LPrint("Publish failed with status ", status, "\n");
+			return false;
+		}
+		// all done!
+		print_module_label();
+		LPrint("Published successfully!\n");
+		return true;
+	}
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 }; // namespace Loom
@@ -26,6 +26,7 @@ namespace Loom {
 ///////////////////////////////////////////////////////////////////////////////
 class DS3231 : public RTC
 {
+	LOOM_MODULE_TYPE(DS3231, RTC)
 
 protected:
 
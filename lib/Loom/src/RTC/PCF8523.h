@@ -28,6 +28,7 @@ namespace Loom {
 ///////////////////////////////////////////////////////////////////////////////
 class PCF8523 : public RTC
 {
+	LOOM_MODULE_TYPE(PCF8523, RTC)
 
 protected:
 
@@ -168,6 +168,23 @@ void RTC::package(JsonObject json)
 	}
 }
 
+///////////////////////////////////////////////////////////////////////////////
+bool RTC::package_record(Record::Writer& record)
+{
+	read_rtc();
+	record.add(datestring);
+	record.add(timestring);
+	if (use_local_time){
+		local_rtc();
+		sprintf(local_datestring, "%d/%d/%d", local_time.year(), local_time.month(), local_time.day());
+		sprintf(local_timestring, "%d:%d:%d", local_time.hour(), local_time.minute(), local_time.second());
+		record.add(local_datestring);
+		record.add(local_timestring);
+		record.add(enum_timezone_string(timezone));
+	}
+	return true;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 void RTC::print_time(const bool verbose)
 {
@@ -28,6 +28,7 @@ namespace Loom {
 ///////////////////////////////////////////////////////////////////////////////
 class RTC : public Module
 {
+	LOOM_MODULE_TYPE(RTC, Module)
 
 public:
 
@@ -94,6 +95,11 @@ public:
 	/// @param[out]	json	Object to add timestamp to
 	virtual void 	package(JsonObject json) override;
 
+	/// Writes the same timestamp as package() into a compiled record
+	/// @param[out]	record	Writer for this module's values
+	/// @return True
+	virtual bool	package_record(Record::Writer& record) override;
+
 	/// Get DateTime of current time
 	/// @return	DateTime
 	virtual DateTime now() const = 0;
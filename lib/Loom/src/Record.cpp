@@ -0,0 +1,202 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+/// @file		Record.cpp
+/// @brief		File for Record implementation.
+/// @date		2020
+/// @copyright	GNU General Public License v3.0
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#include "Record.h"
+#include "Package.h"
+
+using namespace Loom;
+
+///////////////////////////////////////////////////////////////////////////////
+/// Get the record type of a packaged value
+/// @param[in]	val		Value to classify
+/// @param[out]	type	Record type of value
+/// @return False if value can't be stored in a record (arrays, objects, null)
+static bool value_type(JsonVariantConst val, Record::Type& type)
+{
+	if		(val.is<bool>())		type = Record::Type::BOOL;
+	else if	(val.is<int32_t>())		type = Record::Type::INT;
+	else if	(val.is<float>())		type = Record::Type::FLOAT;
+	else if	(val.is<const char*>())	type = Record::Type::STRING;
+	else return false;
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+template<typename F>
+bool Record::walk(JsonObjectConst json, F&& visit)
+{
+	for (auto kv : json) {
+		const char* name = kv.key().c_str();
+
+		if (strcmp(name, "type") == 0) continue;
+
+		if ( (strcmp(name, "id") == 0) || (strcmp(name, "timestamp") == 0) ) {
+			const Section section = (name[0] == 'i') ? Section::ID : Section::TIMESTAMP;
+			for (auto item : kv.value().as<JsonObjectConst>()) {
+				if ( !visit(section, "", item.key().c_str(), item.value()) ) return false;
+			}
+		} else if (strcmp(name, "contents") == 0) {
+			for (JsonObjectConst block : kv.value().as<JsonArrayConst>()) {
+				const char* module = block["module"] | "";
+				for (auto item : block["data"].as<JsonObjectConst>()) {
+					if ( !visit(Section::CONTENTS, module, item.key().c_str(), item.value()) ) return false;
+				}
+			}
+		} else {
+			return false;
+		}
+	}
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void Record::reset()
+{
+	column_count	= 0;
+	segments_used	= 0;
+	names[0]		= '\0';		// Offset 0 is the empty name
+	names_used		= 1;
+	text_used		= 0;
+	hash			= 2166136261UL;	// FNV-1a offset basis
+}
+
+///////////////////////////////////////////////////////////////////////////////
+uint16_t Record::add_name(const char* name)
+{
+	// Reuse identical names already in the pool (repeated module names and keys)
+	for (uint16_t i = 0; i < names_used; i += strlen(names + i) + 1) {
+		if (strcmp(names + i, name) == 0) return i;
+	}
+
+	const uint16_t len = strlen(name) + 1;
+	if (names_used + len > RECORD_NAME_POOL) return RECORD_NAME_POOL;
+
+	memcpy(names + names_used, name, len);
+	names_used += len;
+	return names_used - len;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void Record::hash_column(const Column& col)
+{
+	auto mix = [this](const uint8_t byte) { hash = (hash ^ byte) * 16777619UL; };
+
+	mix((uint8_t)col.section);
+	mix((uint8_t)col.type);
+	for (const char* c = names + col.module; ; c++) { mix(*c); if (!*c) break; }
+	for (const char* c = names + col.key; ; c++) { mix(*c); if (!*c) break; }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+const char* Record::copy_text(const char* str)
+{
+	if (!str) return "";
+	const uint16_t len = strlen(str) + 1;
+	if (text_used + len > RECORD_TEXT_POOL) return nullptr;
+
+	char* copy = text + text_used;
+	memcpy(copy, str, len);
+	text_used += len;
+	return copy;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool Record::add_segment(const Module* module, JsonObjectConst json)
+{
+	if (segments_used >= RECORD_MAX_SEGMENTS) return false;
+
+	const uint8_t begin			= column_count;
+	const uint32_t begin_hash	= hash;
+
+	bool success = walk(json, [&](Section section, const char* module_name, const char* key, JsonVariantConst val) {
+		Type type;
+		if ( (column_count >= RECORD_MAX_COLUMNS) || !value_type(val, type) ) return false;
+
+		const uint16_t module_off	= add_name(module_name);
+		const uint16_t key_off		= add_name(key);
+		if ( (module_off == RECORD_NAME_POOL) || (key_off == RECORD_NAME_POOL) ) return false;
+
+		columns[column_count] = { section, type, module_off, key_off };
+		hash_column(columns[column_count++]);
+		return true;
+	});
+
+	if (!success) {
+		column_count	= begin;
+		hash			= begin_hash;
+		return false;
+	}
+
+	segments[segments_used++] = { module, begin, column_count };
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool Record::copy_segment(const uint8_t idx, JsonObjectConst json)
+{
+	const Segment& seg = segments[idx];
+	uint8_t pos = seg.begin;
+
+	bool success = walk(json, [&](Section section, const char* module_name, const char* key_name, JsonVariantConst val) {
+		Type type;
+		if ( (pos >= seg.end) || !value_type(val, type) ) return false;
+
+		const Column& col = columns[pos];
+		if ( (col.section != section) || (col.type != type)
+			|| (strcmp(key(pos), key_name) != 0) || (strcmp(module(pos), module_name) != 0) ) {
+			return false;
+		}
+
+		Value& v = values[pos++];
+		switch (type) {
+			case Type::INT:		v.i = val.as<int32_t>(); break;
+			case Type::FLOAT:	v.f = val.as<float>(); break;
+			case Type::BOOL:	v.b = val.as<bool>(); break;
+			case Type::STRING:	v.s = copy_text(val.as<const char*>()); break;
+		}
+		return (type != Type::STRING) || (v.s != nullptr);
+	});
+
+	return success && (pos == seg.end);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void Record::to_json(JsonObject json) const
+{
+	json["type"] = "data";
+
+	JsonObject block;
+	for (auto i = 0; i < column_count; i++) {
+		const Column& col = columns[i];
+
+		// Start a new block when the section or module changes
+		if ( (i == 0) || (col.section != columns[i-1].section) || (col.module != columns[i-1].module) ) {
+			switch (col.section) {
+				case Section::ID:
+				case Section::TIMESTAMP: {
+					const char* name = (col.section == Section::ID) ? "id" : "timestamp";
+					block = json[name];
+					if (block.isNull()) block = json.createNestedObject(name);
+					break;
+				}
+				case Section::CONTENTS:
+					block = get_module_data_object(json, module(i));
+					break;
+			}
+		}
+
+		const Value& v = values[i];
+		switch (col.type) {
+			case Type::INT:		block[key(i)] = v.i; break;
+			case Type::FLOAT:	block[key(i)] = v.f; break;
+			case Type::BOOL:	block[key(i)] = v.b; break;
+			case Type::STRING:	block[key(i)] = v.s; break;
+		}
+	}
+}
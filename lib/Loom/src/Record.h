@@ -0,0 +1,273 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+/// @file		Record.h
+/// @brief		File for Record definition.
+///				Flat, schema-compiled alternative to packaging into a JsonObject.
+/// @date		2020
+/// @copyright	GNU General Public License v3.0
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+#include <type_traits>
+
+namespace Loom {
+
+///////////////////////////////////////////////////////////////////////////////
+
+class Module; // Specify that Module exists, defined in own file
+
+#define RECORD_MAX_COLUMNS		64		///< Maximum number of values in a record
+#define RECORD_MAX_SEGMENTS		24		///< Maximum number of modules contributing to a record
+#define RECORD_NAME_POOL		384		///< Bytes for module names and keys, fixed at compile time
+#define RECORD_TEXT_POOL		96		///< Bytes for string values, refilled every cycle
+
+
+///////////////////////////////////////////////////////////////////////////////
+///
+/// A compiled data record.
+///
+/// The layout of a device's packaged data (which module produces which
+/// key, and of what type) is fixed once the configuration has been parsed.
+/// A Record captures that layout once as a column schema, then each cycle
+/// modules write typed values into a flat, preallocated slot array instead of
+/// building a JsonObject tree.
+/// The equivalent JSON is only produced when a consumer asks for it
+/// (see to_json()).
+///
+/// Schemas are compiled from a module's normal package(JsonObject) output, so
+/// every module works in a record. Modules can additionally override
+/// Module::package_record() to write their values straight into the slots.
+///
+///////////////////////////////////////////////////////////////////////////////
+class Record
+{
+
+public:
+
+	/// Value types that can be stored in a slot
+	enum class Type : uint8_t {
+		INT,		///< Integer (int32_t)
+		FLOAT,		///< Float
+		BOOL,		///< Boolean
+		STRING		///< C-string, copied into the record's text pool
+	};
+
+	/// Where in the packaged JSON a column belongs
+	enum class Section : uint8_t {
+		ID,			///< json["id"][key]
+		TIMESTAMP,	///< json["timestamp"][key]
+		CONTENTS	///< json["contents"][{"module":module, "data":{key}}]
+	};
+
+	/// One column of the schema
+	struct Column {
+		Section		section;
+		Type		type;
+		uint16_t	module;		///< Offset of module name in the name pool (CONTENTS only)
+		uint16_t	key;		///< Offset of key in the name pool
+	};
+
+	/// Columns contributed by one module
+	struct Segment {
+		const Module*	module;		///< Module that produces the values (nullptr for Manager)
+		uint8_t			begin;		///< First column
+		uint8_t			end;		///< One past last column
+	};
+
+	/// Value of one slot
+	union Value {
+		int32_t		i;
+		float		f;
+		bool		b;
+		const char*	s;
+	};
+
+	///////////////////////////////////////////////////////////////////////////
+	///
+	/// Writes one segment's values, in column order.
+	/// Passed to Module::package_record().
+	///
+	///////////////////////////////////////////////////////////////////////////
+	class Writer
+	{
+
+	public:
+
+		/// Write the next value.
+		/// Must be called in the same order that package(JsonObject) adds keys,
+		/// with the same type
+		/// @param[in]	val		Value to write
+		template<typename T>
+		void add(const T val)
+		{
+			if constexpr (std::is_same<T, bool>::value) {
+				put(Type::BOOL, [&](Value& v){ v.b = val; return true; });
+			} else if constexpr (std::is_integral<T>::value) {
+				put(Type::INT, [&](Value& v){ v.i = val; return true; });
+			} else if constexpr (std::is_floating_point<T>::value) {
+				put(Type::FLOAT, [&](Value& v){ v.f = val; return true; });
+			} else {
+				static_assert(std::is_convertible<T, const char*>::value, "Unsupported record value type");
+				put(Type::STRING, [&](Value& v){ return (v.s = record.copy_text(val)) != nullptr; });
+			}
+		}
+
+		/// Whether every column of the segment was written with the expected type,
+		/// and every string fit in the text pool
+		/// @return True if values match the schema
+		bool	valid() const { return ok && (pos == end); }
+
+	private:
+
+		friend class Record;
+
+		Writer(Record& record, const Segment& segment)
+			: record(record), pos(segment.begin), end(segment.end), ok(true) {}
+
+		template<typename F>
+		void put(const Type type, F&& store)
+		{
+			if ( (pos >= end) || (record.columns[pos].type != type) || !store(record.values[pos]) ) {
+				ok = false;
+				return;
+			}
+			pos++;
+		}
+
+		Record&		record;
+		uint8_t		pos;
+		uint8_t		end;
+		bool		ok;
+
+	};
+
+//=============================================================================
+///@name	CONSTRUCTORS / DESTRUCTOR
+/*@{*/ //======================================================================
+
+	Record() { reset(); }
+
+	Record(const Record&) = delete;
+	Record& operator=(const Record&) = delete;
+
+//=============================================================================
+///@name	SCHEMA
+/*@{*/ //======================================================================
+
+	/// Drop the schema and all values
+	void		reset();
+
+	/// Append a segment to the schema, with columns in the order they
+	/// appear in the packaged json of the module.
+	/// @param[in]	module	Module the json came from (nullptr for Manager)
+	/// @param[in]	json	Output of the module's package(JsonObject)
+	/// @return False if json contains values a record can't hold, or capacity is exceeded
+	bool		add_segment(const Module* module, JsonObjectConst json);
+
+	/// Number of columns in the schema
+	/// @return Column count
+	uint8_t		size() const { return column_count; }
+
+	/// Number of segments in the schema
+	/// @return Segment count
+	uint8_t		segment_count() const { return segments_used; }
+
+	/// Hash of the schema (section, type, module and key of each column).
+	/// Equal hashes mean equal layouts, e.g. a log file header can be reused
+	/// @return FNV-1a hash of the columns
+	uint32_t	schema_hash() const { return hash; }
+
+	/// Get a segment of the schema
+	/// @param[in]	idx		Segment index
+	/// @return Segment
+	const Segment&	segment(const uint8_t idx) const { return segments[idx]; }
+
+	/// Get a column of the schema
+	/// @param[in]	idx		Column index
+	/// @return Column
+	const Column&	column(const uint8_t idx) const { return columns[idx]; }
+
+	/// Get the key of a column
+	/// @param[in]	idx		Column index
+	/// @return Key
+	const char*	key(const uint8_t idx) const { return names + columns[idx].key; }
+
+	/// Get the module name of a column
+	/// @param[in]	idx		Column index
+	/// @return Module name, empty for ID and TIMESTAMP columns
+	const char*	module(const uint8_t idx) const { return names + columns[idx].module; }
+
+//=============================================================================
+///@name	VALUES
+/*@{*/ //======================================================================
+
+	/// Start a new set of values. Clears the text pool
+	void		begin_fill() { text_used = 0; }
+
+	/// Get a writer for a segment
+	/// @param[in]	idx		Segment index
+	/// @return Writer over the segment's columns
+	Writer		writer(const uint8_t idx) { return Writer(*this, segments[idx]); }
+
+	/// Copy a segment's values out of packaged json.
+	/// Used for modules that do not implement Module::package_record().
+	/// @param[in]	idx		Segment index
+	/// @param[in]	json	Output of the module's package(JsonObject)
+	/// @return False if json does not match the segment's columns, or its strings
+	///			don't fit in the text pool
+	bool		copy_segment(const uint8_t idx, JsonObjectConst json);
+
+	/// Get a slot value
+	/// @param[in]	idx		Column index
+	/// @return Value, interpret according to column(idx).type
+	const Value&	value(const uint8_t idx) const { return values[idx]; }
+
+	/// Build the packaged json equivalent of the current values.
+	/// Keys and strings are stored in json by pointer, so json is only valid
+	/// until the record is next reset or filled.
+	/// @param[out]	json	Object to add data to
+	void		to_json(JsonObject json) const;
+
+private:
+
+	friend class Writer;
+
+	Column		columns[RECORD_MAX_COLUMNS];
+	Value		values[RECORD_MAX_COLUMNS];
+	Segment		segments[RECORD_MAX_SEGMENTS];
+	char		names[RECORD_NAME_POOL];
+	char		text[RECORD_TEXT_POOL];
+
+	uint8_t		column_count;
+	uint8_t		segments_used;
+	uint16_t	names_used;
+	uint16_t	text_used;
+	uint32_t	hash;
+
+	/// Copy a string into the name pool, reusing an equal name already in it
+	/// @return Offset in pool, or RECORD_NAME_POOL if full
+	uint16_t	add_name(const char* name);
+
+	/// Copy a string value into the text pool
+	/// @return Pointer to copy, nullptr if the pool is full
+	const char*	copy_text(const char* str);
+
+	/// Add a column to the schema hash
+	void		hash_column(const Column& col);
+
+	/// Call visit(section, module, key, value) for each value in packaged json,
+	/// in the order a record stores them
+	/// @return False if json contains something other than id, timestamp and contents
+	template<typename F>
+	static bool	walk(JsonObjectConst json, F&& visit);
+
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+}; // namespace Loom
@@ -189,6 +189,21 @@ void Analog::package(JsonObject json)
 	}
 }
 
+///////////////////////////////////////////////////////////////////////////////
+bool Analog::package_record(Record::Writer& record)
+{
+	// Same values and order as package()
+	record.add(battery);
+	for (auto i = 0; i < ANALOG_COUNT; i++) {
+		if (pin_enabled[i]) {
+			record.add( (!enable_conversions || conversions[i] == Conversion::NONE)
+						 ? analog_vals[i]
+						 : convert(i, analog_vals[i]) );
+		}
+	}
+	return true;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 int Analog::get_analog_val(const uint8_t pin) const
 {
@@ -202,6 +217,7 @@ void Analog::set_pin_enabled(const uint8_t pin, const bool e)
 	if (pin_enabled[pin]) {
 		pinMode(14+pin, INPUT);
 	}
+	invalidate_record();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -30,6 +30,8 @@ namespace Loom {
 ///////////////////////////////////////////////////////////////////////////////
 class Analog : public Sensor
 {
+	LOOM_MODULE_TYPE(Analog, Sensor)
+
 public:
 
 	/// Different types of conversions from
@@ -124,6 +126,7 @@ public:
 
 	void		measure() override;
 	void		package(JsonObject json) override;
+	bool		package_record(Record::Writer& record) override;
 	void		add_config(JsonObject json) override;
 
 //=============================================================================
@@ -177,11 +180,11 @@ public:
 	/// Set the current conversion associated with a pin
 	/// @param[in]	pin		The pin to set conversion for
 	/// @param[in]	c		The Conversion to use
-	void  		set_conversion(const uint8_t pin, const Conversion c) { conversions[pin] = c; }
+	void  		set_conversion(const uint8_t pin, const Conversion c) { conversions[pin] = c; invalidate_record(); }
 
 	/// Enable or disable all conversions
 	/// @param[in]	e		Enable state
-	void  		set_enable_conversions(const bool e) { enable_conversions = e; }
+	void  		set_enable_conversions(const bool e) { enable_conversions = e; invalidate_record(); }
 
 	/// Set temperature to use in conversions that require temperature compensation
 	/// @param[in]	temp	Temperature to use
@@ -154,6 +154,19 @@ void Digital::package(JsonObject json)
 	}
 }
 
+///////////////////////////////////////////////////////////////////////////////
+bool Digital::package_record(Record::Writer& record)
+{
+	// Same values and order as package()
+	for (auto i = 0; i < 6; i++) {
+		if (pin_enabled[i]) record.add(digital_vals[i]);
+	}
+	for (auto i = 0; i < 6; i++) {
+		if (pin_enabled[i+6]) record.add(digital_vals[i]);
+	}
+	return true;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 bool Digital::get_digital_val(const uint8_t pin) const
 {
@@ -185,6 +198,7 @@ bool Digital::get_pin_enabled(const uint8_t pin) const
 void Digital::set_pin_enabled(const uint8_t pin, const bool e)
 {
 	pin_enabled[ pin_to_index(pin) ] = e;
+	invalidate_record();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
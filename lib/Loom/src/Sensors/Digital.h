@@ -32,6 +32,7 @@ namespace Loom {
 ///////////////////////////////////////////////////////////////////////////////
 class Digital : public Sensor
 {
+	LOOM_MODULE_TYPE(Digital, Sensor)
 
 protected:
 
@@ -87,6 +88,7 @@ public:
 
 	void		measure() override;
 	void		package(JsonObject json) override;
+	bool		package_record(Record::Writer& record) override;
 	void		add_config(JsonObject json) override;
 
 //=============================================================================
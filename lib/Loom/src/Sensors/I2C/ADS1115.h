@@ -32,6 +32,8 @@ namespace Loom {
 ///////////////////////////////////////////////////////////////////////////////
 class ADS1115 : public I2CSensor
 {
+	LOOM_MODULE_TYPE(ADS1115, I2CSensor)
+
 protected :
 		///< Underlying ADS1115 sensor manager instance
 
@@ -35,6 +35,8 @@ namespace Loom {
 ///////////////////////////////////////////////////////////////////////////////
 class AS7262 : public I2CSensor
 {
+	LOOM_MODULE_TYPE(AS7262, I2CSensor)
+
 protected:
 
 	// AS726X		inst_AS7262;		///< Underlying AS7262 sensor manager instance
@@ -33,6 +33,8 @@ namespace Loom {
 ///////////////////////////////////////////////////////////////////////////////
 class AS7263 : public I2CSensor
 {
+	LOOM_MODULE_TYPE(AS7263, I2CSensor)
+
 protected:
 
 	// AS726X		inst_AS7263;		///< Underlying AS7263 sensor manager instance
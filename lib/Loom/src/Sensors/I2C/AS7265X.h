@@ -33,6 +33,8 @@ namespace Loom {
 ///////////////////////////////////////////////////////////////////////////////
 class AS7265X : public I2CSensor
 {
+	LOOM_MODULE_TYPE(AS7265X, I2CSensor)
+
 protected:
 
 	::AS7265X inst_AS7265X; ///< Underlying AS7265X sensor manager instance
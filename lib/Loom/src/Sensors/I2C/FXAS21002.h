@@ -33,6 +33,8 @@ namespace Loom {
 ///////////////////////////////////////////////////////////////////////////////
 class FXAS21002 : public I2CSensor
 {
+	LOOM_MODULE_TYPE(FXAS21002, I2CSensor)
+
 protected:
 	
 	Adafruit_FXAS21002C		inst_FXAS21002;		///< Underlying FXAS21002 sensor manager instance
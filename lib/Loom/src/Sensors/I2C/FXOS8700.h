@@ -33,6 +33,8 @@ namespace Loom {
 ///////////////////////////////////////////////////////////////////////////////
 class FXOS8700 : public I2CSensor
 {
+	LOOM_MODULE_TYPE(FXOS8700, I2CSensor)
+
 protected:
 
 	Adafruit_FXOS8700	inst_FXOS8700;		///< Underlying FXOS8700 sensor manager instance
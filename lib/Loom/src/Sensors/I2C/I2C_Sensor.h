@@ -27,6 +27,8 @@ namespace Loom {
 ///////////////////////////////////////////////////////////////////////////////
 class I2CSensor : public Sensor
 {
+	LOOM_MODULE_TYPE(I2CSensor, Sensor)
+
 protected:
 	
 	/// The sensor's I2C address.
@@ -35,6 +35,8 @@ namespace Loom {
 ///////////////////////////////////////////////////////////////////////////////
 class LIS3DH : public I2CSensor
 {
+	LOOM_MODULE_TYPE(LIS3DH, I2CSensor)
+
 protected:
 
 	::LIS3DH inst_LIS3DH; ///< Underlying LIS3DH sensor manager instance
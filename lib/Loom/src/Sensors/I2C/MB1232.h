@@ -28,6 +28,8 @@ namespace Loom {
 ///////////////////////////////////////////////////////////////////////////////
 class MB1232 : public I2CSensor
 {
+	LOOM_MODULE_TYPE(MB1232, I2CSensor)
+
 protected:
 
 	uint16_t	range;		///< Measure distance. Units: cm.
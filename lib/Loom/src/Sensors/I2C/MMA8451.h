@@ -33,6 +33,8 @@ namespace Loom {
 ///////////////////////////////////////////////////////////////////////////////
 class MMA8451 : public I2CSensor
 {
+	LOOM_MODULE_TYPE(MMA8451, I2CSensor)
+
 protected:
 
 	Adafruit_MMA8451 MMA;			///< Underlying MMA8451 sensor manager instance
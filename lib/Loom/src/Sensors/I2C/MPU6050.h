@@ -32,6 +32,8 @@ namespace Loom {
 ///////////////////////////////////////////////////////////////////////////////
 class MPU6050 : public I2CSensor
 {
+	LOOM_MODULE_TYPE(MPU6050, I2CSensor)
+
 protected:
 
 	float temp;				///< Temperature. Units: °C
@@ -36,6 +36,8 @@ namespace Loom {
 ///////////////////////////////////////////////////////////////////////////////
 class MS5803 : public I2CSensor
 {
+	LOOM_MODULE_TYPE(MS5803, I2CSensor)
+
 protected:
 
 	MS_5803		inst_MS5803;	///< Underlying MS5803 sensor manager instance
@@ -31,6 +31,8 @@ namespace Loom {
 ///////////////////////////////////////////////////////////////////////////////
 class SHT31D : public I2CSensor
 {
+	LOOM_MODULE_TYPE(SHT31D, I2CSensor)
+
 protected:
 	
 	Adafruit_SHT31	inst_sht31d;	///< Underlying SHT31D sensor manager instance
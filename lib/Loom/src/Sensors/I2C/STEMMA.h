@@ -21,6 +21,8 @@ namespace Loom {
 ///////////////////////////////////////////////////////////////////////////////
 class STEMMA : public I2CSensor
 {
+  LOOM_MODULE_TYPE(STEMMA, I2CSensor)
+
 protected:
 
     /// Adafruit Seesaw object.
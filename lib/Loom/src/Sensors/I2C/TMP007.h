@@ -31,6 +31,8 @@ namespace Loom {
 ///////////////////////////////////////////////////////////////////////////////
 class TMP007 : public I2CSensor
 {
+	LOOM_MODULE_TYPE(TMP007, I2CSensor)
+
 protected:
 
 	Adafruit_TMP007 inst_tmp007;	///< Underlying TMP007 sensor manager instance
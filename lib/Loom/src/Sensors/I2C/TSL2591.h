@@ -32,6 +32,8 @@ namespace Loom {
 ///////////////////////////////////////////////////////////////////////////////
 class TSL2591 : public I2CSensor
 {
+	LOOM_MODULE_TYPE(TSL2591, I2CSensor)
+
 protected:
 
 	Adafruit_TSL2591	inst_tsl2591;		///< Underlying TSL2591 sensor manager instance
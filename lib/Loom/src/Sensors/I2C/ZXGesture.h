@@ -33,6 +33,8 @@ namespace Loom {
 ///////////////////////////////////////////////////////////////////////////////
 class ZXGesture : public I2CSensor
 {
+	LOOM_MODULE_TYPE(ZXGesture, I2CSensor)
+
 public:
 
 	/// Different modes of the ZX gesture sensor
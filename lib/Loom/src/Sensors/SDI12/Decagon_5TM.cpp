@@ -57,6 +57,17 @@ void Decagon5TM::measure()
 	LMark;
 }
 
+///////////////////////////////////////////////////////////////////////////////
+bool Decagon5TM::poll()
+{
+	if(poll_measurement(sensorAddr, sdiResponse)){
+		return true;
+	}
+
+	parse_results();
+	return false;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 void Decagon5TM::package(JsonObject json)
 {
@@ -28,6 +28,7 @@ namespace Loom {
 ///////////////////////////////////////////////////////////////////////////////
 class Decagon5TM : public SDI12Sensor
 {
+	LOOM_MODULE_TYPE(Decagon5TM, SDI12Sensor)
 
 protected:
 
@@ -67,6 +68,10 @@ public:
 /*@{*/ //======================================================================
 
 	void		measure() override;
+
+	/// Measure in steps, without blocking while the sensor responds
+	/// @return True while the measurement is in progress
+	bool		poll() override;
 	void		package(JsonObject json) override;
 
 //=============================================================================
@@ -57,6 +57,17 @@ void DecagonGS3::measure()
 	LMark;
 }
 
+///////////////////////////////////////////////////////////////////////////////
+bool DecagonGS3::poll()
+{
+	if(poll_measurement(sensorAddr, sdiResponse)){
+		return true;
+	}
+
+	parse_results();
+	return false;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 void DecagonGS3::package(JsonObject json)
 {
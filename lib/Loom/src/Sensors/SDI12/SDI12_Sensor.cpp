@@ -190,6 +190,83 @@ String SDI12Sensor::sendCommand_allBuffer(char addr, String command){
 	return "";
 }
 
+// Sends a command over SDI12 to a device without waiting for the response
+void SDI12Sensor::begin_command(char addr, const char* command){
+	String fullCommand = "";
+
+	fullCommand += addr;
+	fullCommand += command; // [address][command]
+
+	sdiInterface.sendCommand(fullCommand);
+	LMark;
+
+	poll_response = "";
+	poll_wait.start(SDI12_RESPONSE_DELAY, AsyncDelay::MILLIS);
+}
+
+// Reads whatever part of the response has arrived, returns true once complete
+bool SDI12Sensor::read_response(){
+	// Give the sensor time to start responding, like sendCommand()
+	if(!poll_wait.isExpired()){
+		return false;
+	}
+
+	bool ended = false;
+	while (sdiInterface.available()){
+		char c = sdiInterface.read();
+
+		// End of the message
+		if(c == '\n'){
+			ended = true;
+			break;
+		}
+
+		poll_response += c;
+
+		// Wait for the next character like read_next_message() does
+		poll_wait.start(SDI12_CHAR_TIMEOUT, AsyncDelay::MILLIS);
+	}
+
+	// Complete once the line ended or the sensor stopped sending
+	if(!ended && !poll_wait.isExpired()){
+		return false;
+	}
+
+	if(poll_response.endsWith("\r")){
+		poll_response.remove(poll_response.length()-1);
+	}
+
+	// Clear the serial buffer
+	sdiInterface.clearBuffer();
+	return true;
+}
+
+// Steps through a measurement, returns true until the data has been read
+bool SDI12Sensor::poll_measurement(char addr, String& response){
+	switch(poll_step){
+		case PollStep::Idle:
+			begin_command(addr, "M!");
+			poll_step = PollStep::Measure;
+			return true;
+
+		case PollStep::Measure:
+			if(!read_response()) return true;
+
+			// Poll data from the sensor
+			begin_command(addr, "D0!");
+			poll_step = PollStep::Data;
+			return true;
+
+		case PollStep::Data:
+			if(!read_response()) return true;
+
+			response = poll_response;
+			poll_step = PollStep::Idle;
+			return false;
+	}
+	return false;
+}
+
 /**
  * Read next message in the message queue 
  */ 
@@ -13,11 +13,15 @@
 
 #include "../Sensor.h"
 #include <SDI12.h>
+#include <AsyncDelay.h>
 #include <vector>
 #include <string.h>
 
 namespace Loom {
 
+#define SDI12_RESPONSE_DELAY	30	///< Milliseconds a sensor is given to start responding to a command
+#define SDI12_CHAR_TIMEOUT		20	///< Milliseconds to wait for the next character of a response
+
 ///////////////////////////////////////////////////////////////////////////////
 ///
 /// Abstract base class for SDI12 sensor modules.
@@ -29,6 +33,7 @@ namespace Loom {
 ///////////////////////////////////////////////////////////////////////////////
 class SDI12Sensor : public Sensor
 {
+	LOOM_MODULE_TYPE(SDI12Sensor, Sensor)
 
 protected:
 	SDI12 sdiInterface; // SDI12 Object
@@ -70,6 +75,34 @@ protected:
 	// Given a string split by delimeter and return the requested index
 	String parse_string_by_delimeter(String str, const char* delim, int index);
 
+	/// Steps of a measurement taken by poll_measurement()
+	enum class PollStep : uint8_t {
+		Idle,		///< No measurement in progress
+		Measure,	///< Reading the response to M!
+		Data		///< Reading the response to D0!
+	};
+
+	PollStep	poll_step = PollStep::Idle;	///< Step of the measurement in progress
+	AsyncDelay	poll_wait;					///< Time left to wait for the response
+	String		poll_response;				///< Response read so far
+
+	/// Send a command without waiting for the response, see read_response()
+	/// @param[in]	addr		Address of the sensor
+	/// @param[in]	command		Command to send
+	void begin_command(char addr, const char* command);
+
+	/// Read the part of the response to begin_command() that has arrived.
+	/// Same result as sendCommand(), without its delays
+	/// @return True once the whole response is in poll_response
+	bool read_response();
+
+	/// Take a measurement (M! then D0!, as the sensors' measure() does)
+	/// in non-blocking steps, for poll()
+	/// @param[in]	addr		Address of the sensor
+	/// @param[out]	response	Response to D0!, once finished
+	/// @return True while the measurement is in progress
+	bool poll_measurement(char addr, String& response);
+
 public:
 	
 //=============================================================================
@@ -91,6 +91,22 @@ void SDI_Manager::measure()
 
 ///////////////////////////////////////////////////////////////////////////////
 
+bool SDI_Manager::poll()
+{
+	// Move on to the next sensor once one finishes
+	while(poll_index < sensors.size()){
+		if(sensors[poll_index]->poll()){
+			return true;
+		}
+		poll_index++;
+	}
+
+	poll_index = 0;
+	return false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 void SDI_Manager::package(JsonObject json)
 {
 	// For each constructed sensor call their respective package methods
@@ -29,12 +29,14 @@ namespace Loom {
 	///////////////////////////////////////////////////////////////////////////////
 	class SDI_Manager : public SDI12Sensor
 	{
+		LOOM_MODULE_TYPE(SDI_Manager, SDI12Sensor)
 
 		protected:
 			const uint8_t				pinAddr; // Pin on the feather that SDI12 is running off
 
 			std::map<char, String> 			sensorsInfo; // Mapping sensor address to sensor version
 			std::vector<SDI12Sensor*> 		sensors; // Vector of actual sensor classes
+			uint8_t							poll_index = 0; // Sensor poll() is measuring
 
 			// Construct the used sensors and add them to a vector
 			void construct_sensors();
@@ -67,6 +69,11 @@ namespace Loom {
 			void		measure() override;
 			void		package(JsonObject json) override;
 
+			/// Measure each sensor in steps, one after another since they
+			/// share the bus
+			/// @return True while a measurement is in progress
+			bool		poll() override;
+
 			void		power_up() override;
 			void 		power_down() override;
 
@@ -62,6 +62,17 @@ void Teros::measure()
 }
 
 
+///////////////////////////////////////////////////////////////////////////////
+bool Teros::poll()
+{
+	if(poll_measurement(sensorAddr, sdiResponse)){
+		return true;
+	}
+
+	parse_results();
+	return false;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 void Teros::package(JsonObject json)
 {
@@ -29,6 +29,7 @@ namespace Loom {
 ///////////////////////////////////////////////////////////////////////////////
 class Teros : public SDI12Sensor
 {
+	LOOM_MODULE_TYPE(Teros, SDI12Sensor)
 
 protected:
 
@@ -71,6 +72,10 @@ public:
 /*@{*/ //======================================================================
 
 	void		measure() override;
+
+	/// Measure in steps, without blocking while the sensor responds
+	/// @return True while the measurement is in progress
+	bool		poll() override;
 	void		package(JsonObject json) override;
 
 //=============================================================================
@@ -29,6 +29,8 @@ namespace Loom {
 ///////////////////////////////////////////////////////////////////////////////
 class K30 : public SerialSensor
 {
+  LOOM_MODULE_TYPE(K30, SerialSensor)
+
     protected:
 
     float CO2_levels;
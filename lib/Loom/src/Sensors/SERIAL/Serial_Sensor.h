@@ -24,6 +24,7 @@ namespace Loom {
 ///////////////////////////////////////////////////////////////////////////////
 class SerialSensor : public Sensor 
 {
+  LOOM_MODULE_TYPE(SerialSensor, Sensor)
 
 protected:
 
@@ -29,6 +29,8 @@ namespace Loom {
 ///////////////////////////////////////////////////////////////////////////////
 class MAX31855 : public SPISensor
 {
+	LOOM_MODULE_TYPE(MAX31855, SPISensor)
+
 protected:
 
 	Adafruit_MAX31855 inst_max;		///< Underlying MAX31855 sensor manager instance
@@ -29,6 +29,8 @@ namespace Loom {
 ///////////////////////////////////////////////////////////////////////////////
 class MAX31856 : public SPISensor
 {
+	LOOM_MODULE_TYPE(MAX31856, SPISensor)
+
 protected:
 
 	Adafruit_MAX31856 inst_max;		///< Underlying MAX31856 sensor manager instance
@@ -25,6 +25,7 @@ namespace Loom {
 ///////////////////////////////////////////////////////////////////////////////
 class SPISensor : public Sensor
 {
+	LOOM_MODULE_TYPE(SPISensor, Sensor)
 
 protected:
 
@@ -25,6 +25,7 @@ namespace Loom {
 ///////////////////////////////////////////////////////////////////////////////
 class Sensor : public Module
 {
+	LOOM_MODULE_TYPE(Sensor, Module)
 
 protected:
 
@@ -59,6 +60,11 @@ public:
 	/// Take any relevant measurements
 	virtual void	measure() = 0;
 
+	/// Take a measurement when scheduled with Manager::schedule().
+	/// Sensors on slow buses override this to measure in several steps
+	/// @return True if the measurement is still in progress
+	virtual bool	poll() override { measure(); return false; }
+
 //=============================================================================
 ///@name	PRINT INFORMATION
 /*@{*/ //======================================================================
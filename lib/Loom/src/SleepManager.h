@@ -34,6 +34,7 @@ class InterruptManager;
 ///////////////////////////////////////////////////////////////////////////////
 class SleepManager : public Module
 {
+	LOOM_MODULE_TYPE(SleepManager, Module)
 
 public:
 
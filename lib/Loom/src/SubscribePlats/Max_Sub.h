@@ -28,6 +28,7 @@ namespace Loom {
 ///////////////////////////////////////////////////////////////////////////////
 class MaxSub : public SubscribePlat
 {
+	LOOM_MODULE_TYPE(MaxSub, SubscribePlat)
 
 protected:
 
@@ -28,6 +28,7 @@ namespace Loom {
 ///////////////////////////////////////////////////////////////////////////////
 class SubscribePlat : public Module
 {
+	LOOM_MODULE_TYPE(SubscribePlat, Module)
 
 protected:
 
@@ -0,0 +1,40 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+/// @file		Adafruit_BluefruitLE_SPI.h
+/// @brief		Simulated Adafruit Bluefruit LE (nRF51 over SPI) used by the
+///				native (host) build.
+/// @details	No central ever connects: the UART accepts and discards
+///				writes and has nothing to read.
+/// @date		2020
+/// @copyright	GNU General Public License v3.0
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "Arduino.h"
+
+#define BLUEFRUIT_MODE_COMMAND	1
+#define BLUEFRUIT_MODE_DATA		0
+
+///////////////////////////////////////////////////////////////////////////////
+class Adafruit_BluefruitLE_SPI : public Stream
+{
+
+public:
+
+	Adafruit_BluefruitLE_SPI(int8_t cs_pin, int8_t irq_pin, int8_t rst_pin = -1) {}
+
+	bool		begin(bool verbose = false, bool blocking = true) { return true; }
+	bool		setMode(uint8_t mode) { return true; }
+	bool		isConnected() { return false; }
+
+	size_t		write(uint8_t data) override { return 1; }
+	size_t		write(const uint8_t* data, size_t quantity) override { return quantity; }
+	using Print::write;
+
+	int			available() override { return 0; }
+	int			read() override { return -1; }
+	int			peek() override { return -1; }
+
+};
@@ -0,0 +1,57 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+/// @file		Adafruit_GFX.h
+/// @brief		Simulated Adafruit_GFX used by the native (host) build.
+/// @details	Tracks cursor and text state, drawing is discarded.
+/// @date		2020
+/// @copyright	GNU General Public License v3.0
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "Arduino.h"
+
+///////////////////////////////////////////////////////////////////////////////
+class Adafruit_GFX : public Print
+{
+
+public:
+
+	Adafruit_GFX(int16_t w, int16_t h) : _width(w), _height(h) {}
+
+	void		setCursor(int16_t x, int16_t y) { cursor_x = x; cursor_y = y; }
+	void		setTextColor(uint16_t c) { textcolor = c; }
+	void		setTextColor(uint16_t c, uint16_t bg) { textcolor = c; }
+	void		setTextSize(uint8_t s) { textsize = s; }
+	void		setTextWrap(bool w) {}
+	void		setRotation(uint8_t r) {}
+
+	virtual void	drawPixel(int16_t x, int16_t y, uint16_t color) {}
+	virtual void	fillScreen(uint16_t color) {}
+	void		drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color) {}
+	void		drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {}
+	void		fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {}
+
+	int16_t		width() const { return _width; }
+	int16_t		height() const { return _height; }
+	int16_t		getCursorX() const { return cursor_x; }
+	int16_t		getCursorY() const { return cursor_y; }
+
+	/// Advances the cursor as a 6x8 font would
+	size_t		write(uint8_t c) override
+	{
+		if (c == '\n') { cursor_x = 0; cursor_y += 8 * textsize; }
+		else if (c != '\r') cursor_x += 6 * textsize;
+		return 1;
+	}
+	using Print::write;
+
+protected:
+
+	int16_t		_width, _height;
+	int16_t		cursor_x = 0, cursor_y = 0;
+	uint16_t	textcolor = 0xFFFF;
+	uint8_t		textsize = 1;
+
+};
@@ -0,0 +1,43 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+/// @file		Adafruit_SSD1306.h
+/// @brief		Simulated Adafruit_SSD1306 used by the native (host) build.
+/// @date		2020
+/// @copyright	GNU General Public License v3.0
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "Adafruit_GFX.h"
+
+#define BLACK				0
+#define WHITE				1
+#define INVERSE				2
+
+#define SSD1306_BLACK		BLACK
+#define SSD1306_WHITE		WHITE
+#define SSD1306_INVERSE		INVERSE
+
+#define SSD1306_EXTERNALVCC	0x01
+#define SSD1306_SWITCHCAPVCC	0x02
+
+#define SSD1306_LCDWIDTH	128
+#define SSD1306_LCDHEIGHT	32
+
+///////////////////////////////////////////////////////////////////////////////
+class Adafruit_SSD1306 : public Adafruit_GFX
+{
+
+public:
+
+	Adafruit_SSD1306(int8_t reset_pin = -1)
+		: Adafruit_GFX(SSD1306_LCDWIDTH, SSD1306_LCDHEIGHT) {}
+
+	bool		begin(uint8_t vcs = SSD1306_SWITCHCAPVCC, uint8_t addr = 0x3C, bool reset = true) { return true; }
+	void		display() {}
+	void		clearDisplay() { cursor_x = cursor_y = 0; }
+	void		invertDisplay(bool i) {}
+	void		dim(bool dim) {}
+
+};
@@ -0,0 +1,242 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+/// @file		Arduino.cpp
+/// @brief		Simulated Arduino core implementation (time, pins, helpers).
+/// @date		2020
+/// @copyright	GNU General Public License v3.0
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#include "Arduino.h"
+
+using namespace LoomNative;
+
+USBDeviceClass	USBDevice;
+SysTick_Type	SysTick_Regs = { SysTick_CTRL_CLKSOURCE_Msk | SysTick_CTRL_TICKINT_Msk | SysTick_CTRL_ENABLE_Msk, 0, 0, 0 };
+
+///////////////////////////////////////////////////////////////////////////////
+// Time
+
+unsigned long millis()
+{
+	return (unsigned long)(uint32_t)(Clock::now_us() / 1000ULL);
+}
+
+unsigned long micros()
+{
+	return (unsigned long)(uint32_t)Clock::now_us();
+}
+
+void delay(unsigned long ms)
+{
+	Clock::sleep_us((uint64_t)ms * 1000ULL);
+}
+
+void delayMicroseconds(unsigned int us)
+{
+	Clock::sleep_us(us);
+}
+
+void yield() {}
+
+///////////////////////////////////////////////////////////////////////////////
+// Pins
+
+/// State of one simulated pin
+struct SimPin {
+	int			mode;
+	int			input_level;
+	int			output_level;
+	uint16_t	analog_value;
+	voidFuncPtr	isr;
+	uint32_t	isr_mode;
+};
+
+static SimPin	pins[NUM_DIGITAL_PINS];
+static int		read_resolution = 10;
+
+void pinMode(uint32_t pin, uint32_t mode)
+{
+	if (pin >= NUM_DIGITAL_PINS) return;
+	pins[pin].mode = mode;
+	if (mode == INPUT_PULLUP) pins[pin].input_level = HIGH;
+}
+
+void digitalWrite(uint32_t pin, uint32_t val)
+{
+	if (pin >= NUM_DIGITAL_PINS) return;
+	pins[pin].output_level = val ? HIGH : LOW;
+}
+
+int digitalRead(uint32_t pin)
+{
+	if (pin >= NUM_DIGITAL_PINS) return LOW;
+	return (pins[pin].mode == OUTPUT) ? pins[pin].output_level : pins[pin].input_level;
+}
+
+int analogRead(uint32_t pin)
+{
+	if (pin <= 5) pin += A0;	// As the SAMD core, channel numbers 0-5 map to A0..A5
+	if (pin >= NUM_DIGITAL_PINS) return 0;
+	// Simulated values are stored at 12 bits
+	const int shift = 12 - read_resolution;
+	return (shift >= 0) ? (pins[pin].analog_value >> shift) : (pins[pin].analog_value << -shift);
+}
+
+void analogWrite(uint32_t pin, uint32_t val)
+{
+	if (pin >= NUM_DIGITAL_PINS) return;
+	pins[pin].output_level = val;
+}
+
+void analogReadResolution(int bits)
+{
+	read_resolution = bits;
+}
+
+void analogWriteResolution(int bits) {}
+
+void attachInterrupt(uint32_t pin, voidFuncPtr callback, uint32_t mode)
+{
+	if (pin >= NUM_DIGITAL_PINS) return;
+	pins[pin].isr = callback;
+	pins[pin].isr_mode = mode;
+}
+
+void detachInterrupt(uint32_t pin)
+{
+	if (pin >= NUM_DIGITAL_PINS) return;
+	pins[pin].isr = nullptr;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void Pins::set_analog(const uint8_t pin, const uint16_t value)
+{
+	if (pin >= NUM_DIGITAL_PINS) return;
+	pins[pin].analog_value = value & 0x0FFF;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void Pins::set_digital(const uint8_t pin, const int level)
+{
+	if (pin >= NUM_DIGITAL_PINS) return;
+	SimPin& p = pins[pin];
+	const int previous = p.input_level;
+	p.input_level = level ? HIGH : LOW;
+
+	if (!p.isr) return;
+	bool fire = false;
+	switch (p.isr_mode) {
+		case LOW:		fire = (p.input_level == LOW); break;
+		case HIGH:		fire = (p.input_level == HIGH); break;
+		case CHANGE:	fire = (previous != p.input_level); break;
+		case FALLING:	fire = (previous == HIGH && p.input_level == LOW); break;
+		case RISING:	fire = (previous == LOW && p.input_level == HIGH); break;
+	}
+	if (fire) p.isr();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int Pins::get_output(const uint8_t pin)
+{
+	return (pin < NUM_DIGITAL_PINS) ? pins[pin].output_level : LOW;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int Pins::get_mode(const uint8_t pin)
+{
+	return (pin < NUM_DIGITAL_PINS) ? pins[pin].mode : INPUT;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void Pins::reset()
+{
+	for (auto& p : pins) p = SimPin{};
+	read_resolution = 10;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Math
+
+/// Deterministic generator so simulated runs are reproducible
+static uint32_t random_state = 1;
+
+static uint32_t next_random()
+{
+	// xorshift32
+	uint32_t x = random_state;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	random_state = x;
+	return x;
+}
+
+long random(long max)
+{
+	return (max <= 0) ? 0 : (long)(next_random() % (uint32_t)max);
+}
+
+long random(long min, long max)
+{
+	return (min >= max) ? min : min + random(max - min);
+}
+
+void randomSeed(unsigned long seed)
+{
+	if (seed != 0) random_state = (uint32_t)seed;
+}
+
+long map(long x, long in_min, long in_max, long out_min, long out_max)
+{
+	if (in_max == in_min) return out_min;
+	return (x - in_min) * (out_max - out_min) / (in_max - in_min) + out_min;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Non-standard C helpers
+
+extern "C" {
+
+char* ultoa(unsigned long value, char* str, int base)
+{
+	char buf[8 * sizeof(long) + 1];
+	char* p = &buf[sizeof(buf) - 1];
+	*p = '\0';
+	if (base < 2 || base > 36) base = 10;
+	do {
+		const int digit = value % base;
+		*--p = (digit < 10) ? ('0' + digit) : ('a' + digit - 10);
+		value /= base;
+	} while (value);
+	strcpy(str, p);
+	return str;
+}
+
+char* ltoa(long value, char* str, int base)
+{
+	if (base == 10 && value < 0) {
+		str[0] = '-';
+		ultoa((unsigned long)(-value), str + 1, base);
+		return str;
+	}
+	return ultoa((unsigned long)value, str, base);
+}
+
+char* itoa(int value, char* str, int base)
+{
+	return ltoa(value, str, base);
+}
+
+char* utoa(unsigned value, char* str, int base)
+{
+	return ultoa(value, str, base);
+}
+
+char* dtostrf(double val, signed char width, unsigned char prec, char* sout)
+{
+	sprintf(sout, "%*.*f", width, prec, val);
+	return sout;
+}
+
+} // extern "C"
@@ -0,0 +1,203 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+/// @file		Arduino.h
+/// @brief		Simulated Arduino core used by the native (host) build.
+/// @details	Provides the subset of the Arduino API that Loom relies on,
+///				backed by a deterministic virtual clock and simulated pins.
+/// @date		2020
+/// @copyright	GNU General Public License v3.0
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+#include <ctype.h>
+
+#include <algorithm>
+#include <typeinfo>
+
+#include "SimClock.h"
+#include "WString.h"
+#include "Print.h"
+#include "Stream.h"
+#include "HardwareSerial.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Types and constants
+
+typedef uint8_t		byte;
+typedef bool		boolean;
+typedef uint16_t	word;
+typedef unsigned int uint;
+
+#define HIGH			0x1
+#define LOW				0x0
+
+#define INPUT			0x0
+#define OUTPUT			0x1
+#define INPUT_PULLUP	0x2
+#define INPUT_PULLDOWN	0x3
+
+#define CHANGE			2
+#define FALLING			3
+#define RISING			4
+
+#define LED_BUILTIN		13
+
+#define PIN_A0			14
+#define PIN_A1			15
+#define PIN_A2			16
+#define PIN_A3			17
+#define PIN_A4			18
+#define PIN_A5			19
+
+static const uint8_t A0 = PIN_A0;
+static const uint8_t A1 = PIN_A1;
+static const uint8_t A2 = PIN_A2;
+static const uint8_t A3 = PIN_A3;
+static const uint8_t A4 = PIN_A4;
+static const uint8_t A5 = PIN_A5;
+static const uint8_t A7 = 9;		///< Feather M0 battery divider
+
+#define PIN_WIRE_SDA	20
+#define PIN_WIRE_SCL	21
+
+static const uint8_t SDA = PIN_WIRE_SDA;
+static const uint8_t SCL = PIN_WIRE_SCL;
+
+#define NUM_DIGITAL_PINS	26
+
+#define PI			3.1415926535897932384626433832795
+#define DEG_TO_RAD	0.017453292519943295769236907684886
+#define RAD_TO_DEG	57.295779513082320876798154814105
+
+#define bitRead(value, bit)				(((value) >> (bit)) & 0x01)
+#define bitSet(value, bit)				((value) |= (1UL << (bit)))
+#define bitClear(value, bit)			((value) &= ~(1UL << (bit)))
+#define bitWrite(value, bit, bitvalue)	((bitvalue) ? bitSet(value, bit) : bitClear(value, bit))
+#define lowByte(w)						((uint8_t) ((w) & 0xff))
+#define highByte(w)						((uint8_t) ((w) >> 8))
+
+#define digitalPinToInterrupt(p)		(p)
+
+#define interrupts()
+#define noInterrupts()
+
+/// Flash strings are ordinary strings on the host
+class __FlashStringHelper;
+#define F(string_literal) (reinterpret_cast<const __FlashStringHelper*>(string_literal))
+#define PROGMEM
+#define pgm_read_byte(addr)	(*(const uint8_t*)(addr))
+
+///////////////////////////////////////////////////////////////////////////////
+// Time
+
+unsigned long	millis();
+unsigned long	micros();
+void			delay(unsigned long ms);
+void			delayMicroseconds(unsigned int us);
+void			yield();
+
+///////////////////////////////////////////////////////////////////////////////
+// Pins
+
+typedef void (*voidFuncPtr)(void);
+
+void			pinMode(uint32_t pin, uint32_t mode);
+void			digitalWrite(uint32_t pin, uint32_t val);
+int				digitalRead(uint32_t pin);
+int				analogRead(uint32_t pin);
+void			analogWrite(uint32_t pin, uint32_t val);
+void			analogReadResolution(int bits);
+void			analogWriteResolution(int bits);
+void			attachInterrupt(uint32_t pin, voidFuncPtr callback, uint32_t mode);
+void			detachInterrupt(uint32_t pin);
+
+///////////////////////////////////////////////////////////////////////////////
+// Math
+
+long			random(long max);
+long			random(long min, long max);
+void			randomSeed(unsigned long seed);
+long			map(long x, long in_min, long in_max, long out_min, long out_max);
+
+inline uint16_t	makeWord(uint8_t h, uint8_t l) { return (h << 8) | l; }
+#define word(...) makeWord(__VA_ARGS__)
+
+template <typename T, typename L, typename H>
+inline T constrain(T amt, L low, H high) { return (amt < low) ? low : ((amt > high) ? high : amt); }
+
+// Same as newer SAMD cores: std::min/max rather than macros, so the
+// standard library headers can be included after Arduino.h
+using std::min;
+using std::max;
+
+///////////////////////////////////////////////////////////////////////////////
+// SAMD21 registers and peripherals touched directly by Loom
+
+/// USB device controller, attach/detach are no-ops on the host
+struct USBDeviceClass {
+	bool	attach() { return true; }
+	bool	detach() { return true; }
+};
+extern USBDeviceClass USBDevice;
+
+/// SysTick register block. Writes are recorded but do not affect the virtual clock
+struct SysTick_Type {
+	volatile uint32_t CTRL;
+	volatile uint32_t LOAD;
+	volatile uint32_t VAL;
+	volatile uint32_t CALIB;
+};
+extern SysTick_Type SysTick_Regs;
+#define SysTick		(&SysTick_Regs)
+
+#define SysTick_CTRL_ENABLE_Msk		(1UL << 0)
+#define SysTick_CTRL_TICKINT_Msk	(1UL << 1)
+#define SysTick_CTRL_CLKSOURCE_Msk	(1UL << 2)
+
+///////////////////////////////////////////////////////////////////////////////
+// Non-standard C helpers provided by the Arduino core
+
+extern "C" {
+	char*	itoa(int value, char* str, int base);
+	char*	utoa(unsigned value, char* str, int base);
+	char*	ltoa(long value, char* str, int base);
+	char*	ultoa(unsigned long value, char* str, int base);
+	char*	dtostrf(double val, signed char width, unsigned char prec, char* sout);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Simulation controls (not part of the Arduino API)
+
+namespace LoomNative {
+
+/// Simulated GPIO / ADC state.
+/// Lets benchmarks and host tools drive what the sketch reads.
+namespace Pins {
+
+	/// Set the raw value returned by analogRead(pin), at 12-bit resolution
+	void	set_analog(const uint8_t pin, const uint16_t value);
+
+	/// Set the level returned by digitalRead(pin).
+	/// Fires an interrupt attached to the pin if the transition matches its mode
+	void	set_digital(const uint8_t pin, const int level);
+
+	/// Get the last level written with digitalWrite(pin)
+	int		get_output(const uint8_t pin);
+
+	/// Get the last mode set with pinMode(pin)
+	int		get_mode(const uint8_t pin);
+
+	/// Reset all pins to inputs reading zero and detach interrupts
+	void	reset();
+
+} // namespace Pins
+
+} // namespace LoomNative
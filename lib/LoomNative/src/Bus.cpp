@@ -0,0 +1,14 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+/// @file		Bus.cpp
+/// @brief		Instances of the simulated I2C and SPI buses.
+/// @date		2020
+/// @copyright	GNU General Public License v3.0
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#include "Wire.h"
+#include "SPI.h"
+
+TwoWire		Wire;
+SPIClass	SPI;
@@ -0,0 +1,24 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+/// @file		EnableInterrupt.h
+/// @brief		Simulated EnableInterrupt used by the native (host) build.
+/// @details	Maps onto the simulated attachInterrupt(), so interrupts can be
+///				fired with LoomNative::Pins::set_digital().
+/// @date		2020
+/// @copyright	GNU General Public License v3.0
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <Arduino.h>
+
+inline void enableInterrupt(uint8_t pin, void (*isr)(void), uint8_t mode)
+{
+	attachInterrupt(pin, isr, mode);
+}
+
+inline void disableInterrupt(uint8_t pin)
+{
+	detachInterrupt(pin);
+}
@@ -0,0 +1,91 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+/// @file		EthernetLarge.cpp
+/// @brief		Simulated Ethernet FeatherWing implementation.
+/// @date		2020
+/// @copyright	GNU General Public License v3.0
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#include "EthernetLarge.h"
+#include "SimNet.h"
+
+using namespace LoomNative;
+
+EthernetClass Ethernet;
+
+///////////////////////////////////////////////////////////////////////////////
+int EthernetClass::begin(uint8_t* /* mac */)
+{
+	address = IPAddress(192, 168, 0, 2);
+	return 1;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void EthernetClass::begin(uint8_t* /* mac */, IPAddress ip)
+{
+	address = ip;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int EthernetClient::connect(IPAddress /* ip */, uint16_t /* port */)
+{
+	// servers are only reached by name
+	stop();
+	return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int EthernetClient::connect(const char* host, uint16_t /* port */)
+{
+	stop();
+	socket = Net::open(host);
+	return socket >= 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+size_t EthernetClient::write(const uint8_t* buffer, size_t size)
+{
+	const size_t sent = Net::send(socket, buffer, size);
+	if (sent < size) setWriteError();
+	return sent;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int EthernetClient::available()
+{
+	return Net::available(socket);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int EthernetClient::read()
+{
+	uint8_t byte;
+	return (Net::receive(socket, &byte, 1) == 1) ? byte : -1;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int EthernetClient::read(uint8_t* buffer, size_t size)
+{
+	return Net::receive(socket, buffer, size);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int EthernetClient::peek()
+{
+	return Net::receive(socket, nullptr, 0);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void EthernetClient::stop()
+{
+	if (socket < 0) return;
+	Net::close(socket);
+	socket = -1;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+uint8_t EthernetClient::connected()
+{
+	return Net::connected(socket);
+}
@@ -0,0 +1,109 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+/// @file		EthernetLarge.h
+/// @brief		Simulated Ethernet FeatherWing used by the native (host) build.
+/// @date		2020
+/// @copyright	GNU General Public License v3.0
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "Client.h"
+#include "Udp.h"
+
+///////////////////////////////////////////////////////////////////////////////
+///
+/// The W5500 chip: DHCP always succeeds.
+///
+///////////////////////////////////////////////////////////////////////////////
+class EthernetClass
+{
+
+public:
+
+	void		init(uint8_t /* cs_pin */) {}
+
+	/// Configure with DHCP
+	/// @return 1 if success
+	int			begin(uint8_t* mac);
+
+	/// Configure with a static address
+	void		begin(uint8_t* mac, IPAddress ip);
+
+	IPAddress	localIP() const { return address; }
+
+private:
+
+	IPAddress	address;
+
+};
+
+extern EthernetClass Ethernet;
+
+///////////////////////////////////////////////////////////////////////////////
+///
+/// TCP connection over the simulated network (see SimNet.h).
+///
+/// Connects by host name only, to the servers added with Net::serve().
+///
+///////////////////////////////////////////////////////////////////////////////
+class EthernetClient : public Client
+{
+
+public:
+
+	EthernetClient() : socket(-1) {}
+	~EthernetClient() { stop(); }
+
+	int			connect(IPAddress ip, uint16_t port) override;
+	int			connect(const char* host, uint16_t port) override;
+	size_t		write(uint8_t byte) override { return write(&byte, 1); }
+	size_t		write(const uint8_t* buffer, size_t size) override;
+	int			available() override;
+	int			read() override;
+	int			read(uint8_t* buffer, size_t size) override;
+	int			peek() override;
+	void		flush() override {}
+	void		stop() override;
+	uint8_t		connected() override;
+				operator bool() override { return socket >= 0; }
+
+	using Print::write;
+
+private:
+
+	int			socket;		///< Handle from Net::open(), -1 if closed
+
+};
+
+///////////////////////////////////////////////////////////////////////////////
+///
+/// UDP socket: nothing answers over UDP in the simulation, so begin() fails.
+///
+///////////////////////////////////////////////////////////////////////////////
+class EthernetUDP : public UDP
+{
+
+public:
+
+	uint8_t		begin(uint16_t /* port */) override { return 0; }
+	void		stop() override {}
+	int			beginPacket(IPAddress /* ip */, uint16_t /* port */) override { return 0; }
+	int			beginPacket(const char* /* host */, uint16_t /* port */) override { return 0; }
+	int			endPacket() override { return 0; }
+	size_t		write(uint8_t /* byte */) override { return 0; }
+	size_t		write(const uint8_t* /* buffer */, size_t /* size */) override { return 0; }
+	int			parsePacket() override { return 0; }
+	int			available() override { return 0; }
+	int			read() override { return -1; }
+	int			read(unsigned char* /* buffer */, size_t /* len */) override { return -1; }
+	int			read(char* /* buffer */, size_t /* len */) override { return -1; }
+	int			peek() override { return -1; }
+	void		flush() override {}
+	IPAddress	remoteIP() override { return IPAddress(); }
+	uint16_t	remotePort() override { return 0; }
+
+	using Print::write;
+
+};
@@ -0,0 +1,48 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+/// @file		FeatherFault.cpp
+/// @brief		Simulated FeatherFault implementation.
+/// @date		2020
+/// @copyright	GNU General Public License v3.0
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#include "FeatherFault.h"
+
+namespace FeatherFault {
+
+static volatile int			last_line = 0;
+static const char* volatile	last_file = "";
+
+void StartWDT(const WDTTimeout timeout) {}
+
+void StopWDT() {}
+
+void SetCallback(void(*callback)()) {}
+
+void PrintFault(Print& where)
+{
+	where.println("No fault");
+}
+
+bool DidFault()
+{
+	return false;
+}
+
+FaultData GetFault()
+{
+	FaultData data{};
+	data.cause = FAULT_NONE;
+	data.line = last_line;
+	strncpy(data.file, last_file, sizeof(data.file) - 1);
+	return data;
+}
+
+void mark(const int line, const char* file)
+{
+	last_line = line;
+	last_file = file;
+}
+
+} // namespace FeatherFault
@@ -0,0 +1,63 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+/// @file		FeatherFault.h
+/// @brief		Simulated FeatherFault used by the native (host) build.
+/// @details	There is no watchdog on the host: StartWDT/StopWDT only record
+///				state, and no fault is ever reported. mark() remembers the last
+///				location, which is useful when debugging a host crash.
+/// @date		2020
+/// @copyright	GNU General Public License v3.0
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <Arduino.h>
+
+namespace FeatherFault {
+
+	enum FaultCause : uint32_t {
+		FAULT_NONE = 0,
+		FAULT_HUNG = 1,
+		FAULT_HARDFAULT = 2,
+		FAULT_OUTOFMEMORY = 3
+	};
+
+	enum class WDTTimeout : uint8_t {
+		WDT_8MS = 1,
+		WDT_15MS = 2,
+		WDT_31MS = 3,
+		WDT_62MS = 4,
+		WDT_125MS = 5,
+		WDT_250MS = 6,
+		WDT_500MS = 7,
+		WDT_1S = 8,
+		WDT_2S = 9,
+		WDT_4S = 10,
+		WDT_8S = 11
+	};
+
+	struct FaultData {
+		FeatherFault::FaultCause cause;
+		uint8_t is_corrupted;
+		uint32_t failnum;
+		int32_t line;
+		char file[64];
+	};
+
+	void StartWDT(const WDTTimeout timeout);
+
+	void StopWDT();
+
+	void SetCallback(void(*callback)());
+
+	void PrintFault(Print& where);
+
+	bool DidFault();
+
+	FaultData GetFault();
+
+	void mark(const int line = __builtin_LINE(), const char* file = __builtin_FILE());
+}
+
+#define MARK { FeatherFault::mark(); }
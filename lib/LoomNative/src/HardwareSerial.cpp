@@ -0,0 +1,68 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+/// @file		HardwareSerial.cpp
+/// @brief		Simulated Serial port implementation.
+/// @date		2020
+/// @copyright	GNU General Public License v3.0
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#include "Arduino.h"
+
+using namespace LoomNative;
+
+HardwareSerial Serial;
+HardwareSerial Serial1;
+
+static bool echo_enabled	= true;
+static bool capture_enabled	= false;
+
+///////////////////////////////////////////////////////////////////////////////
+void SerialPort::set_echo(const bool enable)
+{
+	echo_enabled = enable;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void SerialPort::set_capture(const bool enable)
+{
+	capture_enabled = enable;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+size_t SerialPort::write(uint8_t c)
+{
+	return write(&c, 1);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+size_t SerialPort::write(const uint8_t* buffer, size_t size)
+{
+	if (echo_enabled) fwrite(buffer, 1, size, stdout);
+	if (capture_enabled) capture.append((const char*)buffer, size);
+	return size;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int SerialPort::read()
+{
+	if (rx_pos >= rx.size()) return -1;
+	const int c = (uint8_t)rx[rx_pos++];
+	if (rx_pos == rx.size()) {
+		rx.clear();
+		rx_pos = 0;
+	}
+	return c;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int SerialPort::peek()
+{
+	return (rx_pos < rx.size()) ? (uint8_t)rx[rx_pos] : -1;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void SerialPort::flush()
+{
+	if (echo_enabled) fflush(stdout);
+}
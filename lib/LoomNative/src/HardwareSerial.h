@@ -0,0 +1,75 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+/// @file		HardwareSerial.h
+/// @brief		Simulated Serial port used by the native (host) build.
+/// @date		2020
+/// @copyright	GNU General Public License v3.0
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "Stream.h"
+
+#include <string>
+
+namespace LoomNative {
+
+///////////////////////////////////////////////////////////////////////////////
+///
+/// Serial port simulation.
+///
+/// Output is echoed to the host's stdout (can be disabled for benchmarks)
+/// and optionally captured. Input is fed from the host with inject().
+///
+///////////////////////////////////////////////////////////////////////////////
+class SerialPort : public Stream
+{
+
+public:
+
+	void		begin(unsigned long baud) { this->baud = baud; }
+	void		end() {}
+	operator	bool() const { return true; }
+
+	size_t		write(uint8_t c) override;
+	size_t		write(const uint8_t* buffer, size_t size) override;
+	using Print::write;
+
+	int			available() override { return (int)(rx.size() - rx_pos); }
+	int			read() override;
+	int			peek() override;
+	int			availableForWrite() override { return 64; }
+	void		flush() override;
+
+	/// Queue bytes to be returned by read()
+	/// @param[in]	data	Bytes the "remote" side sends
+	void		inject(const char* data) { rx += data; }
+
+	/// Echo output to stdout (default true)
+	static void	set_echo(const bool enable);
+
+	/// Keep a copy of everything written (default false)
+	static void	set_capture(const bool enable);
+
+	/// Everything written since capture was enabled or last cleared
+	const std::string&	captured() const { return capture; }
+
+	/// Clear captured output
+	void		clear_capture() { capture.clear(); }
+
+private:
+
+	unsigned long	baud = 0;
+	std::string		rx;
+	size_t			rx_pos = 0;
+	std::string		capture;
+
+};
+
+} // namespace LoomNative
+
+using HardwareSerial = LoomNative::SerialPort;
+
+extern HardwareSerial Serial;
+extern HardwareSerial Serial1;
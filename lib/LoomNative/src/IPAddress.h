@@ -0,0 +1,46 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+/// @file		IPAddress.h
+/// @brief		Arduino IPAddress for the native (host) build.
+/// @date		2020
+/// @copyright	GNU General Public License v3.0
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <stdint.h>
+
+///////////////////////////////////////////////////////////////////////////////
+///
+/// IPv4 address, as in the Arduino core.
+///
+///////////////////////////////////////////////////////////////////////////////
+class IPAddress
+{
+
+public:
+
+	IPAddress() : bytes{} {}
+	IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) : bytes{ a, b, c, d } {}
+	IPAddress(uint32_t address) { *this = address; }
+
+	IPAddress&	operator=(uint32_t address)
+	{
+		for (auto i = 0; i < 4; i++) bytes[i] = address >> (8 * i);
+		return *this;
+	}
+
+	/// Address with its first octet in the low byte, as the Arduino core stores it
+	operator uint32_t() const { return bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | ((uint32_t)bytes[3] << 24); }
+
+	bool		operator==(const IPAddress& other) const { return (uint32_t)*this == (uint32_t)other; }
+
+	uint8_t		operator[](int index) const { return bytes[index]; }
+	uint8_t&	operator[](int index) { return bytes[index]; }
+
+private:
+
+	uint8_t		bytes[4];
+
+};
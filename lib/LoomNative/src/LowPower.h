@@ -0,0 +1,28 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+/// @file		LowPower.h
+/// @brief		Simulated Low-Power library used by the native (host) build.
+/// @date		2020
+/// @copyright	GNU General Public License v3.0
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <Arduino.h>
+
+///////////////////////////////////////////////////////////////////////////////
+/// Sleep modes return immediately. Wake sources on the host are driven
+/// explicitly (LoomNative::Clock::advance() fires RTC alarms, and
+/// LoomNative::Pins::set_digital() fires pin interrupts).
+class LowPowerClass
+{
+public:
+	void	idle(int mode = 0) {}
+	void	standby() { standby_count++; }
+
+	/// Number of times standby() was entered
+	uint32_t	standby_count = 0;
+};
+
+extern LowPowerClass LowPower;
@@ -0,0 +1,486 @@
+// Code by JeeLabs http://news.jeelabs.org/code/
+// Released to the public domain! Enjoy!
+//
+// Native (host) build: DateTime / TimeSpan math is the original RTClib code,
+// the chips are simulated on top of LoomNative::Clock.
+
+#include "OPEnS_RTC.h"
+
+using namespace LoomNative;
+
+////////////////////////////////////////////////////////////////////////////////
+// utility code, some of this could be exposed in the DateTime API if needed
+
+const uint8_t daysInMonth [] = { 31,28,31,30,31,30,31,31,30,31,30,31 };
+
+// number of days since 2000/01/01, valid for 2001..2099
+static uint16_t date2days(uint16_t y, uint8_t m, uint8_t d)
+{
+	if (y >= 2000)
+		y -= 2000;
+	uint16_t days = d;
+	for (uint8_t i = 1; i < m; ++i)
+		days += daysInMonth[i - 1];
+	if (m > 2 && y % 4 == 0)
+		++days;
+	return days + 365 * y + (y + 3) / 4 - 1;
+}
+
+static long time2long(uint16_t days, uint8_t h, uint8_t m, uint8_t s)
+{
+	return ((days * 24L + h) * 60 + m) * 60 + s;
+}
+
+static uint8_t conv2d(const char* p)
+{
+	uint8_t v = 0;
+	if ('0' <= *p && *p <= '9')
+		v = *p - '0';
+	return 10 * v + *++p - '0';
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// DateTime implementation - ignores time zones and DST changes
+// NOTE: also ignores leap seconds, see http://en.wikipedia.org/wiki/Leap_second
+
+DateTime::DateTime (uint32_t t)
+{
+	t -= SECONDS_FROM_1970_TO_2000;    // bring to 2000 timestamp from 1970
+
+	ss = t % 60;
+	t /= 60;
+	mm = t % 60;
+	t /= 60;
+	hh = t % 24;
+	uint16_t days = t / 24;
+	uint8_t leap;
+	for (yOff = 0; ; ++yOff) {
+		leap = yOff % 4 == 0;
+		if (days < 365 + leap)
+			break;
+		days -= 365 + leap;
+	}
+	for (m = 1; ; ++m) {
+		uint8_t daysPerMonth = daysInMonth[m - 1];
+		if (leap && m == 2)
+			++daysPerMonth;
+		if (days < daysPerMonth)
+			break;
+		days -= daysPerMonth;
+	}
+	d = days + 1;
+}
+
+DateTime::DateTime (uint16_t year, uint8_t month, uint8_t day, uint8_t hour, uint8_t min, uint8_t sec)
+{
+	if (year >= 2000)
+		year -= 2000;
+	yOff = year;
+	m = month;
+	d = day;
+	hh = hour;
+	mm = min;
+	ss = sec;
+}
+
+DateTime::DateTime (const DateTime& copy)
+	: yOff(copy.yOff), m(copy.m), d(copy.d), hh(copy.hh), mm(copy.mm), ss(copy.ss)
+{}
+
+// A convenient constructor for using "the compiler's time":
+//   DateTime now (__DATE__, __TIME__);
+DateTime::DateTime (const char* date, const char* time)
+{
+	// sample input: date = "Dec 26 2009", time = "12:34:56"
+	yOff = conv2d(date + 9);
+	// Jan Feb Mar Apr May Jun Jul Aug Sep Oct Nov Dec
+	switch (date[0]) {
+		case 'J': m = (date[1] == 'a') ? 1 : ((date[2] == 'n') ? 6 : 7); break;
+		case 'F': m = 2; break;
+		case 'A': m = date[2] == 'r' ? 4 : 8; break;
+		case 'M': m = date[2] == 'r' ? 3 : 5; break;
+		case 'S': m = 9; break;
+		case 'O': m = 10; break;
+		case 'N': m = 11; break;
+		case 'D': m = 12; break;
+	}
+	d = conv2d(date + 4);
+	hh = conv2d(time);
+	mm = conv2d(time + 3);
+	ss = conv2d(time + 6);
+}
+
+// Flash strings are plain strings on the host
+DateTime::DateTime (const __FlashStringHelper* date, const __FlashStringHelper* time)
+	: DateTime(reinterpret_cast<const char*>(date), reinterpret_cast<const char*>(time))
+{}
+
+uint8_t DateTime::dayOfTheWeek() const
+{
+	uint16_t day = date2days(yOff, m, d);
+	return (day + 6) % 7; // Jan 1, 2000 is a Saturday, i.e. returns 6
+}
+
+uint32_t DateTime::unixtime(void) const
+{
+	uint32_t t;
+	uint16_t days = date2days(yOff, m, d);
+	t = time2long(days, hh, mm, ss);
+	t += SECONDS_FROM_1970_TO_2000;  // seconds from 1970 to 2000
+
+	return t;
+}
+
+long DateTime::secondstime(void) const
+{
+	long t;
+	uint16_t days = date2days(yOff, m, d);
+	t = time2long(days, hh, mm, ss);
+	return t;
+}
+
+DateTime DateTime::operator+(const TimeSpan& span)
+{
+	return DateTime(unixtime()+span.totalseconds());
+}
+
+DateTime DateTime::operator-(const TimeSpan& span)
+{
+	return DateTime(unixtime()-span.totalseconds());
+}
+
+TimeSpan DateTime::operator-(const DateTime& right)
+{
+	return TimeSpan(unixtime()-right.unixtime());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// TimeSpan implementation
+
+TimeSpan::TimeSpan (int32_t seconds)
+	: _seconds(seconds)
+{}
+
+TimeSpan::TimeSpan (int16_t days, int8_t hours, int8_t minutes, int8_t seconds)
+	: _seconds((int32_t)days*86400L + (int32_t)hours*3600 + (int32_t)minutes*60 + seconds)
+{}
+
+TimeSpan::TimeSpan (const TimeSpan& copy)
+	: _seconds(copy._seconds)
+{}
+
+TimeSpan TimeSpan::operator+(const TimeSpan& right)
+{
+	return TimeSpan(_seconds+right._seconds);
+}
+
+TimeSpan TimeSpan::operator-(const TimeSpan& right)
+{
+	return TimeSpan(_seconds-right._seconds);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Simulated chip
+//
+// All RTC classes share one time base (there is only ever one RTC on a board).
+// Time is LoomNative::Clock::epoch() plus an offset set by adjust().
+
+namespace {
+
+	int32_t		time_offset		= 0;
+	bool		power_lost		= true;
+	uint8_t		int_pin			= 12;
+	int			alarm_timer		= 0;
+
+	/// Pending alarm match, as Ds3231_ALARM_TYPES_t (PCF8523 alarms map onto these)
+	uint8_t		alarm_type		= ALM1_MATCH_HOURS;
+	uint8_t		alarm_s = 0, alarm_m = 0, alarm_h = 0, alarm_dd = 0;
+	bool		alarm_armed		= false;
+
+	uint32_t now_unix()
+	{
+		return Clock::epoch() + time_offset;
+	}
+
+	void release_int()
+	{
+		Pins::set_digital(int_pin, HIGH);
+	}
+
+	void fire()
+	{
+		alarm_timer = 0;
+		Pins::set_digital(int_pin, LOW);
+	}
+
+	/// Find the next time (strictly after now) matching the pending alarm
+	uint32_t next_match()
+	{
+		const uint32_t now = now_unix();
+		const DateTime t(now);
+		const uint8_t type = alarm_type & 0x7F;		// ALM2 types match like ALM1 with seconds = 0
+		const uint8_t s = (alarm_type & 0x80) ? 0 : alarm_s;
+
+		if (alarm_type == ALM1_EVERY_SECOND) return now + 1;
+		if (alarm_type == ALM2_EVERY_MINUTE) return now - t.second() + 60;
+
+		uint32_t candidate;
+		switch (type) {
+			case ALM1_MATCH_SECONDS:
+				candidate = DateTime(t.year(), t.month(), t.day(), t.hour(), t.minute(), s).unixtime();
+				return (candidate > now) ? candidate : candidate + 60;
+			case ALM1_MATCH_MINUTES:
+				candidate = DateTime(t.year(), t.month(), t.day(), t.hour(), alarm_m, s).unixtime();
+				return (candidate > now) ? candidate : candidate + 3600;
+			case ALM1_MATCH_HOURS:
+				candidate = DateTime(t.year(), t.month(), t.day(), alarm_h, alarm_m, s).unixtime();
+				return (candidate > now) ? candidate : candidate + SECONDS_PER_DAY;
+			default:	// Match date or day of week, search forward day by day
+				candidate = DateTime(t.year(), t.month(), t.day(), alarm_h, alarm_m, s).unixtime();
+				for (int i = 0; i < 62; i++, candidate += SECONDS_PER_DAY) {
+					if (candidate <= now) continue;
+					const DateTime c(candidate);
+					const bool by_day = (type == ALM1_MATCH_DAY);
+					if (by_day ? (c.dayOfTheWeek() + 1 == alarm_dd) : (c.day() == alarm_dd)) return candidate;
+				}
+				return candidate;
+		}
+	}
+
+	void schedule()
+	{
+		if (alarm_timer) Clock::cancel_timer(alarm_timer);
+		alarm_timer = 0;
+		if (!alarm_armed) return;
+		const uint32_t delta = next_match() - now_unix();
+		alarm_timer = Clock::add_timer(Clock::now_us() + delta * 1000000ULL, fire);
+	}
+
+	void disarm()
+	{
+		alarm_armed = false;
+		schedule();
+	}
+
+	void do_adjust(const DateTime& dt)
+	{
+		time_offset = (int32_t)(dt.unixtime() - Clock::epoch());
+		power_lost = false;
+		schedule();
+	}
+
+} // namespace
+
+void LoomNative::RtcSim::set_interrupt_pin(const uint8_t pin)
+{
+	int_pin = pin;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// RTC_DS3231 implementation
+
+boolean RTC_DS3231::begin(void)
+{
+	return true;
+}
+
+void RTC_DS3231::adjust(const DateTime& dt)
+{
+	do_adjust(dt);
+}
+
+bool RTC_DS3231::lostPower(void)
+{
+	return power_lost;
+}
+
+DateTime RTC_DS3231::now()
+{
+	return DateTime(now_unix());
+}
+
+Ds3231SqwPinMode RTC_DS3231::readSqwPinMode()
+{
+	return DS3231_OFF;
+}
+
+void RTC_DS3231::writeSqwPinMode(Ds3231SqwPinMode mode) {}
+
+float RTC_DS3231::getTemp()
+{
+	return 25.0f;
+}
+
+void RTC_DS3231::forceConversion(void) {}
+
+void RTC_DS3231::setAlarm(Ds3231_ALARM_TYPES_t alarmType, byte seconds, byte minutes, byte hours, byte daydate)
+{
+	alarm_type = alarmType;
+	alarm_s = seconds;
+	alarm_m = minutes;
+	alarm_h = hours;
+	alarm_dd = daydate;
+	schedule();
+}
+
+void RTC_DS3231::setAlarm(Ds3231_ALARM_TYPES_t alarmType, byte minutes, byte hours, byte daydate)
+{
+	setAlarm(alarmType, 0, minutes, hours, daydate);
+}
+
+void RTC_DS3231::armAlarm(byte alarmNumber, bool armed)
+{
+	if (!armed) disarm();
+}
+
+void RTC_DS3231::alarmInterrupt(byte alarmNumber, bool alarmEnabled)
+{
+	alarm_armed = alarmEnabled;
+	schedule();
+}
+
+bool RTC_DS3231::isArmed(byte alarmNumber)
+{
+	return alarm_armed;
+}
+
+void RTC_DS3231::clearAlarm(byte alarmNumber)
+{
+	release_int();
+}
+
+void RTC_DS3231::write(byte addr, byte value) {}
+
+byte RTC_DS3231::read(byte addr)
+{
+	return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// RTC_PCF8523 implementation
+
+uint8_t RTC_PCF8523::begin(void)
+{
+	return 1;
+}
+
+void RTC_PCF8523::adjust(const DateTime& dt)
+{
+	do_adjust(dt);
+}
+
+boolean RTC_PCF8523::initialized(void)
+{
+	return !power_lost;
+}
+
+uint8_t RTC_PCF8523::isrunning(void)
+{
+	return 1;
+}
+
+DateTime RTC_PCF8523::now()
+{
+	return DateTime(now_unix());
+}
+
+uint8_t RTC_PCF8523::read_reg(uint8_t address)
+{
+	return 0;
+}
+
+void RTC_PCF8523::read_reg(uint8_t* buf, uint8_t size, uint8_t address)
+{
+	memset(buf, 0, size);
+}
+
+void RTC_PCF8523::write_reg(uint8_t address, uint8_t data) {}
+
+void RTC_PCF8523::write_reg(uint8_t address, uint8_t* buf, uint8_t size) {}
+
+void RTC_PCF8523::set_alarm(uint8_t day_alarm, uint8_t hour_alarm, uint8_t minute_alarm)
+{
+	alarm_type = ALM2_MATCH_DATE;
+	alarm_dd = day_alarm;
+	alarm_h = hour_alarm;
+	alarm_m = minute_alarm;
+	schedule();
+}
+
+void RTC_PCF8523::set_alarm(uint8_t hour_alarm, uint8_t minute_alarm)
+{
+	alarm_type = ALM2_MATCH_HOURS;
+	alarm_h = hour_alarm;
+	alarm_m = minute_alarm;
+	schedule();
+}
+
+void RTC_PCF8523::set_alarm(uint8_t minute_alarm)
+{
+	alarm_type = ALM2_MATCH_MINUTES;
+	alarm_m = minute_alarm;
+	schedule();
+}
+
+void RTC_PCF8523::get_alarm(uint8_t* buf)
+{
+	buf[0] = alarm_m;
+	buf[1] = alarm_h;
+	buf[2] = alarm_dd;
+}
+
+void RTC_PCF8523::reset()
+{
+	disarm();
+	release_int();
+}
+
+uint8_t RTC_PCF8523::clear_rtc_interrupt_flags()
+{
+	release_int();
+	return 0;
+}
+
+void RTC_PCF8523::stop_32768_clkout() {}
+
+void RTC_PCF8523::start_counter_1(uint8_t value) {}
+
+void RTC_PCF8523::enable_alarm(bool enable)
+{
+	alarm_armed = enable;
+	schedule();
+}
+
+void RTC_PCF8523::ack_alarm(void)
+{
+	release_int();
+}
+
+Pcf8523SqwPinMode RTC_PCF8523::readSqwPinMode()
+{
+	return PCF8523_OFF;
+}
+
+void RTC_PCF8523::writeSqwPinMode(Pcf8523SqwPinMode mode) {}
+
+void RTC_PCF8523::setTimer1(eTIMER_TIMEBASE timebase, uint8_t value) {}
+void RTC_PCF8523::ackTimer1(void) {}
+uint8_t RTC_PCF8523::getTimer1(void) { return 0; }
+void RTC_PCF8523::setTimer2(eTIMER_TIMEBASE timebase, uint8_t value) {}
+void RTC_PCF8523::ackTimer2(void) {}
+uint8_t RTC_PCF8523::getTimer2(void) { return 0; }
+
+////////////////////////////////////////////////////////////////////////////////
+// RTC_Millis implementation
+
+long RTC_Millis::offset = 0;
+
+void RTC_Millis::adjust(const DateTime& dt)
+{
+	offset = dt.unixtime() - millis() / 1000;
+}
+
+DateTime RTC_Millis::now()
+{
+	return (uint32_t)(offset + millis() / 1000);
+}
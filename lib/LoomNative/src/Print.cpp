@@ -0,0 +1,125 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+/// @file		Print.cpp
+/// @brief		Simulated Arduino Print implementation.
+/// @date		2020
+/// @copyright	GNU General Public License v3.0
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#include "Arduino.h"
+
+///////////////////////////////////////////////////////////////////////////////
+size_t Print::strlen_(const char* str)
+{
+	return strlen(str);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+size_t Print::write(const uint8_t* buffer, size_t size)
+{
+	size_t n = 0;
+	while (size--) {
+		if (write(*buffer++)) n++;
+		else break;
+	}
+	return n;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+size_t Print::print(const __FlashStringHelper* str)	{ return write(reinterpret_cast<const char*>(str)); }
+size_t Print::print(const String& str)				{ return write((const uint8_t*)str.c_str(), str.length()); }
+size_t Print::print(const char* str)					{ return write(str); }
+size_t Print::print(char c)							{ return write((uint8_t)c); }
+size_t Print::print(unsigned char n, int base)		{ return print((unsigned long long)n, base); }
+size_t Print::print(int n, int base)					{ return print((long long)n, base); }
+size_t Print::print(unsigned int n, int base)		{ return print((unsigned long long)n, base); }
+size_t Print::print(long n, int base)				{ return print((long long)n, base); }
+size_t Print::print(unsigned long n, int base)		{ return print((unsigned long long)n, base); }
+size_t Print::print(const Printable& p)				{ return p.printTo(*this); }
+size_t Print::print(double n, int digits)			{ return print_float(n, digits); }
+
+///////////////////////////////////////////////////////////////////////////////
+size_t Print::print(long long n, int base)
+{
+	if (base == 0) return write((uint8_t)n);
+	if (base == 10 && n < 0) {
+		return print('-') + print_number((unsigned long long)(-n), 10);
+	}
+	return print_number((unsigned long long)n, base);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+size_t Print::print(unsigned long long n, int base)
+{
+	if (base == 0) return write((uint8_t)n);
+	return print_number(n, base);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+size_t Print::println()										{ return write("\r\n"); }
+size_t Print::println(const __FlashStringHelper* str)		{ return print(str) + println(); }
+size_t Print::println(const String& str)					{ return print(str) + println(); }
+size_t Print::println(const char* str)						{ return print(str) + println(); }
+size_t Print::println(char c)								{ return print(c) + println(); }
+size_t Print::println(unsigned char n, int base)			{ return print(n, base) + println(); }
+size_t Print::println(int n, int base)						{ return print(n, base) + println(); }
+size_t Print::println(unsigned int n, int base)				{ return print(n, base) + println(); }
+size_t Print::println(long n, int base)						{ return print(n, base) + println(); }
+size_t Print::println(unsigned long n, int base)			{ return print(n, base) + println(); }
+size_t Print::println(long long n, int base)				{ return print(n, base) + println(); }
+size_t Print::println(unsigned long long n, int base)		{ return print(n, base) + println(); }
+size_t Print::println(double n, int digits)					{ return print(n, digits) + println(); }
+size_t Print::println(const Printable& p)					{ return print(p) + println(); }
+
+///////////////////////////////////////////////////////////////////////////////
+size_t Print::print_number(unsigned long long n, uint8_t base)
+{
+	char buf[8 * sizeof(long long) + 1];
+	char* str = &buf[sizeof(buf) - 1];
+	*str = '\0';
+
+	if (base < 2) base = 10;
+
+	do {
+		const char c = n % base;
+		n /= base;
+		*--str = c < 10 ? c + '0' : c + 'A' - 10;
+	} while (n);
+
+	return write(str);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+size_t Print::print_float(double number, uint8_t digits)
+{
+	// Same special cases and rounding as the Arduino core's printFloat()
+	if (isnan(number)) return print("nan");
+	if (isinf(number)) return print("inf");
+	if (number > 4294967040.0) return print("ovf");
+	if (number < -4294967040.0) return print("ovf");
+
+	size_t n = 0;
+	if (number < 0.0) {
+		n += print('-');
+		number = -number;
+	}
+
+	// Round half up at the last digit, then print the digits one at a time
+	double rounding = 0.5;
+	for (uint8_t i = 0; i < digits; i++) rounding /= 10.0;
+	number += rounding;
+
+	const uint32_t int_part = (uint32_t)number;
+	double remainder = number - (double)int_part;
+	n += print_number(int_part, 10);
+	if (digits > 0) n += print('.');
+
+	while (digits-- > 0) {
+		remainder *= 10.0;
+		const unsigned int digit = (unsigned int)remainder;
+		n += print_number(digit, 10);
+		remainder -= digit;
+	}
+	return n;
+}
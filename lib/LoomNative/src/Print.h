@@ -0,0 +1,99 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+/// @file		Print.h
+/// @brief		Simulated Arduino Print base class used by the native (host) build.
+/// @date		2020
+/// @copyright	GNU General Public License v3.0
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "WString.h"
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+class Print;
+
+/// Objects that know how to print themselves
+class Printable
+{
+public:
+	virtual ~Printable() = default;
+	virtual size_t printTo(Print& p) const = 0;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+///
+/// Arduino Print interface.
+/// Derived classes only need to implement write(uint8_t), and optionally
+/// the buffer version of write() for efficiency.
+///
+///////////////////////////////////////////////////////////////////////////////
+class Print
+{
+
+public:
+
+	Print() : write_error(0) {}
+	virtual ~Print() = default;
+
+	int				getWriteError() const { return write_error; }
+	void			clearWriteError() { setWriteError(0); }
+
+	virtual size_t	write(uint8_t c) = 0;
+	virtual size_t	write(const uint8_t* buffer, size_t size);
+	size_t			write(const char* str) { return str ? write((const uint8_t*)str, strlen_(str)) : 0; }
+	size_t			write(const char* buffer, size_t size) { return write((const uint8_t*)buffer, size); }
+
+	virtual int		availableForWrite() { return 0; }
+	virtual void	flush() {}
+
+	size_t			print(const __FlashStringHelper* str);
+	size_t			print(const String& str);
+	size_t			print(const char* str);
+	size_t			print(char c);
+	size_t			print(unsigned char n, int base = DEC);
+	size_t			print(int n, int base = DEC);
+	size_t			print(unsigned int n, int base = DEC);
+	size_t			print(long n, int base = DEC);
+	size_t			print(unsigned long n, int base = DEC);
+	size_t			print(long long n, int base = DEC);
+	size_t			print(unsigned long long n, int base = DEC);
+	size_t			print(double n, int digits = 2);
+	size_t			print(const Printable& p);
+
+	size_t			println(const __FlashStringHelper* str);
+	size_t			println(const String& str);
+	size_t			println(const char* str);
+	size_t			println(char c);
+	size_t			println(unsigned char n, int base = DEC);
+	size_t			println(int n, int base = DEC);
+	size_t			println(unsigned int n, int base = DEC);
+	size_t			println(long n, int base = DEC);
+	size_t			println(unsigned long n, int base = DEC);
+	size_t			println(long long n, int base = DEC);
+	size_t			println(unsigned long long n, int base = DEC);
+	size_t			println(double n, int digits = 2);
+	size_t			println(const Printable& p);
+	size_t			println();
+
+protected:
+
+	void			setWriteError(int err = 1) { write_error = err; }
+
+private:
+
+	int				write_error;
+
+	static size_t	strlen_(const char* str);
+	size_t			print_number(unsigned long long n, uint8_t base);
+	size_t			print_float(double n, uint8_t digits);
+
+};
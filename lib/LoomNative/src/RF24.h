@@ -0,0 +1,31 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+/// @file		RF24.h
+/// @brief		Simulated nRF24L01(+) radio used by the native (host) build.
+/// @date		2020
+/// @copyright	GNU General Public License v3.0
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "Arduino.h"
+#include "SPI.h"
+
+typedef enum { RF24_PA_MIN = 0, RF24_PA_LOW, RF24_PA_HIGH, RF24_PA_MAX, RF24_PA_ERROR } rf24_pa_dbm_e;
+typedef enum { RF24_1MBPS = 0, RF24_2MBPS, RF24_250KBPS } rf24_datarate_e;
+
+///////////////////////////////////////////////////////////////////////////////
+class RF24
+{
+
+public:
+
+	RF24(uint16_t ce_pin, uint16_t cs_pin) {}
+
+	bool		begin() { return true; }
+	bool		setDataRate(rf24_datarate_e speed) { return true; }
+	void		setPALevel(uint8_t level) {}
+	void		setRetries(uint8_t delay, uint8_t count) {}
+
+};
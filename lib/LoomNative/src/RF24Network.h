@@ -0,0 +1,43 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+/// @file		RF24Network.h
+/// @brief		Simulated RF24Network layer used by the native (host) build.
+/// @details	No other nodes are in the network: writes to a node are never
+///				acknowledged, multicasts are sent and nothing arrives.
+/// @date		2020
+/// @copyright	GNU General Public License v3.0
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "RF24.h"
+
+///////////////////////////////////////////////////////////////////////////////
+struct RF24NetworkHeader
+{
+	uint16_t		from_node = 0;
+	uint16_t		to_node = 0;
+	uint16_t		id = 0;
+	unsigned char	type = 0;
+
+	RF24NetworkHeader() {}
+	RF24NetworkHeader(uint16_t to, unsigned char type = 0) : to_node(to), type(type) {}
+};
+
+///////////////////////////////////////////////////////////////////////////////
+class RF24Network
+{
+
+public:
+
+	RF24Network(RF24& radio) {}
+
+	void		begin(uint8_t channel, uint16_t node_address) {}
+	uint8_t		update() { return 0; }
+	bool		available() { return false; }
+	uint16_t	read(RF24NetworkHeader& header, void* message, uint16_t max_len) { return 0; }
+	bool		write(RF24NetworkHeader& header, const void* message, uint16_t len) { return false; }
+	bool		multicast(RF24NetworkHeader& header, const void* message, uint16_t len, uint8_t level) { return true; }
+
+};
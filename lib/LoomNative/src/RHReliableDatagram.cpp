@@ -0,0 +1,97 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+/// @file		RHReliableDatagram.cpp
+/// @brief		Simulated RadioHead reliable datagram manager implementation.
+/// @date		2020
+/// @copyright	GNU General Public License v3.0
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#include "RHReliableDatagram.h"
+
+///////////////////////////////////////////////////////////////////////////////
+bool RHReliableDatagram::sendtoWait(uint8_t* buf, uint8_t len, uint8_t address)
+{
+	const uint8_t id = ++sequence;
+	driver.setHeaderTo(address);
+	driver.setHeaderId(id);
+
+	for (uint8_t attempt = 0; attempt <= retries; attempt++) {
+		if (attempt > 0) retransmitted++;
+		driver.setHeaderFlags( (attempt > 0) ? RH_FLAGS_RETRY : RH_FLAGS_NONE, RH_FLAGS_ACK | RH_FLAGS_RETRY );
+		if (!driver.send(buf, len)) return false;
+		if (address == RH_BROADCAST_ADDRESS) return true;
+
+		// Frames other than the acknowledgement are dropped meanwhile
+		const unsigned long wait = timeout + random(timeout);
+		const unsigned long start = millis();
+		unsigned long elapsed;
+		while ( (elapsed = millis() - start) < wait ) {
+			if (!driver.waitAvailableTimeout(wait - elapsed)) break;
+			const uint8_t from	= driver.headerFrom();
+			const uint8_t to	= driver.headerTo();
+			const uint8_t rx_id	= driver.headerId();
+			const uint8_t flags	= driver.headerFlags();
+			uint8_t frame[RH_RF95_MAX_MESSAGE_LEN];
+			uint8_t frame_len = sizeof(frame);
+			driver.recv(frame, &frame_len);
+
+			if ( (flags & RH_FLAGS_ACK) && (from == address) && (to == this_address) && (rx_id == id) ) {
+				driver.setHeaderFlags(RH_FLAGS_NONE, RH_FLAGS_ACK | RH_FLAGS_RETRY);
+				return true;
+			}
+			// A sender that missed our acknowledgement is acknowledged again
+			if ( !(flags & RH_FLAGS_ACK) && (to == this_address) && (seen_ids[from] == rx_id) ) {
+				acknowledge(rx_id, from);
+				driver.setHeaderTo(address);
+				driver.setHeaderId(id);
+			}
+		}
+	}
+	driver.setHeaderFlags(RH_FLAGS_NONE, RH_FLAGS_ACK | RH_FLAGS_RETRY);
+	return false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool RHReliableDatagram::recvfromAck(uint8_t* buf, uint8_t* len, uint8_t* from)
+{
+	if (!driver.available()) return false;
+	const uint8_t rx_from	= driver.headerFrom();
+	const uint8_t to		= driver.headerTo();
+	const uint8_t id		= driver.headerId();
+	const uint8_t flags		= driver.headerFlags();
+	if ( !driver.recv(buf, len) || (flags & RH_FLAGS_ACK) ) return false;
+
+	if (to == this_address) acknowledge(id, rx_from);
+
+	// A retransmission of the last datagram received is not delivered again
+	if ( (flags & RH_FLAGS_RETRY) && (seen_ids[rx_from] == id) ) return false;
+	seen_ids[rx_from] = id;
+	if (from) *from = rx_from;
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool RHReliableDatagram::recvfromAckTimeout(uint8_t* buf, uint8_t* len, uint16_t timeout, uint8_t* from)
+{
+	const unsigned long start = millis();
+	unsigned long elapsed;
+	while ( (elapsed = millis() - start) < timeout ) {
+		if (!driver.waitAvailableTimeout(timeout - elapsed)) return false;
+		const uint8_t max_len = *len;
+		if (recvfromAck(buf, len, from)) return true;
+		*len = max_len;
+	}
+	return false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void RHReliableDatagram::acknowledge(const uint8_t id, const uint8_t to)
+{
+	uint8_t ack = '!';
+	driver.setHeaderTo(to);
+	driver.setHeaderId(id);
+	driver.setHeaderFlags(RH_FLAGS_ACK, RH_FLAGS_ACK | RH_FLAGS_RETRY);
+	driver.send(&ack, sizeof(ack));
+	driver.setHeaderFlags(RH_FLAGS_NONE, RH_FLAGS_ACK | RH_FLAGS_RETRY);
+}
@@ -0,0 +1,62 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+/// @file		RHReliableDatagram.h
+/// @brief		Simulated RadioHead reliable datagram manager used by the
+///				native (host) build.
+/// @details	As RadioHead's: addressed datagrams are acknowledged by the
+///				receiver and sent again until acknowledged, waiting a random
+///				timeout to timeout * 2 for each acknowledgement, and
+///				retransmissions of a datagram already received are
+///				acknowledged and dropped.
+/// @date		2020
+/// @copyright	GNU General Public License v3.0
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "RH_RF95.h"
+
+///////////////////////////////////////////////////////////////////////////////
+class RHReliableDatagram
+{
+
+public:
+
+	RHReliableDatagram(RH_RF95& driver, uint8_t this_address = 0)
+		: driver(driver), this_address(this_address) {}
+
+	bool		init() { driver.setThisAddress(this_address); return driver.init(); }
+	void		setThisAddress(uint8_t address) { this_address = address; driver.setThisAddress(address); }
+	void		setTimeout(uint16_t ms) { timeout = ms; }
+	void		setRetries(uint8_t count) { retries = count; }
+
+	/// Number of datagrams sent again
+	uint32_t	retransmissions() const { return retransmitted; }
+
+	/// Send a datagram, waiting for its acknowledgement unless broadcast
+	/// @return True if broadcast or acknowledged
+	bool		sendtoWait(uint8_t* buf, uint8_t len, uint8_t address);
+
+	/// Receive a datagram that has arrived, acknowledging it
+	/// @return True if a new datagram was received
+	bool		recvfromAck(uint8_t* buf, uint8_t* len, uint8_t* from = nullptr);
+
+	/// Wait for a datagram, acknowledging it
+	/// @return True if a new datagram was received in time
+	bool		recvfromAckTimeout(uint8_t* buf, uint8_t* len, uint16_t timeout, uint8_t* from = nullptr);
+
+protected:
+
+	/// Acknowledge a datagram
+	void		acknowledge(const uint8_t id, const uint8_t to);
+
+	RH_RF95&	driver;
+	uint8_t		this_address;
+	uint16_t	timeout = 200;
+	uint8_t		retries = 3;
+	uint8_t		sequence = 0;
+	uint8_t		seen_ids[256] = {};		///< ID of the last datagram received from each address
+	uint32_t	retransmitted = 0;
+
+};
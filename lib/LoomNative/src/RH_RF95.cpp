@@ -0,0 +1,160 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+/// @file		RH_RF95.cpp
+/// @brief		Simulated RadioHead RFM95 (LoRa) driver implementation.
+/// @date		2020
+/// @copyright	GNU General Public License v3.0
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#include <string.h>
+
+#include "RH_RF95.h"
+
+using namespace LoomNative;
+
+/// Sensitivity of SF7 to SF12 at 125 kHz (dBm, SX1276 datasheet),
+/// 3 dB less for each doubling of the bandwidth
+static const int16_t sensitivity_125khz[6] = { -123, -126, -129, -132, -134, -137 };
+
+/// Symbols of the preamble and header of a frame
+static const uint32_t header_symbols = 20;
+
+///////////////////////////////////////////////////////////////////////////////
+RH_RF95::~RH_RF95()
+{
+	Channel::detach(radio);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool RH_RF95::init()
+{
+	if (radio < 0) radio = Channel::attach(this_address);
+	update_phy();
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void RH_RF95::setTxPower(int8_t power, bool /* use_rfo */)
+{
+	this->power = power;
+	update_phy();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void RH_RF95::setSignalBandwidth(long sbw)
+{
+	bandwidth = sbw;
+	update_phy();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void RH_RF95::setSpreadingFactor(uint8_t sf)
+{
+	spreading_factor = (sf < 6) ? 6 : (sf > 12) ? 12 : sf;
+	update_phy();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void RH_RF95::setCodingRate4(uint8_t denominator)
+{
+	coding_rate = (denominator < 5) ? 5 : (denominator > 8) ? 8 : denominator;
+	update_phy();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void RH_RF95::setThisAddress(uint8_t address)
+{
+	this_address = address;
+	if (radio >= 0) Channel::set_address(radio, address);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void RH_RF95::update_phy()
+{
+	if (radio < 0) return;
+
+	// A symbol of 2^SF chips, of SF bits at the coding rate
+	const uint32_t symbol_us = (uint32_t)( (1000000ULL << spreading_factor) / bandwidth );
+	const uint8_t sf = (spreading_factor < 7) ? 7 : spreading_factor;
+	int16_t sensitivity = sensitivity_125khz[sf - 7];
+	for (long bw = 125000; bw < bandwidth; bw *= 2) sensitivity += 3;
+
+	Channel::Phy phy;
+	phy.rate		= spreading_factor + 16 * (uint8_t)(bandwidth / 125000);
+	phy.bitrate		= (uint32_t)( (uint64_t)spreading_factor * bandwidth * 4 / coding_rate >> spreading_factor );
+	phy.frame_us	= header_symbols * symbol_us;
+	phy.power		= power;
+	phy.sensitivity	= sensitivity;
+	Channel::set_phy(radio, phy);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool RH_RF95::send(const uint8_t* data, uint8_t len)
+{
+	if (len > RH_RF95_MAX_MESSAGE_LEN) return false;
+	if (!waitCAD()) return false;
+	// A frame waiting to be read is lost while transmitting
+	rx_held = false;
+	if (radio >= 0) {
+		Channel::transmit(radio, { header_to, this_address, header_id, header_flags }, data, len);
+	}
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool RH_RF95::isChannelActive()
+{
+	return (radio >= 0) && Channel::busy(radio);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool RH_RF95::waitCAD()
+{
+	if (cad_timeout == 0) return true;
+	const unsigned long start = millis();
+	while (isChannelActive()) {
+		if (millis() - start > cad_timeout) return false;
+		delay(random(1, 10) * 100);
+	}
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool RH_RF95::available()
+{
+	if (rx_held) return true;
+	if (radio < 0) return false;
+
+	const int len = Channel::receive(radio, rx_header, rx_buffer, sizeof(rx_buffer), 0, &last_rssi);
+	if (len < 0) return false;
+	rx_len = len;
+	rx_held = true;
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool RH_RF95::waitAvailableTimeout(uint16_t timeout)
+{
+	if (rx_held) return true;
+	if (radio < 0) {
+		delay(timeout);
+		return false;
+	}
+
+	const int len = Channel::receive(radio, rx_header, rx_buffer, sizeof(rx_buffer), (uint64_t)timeout * 1000ULL, &last_rssi);
+	if (len < 0) return false;
+	rx_len = len;
+	rx_held = true;
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool RH_RF95::recv(uint8_t* buf, uint8_t* len)
+{
+	if (!available()) return false;
+	rx_held = false;
+	if (*len > rx_len) *len = rx_len;
+	memcpy(buf, rx_buffer, *len);
+	return true;
+}
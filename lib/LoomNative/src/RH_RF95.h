@@ -0,0 +1,102 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+/// @file		RH_RF95.h
+/// @brief		Simulated RadioHead RFM95 (LoRa) driver used by the native
+///				(host) build.
+/// @details	The radio is attached to the simulated channel (see
+///				SimChannel.h) by init(), at the spreading factor, bandwidth,
+///				coding rate and power it is set to: frames take the airtime of
+///				the modem settings, are only heard by radios at the same
+///				settings, and arrive at the power set less the path loss of the
+///				link, lost below the sensitivity of the receiver's settings.
+///				Alone on the channel, frames are sent and never answered.
+/// @date		2020
+/// @copyright	GNU General Public License v3.0
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "Arduino.h"
+#include "SimChannel.h"
+
+#define RH_BROADCAST_ADDRESS			0xFF
+#define RH_FLAGS_NONE					0x00
+#define RH_FLAGS_ACK					0x80
+#define RH_FLAGS_RETRY					0x40
+#define RH_FLAGS_APPLICATION_SPECIFIC	0x0F
+#define RH_RF95_MAX_MESSAGE_LEN			251
+
+///////////////////////////////////////////////////////////////////////////////
+class RH_RF95
+{
+
+public:
+
+	RH_RF95(uint8_t slave_select_pin = 10, uint8_t interrupt_pin = 2) {}
+	~RH_RF95();
+
+	/// Attach to the channel
+	bool		init();
+	bool		setFrequency(float centre) { return true; }
+	void		setTxPower(int8_t power, bool use_rfo = false);
+	void		setSignalBandwidth(long sbw);
+	void		setSpreadingFactor(uint8_t sf);
+	void		setCodingRate4(uint8_t denominator);
+	bool		sleep() { return true; }
+	/// Wait for the channel to clear before each send, up to timeout (ms), 0 not to
+	void		setCADTimeout(unsigned long timeout) { cad_timeout = timeout; }
+	/// Whether another radio is heard transmitting
+	bool		isChannelActive();
+
+	void		setThisAddress(uint8_t address);
+	void		setHeaderTo(uint8_t to) { header_to = to; }
+	void		setHeaderId(uint8_t id) { header_id = id; }
+	void		setHeaderFlags(uint8_t set, uint8_t clear = RH_FLAGS_APPLICATION_SPECIFIC)
+				{ header_flags = (header_flags & ~clear) | set; }
+
+	/// Headers of the frame available
+	uint8_t		headerTo() const { return rx_header.to; }
+	uint8_t		headerFrom() const { return rx_header.from; }
+	uint8_t		headerId() const { return rx_header.id; }
+	uint8_t		headerFlags() const { return rx_header.flags; }
+
+	/// Transmit a frame once the channel is clear, waiting out its airtime
+	bool		send(const uint8_t* data, uint8_t len);
+	bool		waitPacketSent() { return true; }
+
+	/// Whether a frame has arrived, held until recv()
+	bool		available();
+	/// Wait for a frame to arrive, on the virtual clock
+	bool		waitAvailableTimeout(uint16_t timeout);
+	bool		recv(uint8_t* buf, uint8_t* len);
+	/// Signal of the last frame that arrived (dBm)
+	int16_t		lastRssi() const { return last_rssi; }
+
+protected:
+
+	/// Apply the modem settings to the channel radio
+	void		update_phy();
+	/// Wait for the channel to clear, as RadioHead's RHGenericDriver::waitCAD()
+	/// @return False if still busy after cad_timeout
+	bool		waitCAD();
+
+	int			radio = -1;		///< Channel handle, -1 until init()
+	uint8_t		this_address = RH_BROADCAST_ADDRESS;
+	uint8_t		header_to = RH_BROADCAST_ADDRESS;
+	uint8_t		header_id = 0;
+	uint8_t		header_flags = RH_FLAGS_NONE;
+
+	uint8_t		spreading_factor = 7;
+	long		bandwidth = 125000;
+	uint8_t		coding_rate = 5;	///< Denominator of the coding rate 4/n
+	int8_t		power = 13;
+	uint32_t	cad_timeout = 0;	///< Longest wait for a clear channel before sending (ms), 0 not to wait
+
+	bool						rx_held = false;	///< Whether a frame has arrived and not been read
+	LoomNative::Channel::Header	rx_header = { RH_BROADCAST_ADDRESS, RH_BROADCAST_ADDRESS, 0, RH_FLAGS_NONE };
+	uint8_t						rx_buffer[RH_RF95_MAX_MESSAGE_LEN];
+	uint8_t						rx_len = 0;
+	int16_t						last_rssi = 0;
+
+};
@@ -0,0 +1,97 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+/// @file		RTCCounter.cpp
+/// @brief		Simulated SAMD21 RTC counter implementation.
+/// @date		2020
+/// @copyright	GNU General Public License v3.0
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#include "RTCCounter.h"
+#include "LowPower.h"
+
+using namespace LoomNative;
+
+RTCCounter		rtcCounter;
+LowPowerClass	LowPower;
+
+///////////////////////////////////////////////////////////////////////////////
+RTCCounter::RTCCounter()
+	: _configured(false)
+	, _periodic(false)
+	, _alarmPeriod(0)
+	, _alarmEpoch(0)
+	, _epochOffset(0)
+	, _timer(0)
+{}
+
+///////////////////////////////////////////////////////////////////////////////
+void RTCCounter::begin(bool resetTime)
+{
+	if (resetTime) setEpoch(0);
+	_configured = true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+uint32_t RTCCounter::getEpoch()
+{
+	return (uint32_t)(Clock::now_us() / 1000000ULL) + _epochOffset;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void RTCCounter::setEpoch(uint32_t epoch)
+{
+	_epochOffset = (int32_t)(epoch - (uint32_t)(Clock::now_us() / 1000000ULL));
+	if (_timer) schedule();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void RTCCounter::setAlarmEpoch(uint32_t epoch)
+{
+	_periodic = false;
+	_alarmEpoch = epoch;
+	schedule();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void RTCCounter::setAlarmY2kEpoch(uint32_t y2kEpoch)
+{
+	setAlarmEpoch(y2kEpoch + 946684800UL);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void RTCCounter::setPeriodicAlarm(uint32_t period, uint32_t offset)
+{
+	_periodic = true;
+	_alarmPeriod = period;
+	_alarmEpoch = getEpoch() + period + offset;
+	schedule();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void RTCCounter::disableAlarm()
+{
+	if (_timer) Clock::cancel_timer(_timer);
+	_timer = 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void RTCCounter::schedule()
+{
+	disableAlarm();
+	const int64_t due_s = (int64_t)_alarmEpoch - _epochOffset;
+	const uint64_t due_us = (due_s > 0) ? (uint64_t)due_s * 1000000ULL : 0;
+	_timer = Clock::add_timer(due_us, [](){ rtcCounter.IrqHandler(); });
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void RTCCounter::IrqHandler()
+{
+	_timer = 0;
+	_intFlag = true;
+	if (_periodic) {
+		_alarmEpoch += _alarmPeriod;
+		schedule();
+	}
+	if (_callBack) _callBack();
+}
@@ -0,0 +1,69 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+/// @file		RTCCounter.h
+/// @brief		Simulated SAMD21 RTC counter used by the native (host) build.
+/// @details	Counts seconds of virtual time; alarms fire when
+///				LoomNative::Clock advances past them.
+/// @date		2020
+/// @copyright	GNU General Public License v3.0
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef RTC_COUNTER_H
+#define RTC_COUNTER_H
+
+#include "Arduino.h"
+
+class RTCCounter {
+public:
+	RTCCounter();
+	void begin(bool resetTime = false);
+	bool isConfigured() { return _configured; }
+
+	bool getFlag() { return _intFlag; }
+	void clearFlag() { _intFlag = false; }
+
+	void attachInterrupt(voidFuncPtr callback) { _callBack = callback; }
+	void detachInterrupt() { _callBack = nullptr; }
+
+	/* Alarm functions */
+	void setAlarmEpoch(uint32_t epoch);
+	void setAlarmY2kEpoch(uint32_t y2kEpoch);
+	void setPeriodicAlarm(uint32_t period, uint32_t offset=0);
+
+	uint32_t getAlarmEpoch() { return _alarmEpoch; }
+	uint32_t getAlarmY2kEpoch() { return _alarmEpoch - 946684800UL; }
+
+	uint32_t getAlarmPeriod() { return _alarmPeriod; }
+	bool isAlarmPeriodic() { return _periodic; }
+
+	void disableAlarm();
+
+	/* Get Functions */
+	uint32_t getEpoch();
+	uint32_t getY2kEpoch() { return getEpoch() - 946684800UL; }
+
+	/* Set Functions */
+	void setEpoch(uint32_t epoch);
+	void setY2kEpoch(uint32_t y2kEpoch) { setEpoch(y2kEpoch + 946684800UL); }
+
+	/* Other */
+	void IrqHandler();
+
+private:
+	voidFuncPtr _callBack = NULL;
+	volatile bool _intFlag = false;
+
+	bool _configured;
+	bool _periodic;
+	uint32_t _alarmPeriod;
+	uint32_t _alarmEpoch;
+	int32_t _epochOffset;
+	int _timer;
+
+	void schedule();
+};
+
+extern RTCCounter rtcCounter;
+
+#endif // RTC_COUNTER_H
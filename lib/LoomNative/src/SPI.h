@@ -0,0 +1,46 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+/// @file		SPI.h
+/// @brief		Simulated SPI bus used by the native (host) build.
+/// @date		2020
+/// @copyright	GNU General Public License v3.0
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "Arduino.h"
+
+#define SPI_MODE0 0x02
+#define SPI_MODE1 0x00
+#define SPI_MODE2 0x03
+#define SPI_MODE3 0x01
+
+enum BitOrder { LSBFIRST = 0, MSBFIRST = 1 };
+
+///////////////////////////////////////////////////////////////////////////////
+class SPISettings
+{
+public:
+	SPISettings() {}
+	SPISettings(uint32_t clock, BitOrder bit_order, uint8_t data_mode) {}
+};
+
+///////////////////////////////////////////////////////////////////////////////
+/// No devices are attached, transfers return 0xFF (idle MISO)
+class SPIClass
+{
+
+public:
+
+	void		begin() {}
+	void		end() {}
+	void		beginTransaction(SPISettings settings) {}
+	void		endTransaction() {}
+	uint8_t		transfer(uint8_t data) { return 0xFF; }
+	uint16_t	transfer16(uint16_t data) { return 0xFFFF; }
+	void		transfer(void* buf, size_t count) { memset(buf, 0xFF, count); }
+
+};
+
+extern SPIClass SPI;
@@ -0,0 +1,160 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+/// @file		SSLClient.cpp
+/// @brief		Simulated SSLClient implementation.
+/// @date		2020
+/// @copyright	GNU General Public License v3.0
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#include <string.h>
+
+#include "SSLClient.h"
+#include "SimNet.h"
+
+using namespace LoomNative;
+
+/// Bytes in a record, BearSSL's output buffer in SSLClient
+static const size_t record_size = 2048;
+
+///////////////////////////////////////////////////////////////////////////////
+SSLClient::SSLClient(
+		Client&						client,
+		const br_x509_trust_anchor*	/* trust_anchors */,
+		const size_t				/* trust_anchors_num */,
+		const int					/* analog_pin */,
+		const size_t				max_sessions,
+		const DebugLevel			/* debug */
+	)
+	: client(client)
+	, max_sessions(max_sessions)
+{}
+
+///////////////////////////////////////////////////////////////////////////////
+int SSLClient::connect(IPAddress ip, uint16_t port)
+{
+	// sessions are only cached by host name
+	record.clear();
+	if (!client.connect(ip, port)) {
+		setWriteError(SSL_CLIENT_CONNECT_FAIL);
+		return 0;
+	}
+	Net::handshake(false);
+	return 1;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int SSLClient::connect(const char* host, uint16_t port)
+{
+	record.clear();
+	if (!client.connect(host, port)) {
+		setWriteError(SSL_CLIENT_CONNECT_FAIL);
+		return 0;
+	}
+	const bool resumed = getSession(host) != nullptr;
+	Net::handshake(resumed);
+	if (!client.connected()) {
+		setWriteError(SSL_BR_CONNECT_FAIL);
+		return 0;
+	}
+	if (!resumed) {
+		if (sessions.size() >= max_sessions) sessions.erase(sessions.begin());
+		if (max_sessions > 0) sessions.emplace_back(host);
+	}
+	return 1;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+size_t SSLClient::write(const uint8_t* buffer, size_t size)
+{
+	if (!client.connected()) {
+		setWriteError(SSL_CLIENT_WRTIE_ERROR);
+		return 0;
+	}
+	record.insert(record.end(), buffer, buffer + size);
+	if ( (record.size() >= record_size) && !flush_record() ) return 0;
+	return size;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool SSLClient::flush_record()
+{
+	if (record.empty()) return true;
+	const size_t sent = client.write(record.data(), record.size());
+	const bool whole = sent == record.size();
+	record.clear();
+	if (!whole) {
+		// as SSLClient does after an error, the connection is closed
+		setWriteError(SSL_CLIENT_WRTIE_ERROR);
+		client.stop();
+	}
+	return whole;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int SSLClient::available()
+{
+	flush_record();
+	return client.available();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int SSLClient::read()
+{
+	flush_record();
+	return client.read();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int SSLClient::read(uint8_t* buffer, size_t size)
+{
+	flush_record();
+	return client.read(buffer, size);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int SSLClient::peek()
+{
+	flush_record();
+	return client.peek();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void SSLClient::flush()
+{
+	flush_record();
+	client.flush();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void SSLClient::stop()
+{
+	record.clear();
+	client.stop();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+uint8_t SSLClient::connected()
+{
+	return client.connected();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+SSLSession* SSLClient::getSession(const char* host)
+{
+	for (auto& session : sessions) {
+		if (strcmp(session.get_hostname(), host) == 0) return &session;
+	}
+	return nullptr;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void SSLClient::removeSession(const char* host)
+{
+	for (auto it = sessions.begin(); it != sessions.end(); ++it) {
+		if (strcmp(it->get_hostname(), host) == 0) {
+			sessions.erase(it);
+			return;
+		}
+	}
+}
@@ -0,0 +1,162 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+/// @file		SSLClient.h
+/// @brief		Simulated SSLClient used by the native (host) build.
+/// @date		2020
+/// @copyright	GNU General Public License v3.0
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "Client.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// BearSSL trust anchor types, as used by Trust_Anchors.h
+
+#define BR_X509_TA_CA		0x0001
+#define BR_KEYTYPE_RSA		1
+#define BR_KEYTYPE_EC		2
+
+typedef struct {
+	unsigned char*	data;
+	size_t			len;
+} br_x500_name;
+
+typedef struct {
+	unsigned char*	n;
+	size_t			nlen;
+	unsigned char*	e;
+	size_t			elen;
+} br_rsa_public_key;
+
+typedef struct {
+	int				curve;
+	unsigned char*	q;
+	size_t			qlen;
+} br_ec_public_key;
+
+typedef struct {
+	unsigned char	key_type;
+	union {
+		br_rsa_public_key	rsa;
+		br_ec_public_key	ec;
+	} key;
+} br_x509_pkey;
+
+typedef struct {
+	br_x500_name	dn;
+	unsigned		flags;
+	br_x509_pkey	pkey;
+} br_x509_trust_anchor;
+
+///////////////////////////////////////////////////////////////////////////////
+///
+/// Session cached by SSLClient, resumed by the next connection to its host.
+///
+///////////////////////////////////////////////////////////////////////////////
+class SSLSession
+{
+
+public:
+
+	SSLSession(const char* hostname) : hostname(hostname) {}
+
+	const char*	get_hostname() const { return hostname.c_str(); }
+
+private:
+
+	std::string	hostname;
+
+};
+
+///////////////////////////////////////////////////////////////////////////////
+///
+/// SSLClient's interface over the simulated network (see SimNet.h).
+///
+/// Bytes pass through the wrapped Client unencrypted. connect() waits out
+/// a TLS handshake on virtual time, a short one if it resumes the session
+/// cached for the host, and caches up to max_sessions sessions, replacing
+/// the oldest. As with BearSSL, writes are buffered into records, sent
+/// when a record fills or on flush(), available() and read().
+///
+///////////////////////////////////////////////////////////////////////////////
+class SSLClient : public Client
+{
+
+public:
+
+	/// Errors set as the write error
+	enum Error {
+		SSL_OK = 0,
+		SSL_CLIENT_CONNECT_FAIL,
+		SSL_BR_CONNECT_FAIL,
+		SSL_CLIENT_WRTIE_ERROR,
+		SSL_BR_WRITE_ERROR,
+		SSL_INTERNAL_ERROR,
+		SSL_OUT_OF_MEMORY
+	};
+
+	/// How much is logged, nothing is in the simulation
+	enum DebugLevel {
+		SSL_NONE = 0,
+		SSL_ERROR = 1,
+		SSL_WARN = 2,
+		SSL_INFO = 3,
+		SSL_DUMP = 4,
+	};
+
+	SSLClient(
+			Client&						client,
+			const br_x509_trust_anchor*	trust_anchors,
+			const size_t				trust_anchors_num,
+			const int					analog_pin,
+			const size_t				max_sessions	= 1,
+			const DebugLevel			debug			= SSL_WARN
+		);
+
+	int			connect(IPAddress ip, uint16_t port) override;
+	int			connect(const char* host, uint16_t port) override;
+	size_t		write(uint8_t byte) override { return write(&byte, 1); }
+	size_t		write(const uint8_t* buffer, size_t size) override;
+	int			available() override;
+	int			read() override;
+	int			read(uint8_t* buffer, size_t size) override;
+	int			peek() override;
+	void		flush() override;
+	void		stop() override;
+	uint8_t		connected() override;
+				operator bool() override { return connected() > 0; }
+
+	/// Get the session cached for a host
+	/// @param[in]	host	Host name
+	/// @return The session, nullptr if none is cached
+	SSLSession*	getSession(const char* host);
+
+	/// Forget the session cached for a host
+	/// @param[in]	host	Host name
+	void		removeSession(const char* host);
+
+	/// Number of sessions that can be cached
+	size_t		getSessionCount() const { return max_sessions; }
+
+	/// Get the wrapped client
+	Client&		getClient() { return client; }
+
+	using Print::write;
+
+private:
+
+	/// Send the buffered record
+	/// @return False if the wrapped client could not send all of it
+	bool		flush_record();
+
+	Client&						client;
+	const size_t				max_sessions;
+	std::vector<SSLSession>		sessions;		///< Cached sessions, oldest first
+	std::vector<uint8_t>		record;			///< Bytes written and not yet sent
+
+};
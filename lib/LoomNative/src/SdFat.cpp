@@ -0,0 +1,385 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+/// @file		SdFat.cpp
+/// @brief		Simulated SdFat implementation, backed by host files.
+/// @date		2020
+/// @copyright	GNU General Public License v3.0
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#include "SdFat.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <system_error>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+	std::string	root = "sd";
+	bool		failed = false;
+	uint32_t	writes = 0;
+	uint32_t	syncs = 0;
+
+	/// Block range of a contiguous file
+	struct Extent {
+		std::string	path;
+		uint32_t	first;
+		uint32_t	count;
+	};
+
+	std::vector<Extent>	extents;
+	uint32_t			next_block = 0x2000;	// Leave room for a simulated FAT
+
+	const Extent* find_extent(const std::string& path)
+	{
+		for (const auto& e : extents) {
+			if (e.path == path) return &e;
+		}
+		return nullptr;
+	}
+
+	const Extent* find_extent(const uint32_t lba)
+	{
+		for (const auto& e : extents) {
+			if (lba >= e.first && lba < e.first + e.count) return &e;
+		}
+		return nullptr;
+	}
+
+} // namespace
+
+///////////////////////////////////////////////////////////////////////////////
+void LoomNative::SdCard::set_root(const char* dir)
+{
+	root = dir;
+	extents.clear();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void LoomNative::SdCard::set_failed(const bool fail)
+{
+	failed = fail;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+std::string LoomNative::SdCard::host_path(const char* path)
+{
+	while (*path == '/') path++;
+	return root + "/" + path;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+uint32_t LoomNative::SdCard::write_count()
+{
+	return writes;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+uint32_t LoomNative::SdCard::sync_count()
+{
+	return syncs;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void LoomNative::SdCard::reset_stats()
+{
+	writes = 0;
+	syncs = 0;
+}
+
+using LoomNative::SdCard::host_path;
+
+///////////////////////////////////////////////////////////////////////////////
+bool File::open(const char* name, oflag_t oflag)
+{
+	close();
+	if (failed) return false;
+
+	const std::string host = host_path(name);
+	std::error_code ec;
+	const bool exists = fs::is_regular_file(host, ec);
+
+	if ((oflag & O_CREAT) && (oflag & O_EXCL) && exists) return false;
+	if (!(oflag & O_CREAT) && !exists) return false;
+
+	const bool writable = (oflag & O_ACCMODE) != O_RDONLY;
+	const char* mode;
+	if (!writable)					mode = "rb";
+	else if (oflag & O_APPEND)		mode = "a+b";
+	else if (!exists || (oflag & O_TRUNC))	mode = "w+b";
+	else							mode = "r+b";
+
+	FILE* f = fopen(host.c_str(), mode);
+	if (!f) return false;
+
+	fp.reset(f, fclose);
+	syncs++;
+	path = name;
+	flags = oflag;
+	clearWriteError();
+
+	if (oflag & O_AT_END) seekEnd();
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool File::close()
+{
+	if (!fp) return false;
+	fp.reset();
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool File::sync()
+{
+	if (fp) syncs++;
+	return fp && !failed && fflush(fp.get()) == 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+uint32_t File::curPosition() const
+{
+	return fp ? (uint32_t)ftell(fp.get()) : 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+uint32_t File::fileSize() const
+{
+	if (!fp) return 0;
+	const long pos = ftell(fp.get());
+	fseek(fp.get(), 0, SEEK_END);
+	const long end = ftell(fp.get());
+	fseek(fp.get(), pos, SEEK_SET);
+	return (uint32_t)end;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool File::seekSet(uint32_t pos)
+{
+	return fp && fseek(fp.get(), pos, SEEK_SET) == 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool File::seekEnd(int32_t offset)
+{
+	return fp && fseek(fp.get(), offset, SEEK_END) == 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool File::truncate(uint32_t length)
+{
+	if (!fp) return false;
+	fflush(fp.get());
+	std::error_code ec;
+	fs::resize_file(host_path(path.c_str()), length, ec);
+	if (ec) return false;
+	if (curPosition() > length) seekSet(length);
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool File::createContiguous(const char* name, uint32_t size, uint32_t startCluster)
+{
+	if (size == 0 || !open(name, O_RDWR | O_CREAT | O_EXCL)) return false;
+
+	std::error_code ec;
+	fs::resize_file(host_path(name), size, ec);
+	if (ec) {
+		close();
+		return false;
+	}
+
+	const std::string host = host_path(name);
+	extents.erase(std::remove_if(extents.begin(), extents.end(),
+		[&](const Extent& e) { return e.path == host; }), extents.end());
+
+	const uint32_t count = (size + 511) / 512;
+	extents.push_back({host, next_block, count});
+	next_block += count;
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool File::contiguousRange(uint32_t* bgnBlock, uint32_t* endBlock)
+{
+	const Extent* e = fp ? find_extent(host_path(path.c_str())) : nullptr;
+	if (!e) return false;
+	if (bgnBlock) *bgnBlock = e->first;
+	if (endBlock) *endBlock = e->first + e->count - 1;
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+uint32_t File::firstBlock()
+{
+	uint32_t first = 0;
+	contiguousRange(&first, nullptr);
+	return first;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+size_t File::getName(char* name, size_t size) const
+{
+	if (!size) return 0;
+	const std::string base = fs::path(path).filename().string();
+	const size_t n = std::min(base.size(), size - 1);
+	memcpy(name, base.data(), n);
+	name[n] = '\0';
+	return n;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int File::available()
+{
+	if (!fp) return 0;
+	const uint32_t pos = curPosition();
+	const uint32_t end = fileSize();
+	return (end > pos) ? (int)(end - pos) : 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int File::read()
+{
+	return fp ? fgetc(fp.get()) : -1;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int File::peek()
+{
+	if (!fp) return -1;
+	const int c = fgetc(fp.get());
+	if (c != EOF) ungetc(c, fp.get());
+	return c;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int File::read(void* buf, size_t nbyte)
+{
+	return fp ? (int)fread(buf, 1, nbyte, fp.get()) : -1;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+size_t File::write(const uint8_t* buf, size_t size)
+{
+	if (!fp || failed || (flags & O_ACCMODE) == O_RDONLY) {
+		setWriteError();
+		return 0;
+	}
+	writes++;
+	const size_t n = fwrite(buf, 1, size, fp.get());
+	if (n != size) setWriteError();
+	if (flags & O_SYNC) sync();
+	return n;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool SdSpiCard::seek_block(uint32_t lba, const char* mode)
+{
+	fp.reset();
+	const Extent* e = find_extent(lba);
+	if (!e) return false;
+
+	FILE* f = fopen(e->path.c_str(), mode);
+	if (!f) return false;
+	fp.reset(f, fclose);
+
+	block	= lba;
+	end		= e->first + e->count;
+	return fseek(f, (long)(lba - e->first) * 512, SEEK_SET) == 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool SdSpiCard::erase(uint32_t firstBlock, uint32_t lastBlock)
+{
+	static const uint8_t zeros[512] = {};
+	for (uint32_t lba = firstBlock; lba <= lastBlock; lba++) {
+		if (!seek_block(lba, "r+b") || fwrite(zeros, 1, 512, fp.get()) != 512) {
+			fp.reset();
+			return false;
+		}
+	}
+	fp.reset();
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool SdSpiCard::writeStart(uint32_t blockNumber)
+{
+	return seek_block(blockNumber, "r+b");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool SdSpiCard::writeData(const uint8_t* src)
+{
+	if (!fp || block >= end) return false;
+	writes++;
+	block++;
+	return fwrite(src, 1, 512, fp.get()) == 512;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool SdSpiCard::writeStop()
+{
+	const bool was_writing = (bool)fp;
+	fp.reset();
+	return was_writing;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool SdSpiCard::readBlock(uint32_t lba, uint8_t* dst)
+{
+	const bool success = seek_block(lba, "rb") && fread(dst, 1, 512, fp.get()) == 512;
+	fp.reset();
+	return success;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool SdFat::begin(uint8_t cs_pin, uint32_t max_sck)
+{
+	if (failed) return false;
+	std::error_code ec;
+	fs::create_directories(root, ec);
+	return !ec;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool SdFat::exists(const char* path)
+{
+	std::error_code ec;
+	return fs::exists(host_path(path), ec);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool SdFat::remove(const char* path)
+{
+	std::error_code ec;
+	return fs::is_regular_file(host_path(path), ec) && fs::remove(host_path(path), ec);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool SdFat::mkdir(const char* path, bool pFlag)
+{
+	std::error_code ec;
+	return pFlag ? fs::create_directories(host_path(path), ec)
+				 : fs::create_directory(host_path(path), ec);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool SdFat::rmdir(const char* path)
+{
+	std::error_code ec;
+	return fs::is_directory(host_path(path), ec) && fs::remove(host_path(path), ec);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool SdFat::rename(const char* old_path, const char* new_path)
+{
+	std::error_code ec;
+	if (fs::exists(host_path(new_path), ec)) return false;
+	fs::rename(host_path(old_path), host_path(new_path), ec);
+	return !ec;
+}
@@ -0,0 +1,194 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+/// @file		SdFat.h
+/// @brief		Simulated SdFat used by the native (host) build.
+/// @details	Files live in a directory on the host (default "./sd"),
+///				set with LoomNative::SdCard::set_root().
+///				Only the part of the SdFat API used by Loom is provided.
+/// @date		2020
+/// @copyright	GNU General Public License v3.0
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <stdio.h>
+#include <memory>
+#include <string>
+
+#include "Arduino.h"
+
+// Open flags, same values as SdFat's FatApiConstants.h
+#define O_RDONLY	0X00	///< Open for reading only.
+#define O_WRONLY	0X01	///< Open for writing only.
+#define O_RDWR		0X02	///< Open for reading and writing.
+#define O_AT_END	0X04	///< Open at EOF.
+#define O_APPEND	0X08	///< Set append mode.
+#define O_CREAT		0x10	///< Create file if it does not exist.
+#define O_TRUNC		0x20	///< Truncate file to zero length.
+#define O_EXCL		0x40	///< Fail if the file exists.
+#define O_SYNC		0x80	///< Synchronized write I/O operations.
+#define O_ACCMODE	(O_RDONLY|O_WRONLY|O_RDWR)
+
+typedef uint8_t oflag_t;
+
+#define O_READ		O_RDONLY
+#define O_WRITE		O_WRONLY
+
+#define FILE_READ	O_RDONLY
+#define FILE_WRITE	(O_RDWR | O_CREAT | O_AT_END)
+
+#define SD_SCK_HZ(maxSpeed)		(maxSpeed)
+#define SD_SCK_MHZ(maxMhz)		(1000000UL*(maxMhz))
+
+///////////////////////////////////////////////////////////////////////////////
+///
+/// An open file on the simulated card.
+/// Copies share the same underlying handle, like SdFat's File.
+///
+///////////////////////////////////////////////////////////////////////////////
+class File : public Stream
+{
+
+public:
+
+	File() = default;
+	File(const char* path, oflag_t oflag) { open(path, oflag); }
+
+	bool		open(const char* path, oflag_t oflag = O_RDONLY);
+	bool		close();
+	bool		sync();
+
+	bool		isOpen() const { return (bool)fp; }
+	explicit	operator bool() const { return isOpen(); }
+
+	uint32_t	curPosition() const;
+	uint32_t	fileSize() const;
+	uint32_t	size() const { return fileSize(); }
+	uint32_t	position() const { return curPosition(); }
+	bool		seekSet(uint32_t pos);
+	bool		seekEnd(int32_t offset = 0);
+	bool		seek(uint32_t pos) { return seekSet(pos); }
+	void		rewind() { seekSet(0); }
+	bool		truncate(uint32_t length);
+
+	/// Create a new file of a fixed size whose blocks are consecutive on
+	/// the card, so they can be written with SdSpiCard::writeData()
+	bool		createContiguous(const char* path, uint32_t size, uint32_t startCluster = 0);
+	bool		contiguousRange(uint32_t* bgnBlock, uint32_t* endBlock);
+	uint32_t	firstBlock();
+
+	size_t		getName(char* name, size_t size) const;
+	const char*	name() const { return path.c_str(); }
+
+	// Stream
+	int			available() override;
+	int			read() override;
+	int			peek() override;
+	int			read(void* buf, size_t nbyte);
+	void		flush() override { sync(); }
+
+	// Print
+	size_t		write(uint8_t b) override { return write(&b, 1); }
+	size_t		write(const uint8_t* buf, size_t size) override;
+	using Print::write;
+
+private:
+
+	std::shared_ptr<FILE>	fp;
+	std::string				path;
+	oflag_t					flags = 0;
+
+};
+
+///////////////////////////////////////////////////////////////////////////////
+///
+/// Raw block access to the simulated card.
+/// Only blocks of contiguous files (File::createContiguous()) are backed.
+///
+///////////////////////////////////////////////////////////////////////////////
+class SdSpiCard
+{
+
+public:
+
+	bool		erase(uint32_t firstBlock, uint32_t lastBlock);
+	bool		isBusy() { return false; }
+
+	bool		writeStart(uint32_t blockNumber);
+	bool		writeStart(uint32_t blockNumber, uint32_t eraseCount) { return writeStart(blockNumber); }
+	bool		writeData(const uint8_t* src);
+	bool		writeStop();
+
+	bool		readBlock(uint32_t block, uint8_t* dst);
+
+private:
+
+	std::shared_ptr<FILE>	fp;
+	uint32_t				block = 0;		///< Next block to write
+	uint32_t				end = 0;		///< One past the last block of the open file
+
+	bool		seek_block(uint32_t lba, const char* mode);
+
+};
+
+///////////////////////////////////////////////////////////////////////////////
+///
+/// The simulated card / volume.
+///
+///////////////////////////////////////////////////////////////////////////////
+class SdFat
+{
+
+public:
+
+	/// Always succeeds, creates the host directory if needed
+	bool		begin(uint8_t cs_pin = 10, uint32_t max_sck = SD_SCK_MHZ(50));
+
+	File		open(const char* path, oflag_t oflag = O_RDONLY) { return File(path, oflag); }
+	File		open(const String& path, oflag_t oflag = O_RDONLY) { return open(path.c_str(), oflag); }
+
+	bool		exists(const char* path);
+	bool		remove(const char* path);
+	bool		mkdir(const char* path, bool pFlag = true);
+	bool		rmdir(const char* path);
+	bool		rename(const char* old_path, const char* new_path);
+
+	SdSpiCard*	card() { return &sd_card; }
+
+private:
+
+	SdSpiCard	sd_card;
+
+};
+
+namespace LoomNative {
+
+/// Simulation controls for the SD card (not part of SdFat)
+namespace SdCard {
+
+	/// Set the host directory used as the card root.
+	/// Takes effect for files opened afterwards
+	void		set_root(const char* dir);
+
+	/// Make the card fail, as one pulled out or worn out would:
+	/// begin(), opens, writes and syncs fail, reads carry on
+	/// @param[in]	fail	Whether the card fails
+	void		set_failed(const bool fail);
+
+	/// Get the host path of a file on the card
+	std::string	host_path(const char* path);
+
+	/// Number of write() calls that reached the card, for benchmarks
+	uint32_t	write_count();
+
+	/// Number of file opens and syncs (each costs FAT / directory updates
+	/// on a real card), for benchmarks
+	uint32_t	sync_count();
+
+	/// Reset write_count() and sync_count()
+	void		reset_stats();
+
+} // namespace SdCard
+
+} // namespace LoomNative
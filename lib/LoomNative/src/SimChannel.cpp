@@ -0,0 +1,426 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+/// @file		SimChannel.cpp
+/// @brief		Simulated radio channel and device scheduler implementation.
+/// @date		2020
+/// @copyright	GNU General Public License v3.0
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+#include "SimChannel.h"
+#include "SimClock.h"
+
+namespace LoomNative {
+namespace Channel {
+
+///////////////////////////////////////////////////////////////////////////////
+
+/// One attached radio
+struct Radio {
+	bool		attached;
+	uint8_t		address;
+	Phy			phy;
+	uint64_t	tx_end;		///< End of its last transmission, it hears nothing until then
+	bool		listening;	///< Whether it is waiting in receive()
+	int			owner;		///< Device that last received with it, woken when a frame arrives
+};
+
+/// One frame transmitted
+struct Frame {
+	uint64_t			start_us;
+	uint64_t			end_us;
+	uint64_t			arrival_us;
+	Header				header;
+	uint8_t				rate;		///< Phy::rate of the sender
+	int16_t				power;		///< Phy::power of the sender
+	uint8_t				len;
+	uint8_t				bytes[255];
+	bool				collided;
+	std::vector<bool>	pending;	///< By radio, whether it is still to be received there
+};
+
+/// One simulated device
+struct Node {
+	std::function<void()>	loop;
+	std::thread				thread;
+	std::condition_variable	turn;
+	uint64_t				wake_us;
+	bool					stop;		///< Set to end the device's thread
+};
+
+/// Thrown in a device waiting for its turn when the devices are stopped
+struct Stop {};
+
+static Model							settings;
+static std::map<uint16_t, float>		link_loss;
+static std::map<uint16_t, int16_t>		path_loss;
+static std::mt19937						rng(1);
+static std::vector<Radio>				radios;
+static std::deque<Frame>				air;
+static Stats							totals = {};
+
+static std::vector<std::unique_ptr<Node>>	nodes;
+static std::mutex						lock;
+static std::condition_variable			scheduler;
+static int								current		= -1;	// Device running, -1 for the host
+
+/// Frames kept for radios that do not read them
+static const size_t						max_air		= 1024;
+
+///////////////////////////////////////////////////////////////////////////////
+/// Let a device's wait end early, at a virtual time
+static void wake(const int node, const uint64_t at_us)
+{
+	if ( (node < 0) || (node >= (int)nodes.size()) ) return;
+	Node& n = *nodes[node];
+	const uint64_t now = Clock::now_us();
+	if (at_us < n.wake_us) n.wake_us = (at_us > now) ? at_us : now;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// Clock sleep hook while devices run: the running device waits its turn
+static void node_sleep(uint64_t wake_us)
+{
+	const uint64_t now = Clock::now_us();
+	if (current < 0) {
+		if (wake_us > now) Clock::advance_us(wake_us - now);
+		return;
+	}
+	const int self = current;
+	Node& n = *nodes[self];
+	std::unique_lock<std::mutex> guard(lock);
+	n.wake_us = wake_us;
+	current = -1;
+	scheduler.notify_one();
+	n.turn.wait(guard, [&]{ return (current == self) || n.stop; });
+	if (n.stop) throw Stop{};
+}
+
+///////////////////////////////////////////////////////////////////////////////
+static void node_main(const int self, Node* n)
+{
+	{
+		std::unique_lock<std::mutex> guard(lock);
+		n->turn.wait(guard, [&]{ return (current == self) || n->stop; });
+		if (n->stop) return;
+	}
+	try {
+		while (true) n->loop();
+	} catch (const Stop&) {}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void configure(const Model& model)
+{
+	settings = model;
+	rng.seed(model.seed);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+const Model& model()
+{
+	return settings;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void set_loss(const uint8_t from, const uint8_t to, const float loss)
+{
+	const uint16_t link = (from << 8) | to;
+	if (loss < 0) {
+		link_loss.erase(link);
+	} else {
+		link_loss[link] = loss;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void set_path_loss(const uint8_t from, const uint8_t to, const int16_t db)
+{
+	path_loss[(from << 8) | to] = db;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// Signal a frame from a power arrives with
+static int16_t signal(const uint8_t from, const uint8_t to, const int16_t power)
+{
+	const auto link = path_loss.find((from << 8) | to);
+	return power - ( (link != path_loss.end()) ? link->second : 0 );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// Airtime of a frame at a frame time and bitrate
+static uint64_t airtime_us(const uint8_t len, const uint32_t frame_us, const uint32_t bitrate)
+{
+	// The 4 header bytes are sent as payload, as RadioHead does
+	return frame_us + ((uint64_t)(len + 4) * 8000000ULL + bitrate - 1) / bitrate;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+uint64_t airtime_us(const uint8_t len)
+{
+	return airtime_us(len, settings.frame_us, settings.bitrate);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int attach(const uint8_t address)
+{
+	radios.push_back(Radio{true, address, Phy{}, 0, false, -1});
+	return radios.size() - 1;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void detach(const int radio)
+{
+	if ( (radio < 0) || (radio >= (int)radios.size()) ) return;
+	radios[radio].attached = false;
+	for (auto& frame : air) {
+		if (radio < (int)frame.pending.size()) frame.pending[radio] = false;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void set_address(const int radio, const uint8_t address)
+{
+	if ( (radio < 0) || (radio >= (int)radios.size()) ) return;
+	radios[radio].address = address;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void set_phy(const int radio, const Phy& phy)
+{
+	if ( (radio < 0) || (radio >= (int)radios.size()) ) return;
+	radios[radio].phy = phy;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void transmit(const int radio, Header header, const uint8_t* bytes, const uint8_t len)
+{
+	if ( (radio < 0) || (radio >= (int)radios.size()) || !radios[radio].attached ) return;
+	Radio& sender = radios[radio];
+	const uint64_t start = Clock::now_us();
+
+	// Forget frames that ended and were received everywhere, or were never read
+	while ( !air.empty() && (air.front().end_us < start) ) {
+		const Frame& old = air.front();
+		bool unread = false;
+		for (bool p : old.pending) unread |= p;
+		if (unread && (air.size() < max_air)) break;
+		air.pop_front();
+	}
+
+	Frame frame;
+	frame.start_us		= start;
+	frame.end_us		= start + ( sender.phy.bitrate
+		? airtime_us(len, sender.phy.frame_us, sender.phy.bitrate) : airtime_us(len) );
+	frame.arrival_us	= frame.end_us + settings.latency_us;
+	header.from			= sender.address;
+	frame.header		= header;
+	frame.rate			= sender.phy.rate;
+	frame.power			= sender.phy.power;
+	frame.len			= len;
+	frame.collided		= false;
+	memcpy(frame.bytes, bytes, len);
+
+	// Frames still on the air collide with this one, and go unheard by the sender
+	for (auto& other : air) {
+		if (other.end_us <= start) continue;
+		if (radio < (int)other.pending.size()) other.pending[radio] = false;
+		if ( !settings.collisions || (other.rate != frame.rate) ) continue;
+		if (!other.collided) {
+			other.collided = true;
+			totals.collided++;
+		}
+		if (!frame.collided) {
+			frame.collided = true;
+			totals.collided++;
+		}
+	}
+
+	frame.pending.assign(radios.size(), false);
+	std::uniform_real_distribution<float> draw(0, 1);
+	for (size_t i = 0; i < radios.size(); i++) {
+		const Radio& receiver = radios[i];
+		if ( ((int)i == radio) || !receiver.attached ) continue;
+		if ( (header.to != BROADCAST) && (header.to != receiver.address) ) continue;
+		if (receiver.tx_end > start) continue;
+		if (receiver.phy.rate != frame.rate) continue;
+		if (signal(header.from, receiver.address, frame.power) < receiver.phy.sensitivity) {
+			totals.weak++;
+			continue;
+		}
+
+		const auto link = link_loss.find((header.from << 8) | receiver.address);
+		const float loss = (link != link_loss.end()) ? link->second : settings.loss;
+		if ( (loss > 0) && (draw(rng) < loss) ) {
+			totals.lost++;
+			continue;
+		}
+		frame.pending[i] = true;
+		if (receiver.listening) wake(receiver.owner, frame.arrival_us);
+	}
+	air.push_back(frame);
+
+	sender.tx_end = frame.end_us;
+	totals.frames++;
+	totals.bytes		+= len;
+	totals.airtime_us	+= frame.end_us - start;
+
+	// The sender's turn may end here, so the radio is not used after
+	Clock::sleep_us(frame.end_us - start);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool busy(const int radio)
+{
+	if ( (radio < 0) || (radio >= (int)radios.size()) || !radios[radio].attached ) return false;
+	const Radio& listener = radios[radio];
+	const uint64_t now = Clock::now_us();
+	for (const auto& frame : air) {
+		if ( (frame.start_us > now) || (frame.end_us <= now) ) continue;
+		if ( (frame.header.from == listener.address) || (frame.rate != listener.phy.rate) ) continue;
+		if (signal(frame.header.from, listener.address, frame.power) >= listener.phy.sensitivity) return true;
+	}
+	return false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int receive(const int radio, Header& header, uint8_t* bytes, const uint8_t max_len, const uint64_t wait_us,
+	int16_t* rssi)
+{
+	if ( (radio < 0) || (radio >= (int)radios.size()) || !radios[radio].attached ) return -1;
+	const uint64_t deadline = Clock::now_us() + wait_us;
+
+	while (true) {
+		const uint64_t now = Clock::now_us();
+
+		// Frames arrived, oldest first, beyond what the radio holds are overwritten
+		std::vector<Frame*> arrived;
+		uint64_t next_arrival = deadline;
+		for (auto& frame : air) {
+			if ( (radio >= (int)frame.pending.size()) || !frame.pending[radio] ) continue;
+			if (frame.arrival_us > now) {
+				if (frame.arrival_us < next_arrival) next_arrival = frame.arrival_us;
+				continue;
+			}
+			if (frame.collided) {
+				frame.pending[radio] = false;
+				continue;
+			}
+			arrived.push_back(&frame);
+		}
+		std::stable_sort(arrived.begin(), arrived.end(),
+			[](const Frame* a, const Frame* b){ return a->arrival_us < b->arrival_us; });
+		size_t first = 0;
+		while (arrived.size() - first > settings.rx_frames) {
+			arrived[first++]->pending[radio] = false;
+			totals.overrun++;
+		}
+
+		if (first < arrived.size()) {
+			Frame& frame = *arrived[first];
+			frame.pending[radio] = false;
+			header = frame.header;
+			if (rssi) *rssi = signal(frame.header.from, radios[radio].address, frame.power);
+			const uint8_t len = (frame.len < max_len) ? frame.len : max_len;
+			memcpy(bytes, frame.bytes, len);
+			return len;
+		}
+		if (now >= deadline) return -1;
+
+		// Wait for the next arrival, or one transmitted meanwhile
+		radios[radio].listening	= true;
+		radios[radio].owner		= current;
+		Clock::sleep_us(next_arrival - now);
+		radios[radio].listening	= false;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+const Stats& stats()
+{
+	return totals;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void reset_stats()
+{
+	totals = {};
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void add_node(std::function<void()> loop)
+{
+	nodes.emplace_back(new Node{loop, std::thread(), {}, Clock::now_us(), false});
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void run(const uint32_t ms)
+{
+	const uint64_t end = Clock::now_us() + (uint64_t)ms * 1000ULL;
+	Clock::set_sleep_hook(node_sleep);
+
+	for (size_t i = 0; i < nodes.size(); i++) {
+		if (!nodes[i]->thread.joinable()) {
+			nodes[i]->thread = std::thread(node_main, (int)i, nodes[i].get());
+		}
+	}
+
+	while (true) {
+		// Devices due at the same time run in the order they were added
+		int next = -1;
+		for (size_t i = 0; i < nodes.size(); i++) {
+			if ( (next < 0) || (nodes[i]->wake_us < nodes[next]->wake_us) ) next = i;
+		}
+		if ( (next < 0) || (nodes[next]->wake_us > end) ) break;
+
+		const uint64_t now = Clock::now_us();
+		if (nodes[next]->wake_us > now) Clock::advance_us(nodes[next]->wake_us - now);
+
+		std::unique_lock<std::mutex> guard(lock);
+		current = next;
+		nodes[next]->turn.notify_one();
+		scheduler.wait(guard, []{ return current == -1; });
+	}
+
+	const uint64_t now = Clock::now_us();
+	if (end > now) Clock::advance_us(end - now);
+	Clock::set_sleep_hook(nullptr);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void reset()
+{
+	// One at a time, as the devices unwind their stacks
+	for (auto& n : nodes) {
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			n->stop = true;
+			n->turn.notify_one();
+		}
+		if (n->thread.joinable()) n->thread.join();
+	}
+	nodes.clear();
+	current = -1;
+
+	radios.clear();
+	air.clear();
+	link_loss.clear();
+	path_loss.clear();
+	configure(Model{});
+	reset_stats();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // namespace Channel
+} // namespace LoomNative
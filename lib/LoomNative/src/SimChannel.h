@@ -0,0 +1,182 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+/// @file		SimChannel.h
+/// @brief		Simulated radio channel shared by virtual devices, and the
+///				cooperative scheduler that runs them on the virtual clock.
+/// @date		2020
+/// @copyright	GNU General Public License v3.0
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <stdint.h>
+#include <functional>
+
+namespace LoomNative {
+
+///////////////////////////////////////////////////////////////////////////////
+///
+/// One radio channel in the air, with virtual devices taking turns on it.
+///
+/// Radios attach to the channel by address. A frame occupies the channel
+/// for its airtime (Model::frame_us plus Model::bitrate per byte, or those
+/// of the sender's Phy), arrives Model::latency_us after it ends, and is lost:
+/// - with probability Model::loss, or the loss set for its link
+/// - when another frame at the same rate overlaps it (both are lost, if Model::collisions)
+/// - at a radio that is transmitting while it is on the air
+/// - at a radio that has Model::rx_frames unread frames already
+/// - at a radio at another rate (Phy::rate)
+/// - at a radio it reaches weaker than its Phy::sensitivity: frames arrive
+///   at the sender's Phy::power less the path loss of the link
+///
+/// Devices are functions added with add_node(), each run in a loop by run()
+/// as if on its own Feather. Only one runs at a time: a device runs until it
+/// waits (delay(), or a receive()), then the device that is due first runs,
+/// so frames sent by different devices overlap in virtual time as they
+/// would on the air. All randomness is seeded, so runs are reproducible.
+///
+///////////////////////////////////////////////////////////////////////////////
+namespace Channel {
+
+	/// Channel parameters, the defaults are LoRa at SF7, 125 kHz
+	struct Model {
+		uint32_t	bitrate		= 5470;		///< Bits per second of the payload
+		uint32_t	frame_us	= 20600;	///< Airtime of the preamble and header of each frame
+		uint32_t	latency_us	= 0;		///< Delay from the end of a frame to its arrival
+		float		loss		= 0;		///< Probability each frame is lost at each receiver
+		bool		collisions	= true;		///< Whether overlapping frames are lost
+		uint8_t		rx_frames	= 1;		///< Unread frames a radio holds, older ones are overwritten
+		uint32_t	seed		= 1;		///< Seed of the loss draws
+	};
+
+	/// Physical layer of a radio, like the spreading factor and power of a
+	/// LoRa radio. Radios attach with Phy{}, at rate 0 with the Model's
+	/// airtime, hearing every frame
+	struct Phy {
+		uint8_t		rate		= 0;		///< Frames are only heard, and only collide, at the same rate
+		uint32_t	bitrate		= 0;		///< Bits per second of the payload, 0 for Model::bitrate
+		uint32_t	frame_us	= 0;		///< Airtime of the preamble and header, with bitrate
+		int16_t		power		= 0;		///< Transmit power (dBm)
+		int16_t		sensitivity	= -32768;	///< Weakest frame received (dBm)
+	};
+
+	/// Header sent with each frame (like RadioHead's)
+	struct Header {
+		uint8_t		to;			///< Destination address, 0xFF for all
+		uint8_t		from;		///< Source address
+		uint8_t		id;			///< Sequence number
+		uint8_t		flags;		///< Application flags
+	};
+
+	/// Channel totals, for benchmarks
+	struct Stats {
+		uint32_t	frames;			///< Frames transmitted
+		uint32_t	bytes;			///< Payload bytes transmitted
+		uint64_t	airtime_us;		///< Time the channel was transmitted on
+		uint32_t	lost;			///< Frames lost to Model::loss, per receiver
+		uint32_t	weak;			///< Frames lost below a receiver's sensitivity
+		uint32_t	collided;		///< Frames lost to a collision
+		uint32_t	overrun;		///< Frames lost to a full receiver
+	};
+
+	/// Address frames to all radios
+	constexpr uint8_t BROADCAST = 0xFF;
+
+	/// Replace the channel parameters, and reseed the loss draws
+	/// @param[in]	model	Parameters
+	void			configure(const Model& model);
+
+	/// Get the channel parameters
+	const Model&	model();
+
+	/// Set the loss of one direction of a link, e.g. a node far from the hub
+	/// @param[in]	from	Transmitting address
+	/// @param[in]	to		Receiving address
+	/// @param[in]	loss	Probability each frame is lost, negative for Model::loss
+	void			set_loss(const uint8_t from, const uint8_t to, const float loss);
+
+	/// Set the path loss of one direction of a link, e.g. a node far from the hub
+	/// @param[in]	from	Transmitting address
+	/// @param[in]	to		Receiving address
+	/// @param[in]	db		Loss (dB) between the sender's power and the signal received
+	void			set_path_loss(const uint8_t from, const uint8_t to, const int16_t db);
+
+	/// Airtime of a frame
+	/// @param[in]	len		Payload bytes
+	/// @return Microseconds on the air
+	uint64_t		airtime_us(const uint8_t len);
+
+//=============================================================================
+// Radios
+
+	/// Attach a radio to the channel
+	/// @param[in]	address		Address of the radio
+	/// @return Handle of the radio
+	int				attach(const uint8_t address);
+
+	/// Detach a radio from the channel
+	/// @param[in]	radio	Handle from attach()
+	void			detach(const int radio);
+
+	/// Change the address of a radio
+	/// @param[in]	radio	Handle from attach()
+	/// @param[in]	address	New address
+	void			set_address(const int radio, const uint8_t address);
+
+	/// Change the physical layer of a radio, from its next frame
+	/// @param[in]	radio	Handle from attach()
+	/// @param[in]	phy		Rate, airtime, power and sensitivity
+	void			set_phy(const int radio, const Phy& phy);
+
+	/// Transmit a frame, waiting out its airtime
+	/// @param[in]	radio	Handle from attach()
+	/// @param[in]	header	Header of the frame (from is set to the radio's address)
+	/// @param[in]	bytes	Payload
+	/// @param[in]	len		Payload length
+	void			transmit(const int radio, Header header, const uint8_t* bytes, const uint8_t len);
+
+	/// Whether a radio hears a frame on the air at its rate, as LoRa's
+	/// channel activity detection does before sending
+	/// @param[in]	radio	Handle from attach()
+	/// @return True if another radio is transmitting and heard
+	bool			busy(const int radio);
+
+	/// Receive the next frame addressed to a radio
+	/// @param[in]	radio		Handle from attach()
+	/// @param[out]	header		Header of the frame
+	/// @param[out]	bytes		Buffer for the payload
+	/// @param[in]	max_len		Size of bytes, longer payloads are cut
+	/// @param[in]	wait_us		Longest to wait for a frame to arrive
+	/// @param[out]	rssi		Signal of the frame (dBm), if not nullptr
+	/// @return Payload length, -1 if no frame arrived
+	int				receive(const int radio, Header& header, uint8_t* bytes, const uint8_t max_len, const uint64_t wait_us,
+						int16_t* rssi = nullptr);
+
+	/// Get the channel totals
+	const Stats&	stats();
+
+	/// Reset stats()
+	void			reset_stats();
+
+//=============================================================================
+// Devices
+
+	/// Add a device, whose loop() runs over and over during run().
+	/// loop() must wait now and then (delay(), Manager::pause(), a receive)
+	/// for the other devices to get their turn
+	/// @param[in]	loop	Function called in a loop
+	void			add_node(std::function<void()> loop);
+
+	/// Run the devices for a span of virtual time.
+	/// Devices stopped by the end carry on where they left off in the next run()
+	/// @param[in]	ms		Milliseconds to run for
+	void			run(const uint32_t ms);
+
+	/// Stop and remove the devices, detach all radios, restore the default
+	/// parameters and reset the stats
+	void			reset();
+
+} // namespace Channel
+
+} // namespace LoomNative
@@ -0,0 +1,133 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+/// @file		SimClock.cpp
+/// @brief		Deterministic virtual clock implementation.
+/// @date		2020
+/// @copyright	GNU General Public License v3.0
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#include <chrono>
+#include <vector>
+
+#include "SimClock.h"
+
+namespace LoomNative {
+namespace Clock {
+
+///////////////////////////////////////////////////////////////////////////////
+
+/// One pending callback
+struct Timer {
+	int			handle;
+	uint64_t	due_us;
+	void		(*callback)(void);
+};
+
+static uint64_t				virtual_us	= 0;
+static uint32_t				start_epoch	= 1577836800UL;	// 2020-01-01T00:00:00Z
+static std::vector<Timer>	timers;
+static int					next_handle	= 1;
+static void					(*sleep_hook)(uint64_t) = nullptr;
+
+///////////////////////////////////////////////////////////////////////////////
+uint64_t now_us()
+{
+	return virtual_us;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void advance(const uint32_t ms)
+{
+	advance_us((uint64_t)ms * 1000ULL);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void advance_us(const uint64_t us)
+{
+	const uint64_t target = virtual_us + us;
+
+	// Fire timers in deadline order, stopping the clock at each one so the
+	// callback observes the time it was scheduled for
+	while (true) {
+		auto next = timers.end();
+		for (auto it = timers.begin(); it != timers.end(); ++it) {
+			if (it->due_us <= target && (next == timers.end() || it->due_us < next->due_us)) {
+				next = it;
+			}
+		}
+		if (next == timers.end()) break;
+
+		const Timer fired = *next;
+		timers.erase(next);
+		if (fired.due_us > virtual_us) virtual_us = fired.due_us;
+		fired.callback();
+	}
+
+	virtual_us = target;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void sleep_us(const uint64_t us)
+{
+	if (sleep_hook) {
+		sleep_hook(virtual_us + us);
+	} else {
+		advance_us(us);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void set_sleep_hook(void (*hook)(uint64_t wake_us))
+{
+	sleep_hook = hook;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void reset()
+{
+	virtual_us = 0;
+	timers.clear();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void set_epoch(const uint32_t epoch)
+{
+	start_epoch = epoch;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+uint32_t epoch()
+{
+	return start_epoch + (uint32_t)(virtual_us / 1000000ULL);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int add_timer(const uint64_t due_us, void (*callback)(void))
+{
+	timers.push_back(Timer{next_handle, due_us, callback});
+	return next_handle++;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void cancel_timer(const int handle)
+{
+	for (auto it = timers.begin(); it != timers.end(); ++it) {
+		if (it->handle == handle) {
+			timers.erase(it);
+			return;
+		}
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+uint64_t host_ns()
+{
+	using namespace std::chrono;
+	return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // namespace Clock
+} // namespace LoomNative
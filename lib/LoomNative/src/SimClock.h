@@ -0,0 +1,80 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+/// @file		SimClock.h
+/// @brief		Deterministic virtual clock backing millis(), micros() and delay().
+/// @date		2020
+/// @copyright	GNU General Public License v3.0
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <stdint.h>
+
+namespace LoomNative {
+
+///////////////////////////////////////////////////////////////////////////////
+///
+/// Virtual time source for the native build.
+///
+/// Virtual time starts at zero and only moves forward when sketch code calls
+/// delay() / delayMicroseconds() or the host calls advance(). This keeps runs
+/// reproducible regardless of how fast the host machine is.
+///
+///////////////////////////////////////////////////////////////////////////////
+namespace Clock {
+
+	/// Current virtual time
+	/// @return Microseconds since start of simulation
+	uint64_t	now_us();
+
+	/// Move virtual time forward.
+	/// Runs any timers that come due (see add_timer())
+	/// @param[in]	ms		Milliseconds to advance by
+	void		advance(const uint32_t ms);
+
+	/// Move virtual time forward.
+	/// @param[in]	us		Microseconds to advance by
+	void		advance_us(const uint64_t us);
+
+	/// Wait on behalf of sketch code (delay() and delayMicroseconds()).
+	/// Advances the clock, unless a sleep hook is set (see set_sleep_hook())
+	/// @param[in]	us		Microseconds to wait
+	void		sleep_us(const uint64_t us);
+
+	/// Hand the waits of sleep_us() to another function, e.g. one that runs
+	/// other simulated devices until the wait is over (see Channel::run())
+	/// @param[in]	hook	Function given the virtual time to wake at, nullptr to advance the clock
+	void		set_sleep_hook(void (*hook)(uint64_t wake_us));
+
+	/// Reset virtual time to zero and drop all timers
+	void		reset();
+
+	/// Set the wall-clock time (Unix epoch seconds) that corresponds
+	/// to virtual time zero. Used by the simulated RTCs.
+	/// @param[in]	epoch	Unix time at start of simulation
+	void		set_epoch(const uint32_t epoch);
+
+	/// Current wall-clock time, derived from the virtual clock
+	/// @return Unix epoch seconds
+	uint32_t	epoch();
+
+	/// Register a callback to run once virtual time reaches a deadline.
+	/// Used by simulated RTC alarms.
+	/// @param[in]	due_us		Virtual time (microseconds) to fire at
+	/// @param[in]	callback	Function to call
+	/// @return Timer handle, to pass to cancel_timer()
+	int			add_timer(const uint64_t due_us, void (*callback)(void));
+
+	/// Cancel a timer created with add_timer()
+	/// @param[in]	handle	Handle returned by add_timer()
+	void		cancel_timer(const int handle);
+
+	/// Host monotonic clock, unaffected by virtual time.
+	/// Used by benchmarks to measure real CPU cost.
+	/// @return Nanoseconds from an arbitrary origin
+	uint64_t	host_ns();
+
+} // namespace Clock
+
+} // namespace LoomNative
@@ -0,0 +1,326 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+/// @file		SimNet.cpp
+/// @brief		Simulated TCP network and HTTP servers implementation.
+/// @date		2020
+/// @copyright	GNU General Public License v3.0
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <deque>
+#include <map>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <vector>
+
+#include "SimNet.h"
+#include "SimClock.h"
+
+namespace LoomNative {
+namespace Net {
+
+///////////////////////////////////////////////////////////////////////////////
+
+/// Bytes on their way to the client
+struct Segment {
+	uint64_t		arrival_us;
+	std::string		bytes;
+};
+
+/// One connection, from the server's side and the client's
+struct Socket {
+	bool				open;			///< Whether the client has not closed it
+	bool				dropped;		///< Whether the server forgot it without closing it
+	uint64_t			closed_us;		///< When the server's close reaches the client, UINT64_MAX if open
+	uint64_t			idle_us;		///< When the connection last carried a response
+	std::string			host;
+	std::string			request;		///< Bytes received and not yet parsed into a request
+	std::deque<Segment>	response;		///< Bytes sent back
+};
+
+static const uint64_t					never		= UINT64_MAX;
+
+static Model							settings;
+static std::map<std::string, Handler>	servers;
+static std::vector<Socket>				sockets;
+static Stats							totals = {};
+
+///////////////////////////////////////////////////////////////////////////////
+/// Get an open socket, after dropping it if it has been idle too long
+static Socket* find(const int socket)
+{
+	if ( (socket < 0) || (socket >= (int)sockets.size()) || !sockets[socket].open ) return nullptr;
+	Socket& s = sockets[socket];
+	const uint64_t now = Clock::now_us();
+	const uint64_t timeout_us = (uint64_t)settings.idle_timeout_ms * 1000;
+	if ( (timeout_us > 0) && !s.dropped && (s.closed_us == never) && s.response.empty()
+			&& s.request.empty() && (now - s.idle_us >= timeout_us) ) {
+		totals.dropped_idle++;
+		if (settings.idle_silent) {
+			s.dropped = true;
+		} else {
+			s.closed_us = s.idle_us + timeout_us;
+		}
+	}
+	return &s;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// Bytes of a socket's response that have arrived
+static size_t arrived(const Socket& s)
+{
+	const uint64_t now = Clock::now_us();
+	size_t len = 0;
+	for (const auto& segment : s.response) {
+		if (segment.arrival_us > now) break;
+		len += segment.bytes.size();
+	}
+	return len;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// Read a line ending in CRLF from text, starting at pos
+/// @return False if the line is not complete yet
+static bool parse_line(const std::string& text, size_t& pos, std::string& line)
+{
+	const size_t end = text.find("\r\n", pos);
+	if (end == std::string::npos) return false;
+	line = text.substr(pos, end - pos);
+	pos = end + 2;
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// Parse the first request of the bytes a server received
+/// @param[out]	request		The request
+/// @param[out]	close		Whether the client asked to close the connection
+/// @return Length of the request, 0 if it is not complete yet
+static size_t parse_request(const std::string& text, Request& request, bool& close)
+{
+	const size_t head_end = text.find("\r\n\r\n");
+	if (head_end == std::string::npos) return 0;
+	size_t pos = 0;
+	std::string line;
+	parse_line(text, pos, line);
+	const size_t method_end = line.find(' ');
+	const size_t path_end = line.find(' ', method_end + 1);
+	request.method = line.substr(0, method_end);
+	request.path = line.substr(method_end + 1, path_end - method_end - 1);
+	request.host.clear();
+	request.body.clear();
+	request.chunked = false;
+	request.chunks = 0;
+	request.length = -1;
+	close = false;
+
+	while (parse_line(text, pos, line) && !line.empty()) {
+		const size_t colon = line.find(':');
+		if (colon == std::string::npos) continue;
+		const std::string name = line.substr(0, colon);
+		const size_t value_start = line.find_first_not_of(' ', colon + 1);
+		const std::string value = (value_start == std::string::npos) ? "" : line.substr(value_start);
+		if (strcasecmp(name.c_str(), "Host") == 0) {
+			request.host = value;
+		} else if (strcasecmp(name.c_str(), "Content-Length") == 0) {
+			request.length = strtol(value.c_str(), nullptr, 10);
+		} else if (strcasecmp(name.c_str(), "Transfer-Encoding") == 0) {
+			request.chunked = value.find("chunked") != std::string::npos;
+		} else if (strcasecmp(name.c_str(), "Connection") == 0) {
+			close = strcasecmp(value.c_str(), "close") == 0;
+		}
+	}
+
+	if (!request.chunked) {
+		const size_t length = (request.length > 0) ? request.length : 0;
+		if (text.size() - pos < length) return 0;
+		request.body = text.substr(pos, length);
+		return pos + length;
+	}
+	// chunks, each its length in hex then its bytes, up to an empty one
+	while (true) {
+		if (!parse_line(text, pos, line)) return 0;
+		const size_t size = strtoul(line.c_str(), nullptr, 16);
+		if (size == 0) break;
+		if (text.size() < pos + size + 2) return 0;
+		request.body.append(text, pos, size);
+		request.chunks++;
+		pos += size + 2;
+	}
+	// trailers, up to the empty line
+	do {
+		if (!parse_line(text, pos, line)) return 0;
+	} while (!line.empty());
+	return pos;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// Write a response as sent by the server
+static std::string format_response(const Response& response)
+{
+	std::string text = "HTTP/1.1 " + std::to_string(response.status) + " Status\r\n";
+	if (response.close) text += "Connection: close\r\n";
+	if (!response.chunked) {
+		text += "Content-Length: " + std::to_string(response.body.size()) + "\r\n\r\n" + response.body;
+		return text;
+	}
+	text += "Transfer-Encoding: chunked\r\n\r\n";
+	static const size_t chunk = 256;
+	char size[16];
+	for (size_t pos = 0; pos < response.body.size(); pos += chunk) {
+		const std::string part = response.body.substr(pos, chunk);
+		snprintf(size, sizeof(size), "%zx\r\n", part.size());
+		text += size + part + "\r\n";
+	}
+	return text + "0\r\n\r\n";
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// Answer the requests a server has received whole
+static void serve_requests(Socket& s)
+{
+	const auto server = servers.find(s.host);
+	Request request;
+	bool close;
+	size_t len;
+	while ( (s.closed_us == never) && (len = parse_request(s.request, request, close)) > 0 ) {
+		s.request.erase(0, len);
+		totals.requests++;
+		const Response response = server->second(request);
+		const uint64_t arrival = Clock::now_us() + (uint64_t)settings.rtt_ms * 1000;
+		if (response.status > 0) {
+			const std::string text = format_response(response);
+			s.response.push_back(Segment{arrival, text});
+			totals.responses++;
+			totals.bytes_received += text.size();
+			s.idle_us = arrival;
+		}
+		if (close || response.close) s.closed_us = arrival;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void configure(const Model& model)
+{
+	settings = model;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+const Model& model()
+{
+	return settings;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void serve(const char* host, Handler handler)
+{
+	servers[host] = handler;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void reset()
+{
+	settings = Model{};
+	servers.clear();
+	sockets.clear();
+	totals = {};
+}
+
+///////////////////////////////////////////////////////////////////////////////
+const Stats& stats()
+{
+	return totals;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void reset_stats()
+{
+	totals = {};
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int open(const char* host)
+{
+	Clock::sleep_us((uint64_t)settings.connect_ms * 1000);
+	if (servers.find(host) == servers.end()) return -1;
+	totals.connects++;
+	sockets.push_back(Socket{true, false, never, Clock::now_us(), host, {}, {}});
+	return sockets.size() - 1;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void close(const int socket)
+{
+	if ( (socket < 0) || (socket >= (int)sockets.size()) ) return;
+	Socket& s = sockets[socket];
+	s.open = false;
+	s.request.clear();
+	s.response.clear();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool connected(const int socket)
+{
+	Socket* s = find(socket);
+	if (s == nullptr) return false;
+	return (Clock::now_us() < s->closed_us) || (arrived(*s) > 0);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+size_t send(const int socket, const uint8_t* bytes, const size_t len)
+{
+	Socket* s = find(socket);
+	if ( (s == nullptr) || (Clock::now_us() >= s->closed_us) ) return 0;
+	totals.bytes_sent += len;
+	// the server forgot the connection, and resets it
+	if (s->dropped) {
+		if (s->closed_us == never) s->closed_us = Clock::now_us() + (uint64_t)settings.rtt_ms * 1000;
+		return len;
+	}
+	s->request.append((const char*)bytes, len);
+	serve_requests(*s);
+	return len;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int available(const int socket)
+{
+	Socket* s = find(socket);
+	return (s == nullptr) ? 0 : arrived(*s);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int receive(const int socket, uint8_t* bytes, const size_t len)
+{
+	Socket* s = find(socket);
+	if ( (s == nullptr) || (arrived(*s) == 0) ) return -1;
+	if (bytes == nullptr) return (uint8_t)s->response.front().bytes[0];
+	size_t count = 0;
+	while ( (count < len) && !s->response.empty() && (s->response.front().arrival_us <= Clock::now_us()) ) {
+		std::string& front = s->response.front().bytes;
+		const size_t take = std::min(len - count, front.size());
+		memcpy(bytes + count, front.data(), take);
+		front.erase(0, take);
+		count += take;
+		if (front.empty()) s->response.pop_front();
+	}
+	return count;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void handshake(const bool resumed)
+{
+	if (resumed) {
+		totals.resumed++;
+	} else {
+		totals.handshakes++;
+	}
+	Clock::sleep_us((uint64_t)(resumed ? settings.resume_ms : settings.handshake_ms) * 1000);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // namespace Net
+} // namespace LoomNative
@@ -0,0 +1,150 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+/// @file		SimNet.h
+/// @brief		Simulated TCP network and HTTP servers, behind the native
+///				EthernetClient and SSLClient.
+/// @date		2020
+/// @copyright	GNU General Public License v3.0
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <functional>
+#include <string>
+
+namespace LoomNative {
+
+///////////////////////////////////////////////////////////////////////////////
+///
+/// A network of HTTP/1.1 servers, reached through sockets on virtual time.
+///
+/// A server is a handler added with serve() for a host name. Sockets open
+/// to it after Model::connect_ms, and the server parses what is sent over
+/// them into requests: headers, then a body of Content-Length bytes or
+/// chunks (Transfer-Encoding: chunked). Each request whole is handed to
+/// the handler, and its response arrives Model::rtt_ms later, with a
+/// Content-Length or chunked body. Connections are kept alive unless the
+/// request or response asks to close them, until idle for
+/// Model::idle_timeout_ms; the server then closes them, or forgets them
+/// without a word if Model::idle_silent (as a NAT would), so the client
+/// only learns of it when its next request is reset.
+///
+/// A handler can also leave a request unanswered (Response::status 0),
+/// hanging on to the connection or closing it.
+///
+/// There is no TLS: SSLClient passes bytes through unchanged, and only
+/// waits out its handshake with handshake().
+///
+///////////////////////////////////////////////////////////////////////////////
+namespace Net {
+
+	/// Network parameters
+	struct Model {
+		uint32_t	connect_ms		= 100;		///< TCP connection setup
+		uint32_t	rtt_ms			= 100;		///< Round trip from the end of a request to its response
+		uint32_t	handshake_ms	= 2000;		///< Full TLS handshake, mostly the Feather's public key math
+		uint32_t	resume_ms		= 200;		///< TLS handshake resuming a cached session
+		uint32_t	idle_timeout_ms	= 60000;	///< Servers drop connections idle this long, 0 for never
+		bool		idle_silent		= false;	///< Whether idle connections are dropped without closing them
+	};
+
+	/// A request received by a server
+	struct Request {
+		std::string	method;			///< e.g. GET
+		std::string	path;			///< Path and query
+		std::string	host;			///< Host header
+		std::string	body;			///< Body, its chunks joined
+		long		length;			///< Content-Length header, -1 if none
+		bool		chunked;		///< Whether the body was chunked
+		uint32_t	chunks;			///< Chunks of the body, not counting the last (empty) one
+	};
+
+	/// A server's response
+	struct Response {
+		int			status	= 200;		///< HTTP status, 0 to not answer
+		std::string	body;				///< Body
+		bool		chunked	= false;	///< Send the body chunked
+		bool		close	= false;	///< Close the connection after the response (or instead of it)
+	};
+
+	/// Answers the requests to a server
+	using Handler = std::function<Response(const Request& request)>;
+
+	/// Network totals, for benchmarks
+	struct Stats {
+		uint32_t	connects;		///< Connections opened
+		uint32_t	requests;		///< Requests received whole by servers
+		uint32_t	responses;		///< Responses sent
+		uint32_t	dropped_idle;	///< Connections dropped by servers for being idle
+		uint32_t	handshakes;		///< Full TLS handshakes
+		uint32_t	resumed;		///< TLS handshakes resuming a session
+		uint32_t	bytes_sent;		///< Bytes sent by clients
+		uint32_t	bytes_received;	///< Bytes of responses
+	};
+
+	/// Replace the network parameters
+	/// @param[in]	model	Parameters
+	void			configure(const Model& model);
+
+	/// Get the network parameters
+	const Model&	model();
+
+	/// Add a server, or replace the handler of one
+	/// @param[in]	host	Host name the server is reached at, on any port
+	/// @param[in]	handler	Answers its requests
+	void			serve(const char* host, Handler handler);
+
+	/// Remove all servers and sockets, and restore the default Model
+	void			reset();
+
+	/// Get the network totals
+	const Stats&	stats();
+
+	/// Reset stats()
+	void			reset_stats();
+
+//=============================================================================
+// Sockets, for the simulated clients
+
+	/// Open a connection to a server, waiting out Model::connect_ms
+	/// @param[in]	host	Host name of the server
+	/// @return Handle of the socket, -1 if there is no such server
+	int				open(const char* host);
+
+	/// Close a socket, from the client's end
+	/// @param[in]	socket	Handle from open()
+	void			close(const int socket);
+
+	/// Whether a socket is open, or has bytes left to read after closing
+	/// @param[in]	socket	Handle from open()
+	bool			connected(const int socket);
+
+	/// Send bytes to the server
+	/// @param[in]	socket	Handle from open()
+	/// @param[in]	bytes	Bytes to send
+	/// @param[in]	len		Number of bytes
+	/// @return Number of bytes sent, 0 if the socket is closed
+	size_t			send(const int socket, const uint8_t* bytes, const size_t len);
+
+	/// Bytes of the response that have arrived
+	/// @param[in]	socket	Handle from open()
+	/// @return Bytes ready to read
+	int				available(const int socket);
+
+	/// Read bytes that have arrived
+	/// @param[in]	socket	Handle from open()
+	/// @param[out]	bytes	Buffer for the bytes, nullptr to only look at the next one
+	/// @param[in]	len		Size of bytes
+	/// @return Number of bytes read (or the next byte, without bytes), -1 if none have arrived
+	int				receive(const int socket, uint8_t* bytes, const size_t len);
+
+	/// Wait out a TLS handshake, for the simulated SSLClient
+	/// @param[in]	resumed		Whether it resumes a cached session
+	void			handshake(const bool resumed);
+
+} // namespace Net
+
+} // namespace LoomNative
@@ -0,0 +1,92 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+/// @file		Stream.cpp
+/// @brief		Simulated Arduino Stream implementation.
+/// @date		2020
+/// @copyright	GNU General Public License v3.0
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#include "Arduino.h"
+
+///////////////////////////////////////////////////////////////////////////////
+size_t Stream::readBytes(char* buffer, size_t length)
+{
+	size_t count = 0;
+	while (count < length) {
+		const int c = read();
+		if (c < 0) break;
+		*buffer++ = (char)c;
+		count++;
+	}
+	return count;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+size_t Stream::readBytesUntil(char terminator, char* buffer, size_t length)
+{
+	size_t count = 0;
+	while (count < length) {
+		const int c = read();
+		if (c < 0 || c == terminator) break;
+		*buffer++ = (char)c;
+		count++;
+	}
+	return count;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+String Stream::readString()
+{
+	String ret;
+	int c;
+	while ((c = read()) >= 0) ret += (char)c;
+	return ret;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+String Stream::readStringUntil(char terminator)
+{
+	String ret;
+	int c;
+	while ((c = read()) >= 0 && c != terminator) ret += (char)c;
+	return ret;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool Stream::find(const char* target)
+{
+	const size_t len = strlen(target);
+	size_t index = 0;
+	if (len == 0) return true;
+	int c;
+	while ((c = read()) >= 0) {
+		if (c == target[index]) {
+			if (++index >= len) return true;
+		} else {
+			index = (c == target[0]) ? 1 : 0;
+		}
+	}
+	return false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+long Stream::parseInt()
+{
+	int c;
+	// skip to the first digit or minus sign
+	while ((c = peek()) >= 0 && c != '-' && !isdigit(c)) read();
+	if (c < 0) return 0;
+
+	bool negative = false;
+	long value = 0;
+	if (c == '-') {
+		negative = true;
+		read();
+	}
+	while ((c = peek()) >= 0 && isdigit(c)) {
+		value = value * 10 + (c - '0');
+		read();
+	}
+	return negative ? -value : value;
+}
@@ -0,0 +1,49 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+/// @file		Stream.h
+/// @brief		Simulated Arduino Stream base class used by the native (host) build.
+/// @date		2020
+/// @copyright	GNU General Public License v3.0
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "Print.h"
+
+///////////////////////////////////////////////////////////////////////////////
+///
+/// Arduino Stream interface.
+///
+/// Reads never block on virtual time: a stream with no data available
+/// behaves as if its timeout expired immediately.
+///
+///////////////////////////////////////////////////////////////////////////////
+class Stream : public Print
+{
+
+public:
+
+	virtual ~Stream() = default;
+
+	virtual int		available() = 0;
+	virtual int		read() = 0;
+	virtual int		peek() = 0;
+
+	void			setTimeout(unsigned long timeout) { this->timeout = timeout; }
+	unsigned long	getTimeout() const { return timeout; }
+
+	size_t			readBytes(char* buffer, size_t length);
+	size_t			readBytes(uint8_t* buffer, size_t length) { return readBytes((char*)buffer, length); }
+	size_t			readBytesUntil(char terminator, char* buffer, size_t length);
+	String			readString();
+	String			readStringUntil(char terminator);
+
+	bool			find(const char* target);
+	long			parseInt();
+
+protected:
+
+	unsigned long	timeout = 1000;
+
+};
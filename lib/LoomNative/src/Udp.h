@@ -0,0 +1,44 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+/// @file		Udp.h
+/// @brief		Arduino UDP interface for the native (host) build.
+/// @date		2020
+/// @copyright	GNU General Public License v3.0
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "Stream.h"
+#include "IPAddress.h"
+
+///////////////////////////////////////////////////////////////////////////////
+///
+/// Arduino UDP interface: a socket sending and receiving datagrams.
+///
+///////////////////////////////////////////////////////////////////////////////
+class UDP : public Stream
+{
+
+public:
+
+	virtual uint8_t		begin(uint16_t port) = 0;
+	virtual void		stop() = 0;
+	virtual int			beginPacket(IPAddress ip, uint16_t port) = 0;
+	virtual int			beginPacket(const char* host, uint16_t port) = 0;
+	virtual int			endPacket() = 0;
+	virtual size_t		write(uint8_t byte) = 0;
+	virtual size_t		write(const uint8_t* buffer, size_t size) = 0;
+	virtual int			parsePacket() = 0;
+	virtual int			available() = 0;
+	virtual int			read() = 0;
+	virtual int			read(unsigned char* buffer, size_t len) = 0;
+	virtual int			read(char* buffer, size_t len) = 0;
+	virtual int			peek() = 0;
+	virtual void		flush() = 0;
+	virtual IPAddress	remoteIP() = 0;
+	virtual uint16_t	remotePort() = 0;
+
+	using Print::write;
+
+};
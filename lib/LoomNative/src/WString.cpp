@@ -0,0 +1,236 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+/// @file		WString.cpp
+/// @brief		Simulated Arduino String implementation.
+/// @date		2020
+/// @copyright	GNU General Public License v3.0
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+
+#include "Arduino.h"
+
+///////////////////////////////////////////////////////////////////////////////
+static std::string number_to_string(unsigned long value, const unsigned char base, const bool negative)
+{
+	char buf[8 * sizeof(long) + 2];
+	char* p = &buf[sizeof(buf) - 1];
+	*p = '\0';
+	do {
+		const unsigned long digit = value % base;
+		*--p = (digit < 10) ? ('0' + digit) : ('A' + digit - 10);
+		value /= base;
+	} while (value);
+	if (negative) *--p = '-';
+	return std::string(p);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+String::String(const char* cstr) : buffer(cstr ? cstr : "") {}
+
+String::String(const char* cstr, unsigned int length) : buffer(cstr ? std::string(cstr, length) : "") {}
+
+String::String(const __FlashStringHelper* str) : String(reinterpret_cast<const char*>(str)) {}
+
+String::String(char c) : buffer(1, c) {}
+
+String::String(unsigned char value, unsigned char base) : buffer(number_to_string(value, base, false)) {}
+
+String::String(int value, unsigned char base)
+	: buffer( (base == 10 && value < 0)
+		? number_to_string(-(long)value, base, true)
+		: number_to_string((unsigned int)value, base, false) ) {}
+
+String::String(unsigned int value, unsigned char base) : buffer(number_to_string(value, base, false)) {}
+
+String::String(long value, unsigned char base)
+	: buffer( (base == 10 && value < 0)
+		? number_to_string(-value, base, true)
+		: number_to_string((unsigned long)value, base, false) ) {}
+
+String::String(unsigned long value, unsigned char base) : buffer(number_to_string(value, base, false)) {}
+
+String::String(float value, unsigned char decimal_places) : String((double)value, decimal_places) {}
+
+String::String(double value, unsigned char decimal_places)
+{
+	char buf[40];
+	snprintf(buf, sizeof(buf), "%.*f", decimal_places, value);
+	buffer = buf;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+char& String::operator[](unsigned int index)
+{
+	static char dummy;
+	if (index >= buffer.length()) {
+		dummy = 0;
+		return dummy;
+	}
+	return buffer[index];
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool String::equalsIgnoreCase(const String& s) const
+{
+	if (length() != s.length()) return false;
+	for (unsigned int i = 0; i < length(); i++) {
+		if (tolower(buffer[i]) != tolower(s.buffer[i])) return false;
+	}
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool String::startsWith(const String& prefix) const
+{
+	return startsWith(prefix, 0);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool String::startsWith(const String& prefix, unsigned int offset) const
+{
+	if (offset + prefix.length() > length()) return false;
+	return buffer.compare(offset, prefix.length(), prefix.buffer) == 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool String::endsWith(const String& suffix) const
+{
+	if (suffix.length() > length()) return false;
+	return buffer.compare(length() - suffix.length(), suffix.length(), suffix.buffer) == 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void String::getBytes(unsigned char* buf, unsigned int bufsize, unsigned int index) const
+{
+	if (!bufsize || !buf) return;
+	if (index >= length()) {
+		buf[0] = 0;
+		return;
+	}
+	unsigned int n = std::min<unsigned int>(bufsize - 1, length() - index);
+	memcpy(buf, buffer.c_str() + index, n);
+	buf[n] = 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int String::indexOf(char ch, unsigned int from) const
+{
+	const auto pos = buffer.find(ch, from);
+	return (pos == std::string::npos) ? -1 : (int)pos;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int String::indexOf(const String& str, unsigned int from) const
+{
+	const auto pos = buffer.find(str.buffer, from);
+	return (pos == std::string::npos) ? -1 : (int)pos;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int String::lastIndexOf(char ch) const
+{
+	const auto pos = buffer.rfind(ch);
+	return (pos == std::string::npos) ? -1 : (int)pos;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int String::lastIndexOf(const String& str) const
+{
+	const auto pos = buffer.rfind(str.buffer);
+	return (pos == std::string::npos) ? -1 : (int)pos;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+String String::substring(unsigned int begin_index, unsigned int end_index) const
+{
+	if (begin_index > end_index) std::swap(begin_index, end_index);
+	if (begin_index >= length()) return String();
+	if (end_index > length()) end_index = length();
+	return String(buffer.substr(begin_index, end_index - begin_index));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void String::replace(char find, char replace)
+{
+	std::replace(buffer.begin(), buffer.end(), find, replace);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void String::replace(const String& find, const String& replace)
+{
+	if (find.isEmpty()) return;
+	size_t pos = 0;
+	while ((pos = buffer.find(find.buffer, pos)) != std::string::npos) {
+		buffer.replace(pos, find.length(), replace.buffer);
+		pos += replace.length();
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void String::remove(unsigned int index)
+{
+	if (index < length()) buffer.erase(index);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void String::remove(unsigned int index, unsigned int count)
+{
+	if (index < length()) buffer.erase(index, count);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void String::toLowerCase()
+{
+	for (auto& c : buffer) c = tolower(c);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void String::toUpperCase()
+{
+	for (auto& c : buffer) c = toupper(c);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void String::trim()
+{
+	const auto first = buffer.find_first_not_of(" \t\r\n\v\f");
+	if (first == std::string::npos) {
+		buffer.clear();
+		return;
+	}
+	const auto last = buffer.find_last_not_of(" \t\r\n\v\f");
+	buffer = buffer.substr(first, last - first + 1);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+long String::toInt() const
+{
+	return atol(buffer.c_str());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+float String::toFloat() const
+{
+	return (float)atof(buffer.c_str());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+double String::toDouble() const
+{
+	return atof(buffer.c_str());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+String operator+(const String& lhs, const String& rhs)	{ String s(lhs); s.concat(rhs); return s; }
+String operator+(const String& lhs, const char* rhs)	{ String s(lhs); s.concat(rhs); return s; }
+String operator+(const char* lhs, const String& rhs)	{ String s(lhs); s.concat(rhs); return s; }
+String operator+(const String& lhs, char rhs)			{ String s(lhs); s.concat(rhs); return s; }
+String operator+(const String& lhs, unsigned char rhs)	{ String s(lhs); s.concat(rhs); return s; }
+String operator+(const String& lhs, int rhs)			{ String s(lhs); s.concat(rhs); return s; }
+String operator+(const String& lhs, unsigned int rhs)	{ String s(lhs); s.concat(rhs); return s; }
+String operator+(const String& lhs, long rhs)			{ String s(lhs); s.concat(rhs); return s; }
+String operator+(const String& lhs, unsigned long rhs)	{ String s(lhs); s.concat(rhs); return s; }
+String operator+(const String& lhs, float rhs)			{ String s(lhs); s.concat(rhs); return s; }
+String operator+(const String& lhs, double rhs)			{ String s(lhs); s.concat(rhs); return s; }
@@ -0,0 +1,141 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+/// @file		WString.h
+/// @brief		Simulated Arduino String class used by the native (host) build.
+/// @date		2020
+/// @copyright	GNU General Public License v3.0
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <stdint.h>
+#include <string>
+
+class __FlashStringHelper;
+
+///////////////////////////////////////////////////////////////////////////////
+///
+/// Arduino String, backed by std::string.
+///
+/// Follows the Arduino semantics Loom relies on (numeric constructors,
+/// substring bounds clamping, toInt() returning 0 on garbage).
+///
+///////////////////////////////////////////////////////////////////////////////
+class String
+{
+
+public:
+
+	String(const char* cstr = "");
+	String(const char* cstr, unsigned int length);
+	String(const __FlashStringHelper* str);
+	String(const std::string& str) : buffer(str) {}
+	String(const String& str) = default;
+	String(String&& str) = default;
+	explicit String(char c);
+	explicit String(unsigned char value, unsigned char base = 10);
+	explicit String(int value, unsigned char base = 10);
+	explicit String(unsigned int value, unsigned char base = 10);
+	explicit String(long value, unsigned char base = 10);
+	explicit String(unsigned long value, unsigned char base = 10);
+	explicit String(float value, unsigned char decimal_places = 2);
+	explicit String(double value, unsigned char decimal_places = 2);
+
+	String& operator=(const String& rhs) = default;
+	String& operator=(String&& rhs) = default;
+	String& operator=(const char* cstr) { buffer = cstr ? cstr : ""; return *this; }
+
+	bool		reserve(unsigned int size) { buffer.reserve(size); return true; }
+	unsigned int length() const { return buffer.length(); }
+	bool		isEmpty() const { return buffer.empty(); }
+	const char*	c_str() const { return buffer.c_str(); }
+	char*		begin() { return &buffer[0]; }
+	char*		end() { return &buffer[0] + buffer.length(); }
+
+	bool		concat(const String& str) { buffer += str.buffer; return true; }
+	bool		concat(const char* cstr) { if (cstr) buffer += cstr; return true; }
+	bool		concat(char c) { buffer += c; return true; }
+	bool		concat(unsigned char num) { return concat(String(num)); }
+	bool		concat(int num) { return concat(String(num)); }
+	bool		concat(unsigned int num) { return concat(String(num)); }
+	bool		concat(long num) { return concat(String(num)); }
+	bool		concat(unsigned long num) { return concat(String(num)); }
+	bool		concat(float num) { return concat(String(num)); }
+	bool		concat(double num) { return concat(String(num)); }
+
+	template <typename T>
+	String&		operator+=(const T& rhs) { concat(rhs); return *this; }
+
+	int			compareTo(const String& s) const { return buffer.compare(s.buffer); }
+	bool		equals(const String& s) const { return buffer == s.buffer; }
+	bool		equals(const char* cstr) const { return buffer == (cstr ? cstr : ""); }
+	bool		equalsIgnoreCase(const String& s) const;
+	bool		startsWith(const String& prefix) const;
+	bool		startsWith(const String& prefix, unsigned int offset) const;
+	bool		endsWith(const String& suffix) const;
+
+	bool		operator==(const String& rhs) const { return equals(rhs); }
+	bool		operator==(const char* cstr) const { return equals(cstr); }
+	bool		operator!=(const String& rhs) const { return !equals(rhs); }
+	bool		operator!=(const char* cstr) const { return !equals(cstr); }
+	bool		operator<(const String& rhs) const { return compareTo(rhs) < 0; }
+	bool		operator>(const String& rhs) const { return compareTo(rhs) > 0; }
+
+	char		charAt(unsigned int index) const { return index < buffer.length() ? buffer[index] : 0; }
+	void		setCharAt(unsigned int index, char c) { if (index < buffer.length()) buffer[index] = c; }
+	char		operator[](unsigned int index) const { return charAt(index); }
+	char&		operator[](unsigned int index);
+
+	void		getBytes(unsigned char* buf, unsigned int bufsize, unsigned int index = 0) const;
+	void		toCharArray(char* buf, unsigned int bufsize, unsigned int index = 0) const
+				{ getBytes((unsigned char*)buf, bufsize, index); }
+
+	int			indexOf(char ch, unsigned int from = 0) const;
+	int			indexOf(const String& str, unsigned int from = 0) const;
+	int			lastIndexOf(char ch) const;
+	int			lastIndexOf(const String& str) const;
+
+	String		substring(unsigned int begin_index) const { return substring(begin_index, length()); }
+	String		substring(unsigned int begin_index, unsigned int end_index) const;
+
+	void		replace(char find, char replace);
+	void		replace(const String& find, const String& replace);
+	void		remove(unsigned int index);
+	void		remove(unsigned int index, unsigned int count);
+	void		toLowerCase();
+	void		toUpperCase();
+	void		trim();
+
+	long		toInt() const;
+	float		toFloat() const;
+	double		toDouble() const;
+
+private:
+
+	std::string	buffer;
+
+};
+
+/// Exists so ArduinoJson's String adapters resolve; concatenation
+/// returns plain String on the host
+class StringSumHelper : public String
+{
+public:
+	using String::String;
+	StringSumHelper(const String& s) : String(s) {}
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+String operator+(const String& lhs, const String& rhs);
+String operator+(const String& lhs, const char* rhs);
+String operator+(const char* lhs, const String& rhs);
+String operator+(const String& lhs, char rhs);
+String operator+(const String& lhs, unsigned char rhs);
+String operator+(const String& lhs, int rhs);
+String operator+(const String& lhs, unsigned int rhs);
+String operator+(const String& lhs, long rhs);
+String operator+(const String& lhs, unsigned long rhs);
+String operator+(const String& lhs, float rhs);
+String operator+(const String& lhs, double rhs);
@@ -0,0 +1,43 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+/// @file		Wire.h
+/// @brief		Simulated I2C bus used by the native (host) build.
+/// @details	No devices are attached: writes are accepted and reads return
+///				no data, so I2C sensors fail their presence checks cleanly.
+/// @date		2020
+/// @copyright	GNU General Public License v3.0
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "Arduino.h"
+
+///////////////////////////////////////////////////////////////////////////////
+class TwoWire : public Stream
+{
+
+public:
+
+	void		begin() {}
+	void		begin(uint8_t address) {}
+	void		end() {}
+	void		setClock(uint32_t frequency) {}
+
+	void		beginTransmission(uint8_t address) {}
+	/// @return 2 (address NACK) since no devices are attached
+	uint8_t		endTransmission(bool stop_bit = true) { return 2; }
+
+	uint8_t		requestFrom(uint8_t address, size_t quantity, bool stop_bit = true) { return 0; }
+
+	size_t		write(uint8_t data) override { return 1; }
+	size_t		write(const uint8_t* data, size_t quantity) override { return quantity; }
+	using Print::write;
+
+	int			available() override { return 0; }
+	int			read() override { return -1; }
+	int			peek() override { return -1; }
+
+};
+
+extern TwoWire Wire;
@@ -0,0 +1,144 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+/// @file		Batch.cpp
+/// @brief		BatchSD storage versus the previous one json file per packet.
+/// @date		2020
+/// @copyright	GNU General Public License v3.0
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#include "Bench.h"
+
+#include <Manager.h>
+#include <Sensors/Analog.h>
+#include <LogPlats/BatchSD.h>
+#include <CommPlats/BatchCodec.h>
+
+using namespace Loom;
+
+static const char* batch_config = "{\
+	'general':{'name':'Device','instance':1,'print_verbosity':0},\
+	'components':[\
+		{'name':'Analog','params':'default'},\
+		{'name':'BatchSD','params':[false,0,11]}\
+	]\
+}";
+
+/// Previous BatchSD storage: Batches/Batch-<b>-<i>.json per packet
+struct FilePerPacket
+{
+	SdFat				sd;
+	DynamicJsonDocument	doc{2048};
+	int					count = 0;
+
+	FilePerPacket() { sd.begin(11); sd.mkdir("Legacy"); }
+
+	void name(int index, char* file_name)
+	{
+		String file = "Legacy/Batch-";
+		file = file + 0;
+		file = file + "-";
+		file = file + index;
+		file = file + ".json";
+		file.toCharArray(file_name, file.length()+1);
+	}
+
+	void store(JsonObject json)
+	{
+		char file_name[30];
+		name(count, file_name);
+		File file;
+		file.open(file_name, O_WRONLY | O_CREAT);
+		serializeJson(json, file);
+		file.sync();
+		file.close();
+		count++;
+	}
+
+	JsonObject get(int index)
+	{
+		doc.clear();
+		char file_name[30];
+		name(index, file_name);
+		File file = sd.open(file_name, O_READ);
+		deserializeJson(doc, file);
+		return doc.as<JsonObject>();
+	}
+
+	void clear()
+	{
+		char file_name[30];
+		for (int i = 0; i < count; i++) {
+			name(i, file_name);
+			sd.remove(file_name);
+		}
+		count = 0;
+	}
+};
+
+///////////////////////////////////////////////////////////////////////////////
+BENCH(batch)
+{
+	LoomNative::Pins::set_analog(A0, 1024);
+
+	Manager feather{};
+	feather.parse_config(batch_config);
+	feather.measure();
+	feather.package();
+	JsonObject json = feather.internal_json(false);
+
+	BatchSD& batch = *feather.get<BatchSD>();
+	FilePerPacket legacy;
+
+	state.measure("file_per_packet/store", [&]{ legacy.store(json); });
+	state.measure("file_per_packet/get", [&]{ legacy.get(rand() % legacy.count); });
+	state.measure("file_per_packet/clear_20", [&]{
+		for (int i = 0; i < 20; i++) legacy.store(json);
+		legacy.clear();
+	});
+
+	state.measure("append/store", [&]{ batch.store_batch_json(json); });
+	int next = 0;
+	state.measure("append/get_in_order", [&]{
+		batch.get_batch_json(next);
+		next = (next + 1) % batch.get_packet_counter();
+	});
+	uint8_t raw[255];
+	state.measure("append/get_raw_in_order", [&]{
+		batch.get_batch_raw(next, raw, sizeof(raw));
+		next = (next + 1) % batch.get_packet_counter();
+	});
+	state.measure("append/get_random", [&]{ batch.get_batch_json(rand() % batch.get_packet_counter()); });
+	state.measure("append/clear_20", [&]{
+		for (int i = 0; i < 20; i++) batch.store_batch_json(json);
+		batch.clear_batch_log();
+	});
+
+	// Compressing a block of stored packets for CommPlat::send_batch()
+	for (int i = 0; i < 20; i++) batch.store_batch_json(json);
+	BatchCodec codec;
+	uint8_t block[1024];
+	uint16_t block_len = 0;
+	state.measure("compress/block", [&]{
+		codec.begin(block, sizeof(block));
+		uint32_t raw_len = 0;
+		for (int i = 0; i < batch.get_packet_counter(); i++) {
+			const int len = batch.get_batch_raw(i, codec.packet_buffer(), codec.packet_room());
+			if ( (len > codec.packet_room()) || !codec.add(len) ) break;
+			raw_len += len;
+		}
+		state.count("packets", codec.count());
+		state.count("bytes", raw_len);
+		block_len = codec.finish();
+		state.count("block_bytes", block_len);
+	});
+	BatchCodec reader;
+	state.measure("compress/read_block", [&]{
+		reader.open(block, block_len);
+		const uint8_t* packet;
+		uint32_t raw_len = 0;
+		uint16_t len;
+		while ( (len = reader.next(packet)) > 0 ) raw_len += len;
+		state.count("bytes", raw_len);
+	});
+}
@@ -0,0 +1,152 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+/// @file		Bench.cpp
+/// @brief		Benchmark harness implementation and entry point for the
+///				native (host) build.
+/// @date		2020
+/// @copyright	GNU General Public License v3.0
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#include "Bench.h"
+
+#include <SdFat.h>
+#include <SimChannel.h>
+#include <SimNet.h>
+
+#include <filesystem>
+
+namespace Bench {
+
+///////////////////////////////////////////////////////////////////////////////
+struct Entry {
+	const char*	name;
+	Function	function;
+};
+
+/// Function-local static so registration order across files does not matter
+static std::vector<Entry>& registry()
+{
+	static std::vector<Entry> entries;
+	return entries;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool add(const char* name, Function function)
+{
+	registry().push_back({name, function});
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void reset_board()
+{
+	static const std::string sd_root =
+		(std::filesystem::temp_directory_path() / "loom_bench_sd").string();
+
+	std::error_code ec;
+	std::filesystem::remove_all(sd_root, ec);
+
+	LoomNative::Channel::reset();
+	LoomNative::Net::reset();
+	LoomNative::Clock::reset();
+	LoomNative::Pins::reset();
+	LoomNative::SdCard::set_root(sd_root.c_str());
+	LoomNative::SdCard::set_failed(false);
+	LoomNative::SdCard::reset_stats();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int run(const char* filter, const uint32_t iterations)
+{
+	printf("%-40s %10s %14s %14s\n", "benchmark", "iters", "host ns/op", "virtual us/op");
+
+	int count = 0;
+	for (const auto& entry : registry()) {
+		if (filter && !strstr(entry.name, filter)) continue;
+		reset_board();
+		State state(entry.name, iterations);
+		entry.function(state);
+		count++;
+	}
+	return count;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void State::measure(const char* label, const std::function<void()>& op)
+{
+	// Warm up caches and any lazy initialization
+	op();
+	counters.clear();
+
+	const uint32_t sd_start			= LoomNative::SdCard::write_count();
+	const uint32_t sync_start		= LoomNative::SdCard::sync_count();
+	const uint64_t virtual_start	= LoomNative::Clock::now_us();
+	const uint64_t host_start		= LoomNative::Clock::host_ns();
+	for (uint32_t i = 0; i < iterations; i++) {
+		op();
+	}
+	const uint64_t host_end			= LoomNative::Clock::host_ns();
+	const uint64_t virtual_end		= LoomNative::Clock::now_us();
+
+	if (LoomNative::SdCard::write_count() != sd_start) {
+		count("sd_writes", LoomNative::SdCard::write_count() - sd_start);
+	}
+	if (LoomNative::SdCard::sync_count() != sync_start) {
+		count("sd_syncs", LoomNative::SdCard::sync_count() - sync_start);
+	}
+
+	print_row(label,
+		(double)(host_end - host_start) / iterations,
+		(double)(virtual_end - virtual_start) / iterations);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void State::count(const char* name, const double amount)
+{
+	for (auto& c : counters) {
+		if (strcmp(c.name, name) == 0) {
+			c.total += amount;
+			return;
+		}
+	}
+	counters.push_back({name, amount});
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void State::note(const char* text)
+{
+	printf("  # %s\n", text);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void State::print_row(const char* label, const double host_ns, const double virtual_us)
+{
+	char name[64];
+	snprintf(name, sizeof(name), "%s/%s", bench_name, label);
+	printf("%-40s %10u %14.1f %14.1f", name, iterations, host_ns, virtual_us);
+	for (const auto& c : counters) {
+		printf("  %s=%.2f", c.name, c.total / iterations);
+		if (strcmp(c.name, "bytes") == 0 && host_ns > 0) {
+			printf("  MB/s=%.1f", c.total / iterations / host_ns * 1e3);
+		}
+	}
+	printf("\n");
+	counters.clear();
+}
+
+} // namespace Bench
+
+///////////////////////////////////////////////////////////////////////////////
+/// Usage: program [filter] [iterations]
+int main(int argc, char** argv)
+{
+	const char* filter			= (argc > 1 && strcmp(argv[1], "all") != 0) ? argv[1] : nullptr;
+	const uint32_t iterations	= (argc > 2) ? strtoul(argv[2], nullptr, 10) : 1000;
+
+	// Keep Loom's own prints out of the results
+	LoomNative::SerialPort::set_echo(false);
+
+	const int count = Bench::run(filter, iterations ? iterations : 1);
+	return (count > 0) ? 0 : 1;
+}
@@ -0,0 +1,96 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+/// @file		Bench.h
+/// @brief		Minimal benchmark harness for the native (host) build.
+/// @details	Benchmarks register themselves with BENCH(name) and are run by
+///				the `native` environment's main(). Each benchmark reports host
+///				CPU time per operation (the part that tracks the Feather's
+///				cost) and virtual time per operation (delay() / timeouts that
+///				the code under test would spend on the device).
+/// @date		2020
+/// @copyright	GNU General Public License v3.0
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <Arduino.h>
+
+#include <vector>
+#include <functional>
+
+namespace Bench {
+
+///////////////////////////////////////////////////////////////////////////////
+///
+/// Passed to every benchmark. Times operations and collects result rows.
+///
+///////////////////////////////////////////////////////////////////////////////
+class State
+{
+
+public:
+
+	State(const char* bench_name, const uint32_t iterations)
+		: bench_name(bench_name), iterations(iterations) {}
+
+	/// Number of times measure() runs each operation
+	uint32_t	get_iterations() const { return iterations; }
+
+	/// Time an operation and print a result row.
+	/// @param[in]	label	Name of the operation, printed after the benchmark name
+	/// @param[in]	op		Operation to run get_iterations() times
+	void		measure(const char* label, const std::function<void()>& op);
+
+	/// Add to a named counter from inside a measured operation,
+	/// e.g. bytes sent. Reported per operation on the measure() row,
+	/// a counter named "bytes" is also reported as host MB/s.
+	/// SD card writes and opens / syncs are counted automatically.
+	/// @param[in]	name	Counter name, must outlive the measure() call
+	/// @param[in]	amount	Amount to add
+	void		count(const char* name, const double amount = 1);
+
+	/// Print a free-form note under the benchmark
+	void		note(const char* text);
+
+private:
+
+	struct Counter {
+		const char*	name;
+		double		total;
+	};
+
+	const char*				bench_name;
+	const uint32_t			iterations;
+	std::vector<Counter>	counters;
+
+	void		print_row(const char* label, const double host_ns, const double virtual_us);
+
+};
+
+using Function = void (*)(State& state);
+
+/// Register a benchmark, used by BENCH()
+bool		add(const char* name, Function function);
+
+/// Run all registered benchmarks whose name contains filter
+/// @param[in]	filter		Substring to match, nullptr for all
+/// @param[in]	iterations	Iterations per measured operation
+/// @return Number of benchmarks run
+int			run(const char* filter, const uint32_t iterations);
+
+/// Reset the simulated board (clock, pins, SD card, radio channel and network) before each benchmark
+void		reset_board();
+
+} // namespace Bench
+
+///////////////////////////////////////////////////////////////////////////////
+/// Define and register a benchmark:
+///
+///		BENCH(cycle) {
+///			state.measure("measure", [&]{ feather.measure(); });
+///		}
+#define BENCH(Name) \
+	static void Name##_bench(Bench::State& state); \
+	static const bool Name##_bench_entry = Bench::add(#Name, Name##_bench); \
+	static void Name##_bench(Bench::State& state)
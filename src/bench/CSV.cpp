@@ -0,0 +1,209 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+/// @file		CSV.cpp
+/// @brief		CSV row emission: one print() per value versus CSVRow.
+/// @date		2020
+/// @copyright	GNU General Public License v3.0
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#include "Bench.h"
+
+#include <LogPlats/CSVRow.h>
+#include <SdFat.h>
+
+#include <math.h>
+#include <string.h>
+#include <string>
+
+using namespace Loom;
+
+// Packaged data of a typical float heavy device
+static const char* csv_data = "{\
+	'type':'data',\
+	'id':{'name':'Device','instance':1},\
+	'timestamp':{'date':'2020/6/12','time':'13:47:5'},\
+	'contents':[\
+		{'module':'Packet','data':{'Number':1542}},\
+		{'module':'Analog','data':{'Vbat':4.213,'A0':0.5,'A1':1.27,'A2':3.299,'A3':-0.018,'A4':2048.777,'A5':0.0049}},\
+		{'module':'SHT31D','data':{'temp':23.61,'humid':48.95}},\
+		{'module':'Digital','data':{'D5':0,'D6':1,'D9':0,'D10':true}}\
+	]\
+}";
+
+/// Collects output to compare both paths
+class Capture : public Print
+{
+public:
+	std::string text;
+	size_t write(uint8_t b) override { text += (char)b; return 1; }
+	size_t write(const uint8_t* buf, size_t size) override { text.append((const char*)buf, size); return size; }
+	using Print::write;
+};
+
+/// The Arduino core's Print::printFloat(), as a reference for CSVRow::format_float()
+static std::string arduino_print_float(double number, uint8_t digits)
+{
+	if (isnan(number)) return "nan";
+	if (isinf(number)) return "inf";
+	if (number > 4294967040.0) return "ovf";
+	if (number < -4294967040.0) return "ovf";
+
+	std::string out;
+	if (number < 0.0) {
+		out += '-';
+		number = -number;
+	}
+
+	double rounding = 0.5;
+	for (uint8_t i = 0; i < digits; ++i) rounding /= 10.0;
+	number += rounding;
+
+	const uint32_t int_part = (uint32_t)number;
+	double remainder = number - (double)int_part;
+	out += std::to_string(int_part);
+	if (digits > 0) out += '.';
+
+	while (digits-- > 0) {
+		remainder *= 10.0;
+		const unsigned int to_print = (unsigned int)remainder;
+		out += std::to_string(to_print);
+		remainder -= to_print;
+	}
+	return out;
+}
+
+/// Count the floats that CSVRow::format_float() formats differently from
+/// the Arduino core, over every precision: random bit patterns, and values
+/// a few float steps either side of ties at the last digit
+static uint32_t format_float_mismatches(uint32_t& checked)
+{
+	uint32_t mismatches = 0;
+	char buf[24];
+	auto check = [&](const float val, const uint8_t precision) {
+		const uint8_t len = CSVRow::format_float(buf, val, precision);
+		if (arduino_print_float(val, precision) != std::string(buf, len)) mismatches++;
+		checked++;
+	};
+
+	uint32_t bits = 12345;
+	for (auto i = 0; i < 100000; i++) {
+		bits = bits * 1664525UL + 1013904223UL;
+		float val;
+		memcpy(&val, &bits, sizeof(val));
+		check(val, i % (CSV_ROW_MAX_PRECISION + 1));
+	}
+
+	for (uint8_t precision = 0; precision <= CSV_ROW_MAX_PRECISION; precision++) {
+		const double step = pow(10.0, -(double)precision);
+		for (auto i = 0; i < 20000; i++) {
+			float val = (float)( (i * 7919 % 1000000) * step * 0.01 + step / 2 );
+			for (auto k = 0; k < 3; k++) val = nextafterf(val, 0.0f);
+			for (auto k = 0; k < 7; k++, val = nextafterf(val, INFINITY)) check(val, precision);
+		}
+	}
+	return mismatches;
+}
+
+/// SD's previous data row writer, one print() per value and delimiter
+static void print_row(Print& out, JsonObject json)
+{
+	for (JsonPair dataPoint : json["id"].as<JsonObject>()) {
+		JsonVariant val = dataPoint.value();
+		if (val.is<int>()) {
+			out.print(val.as<int>());
+		} else if (val.is<const char*>()) {
+			out.print(val.as<const char*>());
+		}
+		out.print(',');
+	}
+	for (JsonPair dataPoint : json["timestamp"].as<JsonObject>()) {
+		JsonVariant val = dataPoint.value();
+		if (val.is<const char*>()) {
+			out.print(val.as<const char*>());
+		}
+		out.print(',');
+	}
+	for (JsonObject module : json["contents"].as<JsonArray>()) {
+		for (JsonPair dataPoint : module["data"].as<JsonObject>()) {
+			JsonVariant val = dataPoint.value();
+			if (val.is<int>()) {
+				out.print(val.as<int>());
+			} else if (val.is<bool>()) {
+				out.print(val.as<bool>());
+			} else if (val.is<float>()) {
+				out.print(val.as<float>());
+			} else if (val.is<const char*>()) {
+				out.print(val.as<const char*>());
+			}
+			out.print(",");
+		}
+	}
+	out.println();
+}
+
+/// SD::_write_json_data()'s writer
+static void csv_row(Print& out, JsonObject json)
+{
+	CSVRow row(out, 2);
+	for (JsonPair dataPoint : json["id"].as<JsonObject>()) {
+		row.add_json(dataPoint.value());
+	}
+	for (JsonPair dataPoint : json["timestamp"].as<JsonObject>()) {
+		row.add_json(dataPoint.value());
+	}
+	for (JsonObject module : json["contents"].as<JsonArray>()) {
+		for (JsonPair dataPoint : module["data"].as<JsonObject>()) {
+			row.add_json(dataPoint.value());
+		}
+	}
+	row.end();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+BENCH(csv_row)
+{
+	StaticJsonDocument<1024> doc;
+	deserializeJson(doc, csv_data);
+	JsonObject json = doc.as<JsonObject>();
+
+	Capture before, after;
+	print_row(before, json);
+	csv_row(after, json);
+	state.note( (before.text == after.text) ? "rows identical" : "rows differ" );
+
+	SdFat sd;
+	sd.begin(11);
+	File file;
+
+	file.open("print.csv", O_WRITE | O_CREAT);
+	state.measure("print_per_value", [&]{
+		const uint32_t start = file.curPosition();
+		print_row(file, json);
+		state.count("bytes", file.curPosition() - start);
+	});
+	file.close();
+
+	file.open("row.csv", O_WRITE | O_CREAT);
+	state.measure("csv_row", [&]{
+		const uint32_t start = file.curPosition();
+		csv_row(file, json);
+		state.count("bytes", file.curPosition() - start);
+	});
+	file.close();
+
+	// Same digits as the Arduino core's algorithm, not only on this row
+	uint32_t checked = 0;
+	const uint32_t mismatches = format_float_mismatches(checked);
+	const std::string note = "format_float differs from Arduino's printFloat on "
+		+ std::to_string(mismatches) + " of " + std::to_string(checked) + " values";
+	state.note(note.c_str());
+
+	// Formatting alone, without the file
+	char buf[24];
+	float val = 0;
+	state.measure("format_float", [&]{
+		CSVRow::format_float(buf, val, 2);
+		val += 1.37f;
+	});
+}
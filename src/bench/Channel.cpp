@@ -0,0 +1,398 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+/// @file		Channel.cpp
+/// @brief		Radio protocol throughput over the simulated channel: nodes
+///				sending to a hub, with loss and collisions.
+/// @date		2020
+/// @copyright	GNU General Public License v3.0
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#include "Bench.h"
+
+#include <Manager.h>
+#include <CommPlats/SimRadio.h>
+#include <CommPlats/LoRa.h>
+#include <LogPlats/BatchSD.h>
+
+#include <memory>
+
+using namespace Loom;
+using namespace LoomNative;
+
+/// Virtual time each topology runs for
+static const uint32_t run_ms = 60000;
+
+/// A hub and the nodes sending to it
+struct Topology {
+	uint8_t		nodes		= 1;		///< Nodes sending to the hub
+	uint8_t		modules		= 2;		///< Modules of five readings in each message
+	uint32_t	period		= 2000;		///< Milliseconds between a node's messages
+	float		loss		= 0.0f;		///< Loss of every frame
+	bool		fragment	= true;		///< Fragment long messages, else split them by module
+	bool		queue		= false;	///< Hub receives with the receive queue
+	uint8_t		aggregate	= 0;		///< Samples nodes pack into each packet, 0 to send each at once
+	bool		repeater	= false;	///< Nodes are out of the hub's range, and reach it through a repeater
+	uint16_t	slot_ms		= 0;		///< Length of each node's time slot, 0 to send unslotted
+};
+
+/// Fill a packaged json with a node's readings
+static void package(JsonObject json, const uint8_t instance, const uint8_t modules)
+{
+	json["type"] = "data";
+	json["id"]["name"] = "Node";
+	json["id"]["instance"] = instance;
+	JsonArray contents = json.createNestedArray("contents");
+	for (auto m = 0; m < modules; m++) {
+		JsonObject component = contents.createNestedObject();
+		component["module"] = String("Sensor") + m;
+		JsonObject data = component.createNestedObject("data");
+		for (auto k = 0; k < 5; k++) data[String("value") + k] = m * 1.5f + k;
+	}
+}
+
+/// Run a topology, counting per run:
+/// - sent: messages the nodes' sends reported delivered (or buffered, with aggregation)
+/// - samples_lost: samples the nodes failed to send, given up after their
+///   packet's attempts with aggregation
+/// - samples_buffered: samples the nodes hold at the end, with aggregation
+/// - delivered: messages (samples) the hub received whole
+/// - partial: messages the hub received without all their modules
+/// - goodput_Bps: bytes of messages received whole per virtual second
+/// - retransmits: acknowledged messages sent again
+/// - frames, collided, lost: frames on the air and lost there
+/// - forwarded: frames the repeater forwarded
+/// - beacons: slot beacons the hub sent
+/// @return Samples lost in the last run
+static uint32_t run_topology(Bench::State& state, const char* label, const Topology& t)
+{
+	uint32_t lost = 0;
+	state.measure(label, [&]{
+		Channel::reset();
+		Channel::Model model;
+		model.loss = t.loss;
+		Channel::configure(model);
+
+		// Node offsets and backoffs don't depend on the topologies run before
+		randomSeed(1);
+
+		Manager hub{"Hub", 1, Manager::DeviceType::HUB, Verbosity::V_OFF, Verbosity::V_OFF};
+		auto hub_radio = new SimRadio(251, 1, 3, 200, t.fragment);
+		hub.add_module(hub_radio);
+		hub_radio->set_slots(t.slot_ms, t.nodes + 1);
+
+		uint32_t delivered = 0;
+		uint32_t partial = 0;
+		const auto received = [&]{
+			if (hub.internal_json()["contents"].size() == t.modules) {
+				delivered++;
+			} else {
+				partial++;
+			}
+		};
+		Channel::add_node([&]{
+			if (t.queue) {
+				hub_radio->queue_receive(1000);
+				while (hub_radio->receive_queued()) received();
+			} else if (hub_radio->receive_blocking(1000)) {
+				received();
+			}
+		});
+
+		// Forwards between the hub and nodes it can't hear
+		std::unique_ptr<Manager> repeater;
+		SimRadio* repeater_radio = nullptr;
+		if (t.repeater) {
+			repeater.reset(new Manager{"Repeater", 1, Manager::DeviceType::REPEATER, Verbosity::V_OFF, Verbosity::V_OFF});
+			repeater_radio = new SimRadio(251, 5, 3, 200, t.fragment);
+			repeater->add_module(repeater_radio);
+			Channel::add_node([&]{ repeater_radio->forward(1000); });
+		}
+
+		std::vector<std::unique_ptr<Manager>> nodes;
+		std::vector<std::unique_ptr<DynamicJsonDocument>> docs;
+		std::vector<SimRadio*> radios;
+		uint32_t sent = 0;
+		uint32_t failed = 0;
+		uint32_t retransmits = 0;
+		size_t size = 0;
+		for (auto i = 0; i < t.nodes; i++) {
+			nodes.emplace_back(new Manager{"Node", (uint8_t)(i + 1), Manager::DeviceType::NODE, Verbosity::V_OFF, Verbosity::V_OFF});
+			auto radio = new SimRadio(251, 10 + i, 3, 200, t.fragment);
+			nodes.back()->add_module(radio);
+			radios.push_back(radio);
+			radio->set_aggregation(t.aggregate);
+			radio->set_slots(t.slot_ms, t.nodes + 1);
+			if (t.repeater) {
+				Channel::set_loss(10 + i, 1, 1.0f);
+				Channel::set_loss(1, 10 + i, 1.0f);
+				radio->add_route(1, 5);
+			}
+
+			docs.emplace_back(new DynamicJsonDocument(4096));
+			JsonObject json = docs.back()->to<JsonObject>();
+			package(json, i + 1, t.modules);
+			size = measureMsgPack(json);
+
+			// Nodes start at different times within a period, as unsynchronized clocks would
+			const uint32_t offset = random(t.period);
+			Channel::add_node([&, radio, json, offset, started = false]() mutable {
+				if (!started) {
+					started = true;
+					delay(offset);
+				}
+				const unsigned long start = millis();
+				const uint32_t before = radio->get_retransmits();
+				if (radio->send(json, 1)) {
+					sent++;
+				} else {
+					failed++;
+				}
+				retransmits += radio->get_retransmits() - before;
+				const unsigned long elapsed = millis() - start;
+				if (elapsed < t.period) delay(t.period - elapsed);
+			});
+		}
+
+		Channel::run(run_ms);
+
+		// Without aggregation, a sample is lost with its send
+		lost = (t.aggregate > 1) ? 0 : failed;
+		uint32_t buffered = 0;
+		for (auto radio : radios) {
+			lost += radio->get_lost_samples();
+			buffered += radio->get_buffered_samples();
+		}
+
+		const Channel::Stats& air = Channel::stats();
+		state.count("sent", sent);
+		state.count("samples_lost", lost);
+		state.count("samples_buffered", buffered);
+		state.count("delivered", delivered);
+		state.count("partial", partial);
+		state.count("goodput_Bps", delivered * size * 1000.0 / run_ms);
+		state.count("retransmits", retransmits);
+		state.count("frames", air.frames);
+		state.count("collided", air.collided);
+		state.count("lost", air.lost);
+		state.count("forwarded", repeater_radio ? repeater_radio->get_forwarded() : 0);
+		state.count("beacons", hub_radio->get_beacons());
+
+		// Devices hold references into this run
+		Channel::reset();
+	});
+	return lost;
+}
+
+/// Node with a batch of packets to send after an outage
+static const char* backlog_config = "{\
+	'general':{'name':'Node','instance':1,'print_verbosity':0},\
+	'components':[\
+		{'name':'Analog','params':'default'},\
+		{'name':'BatchSD','params':[false,0,11]}\
+	]\
+}";
+
+/// Drain a backlog of packets with send_batch(), counting per run:
+/// - delivered: packets the hub received
+/// - drain_ms: virtual time send_batch() took
+/// - frames, air_bytes, airtime_ms: what went on the air
+static void run_backlog(Bench::State& state, const char* label, const int packets, const bool compress, const float loss)
+{
+	state.measure(label, [&]{
+		Channel::reset();
+		Channel::Model model;
+		model.loss = loss;
+		Channel::configure(model);
+
+		Manager hub{"Hub", 1, Manager::DeviceType::HUB, Verbosity::V_OFF, Verbosity::V_OFF};
+		auto hub_radio = new SimRadio(251, 1, 3, 200, true);
+		hub.add_module(hub_radio);
+		uint32_t delivered = 0;
+		Channel::add_node([&]{
+			if (hub_radio->receive_blocking(1000)) delivered++;
+		});
+
+		Manager node{};
+		node.parse_config(backlog_config);
+		auto radio = new SimRadio(251, 10, 3, 200, true);
+		node.add_module(radio);
+		radio->set_batch_compression(compress);
+
+		// Readings that change from packet to packet
+		BatchSD& batch = *node.get<BatchSD>();
+		batch.clear_batch_log();
+		for (auto i = 0; i < packets; i++) {
+			Pins::set_analog(A0, 500 + (i * 37) % 300);
+			node.measure();
+			node.package();
+			batch.store_batch_json(node.internal_json());
+		}
+
+		unsigned long drain_ms = 0;
+		bool drained = false;
+		Channel::add_node([&]{
+			if (drained) {
+				delay(60000);
+				return;
+			}
+			const unsigned long start = millis();
+			radio->send_batch(1, 0);
+			drain_ms = millis() - start;
+			drained = true;
+		});
+		Channel::run(run_ms * 5);
+
+		const Channel::Stats& air = Channel::stats();
+		state.count("delivered", delivered);
+		state.count("drain_ms", drain_ms);
+		state.count("frames", air.frames);
+		state.count("air_bytes", air.bytes);
+		state.count("airtime_ms", air.airtime_us / 1000.0);
+
+		Channel::reset();
+	});
+}
+
+/// Nodes of a LoRa hub, each at a path loss from it
+struct LoRaLinks {
+	int16_t		path_loss[2]	= { 100, 0 };	///< dB between each node and the hub, both ways
+	uint8_t		nodes			= 1;			///< Nodes sending to the hub
+	bool		adaptive		= true;			///< Nodes adapt data rate and power
+};
+
+/// Run LoRa nodes sending a packet every 30 s to a hub for two hours,
+/// counting per run:
+/// - sent, failed: the nodes' sends that were and weren't acknowledged
+/// - delivered: packets the hub received
+/// - data_rate, power: the nodes' data rate (0 slowest) and power (dBm) at the end, averaged
+/// - hub_rate: the hub's data rate at the end
+/// - airtime_ms: time the channel was transmitted on
+/// - weak: frames that arrived below the sensitivity of their receiver
+static void run_lora(Bench::State& state, const char* label, const LoRaLinks& l)
+{
+	state.measure(label, [&]{
+		Channel::reset();
+		randomSeed(1);
+
+		Manager hub{"Hub", 1, Manager::DeviceType::HUB, Verbosity::V_OFF, Verbosity::V_OFF};
+		auto hub_radio = new LoRa(251, 1, 23, 3, 1000);
+		hub.add_module(hub_radio);
+		hub_radio->set_adaptive(l.adaptive);
+		uint32_t delivered = 0;
+		Channel::add_node([&]{
+			if (hub_radio->receive_blocking(1000)) delivered++;
+		});
+
+		std::vector<std::unique_ptr<Manager>> nodes;
+		std::vector<std::unique_ptr<DynamicJsonDocument>> docs;
+		std::vector<LoRa*> radios;
+		uint32_t sent = 0;
+		uint32_t failed = 0;
+		for (auto i = 0; i < l.nodes; i++) {
+			nodes.emplace_back(new Manager{"Node", (uint8_t)(i + 1), Manager::DeviceType::NODE, Verbosity::V_OFF, Verbosity::V_OFF});
+			auto radio = new LoRa(251, 10 + i, 23, 3, 1000);
+			nodes.back()->add_module(radio);
+			radios.push_back(radio);
+			radio->set_adaptive(l.adaptive);
+			Channel::set_path_loss(10 + i, 1, l.path_loss[i]);
+			Channel::set_path_loss(1, 10 + i, l.path_loss[i]);
+
+			docs.emplace_back(new DynamicJsonDocument(1024));
+			JsonObject json = docs.back()->to<JsonObject>();
+			package(json, i + 1, 1);
+
+			const uint32_t period = 30000;
+			const uint32_t offset = random(period);
+			Channel::add_node([&, radio, json, period, offset, started = false]() mutable {
+				if (!started) {
+					started = true;
+					delay(offset);
+				}
+				const unsigned long start = millis();
+				if (radio->send(json, 1)) {
+					sent++;
+				} else {
+					failed++;
+				}
+				const unsigned long elapsed = millis() - start;
+				if (elapsed < period) delay(period - elapsed);
+			});
+		}
+
+		Channel::run(2 * 3600000);
+
+		double data_rate = 0;
+		double power = 0;
+		for (auto radio : radios) {
+			data_rate += radio->get_data_rate();
+			power += radio->get_power_level();
+		}
+
+		const Channel::Stats& air = Channel::stats();
+		state.count("sent", sent);
+		state.count("failed", failed);
+		state.count("delivered", delivered);
+		state.count("data_rate", data_rate / l.nodes);
+		state.count("power", power / l.nodes);
+		state.count("hub_rate", hub_radio->get_data_rate());
+		state.count("airtime_ms", air.airtime_us / 1000.0);
+		state.count("weak", air.weak);
+
+		Channel::reset();
+	});
+}
+
+///////////////////////////////////////////////////////////////////////////////
+BENCH(channel)
+{
+	// Single frame messages (2 modules, about 210 bytes) from one node
+	run_topology(state, "frame_loss0",		{ });
+	run_topology(state, "frame_loss10",		{ .loss = 0.1f });
+	run_topology(state, "frame_loss30",		{ .loss = 0.3f });
+
+	// Messages of 5 modules (about 450 bytes), fragmented or split by module
+	run_topology(state, "fragment_loss0",	{ .modules = 5, .period = 4000 });
+	run_topology(state, "fragment_loss10",	{ .modules = 5, .period = 4000, .loss = 0.1f });
+	run_topology(state, "split_loss0",		{ .modules = 5, .period = 4000, .fragment = false });
+	run_topology(state, "split_loss10",		{ .modules = 5, .period = 4000, .loss = 0.1f, .fragment = false });
+
+	// Nodes contending for the channel
+	run_topology(state, "4_nodes",			{ .nodes = 4, .period = 10000 });
+	const uint32_t lost_alone = run_topology(state, "8_nodes",	{ .nodes = 8, .period = 10000 });
+	run_topology(state, "8_nodes_queue",	{ .nodes = 8, .period = 10000, .queue = true });
+	run_topology(state, "4_nodes_fragment",	{ .nodes = 4, .modules = 5, .period = 10000, .queue = true });
+
+	// Samples packed five to a packet
+	run_topology(state, "aggregate5",			{ .aggregate = 5 });
+	run_topology(state, "aggregate5_loss10",	{ .loss = 0.1f, .aggregate = 5 });
+	const uint32_t lost_aggregated = run_topology(state, "8_nodes_aggregate5",
+		{ .nodes = 8, .period = 10000, .queue = true, .aggregate = 5 });
+	if (lost_aggregated > lost_alone) state.note("8_nodes_aggregate5 lost more samples than 8_nodes");
+
+	// Nodes out of the hub's range, through a repeater
+	run_topology(state, "repeater",				{ .period = 4000, .repeater = true });
+	run_topology(state, "repeater_loss10",		{ .period = 4000, .loss = 0.1f, .repeater = true });
+	run_topology(state, "repeater_fragment",	{ .modules = 5, .period = 6000, .repeater = true });
+	run_topology(state, "4_nodes_repeater",		{ .nodes = 4, .period = 10000, .queue = true, .repeater = true });
+
+	// 50 nodes each sending once per frame of 51 slots, unslotted or in their slot
+	run_topology(state, "50_nodes",				{ .nodes = 50, .modules = 1, .period = 15300, .queue = true });
+	run_topology(state, "50_nodes_slots",		{ .nodes = 50, .modules = 1, .period = 15300, .queue = true, .slot_ms = 300 });
+
+	// LoRa nodes adapting data rate and power to their link (ADR): near the
+	// hub, at the fastest rate and least power; in between, at the fastest
+	// rate and the power that keeps the margin; far, at a slower rate and
+	// full power. A hub with two nodes keeps both at the default rate
+	run_lora(state, "lora_fixed_near",		{ .adaptive = false });
+	run_lora(state, "lora_adr_near",		{ });
+	run_lora(state, "lora_adr_mid",			{ .path_loss = { 130, 0 } });
+	run_lora(state, "lora_adr_far",			{ .path_loss = { 140, 0 } });
+	run_lora(state, "lora_adr_near_and_far",	{ .path_loss = { 100, 140 }, .nodes = 2 });
+
+	// Backlog of 200 packets, one by one or in compressed blocks
+	run_backlog(state, "backlog",					200, false, 0.0f);
+	run_backlog(state, "backlog_compressed",		200, true, 0.0f);
+	run_backlog(state, "backlog_loss10",			200, false, 0.1f);
+	run_backlog(state, "backlog_compressed_loss10",	200, true, 0.1f);
+}
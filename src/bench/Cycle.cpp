@@ -0,0 +1,75 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+/// @file		Cycle.cpp
+/// @brief		Per-cycle cost of a typical logging node:
+///				Manager::measure(), Manager::package() and SD::save_json().
+/// @date		2020
+/// @copyright	GNU General Public License v3.0
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#include "Bench.h"
+
+// Only one translation unit may include Loom.h (it defines the getX() helpers)
+#include <Loom.h>
+
+using namespace Loom;
+
+// Same components as the Hypnos example in src/config.h
+static const char* cycle_config = "{\
+	'general':{'name':'Device','instance':1,'interval':5000,'print_verbosity':0},\
+	'components':[\
+		{'name':'Analog','params':'default'},\
+		{'name':'SD','params':'default'},\
+		{'name':'DS3231','params':'default'}\
+	]\
+}";
+
+///////////////////////////////////////////////////////////////////////////////
+BENCH(cycle)
+{
+	LoomNative::Pins::set_analog(A0, 1024);
+	LoomNative::Pins::set_analog(A1, 2048);
+	LoomNative::Pins::set_analog(A2, 3072);
+
+	Manager feather{};
+	feather.parse_config(cycle_config);
+	SD& sd = getSD(feather);
+
+	state.measure("measure", [&]{ feather.measure(); });
+	state.measure("package", [&]{ feather.package(); });
+
+	JsonObject data = feather.internal_json(false);
+	state.measure("save_json", [&]{ sd.log(data); });
+
+	state.measure("full", [&]{
+		feather.measure();
+		feather.package();
+		sd.log();
+	});
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// Same cycle with "compiled_record":true, packaging into a flat record.
+/// package() still returns json so is measured both with and without the
+/// json being requested
+BENCH(cycle_record)
+{
+	LoomNative::Pins::set_analog(A0, 1024);
+	LoomNative::Pins::set_analog(A1, 2048);
+	LoomNative::Pins::set_analog(A2, 3072);
+
+	Manager feather{};
+	feather.parse_config(cycle_config);
+	feather.set_compiled_record(true);
+	SD& sd = getSD(feather);
+
+	state.measure("package_record", [&]{ feather.package_record(); });
+	state.measure("package", [&]{ feather.package(); });
+
+	state.measure("full", [&]{
+		feather.measure();
+		feather.package_record();
+		sd.log();
+	});
+}
@@ -0,0 +1,364 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+/// @file		Http.cpp
+/// @brief		Publishing over Ethernet to simulated servers: connection
+///				reuse, chunked bodies, poll(), batches and servers that don't
+///				answer.
+/// @date		2020
+/// @copyright	GNU General Public License v3.0
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#include "Bench.h"
+
+#include <Manager.h>
+#include <InternetPlats/InternetEthernet.h>
+#include <PublishPlats/GoogleSheets.h>
+#include <PublishPlats/HttpPublish.h>
+#include <LogPlats/BatchSD.h>
+#include <SdFat.h>
+#include <SimNet.h>
+
+#include <algorithm>
+
+using namespace Loom;
+using namespace LoomNative;
+
+/// Packets each scenario publishes
+static const int packets = 10;
+
+/// Milliseconds between the scheduler's calls to poll()
+static const uint32_t poll_ms = 10;
+
+static const char* http_config = "{\
+	'general':{'name':'Node','instance':1,'print_verbosity':0},\
+	'components':[\
+		{'name':'Ethernet','params':'default'},\
+		{'name':'GoogleSheets','params':['Sheets','/macros/s/SCRIPT/exec','SHEET',true]},\
+		{'name':'HttpPublish','params':['HTTP','api.example.com','/data']}\
+	]\
+}";
+
+/// Same, with an SD card to keep the outbox on
+static const char* journal_config = "{\
+	'general':{'name':'Node','instance':1,'print_verbosity':0},\
+	'components':[\
+		{'name':'SD','params':'default'},\
+		{'name':'Ethernet','params':'default'},\
+		{'name':'HttpPublish','params':['HTTP','api.example.com','/data']}\
+	]\
+}";
+
+/// Node with a batch on its SD card, published to Google Sheets
+static const char* batch_config = "{\
+	'general':{'name':'Node','instance':1,'print_verbosity':0},\
+	'components':[\
+		{'name':'Ethernet','params':'default'},\
+		{'name':'GoogleSheets','params':['Sheets','/macros/s/SCRIPT/exec','SHEET',true]},\
+		{'name':'BatchSD','params':[false,0,11]}\
+	]\
+}";
+
+/// How a scenario publishes, and what the servers do
+struct Scenario {
+	bool		sheets		= true;		///< Publish to Google Sheets, else POST with HttpPublish
+	uint8_t		modules		= 2;		///< Modules of five readings in each packet
+	uint32_t	period		= 10000;	///< Milliseconds between packets
+	bool		async		= false;	///< Publish with publish_async() and poll(), else publish()
+	uint32_t	idle_ms		= 60000;	///< Servers drop connections idle this long
+	bool		silent		= false;	///< Servers drop idle connections without closing them
+	bool		answer		= true;		///< Servers answer requests, else close without answering
+	bool		journal		= false;	///< Node has an SD card, for the journal
+	bool		card_failed	= false;	///< The card fails after startup
+	uint8_t		failures	= 0;		///< Requests the servers answer with 503 before taking packets
+};
+
+/// What the servers received
+struct Received {
+	uint32_t	packets		= 0;	///< Packets received and checked
+	uint32_t	chunks		= 0;	///< Chunks of the bodies
+	uint32_t	malformed	= 0;	///< Requests that failed the check
+};
+
+/// Packets poll() reported published or dropped
+static uint32_t polled_published = 0;
+static uint32_t polled_dropped = 0;
+
+/// Fill a packaged json with a node's readings
+static void package(JsonObject json, const uint8_t modules, const int packet)
+{
+	json["type"] = "data";
+	json["id"]["name"] = "Node";
+	json["id"]["instance"] = 1;
+	JsonArray contents = json.createNestedArray("contents");
+	for (auto m = 0; m < modules; m++) {
+		JsonObject component = contents.createNestedObject();
+		component["module"] = String("Sensor") + m;
+		JsonObject data = component.createNestedObject("data");
+		for (auto k = 0; k < 5; k++) data[String("value") + k] = m * 1.5f + k + packet;
+	}
+}
+
+/// Rows of a batch the script took
+struct Rows {
+	uint32_t	posts		= 0;	///< Requests taken
+	uint32_t	rows		= 0;	///< Rows in their bodies
+	uint32_t	malformed	= 0;	///< Requests that failed the check
+};
+
+/// Serve Google's script: a GET with the packet in its query, answered with a redirect
+static void serve_sheets(Received& received)
+{
+	Net::serve("script.google.com", [&received](const Net::Request& request) {
+		Net::Response response;
+		if ( (request.method != "GET") || (request.path.rfind("/macros/s/SCRIPT/exec?", 0) != 0)
+				|| (request.path.find("&key3=full_data&val3=") == std::string::npos) ) {
+			received.malformed++;
+			response.status = 400;
+			return response;
+		}
+		received.packets++;
+		response.status = 302;
+		response.body = "<HTML><HEAD><TITLE>Moved Temporarily</TITLE></HEAD></HTML>";
+		response.chunked = true;
+		return response;
+	});
+}
+
+/// Serve Google's script as doPost() in Spreadsheet.gs reads a batch: a POST
+/// with the sheet in its query and a body of rows, one per line, each of
+/// key~value pairs. A Content-Length off by any amount cuts a row or leaves
+/// bytes that are read as another request
+static void serve_sheets_batch(Rows& received)
+{
+	Net::serve("script.google.com", [&received](const Net::Request& request) {
+		Net::Response response;
+		response.status = 400;
+		const std::string& body = request.body;
+		if ( (request.method != "POST") || (request.path.rfind("/macros/s/SCRIPT/exec?key0=sheetID&", 0) != 0)
+				|| (request.path.find("full_data") != std::string::npos) || request.chunked
+				|| (request.length != (long)body.size()) || body.empty() || (body.back() != '\n') ) {
+			received.malformed++;
+			return response;
+		}
+		uint32_t rows = 0;
+		for (size_t start = 0; start < body.size(); ) {
+			const size_t end = body.find('\n', start);
+			const std::string row = body.substr(start, end - start);
+			start = end + 1;
+			// keys and values alternate, as getDataDict() pairs them
+			if ( row.empty() || (std::count(row.begin(), row.end(), '~') % 2 == 0) ) {
+				received.malformed++;
+				return response;
+			}
+			rows++;
+		}
+		received.posts++;
+		received.rows += rows;
+		response.status = 302;
+		response.body = "<HTML><HEAD><TITLE>Moved Temporarily</TITLE></HEAD></HTML>";
+		response.chunked = true;
+		return response;
+	});
+}
+
+/// Serve an API taking packets as json, checking each is whole, after
+/// answering a number of requests with an error of its own
+static void serve_api(Received& received, const uint8_t modules, const uint8_t failures)
+{
+	Net::serve("api.example.com", [&received, modules, left = failures](const Net::Request& request) mutable {
+		Net::Response response;
+		if (left > 0) {
+			left--;
+			response.status = 503;
+			return response;
+		}
+		DynamicJsonDocument doc(16384);
+		if ( (request.method != "POST") || (request.path != "/data") || !request.chunked
+				|| deserializeJson(doc, request.body) || (doc["contents"].size() != modules) ) {
+			received.malformed++;
+			response.status = 400;
+			return response;
+		}
+		received.packets++;
+		received.chunks += request.chunks;
+		response.status = 201;
+		response.body = "{\"ok\":true}";
+		return response;
+	});
+}
+
+/// Serve a host that closes every connection without answering
+static void serve_silent(const char* host)
+{
+	Net::serve(host, [](const Net::Request&) {
+		Net::Response response;
+		response.status = 0;
+		response.close = true;
+		return response;
+	});
+}
+
+/// Publish packets, one per period, counting per run:
+/// - published: packets publish() or poll() reported published
+/// - dropped: packets poll() dropped
+/// - retained: packets left in the outbox
+/// - received: packets the server received whole, duplicates included
+/// - malformed: requests the server found bad
+/// - connects, handshakes, resumed: TCP connections and TLS handshakes
+/// - dropped_idle: kept-alive connections the server dropped
+/// - chunks: chunks of the request bodies, with HttpPublish
+/// - publish_ms: virtual time in publish() per packet
+/// - polls: poll() calls that had a step to take
+static void run_scenario(Bench::State& state, const char* label, const Scenario& s)
+{
+	state.measure(label, [&]{
+		Net::reset();
+		Net::Model model;
+		model.idle_timeout_ms = s.idle_ms;
+		model.idle_silent = s.silent;
+		Net::configure(model);
+		Received received;
+		if (s.answer) {
+			serve_sheets(received);
+			serve_api(received, s.modules, s.failures);
+		} else {
+			serve_silent("script.google.com");
+			serve_silent("api.example.com");
+		}
+
+		Manager node{};
+		node.parse_config(s.journal ? journal_config : http_config);
+		PublishPlat* publisher = s.sheets ? (PublishPlat*)node.get<GoogleSheets>() : (PublishPlat*)node.get<HttpPublish>();
+		// the card fails after startup, once the journal is open
+		SdCard::set_failed(s.card_failed);
+		polled_published = 0;
+		polled_dropped = 0;
+		publisher->set_publish_callbacks(
+			[](const JsonObject) { polled_published++; },
+			[](const JsonObject) { polled_dropped++; });
+
+		DynamicJsonDocument doc(16384);
+		uint32_t published = 0;
+		uint32_t polls = 0;
+		unsigned long publish_ms = 0;
+		for (auto i = 0; i < packets; i++) {
+			JsonObject json = doc.to<JsonObject>();
+			package(json, s.modules, i);
+			const unsigned long start = millis();
+			if (s.async) {
+				publisher->publish_async(json);
+			} else if (publisher->publish(json)) {
+				published++;
+			}
+			publish_ms += millis() - start;
+			// the scheduler polls until the next packet is due
+			while (millis() - start < s.period) {
+				if (!s.async) {
+					delay(s.period - (millis() - start));
+				} else {
+					if (publisher->poll()) polls++;
+					delay(poll_ms);
+				}
+			}
+		}
+
+		const Net::Stats& net = Net::stats();
+		state.count("published", published + polled_published);
+		state.count("dropped", polled_dropped);
+		state.count("retained", publisher->get_outbox_count());
+		state.count("received", received.packets);
+		state.count("malformed", received.malformed);
+		state.count("connects", net.connects);
+		state.count("handshakes", net.handshakes);
+		state.count("resumed", net.resumed);
+		state.count("dropped_idle", net.dropped_idle);
+		state.count("chunks", received.chunks);
+		state.count("publish_ms", s.async ? 0.0 : (double)publish_ms / packets);
+		state.count("polls", polls);
+
+		SdCard::set_failed(false);
+	});
+}
+
+/// Publish a batch of packets with publish_batch(), counting per run:
+/// - posts, rows: requests and rows the script took
+/// - dropped: packets publish_batch() reported dropped
+/// - malformed: requests the script found bad
+/// - connects: TCP connections
+/// - publish_ms: virtual time in publish_batch()
+static void run_batch(Bench::State& state, const char* label, const int count)
+{
+	state.measure(label, [&]{
+		Net::reset();
+		Net::configure(Net::Model{});
+		Rows received;
+		serve_sheets_batch(received);
+
+		Manager node{};
+		node.parse_config(batch_config);
+		BatchSD& batch = *node.get<BatchSD>();
+		batch.clear_batch_log();
+		DynamicJsonDocument doc(16384);
+		for (auto i = 0; i < count; i++) {
+			JsonObject json = doc.to<JsonObject>();
+			package(json, 2, i);
+			batch.store_batch_json(json);
+		}
+
+		const unsigned long start = millis();
+		const uint8_t dropped = node.get<GoogleSheets>()->publish_batch();
+		const unsigned long publish_ms = millis() - start;
+
+		state.count("posts", received.posts);
+		state.count("rows", received.rows);
+		state.count("dropped", dropped);
+		state.count("malformed", received.malformed);
+		state.count("connects", Net::stats().connects);
+		state.count("publish_ms", publish_ms);
+
+		const uint32_t posts = (count + SHEETS_BATCH_ROWS - 1) / SHEETS_BATCH_ROWS;
+		if ( (received.posts != posts) || (received.rows != (uint32_t)count) || (received.malformed > 0) ) {
+			state.note("the script did not take the batch whole, one POST per SHEETS_BATCH_ROWS rows");
+		}
+	});
+}
+
+///////////////////////////////////////////////////////////////////////////////
+BENCH(http)
+{
+	// A new connection for each packet, resuming the TLS session,
+	// against one kept alive between packets
+	run_scenario(state, "sheets_new_connection",	{ .idle_ms = 5000 });
+	run_scenario(state, "sheets_keep_alive",		{ });
+
+	// A packet of 40 modules, streamed as a chunked body
+	run_scenario(state, "post_chunked_40_modules",	{ .sheets = false, .modules = 40 });
+
+	// Published by poll() in steps, from the outbox in memory or the journal
+	run_scenario(state, "sheets_poll",				{ .async = true });
+	run_scenario(state, "post_poll_journal",		{ .sheets = false, .async = true, .journal = true });
+
+	// Connections the server dropped while idle without closing them,
+	// found out only when the request written over them goes unanswered
+	run_scenario(state, "sheets_stale",				{ .idle_ms = 5000, .silent = true });
+	run_scenario(state, "sheets_stale_poll",		{ .async = true, .idle_ms = 5000, .silent = true });
+
+	// Servers that close the connection without answering: nothing is published,
+	// packets publish_async() took are kept to be retried
+	run_scenario(state, "sheets_no_response",		{ .answer = false });
+	run_scenario(state, "post_no_response_poll",	{ .sheets = false, .async = true, .answer = false });
+
+	// A card that can't hold the journal: publish() sends without it, and
+	// publish_async() keeps the outbox in memory
+	run_scenario(state, "post_card_failed",			{ .sheets = false, .journal = true, .card_failed = true });
+	run_scenario(state, "post_card_failed_poll",	{ .sheets = false, .async = true, .journal = true, .card_failed = true });
+
+	// A server failing the first 5 requests, more than a wake cycle's retries,
+	// on a device that never sleeps: the journal still drains, once the backoff is waited out
+	run_scenario(state, "post_poll_journal_5_failures",
+		{ .sheets = false, .period = 60000, .async = true, .journal = true, .failures = 5 });
+
+	// A batch of 120 packets, published as rows of three POSTs on one connection
+	run_batch(state, "sheets_batch_120",			120);
+}
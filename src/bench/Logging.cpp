@@ -0,0 +1,75 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+/// @file		Logging.cpp
+/// @brief		Per-record cost of the SD logging platforms.
+/// @date		2020
+/// @copyright	GNU General Public License v3.0
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#include "Bench.h"
+
+#include <Manager.h>
+#include <Sensors/Analog.h>
+#include <LogPlats/SD.h>
+#include <LogPlats/BinarySD.h>
+
+using namespace Loom;
+
+// Analog plus each logger, without rate filters
+static const char* logging_config = "{\
+	'general':{'name':'Device','instance':1,'print_verbosity':0,'compiled_record':true},\
+	'components':[\
+		{'name':'Analog','params':'default'},\
+		{'name':'SD','params':[false,0,11,'log',true]},\
+		{'name':'SD','params':[false,0,11,'open',true,true,10,10000]},\
+		{'name':'BinarySD','params':[false,0,11,'bin',2048]}\
+	]\
+}";
+
+// Analog and BinarySD only, logged through Manager::log_all()
+static const char* log_all_config = "{\
+	'general':{'name':'Device','instance':1,'print_verbosity':0,'compiled_record':true},\
+	'components':[\
+		{'name':'Analog','params':'default'},\
+		{'name':'BinarySD','params':[false,0,11,'all',2048]}\
+	]\
+}";
+
+///////////////////////////////////////////////////////////////////////////////
+BENCH(logging)
+{
+	LoomNative::Pins::set_analog(A0, 1024);
+
+	Manager feather{};
+	feather.parse_config(logging_config);
+	feather.measure();
+	feather.package_record();
+
+	SD& sd				= *feather.get<SD>(0);
+	SD& sd_open			= *feather.get<SD>(1);
+	BinarySD& binary	= *feather.get<BinarySD>();
+
+	state.measure("sd_csv", [&]{ sd.log(); });
+	state.measure("sd_csv_keep_open", [&]{ sd_open.log(); });
+	state.measure("binary_json", [&]{ binary.log(feather.internal_json()); });
+	state.measure("binary_record", [&]{ binary.log(); });
+
+	binary.close_file();
+
+	// Packaged and logged each cycle, the json only built if a log platform asks for it
+	Manager node{};
+	node.parse_config(log_all_config);
+	node.measure();
+
+	state.measure("log_all_json", [&]{
+		node.package_record();
+		node.log_all(node.internal_json());
+	});
+	state.measure("log_all_record", [&]{
+		node.package_record();
+		node.log_all();
+	});
+
+	node.get<BinarySD>()->close_file();
+}
@@ -0,0 +1,59 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+/// @file		Lookup.cpp
+/// @brief		Module lookup: Manager::get<T>() and the per-cycle
+///				category dispatch of measure().
+/// @date		2020
+/// @copyright	GNU General Public License v3.0
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#include "Bench.h"
+
+#include <Manager.h>
+#include <Sensors/Analog.h>
+#include <LogPlats/BatchSD.h>
+#include <LogPlats/OLED.h>
+#include <RTC/RTC.h>
+
+using namespace Loom;
+
+static const char* lookup_config = "{\
+	'general':{'name':'Device','instance':1,'print_verbosity':0},\
+	'components':[\
+		{'name':'Analog','params':'default'},\
+		{'name':'Digital','params':'default'},\
+		{'name':'DS3231','params':'default'},\
+		{'name':'InterruptManager','params':'default'},\
+		{'name':'SleepManager','params':'default'},\
+		{'name':'SD','params':[false,0,11,'log',true]},\
+		{'name':'BatchSD','params':[false,0,11]}\
+	]\
+}";
+
+///////////////////////////////////////////////////////////////////////////////
+BENCH(lookup)
+{
+	LoomNative::Pins::set_analog(A0, 1024);
+
+	Manager feather{};
+	feather.parse_config(lookup_config);
+
+	// Keeps the lookups from being optimized away
+	static Module* volatile found;
+
+	// Last module, as CommPlat::send_batch() looks it up
+	state.measure("get_batchsd", [&]{ found = feather.get<BatchSD>(); });
+	if (!found) state.note("get<BatchSD>() found no module");
+
+	// Missing module, as PublishPlat::second_stage_ctor() looks up an InternetPlat
+	state.measure("get_missing", [&]{ found = feather.get<OLED>(); });
+	if (found) state.note("get<OLED>() found a module");
+
+	// Abstract class, matching a derived module
+	state.measure("get_rtc", [&]{ found = feather.get<RTC>(); });
+	if (!found) state.note("get<RTC>() found no module");
+
+	// Every module is checked for the sensor, multiplexer and NTP categories
+	state.measure("measure", [&]{ feather.measure(); });
+}
@@ -0,0 +1,103 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+/// @file		Schedule.cpp
+/// @brief		Cooperative scheduler versus the blocking measure / pause loop,
+///				with a fast sensor next to one on a slow bus.
+/// @date		2020
+/// @copyright	GNU General Public License v3.0
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#include "Bench.h"
+
+#include <Manager.h>
+#include <Sensors/Sensor.h>
+
+using namespace Loom;
+
+/// Sensor that is cheap to read, counts its samples
+class FastSensor : public Sensor
+{
+	LOOM_MODULE_TYPE(FastSensor, Sensor)
+
+public:
+
+	uint32_t	samples = 0;
+
+	FastSensor() : Sensor("Fast", 1) {}
+
+	void		measure() override { samples++; }
+	void		package(JsonObject) override {}
+	void		print_measurements() const override {}
+};
+
+/// Sensor on a slow bus, like SDI-12: a command and a data request
+/// that each take 30 ms to be answered
+class SlowBusSensor : public Sensor
+{
+	LOOM_MODULE_TYPE(SlowBusSensor, Sensor)
+
+public:
+
+	AsyncDelay	wait;
+	uint8_t		step = 0;
+
+	SlowBusSensor() : Sensor("Slow", 1) {}
+
+	void		measure() override { delay(30); delay(30); }
+	bool		poll() override
+	{
+		if (step == 0) {
+			wait.start(30, AsyncDelay::MILLIS);
+			step = 1;
+		} else if (wait.isExpired()) {
+			wait.start(30, AsyncDelay::MILLIS);
+			step = (step + 1) % 3;
+		}
+		return step != 0;
+	}
+	void		package(JsonObject) override {}
+	void		print_measurements() const override {}
+};
+
+///////////////////////////////////////////////////////////////////////////////
+BENCH(schedule)
+{
+	// One virtual second of a node that would like the fast sensor every
+	// 10 ms and the slow one once a second
+	{
+		Manager feather{"Device", 1, Manager::DeviceType::NODE, Verbosity::V_OFF, Verbosity::V_OFF};
+		auto fast = new FastSensor();
+		feather.add_module(fast);
+		feather.add_module(new SlowBusSensor());
+
+		state.measure("blocking_1s", [&]{
+			const uint32_t start = fast->samples;
+			const unsigned long begin = millis();
+			while (millis() - begin < 1000) {
+				feather.measure();
+				feather.pause(10);
+			}
+			state.count("fast_samples", fast->samples - start);
+		});
+	}
+
+	{
+		Manager feather{"Device", 1, Manager::DeviceType::NODE, Verbosity::V_OFF, Verbosity::V_OFF};
+		auto fast = new FastSensor();
+		auto slow = new SlowBusSensor();
+		feather.add_module(fast);
+		feather.add_module(slow);
+		feather.schedule(fast, 10);
+		feather.schedule(slow, 1000);
+
+		state.measure("scheduled_1s", [&]{
+			const uint32_t start = fast->samples;
+			feather.run(1000);
+			state.count("fast_samples", fast->samples - start);
+		});
+
+		// Scheduler overhead of a pass with nothing due
+		state.measure("poll_idle", [&]{ feather.poll(); });
+	}
+}
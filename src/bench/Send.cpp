@@ -0,0 +1,108 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+/// @file		Send.cpp
+/// @brief		Encode cost per radio packet: the MsgPack passes a send
+///				makes before the driver gets the bytes.
+/// @date		2020
+/// @copyright	GNU General Public License v3.0
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#include "Bench.h"
+
+#include <Manager.h>
+#include <CommPlats/CommPlat.h>
+
+using namespace Loom;
+
+static const char* send_config = "{\
+	'general':{'name':'Device','instance':1,'print_verbosity':0},\
+	'components':[\
+		{'name':'Analog','params':'default'},\
+		{'name':'Digital','params':'default'}\
+	]\
+}";
+
+/// Platform whose driver takes a LoRa sized frame instantly,
+/// so only the CommPlat's side of a send is measured
+class InstantRadio : public CommPlat
+{
+	LOOM_MODULE_TYPE(InstantRadio, CommPlat)
+
+public:
+
+	InstantRadio() : CommPlat("Radio", 251) {}
+
+	uint8_t		get_address() const override { return 1; }
+	void		set_address(const uint8_t) override {}
+
+	bool		send_raw(uint8_t*, const uint8_t, const uint8_t) override { return true; }
+
+	uint16_t	encode(JsonObjectConst json) { return json_to_msgpack_buffer(json, send_buffer, sizeof(send_buffer)); }
+
+protected:
+
+	bool		supports_frames() const override { return true; }
+};
+
+/// Same, for a platform without frames (like Bluetooth): whole messages only
+class InstantLink : public InstantRadio
+{
+public:
+
+	uint32_t	reencoded = 0;	///< Messages sent through send_impl(), encoding the json again
+
+	bool		send_impl(JsonObject, const uint8_t) override { reencoded++; return true; }
+
+protected:
+
+	bool		supports_frames() const override { return false; }
+};
+
+///////////////////////////////////////////////////////////////////////////////
+BENCH(send)
+{
+	Manager feather{};
+	feather.parse_config(send_config);
+	feather.measure();
+	feather.package();
+	JsonObject json = feather.internal_json();
+
+	InstantRadio radio;
+	const size_t size = measureMsgPack(json);
+
+	// Keeps the encoding from being optimized away
+	static volatile size_t sink;
+
+	// Before: send() measured the json, LoRa::send_impl() serialized it into
+	// a stack buffer, then measured it again for the length given to the driver
+	state.measure("legacy_encode", [&]{
+		if (measureMsgPack(json) < 252) {
+			char buffer[251];
+			serializeMsgPack(json, buffer, sizeof(buffer));
+			sink = measureMsgPack(json) + buffer[0];
+		}
+		state.count("bytes", size);
+	});
+
+	// One pass into the CommPlat's transmit buffer gives the bytes and length
+	state.measure("encode", [&]{
+		sink = radio.encode(json);
+		state.count("bytes", size);
+	});
+	if (sink != size) state.note("encode() length differs from measureMsgPack()");
+
+	// Whole send() down to the driver
+	state.measure("send", [&]{
+		radio.send(json, 2);
+		state.count("bytes", size);
+	});
+
+	// Without frames, the encoded bytes still go to the driver as they are
+	InstantLink link;
+	state.measure("send_no_frames", [&]{
+		link.send(json, 2);
+		state.count("bytes", size);
+	});
+	if (link.reencoded) state.note("send() encoded the json again for a platform without frames");
+}
@@ -0,0 +1,51 @@
+///////////////////////////////////////////////////////////////////////////////
+///
+/// @file		Startup.cpp
+/// @brief		Boot / wake-from-reset cost: module registration and
+///				Manager::parse_config().
+/// @date		2020
+/// @copyright	GNU General Public License v3.0
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#include "Bench.h"
+
+#include <Manager.h>
+#include <Module_Factory.h>
+#include <Sensors/Analog.h>
+
+using namespace Loom;
+
+// Components of a typical node, looked up by name at startup
+static const char* startup_config = "{\
+	'general':{'name':'Device','instance':1,'print_verbosity':0},\
+	'components':[\
+		{'name':'Analog','params':'default'},\
+		{'name':'Digital','params':'default'},\
+		{'name':'SD','params':[false,0,11,'log',true]},\
+		{'name':'DS3231','params':'default'},\
+		{'name':'InterruptManager','params':'default'},\
+		{'name':'SleepManager','params':'default'}\
+	]\
+}";
+
+///////////////////////////////////////////////////////////////////////////////
+BENCH(startup)
+{
+	// Every translation unit including a module's header registers it again
+	// during static initialization, which is rejected as a duplicate
+	state.measure("register_duplicate", [&]{ Registry<Module>::add<Analog>("Analog"); });
+
+	// Name lookup, a name near the end of the table and a missing name
+	state.measure("create_missing", [&]{ Registry<Module>::create("NotAModule"); });
+
+	StaticJsonDocument<256> doc;
+	deserializeJson(doc, "{'name':'Analog','params':'default'}");
+	JsonVariant component = doc.as<JsonVariant>();
+	state.measure("create_analog", [&]{ delete Registry<Module>::create(component); });
+
+	state.measure("parse_config", [&]{
+		Manager feather{};
+		feather.parse_config(startup_config);
+	});
+}